@@ -165,6 +165,28 @@ ifeq ($(PLATFORM),Windows)
     LIBMSACM
 endif
 
+#------------------------------------------------------------------------------
+# Offline build dependencies
+DEPENDENCIES_OFFLINE = \
+  $(DEPENDENCIES_COMMON)
+
+ifeq ($(PLATFORM),Linux)
+  DEPENDENCIES_OFFLINE += \
+    LIBSNDFILE
+endif
+
+ifeq ($(PLATFORM),BSD)
+  DEPENDENCIES_OFFLINE += \
+    LIBSNDFILE
+endif
+
+ifeq ($(PLATFORM),Windows)
+  DEPENDENCIES_OFFLINE += \
+    LIBSHLWAPI \
+    LIBWINMM \
+    LIBMSACM
+endif
+
 #------------------------------------------------------------------------------
 # VST build dependencies
 DEPENDENCIES_VST2 = \
@@ -210,6 +232,7 @@ DEPENDENCIES = \
   $(DEPENDENCIES_LV2) \
   $(DEPENDENCIES_LV2_UI) \
   $(DEPENDENCIES_LV2TTL_GEN) \
+  $(DEPENDENCIES_OFFLINE) \
   $(DEPENDENCIES_VST2)
 
 TEST_DEPENDENCIES = \
@@ -44,6 +44,8 @@
 #define MIDI_EVENTS_MAX                     4096                /* Maximum number of MIDI events per buffer         */
 #define OSC_BUFFER_MAX                      0x100000            /* Maximum size of the OSC messaging buffer (bytes) */
 #define OSC_PACKET_MAX                      0x10000             /* Maximum size of the OSC packet (bytes)           */
+#define OSC_BUNDLE_HEADER                   16                  /* Size of the OSC bundle header (bytes)            */
+#define OSC_TIMETAG_IMMEDIATE               1                   /* OSC time tag that means 'immediately'            */
 #define OPTIMAL_ALIGN                       64                  /* Optimal data structure alignment                 */
 #define MAX_PARAM_ID_BYTES                  64
 #define FLOAT_CMP_PREC                      1e-6f               /* Float comparison precision                       */
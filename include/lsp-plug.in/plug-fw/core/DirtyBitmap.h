@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 21 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_CORE_DIRTYBITMAP_H_
+#define LSP_PLUG_IN_PLUG_FW_CORE_DIRTYBITMAP_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+
+namespace lsp
+{
+    namespace core
+    {
+        /**
+         * Lock-free two-level bitmap of changed items. Any thread may mark items
+         * as changed without locking, the single consumer thread fetches the changed
+         * items and clears their state. Each bit of the upper level tells that the
+         * corresponding word of the lower level has changed items, so the cost of
+         * fetching is proportional to the number of changes rather than to the number
+         * of items.
+         */
+        class DirtyBitmap
+        {
+            private:
+                DirtyBitmap & operator = (const DirtyBitmap &);
+
+            protected:
+                enum constants_t
+                {
+                    WORD_SHIFT      = 5,
+                    WORD_BITS       = 1 << WORD_SHIFT,
+                    WORD_MASK       = WORD_BITS - 1
+                };
+
+            protected:
+                size_t                  nItems;         // Number of items
+                size_t                  nWords;         // Number of words at the lower level
+                size_t                  nGroups;        // Number of words at the upper level
+                volatile uint32_t      *vWords;         // Lower level: one bit per item
+                volatile uint32_t      *vGroups;        // Upper level: one bit per lower level word
+                uint8_t                *pData;          // Allocated data
+
+                // Consumer state
+                size_t                  nNextGroup;     // Next group to fetch
+                size_t                  nGroup;         // Current group
+                uint32_t                nGroupBits;     // Pending bits of the current group
+                size_t                  nWord;          // Current word
+                uint32_t                nWordBits;      // Pending bits of the current word
+
+            public:
+                explicit DirtyBitmap();
+                ~DirtyBitmap();
+
+                /**
+                 * Initialize the bitmap
+                 * @param items number of items to track
+                 * @return status of operation
+                 */
+                status_t                init(size_t items);
+
+                /**
+                 * Destroy the bitmap
+                 */
+                void                    destroy();
+
+            public:
+                /**
+                 * Get number of tracked items
+                 * @return number of tracked items
+                 */
+                inline size_t           size() const    { return nItems; }
+
+                /**
+                 * Mark the item as changed, wait-free, can be called from any thread.
+                 * Indices out of range are ignored.
+                 * @param index index of the item
+                 */
+                void                    mark(size_t index);
+
+                /**
+                 * Mark all items as changed, can be called from any thread
+                 */
+                void                    mark_all();
+
+                /**
+                 * Fetch next changed item and clear its state, should be called by the
+                 * single consumer thread only. The consumer should call this method until
+                 * it returns false, items marked during the fetch are either returned by
+                 * the current pass or by the next one.
+                 * @param index pointer to store the index of the changed item
+                 * @return true if the item has been fetched, false if there are no more
+                 *   changed items in the current pass
+                 */
+                bool                    next(size_t *index);
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_CORE_DIRTYBITMAP_H_ */
@@ -53,6 +53,38 @@ namespace lsp
                 void                    destroy();
                 IDBuffer               *resize(size_t lines, size_t items);
 
+                /**
+                 * Decimate the source data into the min/max envelope, each item of the buffer
+                 * covers the equal part of the source data
+                 * @param min_line line to store minimums
+                 * @param max_line line to store maximums
+                 * @param src source data
+                 * @param count number of source samples
+                 */
+                void                    decimate_minmax(size_t min_line, size_t max_line, const float *src, size_t count);
+
+                /**
+                 * Decimate the source data into the absolute peak values
+                 * @param line line to store peaks
+                 * @param src source data
+                 * @param count number of source samples
+                 * @param hold keep the previous value of the item if it is greater than the new peak
+                 */
+                void                    decimate_peak(size_t line, const float *src, size_t count, bool hold);
+
+                /**
+                 * Resample linearly-spaced frequency bins (e.g. FFT spectrum) into the logarithmic
+                 * frequency scale. Each item takes the maximum of bins falling into its band or the
+                 * interpolated value if there are no such bins
+                 * @param line line to store values
+                 * @param src source bins, the bin with index i corresponds to frequency i*f_src/count
+                 * @param count number of source bins
+                 * @param f_src the frequency corresponding to the bin index equal to count
+                 * @param f_min frequency of the first item
+                 * @param f_max frequency of the last item
+                 */
+                void                    resample_log(size_t line, const float *src, size_t count, float f_src, float f_min, float f_max);
+
                 void                    dump(dspu::IStateDumper *v) const;
         };
     }
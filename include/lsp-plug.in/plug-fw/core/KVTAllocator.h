@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 16 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_CORE_KVTALLOCATOR_H_
+#define LSP_PLUG_IN_PLUG_FW_CORE_KVTALLOCATOR_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace core
+    {
+        /**
+         * Size-class allocator used by the KVT storage. Small blocks are bump-allocated
+         * from large memory chunks and are recycled into per-size-class free lists
+         * when released. Large blocks are allocated directly from the heap.
+         * All chunks are returned to the system only on destroy() call.
+         */
+        class KVTAllocator
+        {
+            private:
+                KVTAllocator & operator = (const KVTAllocator &);
+
+            protected:
+                enum constants_t
+                {
+                    GRANULARITY     = 16,                       // Size class granularity
+                    SIZE_CLASSES    = 32,                       // Number of size classes
+                    SMALL_MAX       = GRANULARITY * SIZE_CLASSES, // Maximum size of small block
+                    CHUNK_SIZE      = 0x10000                   // Size of the memory chunk
+                };
+
+                typedef struct block_t
+                {
+                    block_t            *next;           // Next free block of the same size class
+                } block_t;
+
+                typedef struct chunk_t
+                {
+                    chunk_t            *next;           // Next allocated chunk
+                } chunk_t;
+
+            protected:
+                block_t                *vFree[SIZE_CLASSES];
+                chunk_t                *pChunks;
+                uint8_t                *pHead;          // Current allocation position in the chunk
+                uint8_t                *pTail;          // End of the current chunk
+                size_t                  nChunks;        // Number of allocated chunks
+                size_t                  nLarge;         // Number of large blocks allocated from heap
+
+            protected:
+                static inline size_t    size_class(size_t size);
+                void                   *bump_alloc(size_t bytes);
+
+            public:
+                explicit KVTAllocator();
+                ~KVTAllocator();
+
+                /**
+                 * Release all memory chunks. All blocks allocated from chunks
+                 * become invalid, large blocks should be released before
+                 */
+                void                    destroy();
+
+            public:
+                /**
+                 * Allocate the memory block
+                 * @param size size of the block
+                 * @return pointer to the block aligned to 16 bytes or NULL if there is no memory
+                 */
+                void                   *alloc(size_t size);
+
+                /**
+                 * Release the memory block
+                 * @param ptr pointer to the block, may be NULL
+                 * @param size the size of the block passed to the alloc() call
+                 */
+                void                    free(void *ptr, size_t size);
+
+                /**
+                 * Duplicate the string
+                 * @param s string to duplicate
+                 * @return pointer to the duplicate or NULL if there is no memory
+                 */
+                char                   *strdup(const char *s);
+
+                /**
+                 * Release the string allocated by the strdup() call
+                 * @param s string to release, may be NULL
+                 */
+                void                    free_string(char *s);
+
+            public:
+                inline size_t           chunks() const          { return nChunks;   }
+                inline size_t           large_blocks() const    { return nLarge;    }
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_CORE_KVTALLOCATOR_H_ */
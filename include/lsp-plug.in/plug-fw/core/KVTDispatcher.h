@@ -26,6 +26,7 @@
 #include <lsp-plug.in/ipc/Thread.h>
 #include <lsp-plug.in/ipc/Mutex.h>
 #include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/core/Notifier.h>
 
 namespace lsp
 {
@@ -36,18 +37,53 @@ namespace lsp
             private:
                 KVTDispatcher & operator = (const KVTDispatcher &);
 
+            protected:
+                class KVTTxListener: public KVTListener
+                {
+                    private:
+                        KVTDispatcher  *pDispatcher;
+
+                    public:
+                        explicit KVTTxListener(KVTDispatcher *dispatcher) { pDispatcher = dispatcher; }
+
+                    public:
+                        virtual void created(KVTStorage *storage, const char *id, const kvt_param_t *param, size_t pending);
+                        virtual void changed(KVTStorage *storage, const char *id, const kvt_param_t *oval, const kvt_param_t *nval, size_t pending);
+                        virtual void removed(KVTStorage *storage, const char *id, const kvt_param_t *param, size_t pending);
+                        virtual void updated(KVTStorage *storage, const char *branch, size_t count, size_t pending);
+                };
+
+            protected:
+                typedef struct tx_packet_t
+                {
+                    uint8_t            *data;           // Space reserved in the transmit queue
+                    size_t              avail;          // Amount of reserved space
+                    size_t              size;           // Actual size of the packet
+                    size_t              first;          // Size of the first message
+                    size_t              count;          // Number of messages in the packet
+                } tx_packet_t;
+
             protected:
                 plug::osc_buffer_t *pRx;
                 plug::osc_buffer_t *pTx;
                 KVTStorage         *pKVT;
                 ipc::Mutex         *pKVTMutex;
-                uint8_t            *pPacket;
                 volatile atomic_t   nClients;
                 volatile atomic_t   nTxRequest;
+                volatile atomic_t   nTxStalled;     // Transmit queue is full, consumer should wake up the dispatcher
+                size_t              nCoalesce;      // Coalescing window in milliseconds
+                KVTTxListener       sListener;
+                Notifier            sNotifier;
 
             protected:
                 size_t              receive_changes();
                 size_t              transmit_changes();
+                size_t              tx_stalled(size_t changes);
+                status_t            pack_message(tx_packet_t *pkt, const char *kvt_name, const kvt_param_t *p);
+                status_t            flush_packet(tx_packet_t *pkt);
+
+                static status_t     parse_frame(KVTStorage *kvt, osc::parse_frame_t *frame, size_t flags);
+                static status_t     parse_kvt_message(KVTStorage *kvt, osc::parse_frame_t *frame, size_t flags);
 
             public:
                 explicit KVTDispatcher(KVTStorage *kvt, ipc::Mutex *mutex);
@@ -56,6 +92,21 @@ namespace lsp
             public:
                 virtual status_t    run();
 
+                /**
+                 * Wake up the dispatcher thread, should be called after cancel()
+                 * to let the thread leave the main loop
+                 */
+                void                wakeup();
+
+                /**
+                 * Set the coalescing window: after being woken up, the dispatcher
+                 * waits for the specified amount of time to collect more changes
+                 * before processing them in one pass
+                 * @param millis the coalescing window in milliseconds, 0 to disable
+                 */
+                inline void         set_coalescing(size_t millis)   { nCoalesce = millis;   }
+                inline size_t       coalescing() const              { return nCoalesce;     }
+
                 status_t            submit(const void *data, size_t size);
                 status_t            submit(const osc::packet_t *packet);
 
@@ -63,6 +114,15 @@ namespace lsp
                 status_t            fetch(osc::packet_t *packet, size_t limit);
                 status_t            skip();
 
+                status_t            peek(const void **data, size_t *size);
+                status_t            release();
+
+                /**
+                 * Drop all pending records of the transfer buffer, should be called by the
+                 * reader when the current record can not be located or released
+                 */
+                void                clear_tx();
+
                 void                connect_client();
                 void                disconnect_client();
 
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 18 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_CORE_KVTSNAPSHOT_H_
+#define LSP_PLUG_IN_PLUG_FW_CORE_KVTSNAPSHOT_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/io/IOutStream.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+
+#define KVT_SNAPSHOT_MAGIC          0x4b565453      /* 'KVTS' */
+#define KVT_SNAPSHOT_VERSION        1
+
+namespace lsp
+{
+    namespace core
+    {
+        /**
+         * Binary snapshot of the KVT storage branch. The snapshot has the following
+         * format, all numbers are stored in big-endian byte order:
+         *
+         *   header:
+         *     uint32   magic           'KVTS'
+         *     uint16   version         format version
+         *     uint16   reserved        should be zero
+         *     uint32   count           number of records
+         *     uint32   size            overall size of records in bytes
+         *   record:
+         *     uint32   size            size of the record without this field
+         *     uint8    type            type of the parameter, @see kvt_param_type_t
+         *     uint8    flags           KVT_PRIVATE flag of the parameter, other bits are zero
+         *     uint16   reserved        should be zero
+         *     uint32   length          length of the name
+         *     char[]   name            zero-terminated full name of the parameter
+         *     value:
+         *       32-bit and 64-bit values are stored as is
+         *       strings are stored as uint32 length (0xffffffff for NULL) and zero-terminated data
+         *       blobs are stored as content type string and uint32 length of data followed by data
+         *
+         * The writer does not copy values of strings and blobs, it references them
+         * directly in the storage. That's why the storage should stay locked and
+         * no garbage collection should be performed until the snapshot is written.
+         */
+        class KVTSnapshot
+        {
+            private:
+                KVTSnapshot & operator = (const KVTSnapshot &);
+
+            protected:
+                typedef struct segment_t
+                {
+                    const uint8_t      *data;           // Pointer to the external data, NULL for the internal buffer
+                    size_t              offset;         // Offset in the internal buffer
+                    size_t              size;           // Size of the segment
+                } segment_t;
+
+            protected:
+                lltl::darray<segment_t> vSegments;
+                uint8_t                *pBuffer;        // Internal buffer for headers and names
+                size_t                  nBufSize;       // Size of the internal buffer
+                size_t                  nBufCap;        // Capacity of the internal buffer
+                size_t                  nSize;          // Overall size of the snapshot
+                size_t                  nCount;         // Number of records
+
+            protected:
+                uint8_t                *append(size_t size);
+                status_t                add_internal(size_t offset, size_t size);
+                status_t                add_external(const void *data, size_t size);
+                status_t                add_record(const char *name, const kvt_param_t *p, size_t flags);
+
+            public:
+                explicit KVTSnapshot();
+                ~KVTSnapshot();
+
+            public:
+                /**
+                 * Build snapshot of the storage branch, transient parameters are skipped
+                 * @param kvt KVT storage, should be locked until the snapshot is written
+                 * @param branch the name of the branch to store
+                 * @return status of operation
+                 */
+                status_t                build(KVTStorage *kvt, const char *branch = "/");
+
+                /**
+                 * Write the snapshot to the output stream
+                 * @param os output stream
+                 * @return status of operation
+                 */
+                status_t                write(io::IOutStream *os);
+
+                /**
+                 * Write the snapshot to the memory
+                 * @param dst destination buffer
+                 * @param size size of the destination buffer, should be not less than size()
+                 * @return status of operation
+                 */
+                status_t                write(void *dst, size_t size);
+
+                /**
+                 * Clear the snapshot
+                 */
+                void                    clear();
+
+            public:
+                inline size_t           size() const        { return nSize;                 }
+                inline size_t           count() const       { return nCount;                }
+
+                /**
+                 * Get the segment of the snapshot, can be used to perform the
+                 * scatter/gather output of the whole snapshot at once
+                 * @param index index of the segment
+                 * @param size pointer to store the size of the segment
+                 * @return pointer to the segment data or NULL if index is invalid
+                 */
+                const void             *segment(size_t index, size_t *size) const;
+                inline size_t           segments() const    { return vSegments.size();      }
+        };
+
+        /**
+         * Reader of the binary KVT snapshot. It validates only the header of the
+         * snapshot when opened, records are validated on the fly when iterating
+         * and values are decoded only when requested, so the snapshot can be
+         * read directly from the memory-mapped file. Strings and blobs returned
+         * by the reader point to the snapshot data.
+         */
+        class KVTSnapshotReader
+        {
+            private:
+                KVTSnapshotReader & operator = (const KVTSnapshotReader &);
+
+            protected:
+                const uint8_t          *pHead;          // Next record
+                const uint8_t          *pTail;          // End of records
+                const uint8_t          *pValue;         // Value of the current record
+                const uint8_t          *pEnd;           // End of the current record
+                const char             *pName;          // Name of the current record
+                size_t                  nType;          // Type of the current record
+                size_t                  nFlags;         // Flags of the current record
+                size_t                  nCount;         // Number of records
+                size_t                  nIndex;         // Index of the current record
+
+            public:
+                explicit KVTSnapshotReader();
+                ~KVTSnapshotReader();
+
+            public:
+                /**
+                 * Open snapshot
+                 * @param data snapshot data, should remain valid while the reader is in use
+                 * @param size size of snapshot data
+                 * @return status of operation
+                 */
+                status_t                open(const void *data, size_t size);
+
+                /**
+                 * Move to the next record
+                 * @return STATUS_OK on success, STATUS_EOF if there are no more records
+                 */
+                status_t                next();
+
+                /**
+                 * Decode the value of the current record
+                 * @param p parameter to store the value
+                 * @return status of operation
+                 */
+                status_t                get(kvt_param_t *p) const;
+
+                /**
+                 * Put all remaining records of the snapshot to the storage as a single batch
+                 * @param kvt KVT storage
+                 * @param flags additional flags for the KVTStorage::put() call, KVT_DELEGATE is ignored
+                 * @return status of operation
+                 */
+                status_t                apply(KVTStorage *kvt, size_t flags = 0);
+
+                void                    close();
+
+            public:
+                inline size_t           count() const       { return nCount;                    }
+                inline const char      *name() const        { return pName;                     }
+                inline kvt_param_type_t type() const        { return kvt_param_type_t(nType);   }
+                inline bool             is_private() const  { return nFlags & KVT_PRIVATE;      }
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_CORE_KVTSNAPSHOT_H_ */
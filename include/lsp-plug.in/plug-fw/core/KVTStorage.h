@@ -26,6 +26,7 @@
 #include <lsp-plug.in/common/status.h>
 #include <lsp-plug.in/lltl/parray.h>
 #include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/plug-fw/core/KVTAllocator.h>
 
 namespace lsp
 {
@@ -142,6 +143,17 @@ namespace lsp
                  */
                 virtual void removed(KVTStorage *storage, const char *id, const kvt_param_t *param, size_t pending);
 
+                /**
+                 * Triggers event when parameters of the branch have been created, changed
+                 * or removed within the batch. Individual created(), changed() and removed()
+                 * events are not triggered for these parameters
+                 * @param storage KVT storage that triggered the event
+                 * @param branch the full identifier of the branch
+                 * @param count number of modified parameters in the branch
+                 * @param pending combination of pending flags of all modified parameters
+                 */
+                virtual void updated(KVTStorage *storage, const char *branch, size_t count, size_t pending);
+
                 /**
                  * The parameter has been accessed for reading
                  * @param storage KVT storage that triggered the event
@@ -203,6 +215,7 @@ namespace lsp
 
                 typedef struct kvt_gcparam_t : public kvt_param_t {
                     size_t              flags;
+                    bool                delegated;      // Data is allocated by the caller and is owned by the heap
                     kvt_gcparam_t      *next;
                 } kvt_gcparam_t;
 
@@ -222,6 +235,13 @@ namespace lsp
                     kvt_node_t        **children;       // Children
                     size_t              nchildren;      // Number of children
                     size_t              capacity;       // Capacity in children
+                    bool                unsorted;       // Children are not sorted
+
+                    uint32_t            hash;           // Hash of the full path to the node
+                    kvt_node_t         *hnext;          // Next node in the index bucket
+
+                    size_t              batch;          // Number of children modified in the batch
+                    size_t              bpending;       // Pending flags of children modified in the batch
                 } kvt_node_t;
 
             protected:
@@ -240,11 +260,22 @@ namespace lsp
                 size_t                  nTxPending;
                 size_t                  nRxPending;
 
+                kvt_node_t            **vIndex;         // Full path hash index
+                size_t                  nIndexCap;      // Number of buckets in the index
+                size_t                  nIndexItems;    // Number of nodes in the index
+                bool                    bIndex;         // Index is enabled
+
+                KVTAllocator            sAllocator;     // Allocator for nodes and parameters
+
+                lltl::parray<kvt_node_t> vBatch;        // Branches modified in the batch
+                size_t                  nBatch;         // Batch nesting level
+
             protected:
                 inline void             notify_created(const char *id, const kvt_param_t *param, size_t pending);
                 inline void             notify_rejected(const char *id, const kvt_param_t *rej, const kvt_param_t *curr, size_t pending);
                 inline void             notify_changed(const char *id, const kvt_param_t *oval, const kvt_param_t *nval, size_t flags);
                 inline void             notify_removed(const char *id, const kvt_param_t *param, size_t pending);
+                inline void             notify_updated(const char *branch, size_t count, size_t pending);
                 inline void             notify_access(const char *id, const kvt_param_t *param, size_t pending);
                 inline void             notify_commit(const char *id, const kvt_param_t *param, size_t pending);
                 inline void             notify_missed(const char *id);
@@ -263,12 +294,27 @@ namespace lsp
                 status_t                commit_parameter(const char *path, kvt_node_t *node, const kvt_param_t *value, size_t flags);
                 kvt_gcparam_t          *copy_parameter(const kvt_param_t *src, size_t flags);
 
+                static inline size_t    node_size(size_t len);
                 inline void             init_node(kvt_node_t *node, const char *name, size_t len);
                 kvt_node_t             *allocate_node(const char *name, size_t len);
                 kvt_node_t             *create_node(kvt_node_t *base, const char *name, size_t len);
                 void                    destroy_node(kvt_node_t *node);
                 kvt_node_t             *get_node(kvt_node_t *base, const char *name, size_t len);
                 status_t                walk_node(kvt_node_t **out, const char *name);
+                void                    sort_children(kvt_node_t *node);
+                bool                    batch_event(kvt_node_t *node, size_t pending);
+                static int              compare_nodes(const void *a, const void *b);
+
+                inline static uint32_t  hash_append(uint32_t hash, const char *s, size_t len);
+                inline uint32_t         child_hash(const kvt_node_t *base, const char *name, size_t len) const;
+                bool                    path_hash(const char *name, uint32_t *hash, size_t *len) const;
+                bool                    path_matches(const kvt_node_t *node, const char *name, size_t len) const;
+                kvt_node_t             *index_find(const char *name, size_t len, uint32_t hash) const;
+                kvt_node_t             *index_find_child(const kvt_node_t *base, const char *name, size_t len, uint32_t hash) const;
+                void                    index_add(kvt_node_t *node);
+                void                    index_remove(kvt_node_t *node);
+                bool                    index_grow(size_t capacity);
+                void                    index_drop();
 
                 status_t                do_remove_node(const char *name, kvt_node_t *node, const kvt_param_t **value, kvt_param_type_t type);
                 status_t                do_touch(const char *name, kvt_node_t *node, size_t flags);
@@ -317,8 +363,36 @@ namespace lsp
                 inline  size_t values() const       { return nValues;       }
                 inline  size_t tx_pending() const   { return nTxPending;    }
                 inline  size_t rx_pending() const   { return nRxPending;    }
+                inline  bool   indexed() const      { return bIndex;        }
+                inline  bool   in_batch() const     { return nBatch > 0;    }
                 size_t         listeners() const;
 
+            public:
+                /**
+                 * Enable or disable the full path hash index. The index makes lookup
+                 * of the parameter by its full name to be performed in constant time
+                 * and keeps insertion of new parameters cheap. The index is enabled by default.
+                 * @param enable enable flag
+                 * @return status of operation
+                 */
+                status_t    set_indexed(bool enable);
+
+                /**
+                 * Begin the batch of modifications. Until the matching end_batch() call
+                 * the storage does not trigger created(), changed() and removed() events
+                 * for each parameter, the listeners receive one updated() event per each
+                 * modified branch at the end of the batch instead. Batches may be nested,
+                 * the gc() call is not allowed within the batch.
+                 * @return status of operation
+                 */
+                status_t    begin_batch();
+
+                /**
+                 * End the batch of modifications and notify listeners
+                 * @return status of operation
+                 */
+                status_t    end_batch();
+
             public:
                 /**
                  * Put parameter to the storage
@@ -422,7 +496,7 @@ namespace lsp
                 /**
                  * Perform garbage collection. Any of previously returned pointers to strings and
                  * blobs can become invalid
-                 * @return status of operation
+                 * @return status of operation, STATUS_BAD_STATE if called within the batch
                  */
                 status_t    gc();
 
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 14 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_CORE_NOTIFIER_H_
+#define LSP_PLUG_IN_PLUG_FW_CORE_NOTIFIER_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+
+#if defined(PLATFORM_WINDOWS)
+    #include <windows.h>
+#else
+    #include <semaphore.h>
+#endif /* PLATFORM_WINDOWS */
+
+#define NOTIFIER_POLL_PERIOD        100     /* Polling period in milliseconds if the semaphore is not available */
+
+namespace lsp
+{
+    namespace core
+    {
+        /**
+         * Auto-reset notification primitive for waking up a single waiting thread.
+         * The notify() call is lock-free and performs the system call only if
+         * the waiting thread is sleeping, so it is safe to call it from the
+         * real-time thread. Multiple notifications issued while the waiting
+         * thread is busy are coalesced into a single wakeup.
+         */
+        class Notifier
+        {
+            private:
+                Notifier & operator = (const Notifier &);
+
+            protected:
+                volatile atomic_t       nSerial;        // Notification serial number
+                volatile atomic_t       nWaiting;       // Waiting thread is sleeping
+                atomic_t                nSeen;          // Last serial number seen by waiting thread
+                bool                    bInit;
+
+            #if defined(PLATFORM_WINDOWS)
+                HANDLE                  hSem;
+            #else
+                sem_t                   hSem;
+            #endif /* PLATFORM_WINDOWS */
+
+            protected:
+                void                    sem_wait();
+                void                    sem_post();
+
+            public:
+                explicit Notifier();
+                ~Notifier();
+
+                status_t                init();
+                void                    destroy();
+
+            public:
+                /**
+                 * Wake up the waiting thread, can be called from any thread
+                 */
+                void                    notify();
+
+                /**
+                 * Wait until notify() is called. Returns immediately if there were
+                 * notifications since the previous call of wait(). Should be called
+                 * by the single thread only. If the notifier has not been initialized,
+                 * sleeps for NOTIFIER_POLL_PERIOD milliseconds instead.
+                 */
+                void                    wait();
+
+                /**
+                 * Check that there were notifications since the previous call of wait()
+                 * @return true if there are pending notifications
+                 */
+                bool                    pending() const;
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_CORE_NOTIFIER_H_ */
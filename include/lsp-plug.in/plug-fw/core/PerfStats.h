@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 24 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_CORE_PERFSTATS_H_
+#define LSP_PLUG_IN_PLUG_FW_CORE_PERFSTATS_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+
+#define PERF_HIST_BUCKETS           11          /* 10 buckets per 10% of the budget and one for overruns */
+#define PERF_RISK_LOAD              0.75f       /* The load considered to be the risk of the xrun */
+#define PERF_PUBLISH_PERIOD         500000000u  /* Publish statistics each 500 ms of the processed audio */
+#define PERF_KVT_BRANCH             "/internal/perf/"
+
+namespace lsp
+{
+    namespace core
+    {
+        enum perf_stage_t
+        {
+            PERF_PRE,               // Pre-processing of ports and settings update
+            PERF_PROCESS,           // Call of the plugin's process() method
+            PERF_POST,              // Post-processing of ports
+
+            PERF_STAGES
+        };
+
+        /**
+         * Statistics of processing cycles collected over the period of time
+         */
+        typedef struct perf_stats_t
+        {
+            uint32_t    nCycles;                    // Number of processing cycles
+            uint64_t    nSamples;                   // Number of processed samples
+            uint64_t    nBudget;                    // Time budget of all cycles (duration of the audio), ns
+            uint64_t    vTime[PERF_STAGES];         // Overall time spent in each stage, ns
+            uint64_t    vMaxTime[PERF_STAGES];      // Maximum time spent in each stage per cycle, ns
+            float       fMaxLoad;                   // Maximum ratio between the cycle time and the budget
+            uint32_t    nRisk;                      // Number of cycles with load above PERF_RISK_LOAD
+            uint32_t    nOverruns;                  // Number of cycles that have exceeded the budget
+            uint64_t    nTotalRisk;                 // Number of risky cycles since the start
+            uint64_t    nTotalOverruns;             // Number of cycles exceeded the budget since the start
+            uint32_t    vHist[PERF_HIST_BUCKETS];   // Histogram of the cycle load
+        } perf_stats_t;
+
+        /**
+         * Lock-free collector of the processing cycle timings. The collector is owned
+         * by the processing thread: begin(), mark() and end() just read the monotonic
+         * clock and update counters without any locks or memory allocations.
+         * When the period is complete, the caller takes the snapshot of statistics
+         * with publish() and passes it to the non-realtime thread for reporting.
+         */
+        class PerfStats
+        {
+            private:
+                PerfStats & operator = (const PerfStats &);
+                PerfStats(const PerfStats &);
+
+            protected:
+                perf_stats_t    sCurr;                      // Statistics of the current period
+                uint64_t        vStamp[PERF_STAGES + 1];    // Timestamps of the current cycle
+                uint64_t        nPeriod;                    // The period of publishing, ns
+
+            public:
+                explicit PerfStats();
+                ~PerfStats();
+
+            public:
+                /**
+                 * Get the value of the monotonic clock
+                 * @return value of the monotonic clock in nanoseconds
+                 */
+                static uint64_t         time();
+
+                /**
+                 * Write the statistics to the KVT storage as transient parameters
+                 * @param kvt KVT storage
+                 * @param base the KVT branch to write parameters, should end with '/'
+                 * @param stats statistics to write
+                 * @return status of operation
+                 */
+                static status_t         write(KVTStorage *kvt, const char *base, const perf_stats_t *stats);
+
+            public:
+                /**
+                 * Reset all statistics including the total counters
+                 */
+                void                    clear();
+
+                /**
+                 * Set the period of publishing
+                 * @param period period in nanoseconds of the processed audio
+                 */
+                inline void             set_period(uint64_t period)     { nPeriod = period;         }
+                inline uint64_t         period() const                  { return nPeriod;           }
+
+                /**
+                 * Mark the start of the processing cycle
+                 */
+                inline void             begin()                         { vStamp[0] = time();       }
+
+                /**
+                 * Mark the end of the processing stage
+                 * @param stage the processing stage
+                 */
+                inline void             mark(perf_stage_t stage)        { vStamp[stage + 1] = time(); }
+
+                /**
+                 * Mark the end of the processing cycle and update statistics. All stages should be marked
+                 * @param samples number of samples processed within the cycle
+                 * @param sample_rate the sample rate
+                 * @return true if the period is complete and statistics can be published
+                 */
+                bool                    end(size_t samples, float sample_rate);
+
+                /**
+                 * Take the snapshot of statistics and start the new period
+                 * @param dst destination to store the snapshot
+                 */
+                void                    publish(perf_stats_t *dst);
+
+                /**
+                 * Drop statistics of the current period and start the new period
+                 */
+                void                    restart();
+
+                /**
+                 * Get statistics of the current period
+                 * @return statistics of the current period
+                 */
+                inline const perf_stats_t  *current() const             { return &sCurr;            }
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_CORE_PERFSTATS_H_ */
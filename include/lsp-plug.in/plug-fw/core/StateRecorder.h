@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 22 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_CORE_STATERECORDER_H_
+#define LSP_PLUG_IN_PLUG_FW_CORE_STATERECORDER_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/plug-fw/core/JsonDumper.h>
+
+namespace lsp
+{
+    namespace core
+    {
+        /**
+         * State dumper that records the dump into the preallocated binary buffer
+         * without any memory allocation, so it can be used in the realtime thread.
+         * The recorded dump can be replayed later into the JsonDumper from any
+         * non-realtime thread. If the buffer overflows, the rest of the dump is
+         * dropped and all pending scopes are closed on replay.
+         */
+        class StateRecorder: public dspu::IStateDumper
+        {
+            private:
+                StateRecorder & operator = (const StateRecorder &);
+
+            protected:
+                enum op_t
+                {
+                    OP_BEGIN_OBJECT,
+                    OP_END_OBJECT,
+                    OP_BEGIN_ARRAY,
+                    OP_END_ARRAY,
+                    OP_BEGIN_RAW_OBJECT,
+                    OP_END_RAW_OBJECT,
+                    OP_VALUE,
+                    OP_VECTOR
+                };
+
+                enum type_t
+                {
+                    T_NONE,
+                    T_PTR,
+                    T_STRING,
+                    T_BOOL,
+                    T_U8,
+                    T_I8,
+                    T_U16,
+                    T_I16,
+                    T_U32,
+                    T_I32,
+                    T_U64,
+                    T_I64,
+                    T_F32,
+                    T_F64
+                };
+
+                typedef struct record_t
+                {
+                    uint8_t             op;         // Operation
+                    uint8_t             type;       // Type of value
+                    uint16_t            name;       // Length of name including terminating zero, 0 if no name
+                    uint32_t            size;       // Size of payload that follows the name
+                } record_t;
+
+                typedef struct scope_t
+                {
+                    const void         *ptr;        // Pointer to the object
+                    uint64_t            size;       // Size of object or number of array elements
+                } scope_t;
+
+            protected:
+                uint8_t                *vData;      // Recorded data
+                size_t                  nSize;      // Size of recorded data
+                size_t                  nCapacity;  // Capacity of the buffer
+                bool                    bOverflow;  // Overflow flag
+
+            protected:
+                uint8_t                *append(op_t op, type_t type, const char *name, size_t payload);
+                void                    emit_scope(op_t op, const char *name, const void *ptr, size_t size);
+                void                    emit_value(type_t type, const char *name, const void *value, size_t size);
+                void                    emit_string(const char *name, const char *value);
+                void                    emit_vector(type_t type, const char *name, const void *value, size_t count, size_t szof);
+
+                static void             replay_value(JsonDumper *dst, type_t type, const char *name, const uint8_t *data, size_t size);
+                static void             replay_vector(JsonDumper *dst, type_t type, const char *name, const uint8_t *data);
+
+            public:
+                explicit StateRecorder();
+                virtual ~StateRecorder();
+
+                /**
+                 * Initialize the recorder
+                 * @param capacity capacity of the buffer in bytes
+                 * @return status of operation
+                 */
+                status_t    init(size_t capacity);
+
+                /**
+                 * Destroy the recorder
+                 */
+                void        destroy();
+
+            public:
+                /**
+                 * Drop the recorded data, realtime-safe
+                 */
+                void        clear();
+
+                /**
+                 * Get the size of recorded data
+                 * @return size of recorded data in bytes
+                 */
+                inline size_t   size() const            { return nSize;         }
+
+                /**
+                 * Get the capacity of the buffer
+                 * @return capacity of the buffer in bytes
+                 */
+                inline size_t   capacity() const        { return nCapacity;     }
+
+                /**
+                 * Check that the buffer has overflown and the recorded dump is incomplete
+                 * @return true if the buffer has overflown
+                 */
+                inline bool     overflow() const        { return bOverflow;     }
+
+                /**
+                 * Replay the recorded dump
+                 * @param dst the destination dumper
+                 * @return status of operation
+                 */
+                status_t    replay(JsonDumper *dst) const;
+
+            public:
+                void begin_raw_object(const char *name);
+                void begin_raw_object();
+                void end_raw_object();
+
+                virtual void begin_object(const char *name, const void *ptr, size_t szof);
+                virtual void begin_object(const void *ptr, size_t szof);
+                virtual void end_object();
+
+                virtual void begin_array(const char *name, const void *ptr, size_t length);
+                virtual void begin_array(const void *ptr, size_t length);
+                virtual void end_array();
+
+                virtual void write(const void *value);
+                virtual void write(const char *value);
+                virtual void write(bool value);
+                virtual void write(uint8_t value);
+                virtual void write(int8_t value);
+                virtual void write(uint16_t value);
+                virtual void write(int16_t value);
+                virtual void write(uint32_t value);
+                virtual void write(int32_t value);
+                virtual void write(uint64_t value);
+                virtual void write(int64_t value);
+                virtual void write(float value);
+                virtual void write(double value);
+
+                virtual void write(const char *name, const void *value);
+                virtual void write(const char *name, const char *value);
+                virtual void write(const char *name, bool value);
+                virtual void write(const char *name, uint8_t value);
+                virtual void write(const char *name, int8_t value);
+                virtual void write(const char *name, uint16_t value);
+                virtual void write(const char *name, int16_t value);
+                virtual void write(const char *name, uint32_t value);
+                virtual void write(const char *name, int32_t value);
+                virtual void write(const char *name, uint64_t value);
+                virtual void write(const char *name, int64_t value);
+                virtual void write(const char *name, float value);
+                virtual void write(const char *name, double value);
+
+                virtual void writev(const void * const *value, size_t count);
+                virtual void writev(const bool *value, size_t count);
+                virtual void writev(const uint8_t *value, size_t count);
+                virtual void writev(const int8_t *value, size_t count);
+                virtual void writev(const uint16_t *value, size_t count);
+                virtual void writev(const int16_t *value, size_t count);
+                virtual void writev(const uint32_t *value, size_t count);
+                virtual void writev(const int32_t *value, size_t count);
+                virtual void writev(const uint64_t *value, size_t count);
+                virtual void writev(const int64_t *value, size_t count);
+                virtual void writev(const float *value, size_t count);
+                virtual void writev(const double *value, size_t count);
+
+                virtual void writev(const char *name, const void * const *value, size_t count);
+                virtual void writev(const char *name, const bool *value, size_t count);
+                virtual void writev(const char *name, const uint8_t *value, size_t count);
+                virtual void writev(const char *name, const int8_t *value, size_t count);
+                virtual void writev(const char *name, const uint16_t *value, size_t count);
+                virtual void writev(const char *name, const int16_t *value, size_t count);
+                virtual void writev(const char *name, const uint32_t *value, size_t count);
+                virtual void writev(const char *name, const int32_t *value, size_t count);
+                virtual void writev(const char *name, const uint64_t *value, size_t count);
+                virtual void writev(const char *name, const int64_t *value, size_t count);
+                virtual void writev(const char *name, const float *value, size_t count);
+                virtual void writev(const char *name, const double *value, size_t count);
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_CORE_STATERECORDER_H_ */
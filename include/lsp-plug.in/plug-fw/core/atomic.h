@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 14 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_CORE_ATOMIC_H_
+#define LSP_PLUG_IN_PLUG_FW_CORE_ATOMIC_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace core
+    {
+        /**
+         * Load the value with acquire semantics: all memory reads and writes
+         * that follow this load can not be reordered before it
+         * @param ptr pointer to the value
+         * @return the loaded value
+         */
+        template <class T>
+            inline T atomic_load_acquire(const volatile T *ptr)
+            {
+                return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+            }
+
+        /**
+         * Store the value with release semantics: all memory reads and writes
+         * that precede this store can not be reordered after it
+         * @param ptr pointer to the value
+         * @param value value to store
+         */
+        template <class T>
+            inline void atomic_store_release(volatile T *ptr, T value)
+            {
+                __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+            }
+
+        /**
+         * Load the value without any ordering constraints, the only guarantee
+         * is that the load is not torn
+         * @param ptr pointer to the value
+         * @return the loaded value
+         */
+        template <class T>
+            inline T atomic_load_relaxed(const volatile T *ptr)
+            {
+                return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+            }
+
+        /**
+         * Store the value without any ordering constraints, the only guarantee
+         * is that the store is not torn
+         * @param ptr pointer to the value
+         * @param value value to store
+         */
+        template <class T>
+            inline void atomic_store_relaxed(volatile T *ptr, T value)
+            {
+                __atomic_store_n(ptr, value, __ATOMIC_RELAXED);
+            }
+
+        /**
+         * Perform bitwise OR of the value with acquire-release semantics
+         * @param ptr pointer to the value
+         * @param mask the mask to apply
+         * @return the previous value
+         */
+        template <class T>
+            inline T atomic_fetch_or(volatile T *ptr, T mask)
+            {
+                return __atomic_fetch_or(ptr, mask, __ATOMIC_ACQ_REL);
+            }
+
+        /**
+         * Replace the value with acquire-release semantics
+         * @param ptr pointer to the value
+         * @param value new value to store
+         * @return the previous value
+         */
+        template <class T>
+            inline T atomic_exchange(volatile T *ptr, T value)
+            {
+                return __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL);
+            }
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_CORE_ATOMIC_H_ */
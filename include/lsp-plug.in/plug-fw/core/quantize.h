@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 19 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_CORE_QUANTIZE_H_
+#define LSP_PLUG_IN_PLUG_FW_CORE_QUANTIZE_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+
+#define LOG_QUANT_DB_MIN            -160.0f
+#define LOG_QUANT_DB_MAX            32.0f
+
+namespace lsp
+{
+    namespace core
+    {
+        /**
+         * Convert single-precision floating-point value to half-precision
+         * floating-point value with rounding to nearest even
+         * @param value value to convert
+         * @return half-precision floating-point value
+         */
+        uint16_t    float_to_half(float value);
+
+        /**
+         * Convert half-precision floating-point value to single-precision
+         * floating-point value
+         * @param value value to convert
+         * @return single-precision floating-point value
+         */
+        float       half_to_float(uint16_t value);
+
+        /**
+         * Quantize the block of samples to 16-bit signed integers, samples are
+         * normalized by the peak value of the block
+         * @param dst destination buffer
+         * @param src source buffer
+         * @param count number of samples
+         * @return scale to apply to the quantized values to restore original values
+         */
+        float       quantize_int16(int16_t *dst, const float *src, size_t count);
+
+        /**
+         * Restore samples quantized by quantize_int16()
+         * @param dst destination buffer
+         * @param src source buffer
+         * @param scale scale of samples
+         * @param count number of samples
+         */
+        void        dequantize_int16(float *dst, const int16_t *src, float scale, size_t count);
+
+        /**
+         * Quantize the block of samples to half-precision floating-point values,
+         * samples are normalized by the peak value of the block
+         * @param dst destination buffer
+         * @param src source buffer
+         * @param count number of samples
+         * @return scale to apply to the quantized values to restore original values
+         */
+        float       quantize_half(uint16_t *dst, const float *src, size_t count);
+
+        /**
+         * Restore samples quantized by quantize_half()
+         * @param dst destination buffer
+         * @param src source buffer
+         * @param scale scale of samples
+         * @param count number of samples
+         */
+        void        dequantize_half(float *dst, const uint16_t *src, float scale, size_t count);
+
+        /**
+         * Quantize magnitudes to the logarithmic scale. Zero code is reserved for
+         * magnitudes below the lower limit of the scale, other codes are uniformly
+         * distributed over the LOG_QUANT_DB_MIN..LOG_QUANT_DB_MAX decibel range
+         * @param dst destination buffer
+         * @param src source buffer with magnitudes
+         * @param count number of values
+         * @param bits number of bits per code: 8 or 16
+         */
+        void        quantize_log(uint16_t *dst, const float *src, size_t count, size_t bits);
+
+        /**
+         * Restore magnitudes quantized by quantize_log()
+         * @param dst destination buffer
+         * @param src source buffer with codes
+         * @param count number of values
+         * @param bits number of bits per code: 8 or 16
+         */
+        void        dequantize_log(float *dst, const uint16_t *src, size_t count, size_t bits);
+
+        /**
+         * Get the maximum possible size of the row encoded by encode_row()
+         * @param count number of values in the row
+         * @param bits number of bits per code: 8 or 16
+         * @return maximum size of encoded row in bytes
+         */
+        size_t      encoded_row_size(size_t count, size_t bits);
+
+        /**
+         * Encode the row of codes as a difference against the previous row
+         * followed by run-length compression of unchanged codes
+         * @param dst destination buffer of at least encoded_row_size() bytes
+         * @param row row of codes to encode
+         * @param prev previous row of codes, NULL to encode the key row
+         * @param count number of values in the row
+         * @param bits number of bits per code: 8 or 16
+         * @return number of bytes written
+         */
+        size_t      encode_row(uint8_t *dst, const uint16_t *row, const uint16_t *prev, size_t count, size_t bits);
+
+        /**
+         * Decode the row encoded by encode_row()
+         * @param row destination row of codes
+         * @param prev previous row of codes, may be NULL if there is no previous row
+         * @param src encoded data
+         * @param size size of encoded data
+         * @param count number of values in the row
+         * @param bits number of bits per code: 8 or 16
+         * @return status of operation, STATUS_NO_DATA if the row is encoded against
+         *   the previous row which is not present
+         */
+        status_t    decode_row(uint16_t *row, const uint16_t *prev, const uint8_t *src, size_t size, size_t count, size_t bits);
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_CORE_QUANTIZE_H_ */
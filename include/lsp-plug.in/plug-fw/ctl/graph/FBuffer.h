@@ -52,15 +52,26 @@ namespace lsp
                 ctl::Expression     sMode;
 
                 size_t              nRowID;
+                size_t              nRows;          // Number of rows committed to the widget
+                size_t              nCols;          // Number of columns committed to the widget
+                bool                bHidden;        // Widget is hidden, rows are not uploaded
+                bool                bViewer;        // Widget reports its visibility to the port
+
+            protected:
+                static status_t     slot_show(tk::Widget *sender, void *ptr, void *data);
+                static status_t     slot_hide(tk::Widget *sender, void *ptr, void *data);
 
             protected:
                 void                trigger_expr();
+                void                sync_rows();
+                void                set_hidden(bool hidden);
 
             public:
                 explicit FBuffer(ui::IWrapper *wrapper, tk::GraphFrameBuffer *widget);
                 virtual ~FBuffer();
 
                 virtual status_t    init();
+                virtual void        destroy();
 
             public:
                 virtual void        set(ui::UIContext *ctx, const char *name, const char *value);
@@ -63,16 +63,24 @@ namespace lsp
                 ssize_t             nYIndex;
                 ssize_t             nSIndex;
                 ssize_t             nMaxDots;
+                bool                bHidden;        // Widget is hidden
+                bool                bViewer;        // Widget reports its visibility to the port
+
+            protected:
+                static status_t     slot_show(tk::Widget *sender, void *ptr, void *data);
+                static status_t     slot_hide(tk::Widget *sender, void *ptr, void *data);
 
             protected:
                 void                trigger_expr();
                 void                commit_data();
+                void                set_hidden(bool hidden);
 
             public:
                 explicit Mesh(ui::IWrapper *wrapper, tk::GraphMesh *widget, bool stream);
                 virtual ~Mesh();
 
                 virtual status_t    init();
+                virtual void        destroy();
 
             public:
                 virtual void        set(ui::UIContext *ctx, const char *name, const char *value);
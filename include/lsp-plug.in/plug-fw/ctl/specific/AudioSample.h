@@ -126,6 +126,13 @@ namespace lsp
                 ctl::Color          sLabelTextColor[tk::AudioSample::LABELS];
                 ctl::Color          sLabelBgColor;
 
+                float              *vLod;           // Min/max pyramid of all channels
+                size_t              nLodChannels;   // Number of channels in the pyramid
+                size_t              nLodSamples;    // Number of samples in each source channel
+                size_t              nLodStride;     // Number of floats per channel in the pyramid
+                size_t              nLodCapacity;   // Capacity of the pyramid buffer, floats
+                ssize_t             nLodLevel;      // Currently displayed level, negative for source data
+
             protected:
                 static status_t     slot_audio_sample_submit(tk::Widget *sender, void *ptr, void *data);
                 static status_t     slot_dialog_submit(tk::Widget *sender, void *ptr, void *data);
@@ -135,6 +142,7 @@ namespace lsp
                 static status_t     slot_popup_paste_action(tk::Widget *sender, void *ptr, void *data);
                 static status_t     slot_popup_clear_action(tk::Widget *sender, void *ptr, void *data);
                 static status_t     slot_drag_request(tk::Widget *sender, void *ptr, void *data);
+                static status_t     slot_resize(tk::Widget *sender, void *ptr, void *data);
 
             protected:
                 void                show_file_dialog();
@@ -143,6 +151,10 @@ namespace lsp
                 void                sync_status();
                 void                sync_labels();
                 void                sync_mesh();
+                void                sync_samples(bool force);
+                void                build_lod(const plug::mesh_t *mesh);
+                ssize_t             select_lod(size_t width) const;
+                const float        *lod_data(size_t channel, ssize_t level, size_t *count) const;
                 tk::Menu           *create_menu();
                 tk::MenuItem       *create_menu_item(tk::Menu *menu);
 
@@ -51,8 +51,12 @@
     { id, label, U_NONE, R_MESH, F_OUT, 0.0, 0.0, points, dim, NULL, NULL }
 #define STREAM(id, label, dim, frames, capacity) \
     { id, label, U_NONE, R_STREAM, F_OUT, dim, frames, capacity, 0.0f, NULL, NULL }
+#define QSTREAM(id, label, dim, frames, capacity, quant) \
+    { id, label, U_NONE, R_STREAM, F_OUT | (quant), dim, frames, capacity, 0.0f, NULL, NULL }
 #define FBUFFER(id, label, rows, cols) \
     { id, label, U_NONE, R_FBUFFER, F_OUT, 0.0, 0.0, rows, cols, NULL, NULL }
+#define QFBUFFER(id, label, rows, cols, quant) \
+    { id, label, U_NONE, R_FBUFFER, F_OUT | (quant), 0.0, 0.0, rows, cols, NULL, NULL }
 #define PATH(id, label) \
     { id, label, U_STRING, R_PATH, F_IN, 0, 0, 0, 0, NULL, NULL }
 #define TRIGGER(id, label)  \
@@ -125,6 +125,9 @@ namespace lsp
             F_PEAK          = (1 << 9),     // Peak flag
             F_CYCLIC        = (1 << 10),    // Cyclic flag
             F_EXT           = (1 << 11),    // Extended range
+            F_QINT16        = (1 << 12),    // Transfer data quantized to 16-bit integers
+            F_QHALF         = (1 << 13),    // Transfer data quantized to half-precision floating-point values
+            F_QINT8         = (1 << 14),    // Transfer data quantized to 8-bit integers
         };
 
         enum plugin_class_t
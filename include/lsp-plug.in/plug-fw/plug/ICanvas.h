@@ -27,6 +27,8 @@
 #endif /* LSP_PLUG_IN_PLUG_FW_PLUG_IMPL_H_ */
 
 #include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/plug-fw/core/IDBuffer.h>
+#include <lsp-plug.in/plug-fw/plug/data.h>
 #include <lsp-plug.in/runtime/Color.h>
 
 namespace lsp
@@ -41,6 +43,36 @@ namespace lsp
             uint8_t    *pData;          // ARGB32 data, 4 bytes per pixel
         } canvas_data_t;
 
+        enum canvas_series_flags_t
+        {
+            CANVAS_SERIES_FILL  = 1 << 0    // Fill the area bounded by the series before drawing the line
+        };
+
+        /**
+         * Affine transform of the graph point (x, y) into the canvas coordinates:
+         *   x' = x*xx + y*yx + x0
+         *   y' = x*xy + y*yy + y0
+         */
+        typedef struct canvas_transform_t
+        {
+            float       xx, xy;         // Contribution of the x coordinate
+            float       yx, yy;         // Contribution of the y coordinate
+            float       x0, y0;         // Translation
+        } canvas_transform_t;
+
+        /**
+         * Styled series of the graph, refers to the buffers of the graph data
+         */
+        typedef struct canvas_series_t
+        {
+            size_t      nX;             // Index of the buffer with x coordinates
+            size_t      nY;             // Index of the buffer with y coordinates
+            size_t      nFlags;         // Series flags
+            float       fWidth;         // Line width
+            Color       sStroke;        // Line color
+            Color       sFill;          // Fill color, used with CANVAS_SERIES_FILL flag
+        } canvas_series_t;
+
         /**
          * Canvas interface for drawing inline-display
          */
@@ -52,6 +84,24 @@ namespace lsp
 
             protected:
                 canvas_data_t       sData;
+                float              *vGraph;         // Buffer for transformed graph coordinates
+                size_t              nGraphItems;    // Capacity of the graph buffer, points
+
+            protected:
+                float              *graph_buffer(size_t items);
+
+            public:
+                /** Apply affine transform to the graph points
+                 *
+                 * @param dx destination x coordinates
+                 * @param dy destination y coordinates
+                 * @param x source x coordinates
+                 * @param y source y coordinates
+                 * @param t transform to apply
+                 * @param count number of points
+                 */
+                static void transform_graph(float *dx, float *dy, const float *x, const float *y,
+                        const canvas_transform_t *t, size_t count);
 
             public:
                 explicit ICanvas();
@@ -169,6 +219,39 @@ namespace lsp
                  */
                 virtual void draw_lines(float *x, float *y, size_t count);
 
+                /** Draw multiple series of the graph with single call. The line width
+                 * and the color of the last drawn series remain the current ones
+                 *
+                 * @param v array of buffers with graph data
+                 * @param lines number of buffers
+                 * @param items number of points in each buffer
+                 * @param t transform of the graph data into canvas coordinates
+                 * @param series list of series to draw
+                 * @param count number of series
+                 */
+                virtual void draw_graph(const float * const *v, size_t lines, size_t items,
+                        const canvas_transform_t *t, const canvas_series_t *series, size_t count);
+
+                /** Draw multiple series of the graph stored in the inline display buffer
+                 *
+                 * @param buf inline display buffer
+                 * @param t transform of the graph data into canvas coordinates
+                 * @param series list of series to draw
+                 * @param count number of series
+                 */
+                void draw_buffer(const core::IDBuffer *buf, const canvas_transform_t *t, const canvas_series_t *series, size_t count);
+
+                /** Draw multiple series of the graph stored in the newest published frame of the mesh.
+                 * The canvas acts as the consumer of the mesh, so the mesh should be dedicated to
+                 * the inline display and should not be bound to a port or consumed by anybody else.
+                 *
+                 * @param mesh mesh to draw
+                 * @param t transform of the graph data into canvas coordinates
+                 * @param series list of series to draw
+                 * @param count number of series
+                 */
+                void draw_mesh(mesh_t *mesh, const canvas_transform_t *t, const canvas_series_t *series, size_t count);
+
                 /** Draw circle
                  *
                  * @param x circle center x
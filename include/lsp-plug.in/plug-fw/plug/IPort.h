@@ -24,6 +24,7 @@
 
 #include <lsp-plug.in/plug-fw/version.h>
 #include <lsp-plug.in/plug-fw/meta/types.h>
+#include <lsp-plug.in/plug-fw/plug/data.h>
 
 namespace lsp
 {
@@ -85,6 +86,12 @@ namespace lsp
                  */
                 inline const meta::port_t *metadata() const { return pMetadata; };
 
+                /** Get the feedback from the UI consumer of the port data
+                 *
+                 * @return feedback of the mesh, stream or frame buffer port, NULL for other ports
+                 */
+                ui_feedback_t *feedback();
+
                 /** Get buffer casted to specified type
                  *
                  * @return buffer casted to specified type
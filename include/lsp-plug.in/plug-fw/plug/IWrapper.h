@@ -29,10 +29,15 @@
 #include <lsp-plug.in/plug-fw/version.h>
 #include <lsp-plug.in/plug-fw/plug/data.h>
 #include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+#include <lsp-plug.in/plug-fw/core/StateRecorder.h>
+#include <lsp-plug.in/plug-fw/core/PerfStats.h>
 #include <lsp-plug.in/ipc/IExecutor.h>
+#include <lsp-plug.in/ipc/ITask.h>
 #include <lsp-plug.in/resource/ILoader.h>
 #include <lsp-plug.in/resource/PrefixLoader.h>
 
+#define INLINE_DISPLAY_FRESH        0x80        /* The middle frame of the inline display has been rendered */
+
 namespace lsp
 {
     namespace plug
@@ -47,15 +52,198 @@ namespace lsp
             private:
                 IWrapper & operator = (const IWrapper &);
 
+            protected:
+                /**
+                 * Offline task that serializes the recorded plugin state to JSON file
+                 */
+                class StateDumpTask: public ipc::ITask
+                {
+                    private:
+                        StateDumpTask & operator = (const StateDumpTask &);
+
+                    public:
+                        IWrapper                   *pWrapper;
+                        ipc::IExecutor             *pExecutor;  // Executor that runs the task
+                        const meta::plugin_t       *pMeta;      // Metadata of the dumped plugin
+                        const void                 *pObject;    // Pointer to the dumped plugin
+                        core::StateRecorder         sRecorder;  // Recorded state of the plugin
+
+                    public:
+                        explicit StateDumpTask(IWrapper *wrapper, ipc::IExecutor *executor);
+                        virtual ~StateDumpTask();
+
+                    public:
+                        virtual status_t    run();
+                };
+
+                /**
+                 * Offline task that publishes the DSP performance statistics to the KVT
+                 */
+                class PerfStatsTask: public ipc::ITask
+                {
+                    private:
+                        PerfStatsTask & operator = (const PerfStatsTask &);
+
+                    public:
+                        IWrapper                   *pWrapper;
+                        ipc::IExecutor             *pExecutor;  // Executor that runs the task
+                        core::perf_stats_t          sStats;     // Snapshot of statistics
+
+                    public:
+                        explicit PerfStatsTask(IWrapper *wrapper, ipc::IExecutor *executor);
+                        virtual ~PerfStatsTask();
+
+                    public:
+                        virtual status_t    run();
+                };
+
+                /**
+                 * Offline task that renders the inline display into the triple-buffered frame:
+                 * the renderer owns the back frame, the host owns the front frame and the
+                 * middle frame is exchanged between them atomically
+                 */
+                class InlineDisplayTask: public ipc::ITask
+                {
+                    private:
+                        InlineDisplayTask & operator = (const InlineDisplayTask &);
+
+                    public:
+                        IWrapper                   *pWrapper;
+                        ipc::IExecutor             *pExecutor;  // Executor that runs the task
+                        volatile uatomic_t          nDirty;     // The inline display has been invalidated
+                        volatile uatomic_t          nSize;      // Requested size of the frame: (width << 16) | height
+                        uint32_t                    nBack;      // Index of back frame, owned by renderer
+                        uint32_t                    nFront;     // Index of front frame, owned by host
+                        volatile atomic_t           nMiddle;    // Index of middle frame and INLINE_DISPLAY_FRESH flag
+                        bool                        bPublished; // The last run has published the new frame
+                        size_t                      vCapacity[3]; // Capacity of frame data in bytes
+                        plug::canvas_data_t         vFrames[3]; // Rendered frames
+
+                    public:
+                        explicit InlineDisplayTask(IWrapper *wrapper, ipc::IExecutor *executor);
+                        virtual ~InlineDisplayTask();
+
+                    public:
+                        virtual status_t    run();
+
+                        /**
+                         * Take the newest rendered frame as the front frame
+                         * @return the front frame or NULL if nothing has been rendered yet
+                         */
+                        plug::canvas_data_t *consume();
+                };
+
             protected:
                 plug::Module               *pPlugin;
                 resource::ILoader          *pLoader;
                 plug::ICanvas              *pCanvas;            // Inline display featured canvas
                 plug::position_t            sPosition;          // Actual time position
+                StateDumpTask              *pDumpTask;          // Deferred state dump task
+                PerfStatsTask              *pPerfTask;          // DSP performance statistics publishing task
+                InlineDisplayTask          *pDisplayTask;       // Deferred inline display rendering task
+                core::PerfStats             sPerf;              // DSP performance statistics
 
             protected:
                 plug::ICanvas              *create_canvas(size_t width, size_t height);
 
+                /**
+                 * Prepare the deferred state dump: the state is recorded in the realtime
+                 * thread into the preallocated buffer and serialized by the executor service.
+                 * Obtains the executor service and allocates the buffer, so it should be called
+                 * from a non-realtime thread on the first state dump request. Has no effect if
+                 * the dump is already prepared or the plugin does not support state dumps.
+                 * The state is dumped synchronously if it has not been prepared.
+                 */
+                void                        prepare_state_dump();
+
+                /**
+                 * Destroy the deferred state dump, should be called after the executor
+                 * service has been shut down
+                 */
+                void                        destroy_state_dump();
+
+                /**
+                 * Write the state of the plugin to the JSON file
+                 * @param meta plugin metadata
+                 * @param object pointer to the plugin
+                 * @param data the recorded plugin state, NULL to dump the state of the plugin directly
+                 * @return status of operation
+                 */
+                status_t                    write_plugin_state(const meta::plugin_t *meta, const void *object, const core::StateRecorder *data);
+
+                /**
+                 * Prepare collection of the DSP performance statistics which are periodically
+                 * published to the KVT under the PERF_KVT_BRANCH branch while the UI is active,
+                 * so idle instances do not wake the KVT dispatcher. Should be called after
+                 * the plugin has been initialized, has no effect if the executor service or
+                 * the KVT are not available.
+                 */
+                void                        init_perf_stats();
+
+                /**
+                 * Destroy the DSP performance statistics publishing task, should be called
+                 * after the executor service has been shut down
+                 */
+                void                        destroy_perf_stats();
+
+                /**
+                 * Mark the start of the processing cycle
+                 */
+                inline void                 perf_begin()
+                {
+                    if (pPerfTask != NULL)
+                        sPerf.begin();
+                }
+
+                /**
+                 * Mark the end of the stage of the processing cycle
+                 * @param stage the processing stage
+                 */
+                inline void                 perf_mark(core::perf_stage_t stage)
+                {
+                    if (pPerfTask != NULL)
+                        sPerf.mark(stage);
+                }
+
+                /**
+                 * Mark the end of the processing cycle and publish statistics if the period is complete,
+                 * the method is safe to be called from the realtime thread
+                 * @param samples number of samples processed within the cycle
+                 */
+                void                        perf_end(size_t samples);
+
+                /**
+                 * Prepare the deferred rendering of the inline display: the display is rendered
+                 * by the executor service and the host obtains the last completed frame without
+                 * waiting. Should be called after the plugin has been initialized, has no effect
+                 * if the plugin has no inline display or the executor service is not available.
+                 */
+                void                        init_inline_display();
+
+                /**
+                 * Destroy the deferred inline display rendering task, should be called after
+                 * the executor service has been shut down
+                 */
+                void                        destroy_inline_display();
+
+                /**
+                 * Schedule rendering of the inline display if it has been invalidated and check
+                 * whether the new frame is ready. Should be called periodically by the single thread,
+                 * safe to be called from the realtime thread.
+                 * @param invalidate the inline display has been invalidated since the last call
+                 * @return true if the new frame has been rendered and the host should be notified
+                 */
+                bool                        update_inline_display(bool invalidate);
+
+                /**
+                 * Get the last rendered frame of the inline display without waiting, should be called
+                 * by the host thread. The frame stays valid until the next call of this method.
+                 * @param width maximum width of the frame
+                 * @param height maximum height of the frame
+                 * @return the last rendered frame or NULL if it is not available
+                 */
+                plug::canvas_data_t        *inline_display_frame(size_t width, size_t height);
+
             public:
                 explicit IWrapper(Module *plugin, resource::ILoader *loader);
                 virtual ~IWrapper();
@@ -115,7 +303,8 @@ namespace lsp
                 virtual void                    state_changed();
 
                 /**
-                 * Dump the state of plugin
+                 * Dump the state of plugin. If the deferred state dump has been prepared, the
+                 * method only records the state and is safe to be called from the realtime thread.
                  */
                 virtual void                    dump_plugin_state();
 
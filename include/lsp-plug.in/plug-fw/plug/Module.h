@@ -55,8 +55,10 @@ namespace lsp
 
                 long                        fSampleRate;
                 ssize_t                     nLatency;
+                size_t                      nSubBlock;      // Minimum sub-block size for sample-accurate control, 0 if disabled
                 bool                        bActivated;
                 bool                        bUIActive;
+                ui_feedback_t               sUIFeedback;    // Refresh rate of the UI reported by the wrapper
 
             public:
                 explicit Module(const meta::plugin_t *meta);
@@ -79,12 +81,57 @@ namespace lsp
                 inline ssize_t              latency() const                 { return nLatency;          }
                 inline void                 set_latency(ssize_t latency)    { nLatency = latency;       }
 
+                /**
+                 * Get the minimum size of the sub-block for sample-accurate control changes
+                 * @return minimum sub-block size in samples, zero if sample-accurate control is disabled
+                 */
+                inline size_t               sub_block() const               { return nSubBlock;         }
+
+                /**
+                 * Enable sample-accurate control changes: the wrapper may split the processing
+                 * block at timestamps of parameter change events and call update_settings() between
+                 * sub-blocks. The size of each sub-block except the last one is not less than the
+                 * specified value, that bounds the overhead of splitting.
+                 *
+                 * Each call of process() receives only MIDI events that fall into the sub-block,
+                 * with timestamps relative to its start, and the time position advanced to its
+                 * start. OSC packets carry no timestamps and are available from the first sub-block.
+                 *
+                 * @param samples minimum sub-block size in samples, zero to disable
+                 */
+                inline void                 set_sub_block(size_t samples)   { nSubBlock = samples;      }
+
                 void                        set_sample_rate(long sr);
 
                 inline long                 get_sample_rate() const         { return fSampleRate;       }
                 inline bool                 active() const                  { return bActivated;        }
                 inline bool                 ui_active() const               { return bUIActive;         }
 
+                /**
+                 * Get the feedback used by the wrapper to report the refresh rate of the UI
+                 * @return the feedback of the UI
+                 */
+                inline ui_feedback_t       *ui_feedback()                   { return &sUIFeedback;      }
+
+                /**
+                 * Get the effective refresh rate of the UI. The plugin may skip computation
+                 * of the data displayed by the UI when the rate is zero and decimate it
+                 * according to the rate otherwise.
+                 *
+                 * @return number of frames per second consumed by the UI, zero if UI is not active
+                 */
+                float                       ui_refresh_rate();
+
+                /**
+                 * Get the effective refresh rate of the UI for the mesh, stream or frame buffer port.
+                 * The rate is zero if the UI is not active or none of the widgets that display
+                 * the port data is visible.
+                 *
+                 * @param port the port to check
+                 * @return number of frames per second consumed by the UI for the port
+                 */
+                float                       ui_refresh_rate(IPort *port);
+
                 inline IWrapper            *wrapper()                       { return pWrapper;          }
 
                 void                        activate_ui();
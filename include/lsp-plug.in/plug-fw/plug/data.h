@@ -24,7 +24,9 @@
 
 #include <lsp-plug.in/plug-fw/version.h>
 #include <lsp-plug.in/plug-fw/const.h>
+#include <lsp-plug.in/plug-fw/core/atomic.h>
 #include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/atomic.h>
 #include <lsp-plug.in/common/status.h>
 #include <lsp-plug.in/protocol/midi.h>
 #include <lsp-plug.in/protocol/osc.h>
@@ -34,7 +36,11 @@
 #define STREAM_MAX_FRAME_SIZE       0x2000
 #define STREAM_BULK_MAX             0x40
 #define FRAMEBUFFER_BULK_MAX        0x10
+#define FRAMEBUFFER_KEY_PERIOD      0x40
 #define MESH_REFRESH_RATE           20
+#define MESH_FRESH                  0x80
+#define UI_FEEDBACK_PERIOD          500         /* Period of UI feedback reports in milliseconds */
+#define UI_FEEDBACK_UNKNOWN         0xffffffffu
 
 namespace lsp
 {
@@ -47,41 +53,118 @@ namespace lsp
             M_DATA          // Mesh contains data
         };
 
-        // Mesh port structure
+        /**
+         * Feedback from the UI consumer to the DSP producer of mesh, stream and
+         * frame buffer data. The UI reports the rate at which it is able to take
+         * new frames, the zero rate means that none of the widgets displaying the
+         * data is visible. The DSP may use the reported rate to skip or decimate
+         * computation of the data. Only one reporter is allowed.
+         */
+        typedef struct ui_feedback_t
+        {
+            volatile uint32_t       nRate;      // Reported rate in millihertz, UI_FEEDBACK_UNKNOWN if not reported
+
+            /**
+             * Reset the feedback to the initial state when nothing has been reported
+             */
+            inline void             reset()     { core::atomic_store_relaxed(&nRate, uint32_t(UI_FEEDBACK_UNKNOWN));   }
+
+            /**
+             * Report the rate of consumption
+             * @param rate number of frames per second the UI is able to consume, zero if data is not visible
+             */
+            void                    report(float rate);
+
+            /**
+             * Get the rate of consumption
+             * @param dfl default value to return if the rate has not been reported
+             * @return number of frames per second the UI is able to consume
+             */
+            float                   rate(float dfl) const;
+        } ui_feedback_t;
+
+        // Frame of the triple-buffered mesh
+        typedef struct mesh_frame_t
+        {
+            size_t                  nBuffers;   // Number of buffers in the frame
+            size_t                  nItems;     // Number of items per each buffer
+            float                 **vData;      // Array of pointers to buffer data
+        } mesh_frame_t;
+
+        /**
+         * Mesh port structure. The mesh is triple-buffered: the producer always
+         * fills the back frame referenced by pvData and publishes it by calling
+         * data() without waiting for the consumer. The consumer takes the newest
+         * published frame by calling consume() and reads it in place until the
+         * next call of consume(). Only one producer and one consumer are allowed.
+         * After publishing, the new back frame holds a copy of the published data,
+         * so the producer may update only some of the buffers before calling data().
+         */
         typedef struct mesh_t
         {
             volatile mesh_state_t   nState;     // Actual state of the mesh
             size_t                  nBuffers;   // Overall number of buffers
             size_t                  nItems;     // Number of items per each buffer
-            float                  *pvData[];   // Array of pointers to buffer data
+            size_t                  nMaxBuffers;// Maximum number of buffers
+            size_t                  nMaxItems;  // Maximum number of items per each buffer
+            uint32_t                nBack;      // Index of back frame, owned by producer
+            uint32_t                nFront;     // Index of front frame, owned by consumer
+            volatile atomic_t       nMiddle;    // Index of middle frame and MESH_FRESH flag
+            ui_feedback_t           sFeedback;  // Feedback from the consumer
+            mesh_frame_t            vFrames[3]; // Frames of the mesh
+            uint8_t                *pData;      // Allocated data
+            float                  *pvData[];   // Array of pointers to back frame buffer data
 
-            inline bool isEmpty() const         { return nState == M_EMPTY; };
-            inline bool containsData() const    { return nState == M_DATA; };
-            inline bool isWaiting() const       { return nState == M_WAIT;  };
+            /**
+             * Create triple-buffered mesh
+             * @param buffers number of buffers
+             * @param items maximum number of items per each buffer, zero to create
+             *   the mesh which only refers to the data of another mesh
+             * @return pointer to the mesh or NULL if there is not enough memory
+             */
+            static mesh_t  *create(size_t buffers, size_t items);
+            static void     destroy(mesh_t *mesh);
 
-            inline void data(size_t bufs, size_t items)
-            {
-                nBuffers    = bufs;
-                nItems      = items;
-                nState      = M_DATA; // This should be the last operation
-            }
+            inline bool isEmpty() const         { return !(nMiddle & MESH_FRESH);   };
+            inline bool containsData() const    { return nMiddle & MESH_FRESH;      };
+            inline bool isWaiting() const       { return false;                     };
 
-            inline void cleanup()
-            {
-                nBuffers    = 0;
-                nItems      = 0;
-                nState      = M_EMPTY; // This should be the last operation
-            }
+            /**
+             * Publish the back frame and make the next free frame the back frame
+             * @param bufs number of buffers filled
+             * @param items number of items per each buffer
+             */
+            void data(size_t bufs, size_t items);
 
-            inline void markEmpty()
-            {
-                nState      = M_EMPTY; // This should be the last operation
-            }
+            /**
+             * Take the newest published frame as the front frame
+             * @return true if new frame has been published since the last call
+             */
+            bool consume();
 
-            inline void setWaiting()
-            {
-                nState      = M_WAIT; // This should be the last operation
-            }
+            /**
+             * Get the front frame taken by the last consume() call
+             * @return front frame
+             */
+            inline const mesh_frame_t *front() const   { return &vFrames[nFront];  }
+
+            /**
+             * Get the feedback from the consumer
+             * @return feedback from the consumer
+             */
+            inline ui_feedback_t   *feedback()          { return &sFeedback;        }
+
+            /**
+             * Make the mesh refer to the front frame of another mesh without copying data
+             * @param dst mesh created with zero number of items
+             */
+            void view(mesh_t *dst) const;
+
+            // The triple-buffered mesh does not need the handshake between
+            // producer and consumer, these methods are kept for compatibility
+            inline void cleanup()               {                                   };
+            inline void markEmpty()             {                                   };
+            inline void setWaiting()            {                                   };
         } mesh_t;
 
         // Streaming mesh
@@ -103,6 +186,7 @@ namespace lsp
                 size_t                  nFrameCap;  // Capacity in frames
 
                 volatile uint32_t       nFrameId;   // Current frame identifier
+                ui_feedback_t           sFeedback;  // Feedback from the consumer
 
                 frame_t                *vFrames;    // List of frames
                 float                 **vChannels;  // Channel data
@@ -169,6 +253,12 @@ namespace lsp
                  */
                 inline uint32_t         frame_id() const        { return nFrameId;      }
 
+                /**
+                 * Get the feedback from the consumer
+                 * @return feedback from the consumer
+                 */
+                inline ui_feedback_t   *feedback()              { return &sFeedback;    }
+
                 /**
                  * Begin write of frame data
                  * @param size the required size of frame
@@ -196,6 +286,17 @@ namespace lsp
                  */
                 ssize_t                 read(size_t channel, float *data, size_t off, size_t count);
 
+                /**
+                 * Read data of the incremental frame block
+                 * @param channel channel number
+                 * @param frame frame identifier
+                 * @param data destination buffer
+                 * @param off offset relative to the beginning of the incremental frame block
+                 * @param count number of elements to read
+                 * @return number of elements read or negative error code
+                 */
+                ssize_t                 read_frame(size_t channel, uint32_t frame, float *data, size_t off, size_t count);
+
                 /**
                  * Commit the new frame to the list of frames
                  * @return true if frame has been committed
@@ -235,6 +336,7 @@ namespace lsp
                 size_t              nCols;              // Number of columns
                 uint32_t            nCapacity;          // Capacity (power of 2)
                 volatile uint32_t   nRowID;             // Unique row identifier
+                ui_feedback_t       sFeedback;          // Feedback from the consumer
                 float              *vData;              // Aligned row data
                 uint8_t            *pData;              // Allocated row data
 
@@ -285,6 +387,12 @@ namespace lsp
                  */
                 inline size_t cols() const { return nCols; }
 
+                /**
+                 * Get the feedback from the consumer
+                 * @return feedback from the consumer
+                 */
+                inline ui_feedback_t *feedback() { return &sFeedback; }
+
                 /**
                  * Clear the buffer contents, set number of changes equal to buffer rows
                  */
@@ -375,27 +483,66 @@ namespace lsp
             }
 
             void sort();
+
+            /**
+             * Replace the contents with events of the source queue that fall into the
+             * range [off, off + samples), timestamps are rebased to the start of the range
+             *
+             * @param src source queue
+             * @param off offset of the range in samples
+             * @param samples length of the range in samples
+             */
+            void slice(const midi_t *src, size_t off, size_t samples);
+
+            /**
+             * Shift timestamps of events starting with the specified one
+             *
+             * @param first index of the first event to shift
+             * @param off number of samples to add to timestamps
+             */
+            void shift(size_t first, size_t off);
         } midi_t;
 
         /**
          * Buffer to transfer OSC packets between two threads.
-         * It is safe to use if one thread is reading data and one thread is
+         * The buffer is a wait-free single-producer single-consumer ring: it is
+         * safe to use if one thread is reading data and one thread is
          * submitting data. Otherwise, additional synchronization mechanism
-         * should be used
+         * should be used.
+         *
+         * Each record is stored as a 32-bit big-endian size followed by the packet
+         * data. The head and the tail are free-running counters: the writer only
+         * modifies the tail and the reader only modifies the head, both are kept on
+         * separate cache lines to avoid false sharing between threads.
+         *
+         * The packet data of each record is always stored contiguously: if there is
+         * not enough space till the end of the ring, the padding record is emitted
+         * and the packet is stored at the beginning of the ring. That allows to
+         * forge and parse packets directly in the buffer memory with the
+         * reserve_packet()/commit_packet() and peek_packet()/release_packet() calls.
          */
         typedef struct osc_buffer_t
         {
-            volatile size_t     nSize;
-            size_t              nCapacity;
-            size_t              nHead;
-            size_t              nTail;
+            // Reader-side state
+            volatile uint32_t   nHead __lsp_aligned64;  // Read position, modified by reader only
+            uint32_t            nTailCache;             // Last observed write position
+
+            // Writer-side state
+            volatile uint32_t   nTail __lsp_aligned64;  // Write position, modified by writer only
+            uint32_t            nHeadCache;             // Last observed read position
+            uint32_t            nResPad;                // Padding of the reserved record
+            uint32_t            nResSize;               // Size of the reserved record, 0 if none
+            size_t              nForgeMax;              // Maximum size of message forged by submit_* calls
+
+            // Shared read-only state
+            size_t              nCapacity __lsp_aligned64;
+            uint32_t            nMask;                  // Capacity mask, capacity is a power of 2
             uint8_t            *pBuffer;
-            uint8_t            *pTempBuf;
-            size_t              nTempSize;
             void               *pData;
 
             /**
-             * Clear the buffer
+             * Clear the buffer. Should be called by the reader thread or when
+             * no other thread is accessing the buffer
              */
             void                clear();
 
@@ -403,11 +550,15 @@ namespace lsp
              * Get buffer size
              * @return buffer size
              */
-            inline size_t       size() const { return nSize; }
+            inline size_t       size() const
+            {
+                return core::atomic_load_acquire(&nTail) - core::atomic_load_acquire(&nHead);
+            }
 
             /**
              * Initialize buffer
-             * @param capacity the buffer capacity
+             * @param capacity the buffer capacity, should be multiple of 4,
+             *   will be rounded up to the nearest power of 2
              * @return status of operation
              */
             static osc_buffer_t *create(size_t capacity);
@@ -418,11 +569,51 @@ namespace lsp
             static void destroy(osc_buffer_t *buf);
 
             /**
-             * Reserve space for temporary buffer, by default 0x1000 bytes
+             * Set the maximum size of the packet forged by submit_* calls,
+             * by default 0x1000 bytes
              * @return status of operation
              */
             status_t    reserve(size_t size);
 
+            /**
+             * Reserve contiguous space in the buffer to write the packet directly,
+             * should be followed by commit_packet() or cancel_packet() call
+             * @param data pointer to store the address of the reserved space
+             * @param size pointer to store the actual size of the reserved space,
+             *   may be less than limit if there is not enough space in the buffer
+             * @param limit the desired size of the reserved space
+             * @return status of operation, STATUS_OVERFLOW if there is no space
+             */
+            status_t    reserve_packet(void **data, size_t *size, size_t limit);
+
+            /**
+             * Commit the packet written to the reserved space and make it available
+             * to the reader
+             * @param size actual size of the packet, multiple of 4 bytes
+             * @return status of operation
+             */
+            status_t    commit_packet(size_t size);
+
+            /**
+             * Cancel the reservation made by reserve_packet()
+             */
+            void        cancel_packet();
+
+            /**
+             * Get the pointer to the data of the current packet in the buffer without
+             * removing it, should be followed by release_packet() call
+             * @param data pointer to store the address of the packet data
+             * @param size pointer to store size of the packet
+             * @return status of operation, STATUS_NO_DATA if buffer is empty
+             */
+            status_t    peek_packet(const void **data, size_t *size);
+
+            /**
+             * Remove the current packet obtained by peek_packet() from the buffer
+             * @return status of operation
+             */
+            status_t    release_packet();
+
             /**
              * Submit OSC packet to the queue
              * @param data packet data
@@ -596,6 +787,15 @@ namespace lsp
             double          ticksPerBeat;
 
             static void init(position_t *pos);
+
+            /**
+             * Advance the time position by the specified number of samples
+             * at the current speed and tempo
+             *
+             * @param pos time position to advance
+             * @param samples number of samples
+             */
+            static void advance(position_t *pos, size_t samples);
         } position_t;
     }
 }
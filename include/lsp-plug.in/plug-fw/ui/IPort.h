@@ -44,6 +44,8 @@ namespace lsp
             protected:
                 const meta::port_t             *pMetadata;
                 lltl::parray<IPortListener>     vListeners;
+                size_t                          nViewers;       // Number of widgets that report visibility
+                size_t                          nVisible;       // Number of visible widgets
 
             public:
                 explicit IPort(const meta::port_t *meta);
@@ -67,6 +69,31 @@ namespace lsp
                  */
                 void                unbind_all();
 
+                /** Register the widget that displays the port data and reports its visibility
+                 *
+                 * @param visible initial visibility of the widget
+                 */
+                void                add_viewer(bool visible);
+
+                /** Unregister the widget that displays the port data
+                 *
+                 * @param visible current visibility of the widget
+                 */
+                void                remove_viewer(bool visible);
+
+                /** Report the change of visibility of the registered widget
+                 *
+                 * @param visible new visibility of the widget
+                 */
+                void                set_viewer_visible(bool visible);
+
+                /** Check that port data is displayed by any visible widget. The port
+                 * is considered to be visible if no widget has reported its visibility.
+                 *
+                 * @return true if port data is visible
+                 */
+                inline bool         visible() const     { return (nViewers <= 0) || (nVisible > 0); }
+
                 /** Write some data to port
                  *
                  * @param buffer data to write to port
@@ -40,6 +40,8 @@ namespace lsp
             nPosition       = 0;
             pJackStatus     = NULL;
             bJackConnected  = false;
+            nFeedbackTime   = 0;
+            nFeedbackTicks  = 0;
         }
 
         UIWrapper::~UIWrapper()
@@ -59,6 +61,13 @@ namespace lsp
             if (pUI->metadata() == NULL)
                 return STATUS_BAD_STATE;
 
+            // Reserve the synchronization slot for each DSP port
+            for (size_t i=0, n=pWrapper->vAllPorts.size(); i<n; ++i)
+            {
+                if (!vSyncPorts.add(static_cast<jack::UIPort *>(NULL)))
+                    return STATUS_NO_MEM;
+            }
+
             // Create list of ports and sort it in ascending order by the identifier
             lsp_trace("Creating ports for %s - %s", meta->name, meta->description);
             for (const meta::port_t *port = meta->ports ; port->id != NULL; ++port) {
@@ -66,6 +75,9 @@ namespace lsp
                     return res;
             }
 
+            // Force synchronization of all ports at startup
+            pWrapper->dirty_ports()->mark_all();
+
             // Initialize parent
             if ((res = IWrapper::init(root_widget)) != STATUS_OK)
                 return res;
@@ -142,6 +154,9 @@ namespace lsp
         {
             pJackStatus = NULL;
 
+            // Nothing is consumed by the UI anymore
+            reset_feedback();
+
             // Call the parent class for destroy
             IWrapper::destroy();
 
@@ -187,7 +202,14 @@ namespace lsp
 
         void UIWrapper::dump_state_request()
         {
-            return pWrapper->dump_plugin_state();
+            pWrapper->request_state_dump();
+        }
+
+        void UIWrapper::add_sync_port(jack::Port *port, jack::UIPort *uport)
+        {
+            size_t index = port->index();
+            if (index < vSyncPorts.size())
+                vSyncPorts.array()[index]   = uport;
         }
 
         status_t UIWrapper::create_port(const meta::port_t *port, const char *postfix)
@@ -205,26 +227,26 @@ namespace lsp
                 case meta::R_MESH:
                     jup     = new jack::UIMeshPort(jp);
                     if (meta::is_out_port(port))
-                        vSyncPorts.add(jup);
+                        add_sync_port(jp, jup);
                     break;
 
                 case meta::R_FBUFFER:
                     jup     = new jack::UIFrameBufferPort(jp);
                     if (meta::is_out_port(port))
-                        vSyncPorts.add(jup);
+                        add_sync_port(jp, jup);
                     break;
 
                 case meta::R_STREAM:
                     jup     = new jack::UIStreamPort(jp);
                     if (meta::is_out_port(port))
-                        vSyncPorts.add(jup);
+                        add_sync_port(jp, jup);
                     break;
 
                 case meta::R_OSC:
                     if (meta::is_out_port(port))
                     {
                         jup     = new jack::UIOscPortIn(jp);
-                        vSyncPorts.add(jup);
+                        add_sync_port(jp, jup);
                     }
                     else
                         jup     = new jack::UIOscPortOut(jp);
@@ -241,7 +263,7 @@ namespace lsp
 
                 case meta::R_METER:
                     jup     = new jack::UIMeterPort(jp);
-                    vSyncPorts.add(jup);
+                    add_sync_port(jp, jup);
                     break;
 
                 case meta::R_PORT_SET:
@@ -358,11 +380,15 @@ namespace lsp
                 nPosition       = pos;
             }
 
-            // Transfer the values of the ports to the UI
-            size_t sync = vSyncPorts.size();
-            for (size_t i=0; i<sync; ++i)
+            // Transfer the values of the changed ports to the UI
+            size_t index;
+            core::DirtyBitmap *dirty = pWrapper->dirty_ports();
+            while (dirty->next(&index))
             {
-                jack::UIPort *jup   = vSyncPorts.uget(i);
+                jack::UIPort *jup   = vSyncPorts.get(index);
+                if (jup == NULL)
+                    continue;
+
                 do {
                     if (jup->sync())
                         jup->notify_all();
@@ -382,9 +408,56 @@ namespace lsp
 
             dsp::finish(&ctx);
 
+            // Report the actual rate of synchronization to the plugin
+            ++nFeedbackTicks;
+            if (nFeedbackTime == 0)
+                nFeedbackTime   = ts;
+            else if ((ts - nFeedbackTime) >= UI_FEEDBACK_PERIOD)
+            {
+                report_feedback((nFeedbackTicks * 1000.0f) / (ts - nFeedbackTime));
+                nFeedbackTime   = ts;
+                nFeedbackTicks  = 0;
+            }
+
             return true;
         }
 
+        void UIWrapper::report_feedback(float rate)
+        {
+            if (pWrapper == NULL)
+                return;
+            if (pPlugin != NULL)
+                pPlugin->ui_feedback()->report(rate);
+
+            // Ports which are not displayed by any visible widget are not consumed
+            for (size_t i=0, n=pWrapper->vAllPorts.size(); i<n; ++i)
+            {
+                jack::Port *jp          = pWrapper->vAllPorts.uget(i);
+                plug::ui_feedback_t *fb = (jp != NULL) ? jp->feedback() : NULL;
+                if (fb == NULL)
+                    continue;
+
+                jack::UIPort *jup       = vSyncPorts.get(i);
+                fb->report(((jup != NULL) && (jup->visible())) ? rate : 0.0f);
+            }
+        }
+
+        void UIWrapper::reset_feedback()
+        {
+            if (pWrapper == NULL)
+                return;
+            if (pPlugin != NULL)
+                pPlugin->ui_feedback()->reset();
+
+            for (size_t i=0, n=pWrapper->vAllPorts.size(); i<n; ++i)
+            {
+                jack::Port *jp          = pWrapper->vAllPorts.uget(i);
+                plug::ui_feedback_t *fb = (jp != NULL) ? jp->feedback() : NULL;
+                if (fb != NULL)
+                    fb->reset();
+            }
+        }
+
         void UIWrapper::sync_inline_display()
         {
             // Check that window is present
@@ -395,10 +468,8 @@ namespace lsp
             dsp::context_t ctx;
             dsp::start(&ctx);
 
-            // Check if inline display is present
-            plug::canvas_data_t *data = NULL;
-            if (pWrapper->test_display_draw())
-                data = pWrapper->render_inline_display(JACK_INLINE_DISPLAY_SIZE, JACK_INLINE_DISPLAY_SIZE);
+            // Check if inline display has been updated
+            plug::canvas_data_t *data = pWrapper->render_inline_display(JACK_INLINE_DISPLAY_SIZE, JACK_INLINE_DISPLAY_SIZE);
 
             // Check that returned data is valid
             if ((data != NULL) && (data->pData != NULL) && (data->nWidth > 0) && (data->nHeight > 0))
@@ -106,9 +106,19 @@ namespace lsp
                 return STATUS_NO_MEM;
             vSortedPorts.qsort(cmp_port_identifiers);
 
+            // Initialize the lists of changed ports
+            if ((res = sDirtyPorts.init(vAllPorts.size())) != STATUS_OK)
+                return res;
+            if ((res = sChangedPorts.init(vAllPorts.size())) != STATUS_OK)
+                return res;
+
             // Initialize plugin and UI
             if (pPlugin != NULL)
+            {
                 pPlugin->init(this, plugin_ports.array());
+                init_perf_stats();
+                init_inline_display();
+            }
 
             // Update state, mark initialized
             nState      = S_INITIALIZED;
@@ -245,15 +255,23 @@ namespace lsp
                     pPlugin->deactivate_ui();
             }
 
-            // Prepare ports
-            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+            // Prepare ports changed by UI since the last cycle
+            perf_begin();
+            size_t index;
+            while (sChangedPorts.next(&index))
             {
-                // Get port
-                jack::Port *port = vAllPorts.uget(i);
-                if (port == NULL)
-                    continue;
+                jack::Port *port = vAllPorts.uget(index);
+                if (port->pre_process(samples))
+                {
+                    lsp_trace("port changed: %s", port->metadata()->id);
+                    bUpdateSettings = true;
+                }
+            }
 
-                // Pre-process data in port
+            // Prepare ports that require processing at each cycle
+            for (size_t i=0, n=vProcPorts.size(); i<n; ++i)
+            {
+                jack::Port *port = vProcPorts.uget(i);
                 if (port->pre_process(samples))
                 {
                     lsp_trace("port changed: %s", port->metadata()->id);
@@ -278,7 +296,9 @@ namespace lsp
             }
 
             // Call the main processing unit
+            perf_mark(core::PERF_PRE);
             pPlugin->process(samples);
+            perf_mark(core::PERF_PROCESS);
 
             // Report latency if changed
             ssize_t latency = pPlugin->latency();
@@ -288,13 +308,16 @@ namespace lsp
                 nLatency = latency;
             }
 
-            // Post-process ALL ports
-            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+            // Post-process ports that require processing at each cycle
+            for (size_t i=0, n=vProcPorts.size(); i<n; ++i)
             {
-                jack::Port *port = vAllPorts.uget(i);
-                if (port != NULL)
-                    port->post_process(samples);
+                jack::Port *port = vProcPorts.uget(i);
+                port->post_process(samples);
             }
+
+            perf_mark(core::PERF_POST);
+            perf_end(samples);
+
             return 0;
         }
 
@@ -360,6 +383,9 @@ namespace lsp
             }
             vAllPorts.flush();
             vSortedPorts.flush();
+            vProcPorts.flush();
+            sDirtyPorts.destroy();
+            sChangedPorts.destroy();
 
             // Cleanup generated metadata
             for (size_t i=0, n=vGenMetadata.size(); i<n; ++i)
@@ -382,6 +408,9 @@ namespace lsp
                 delete pExecutor;
                 pExecutor   = NULL;
             }
+            destroy_state_dump();
+            destroy_perf_stats();
+            destroy_inline_display();
 
             // Destroy package
             meta::free_manifest(pPackage);
@@ -391,6 +420,7 @@ namespace lsp
         void Wrapper::create_port(lltl::parray<plug::IPort> *plugin_ports, const meta::port_t *port, const char *postfix)
         {
             jack::Port *jp  = NULL;
+            bool proc       = true;     // The port requires processing at each cycle
 
             switch (port->role)
             {
@@ -425,11 +455,14 @@ namespace lsp
 
                 case meta::R_CONTROL:
                 case meta::R_BYPASS:
+                    // Processed only when changed
                     jp      = new jack::ControlPort(port, this);
+                    proc    = false;
                     break;
 
                 case meta::R_METER:
                     jp      = new jack::MeterPort(port, this);
+                    proc    = false;
                     break;
 
                 case meta::R_PORT_SET:
@@ -437,6 +470,7 @@ namespace lsp
                     LSPString postfix_str;
                     jack::PortGroup     *pg      = new jack::PortGroup(port, this);
                     pg->init();
+                    pg->set_index(vAllPorts.size());
                     vAllPorts.add(pg);
                     plugin_ports->add(pg);
 
@@ -486,7 +520,10 @@ namespace lsp
                     }
                 #endif /* LSP_DEBUG */
 
+                jp->set_index(vAllPorts.size());
                 vAllPorts.add(jp);
+                if (proc)
+                    vProcPorts.add(jp);
                 plugin_ports->add(jp);
             }
         }
@@ -546,6 +583,12 @@ namespace lsp
             return 0;
         }
 
+        void Wrapper::request_state_dump()
+        {
+            prepare_state_dump();
+            atomic_add(&nDumpReq, 1);
+        }
+
         ipc::IExecutor *Wrapper::executor()
         {
             lsp_trace("executor = %p", reinterpret_cast<void *>(pExecutor));
@@ -646,6 +689,18 @@ namespace lsp
 
         plug::canvas_data_t *Wrapper::render_inline_display(size_t width, size_t height)
         {
+            bool dirty = test_display_draw();
+
+            // Return the frame rendered by the executor only when it is updated
+            if (pDisplayTask != NULL)
+            {
+                bool ready = update_inline_display(dirty);
+                plug::canvas_data_t *data = inline_display_frame(width, height);
+                return (ready) ? data : NULL;
+            }
+            else if (!dirty)
+                return NULL;
+
             // Allocate canvas for drawing
             plug::ICanvas *canvas = create_canvas(width, height);
             if (canvas == NULL)
@@ -729,6 +784,8 @@ namespace lsp
             status_t res;
             config::param_t param;
             core::KVTStorage *kvt = kvt_lock();
+            if (kvt != NULL)
+                kvt->begin_batch();
 
             while ((res = parser->next(&param)) == STATUS_OK)
             {
@@ -833,6 +890,7 @@ namespace lsp
             // Release KVT
             if (kvt != NULL)
             {
+                kvt->end_batch();
                 kvt->gc();
                 kvt_release();
             }
@@ -947,6 +1005,16 @@ namespace lsp
             return nState == S_CONN_LOST;
         }
 
+        core::DirtyBitmap *Wrapper::dirty_ports()
+        {
+            return &sDirtyPorts;
+        }
+
+        core::DirtyBitmap *Wrapper::changed_ports()
+        {
+            return &sChangedPorts;
+        }
+
         void Wrapper::query_display_draw()
         {
             atomic_add(&nQueryDrawReq, 1);
@@ -47,11 +47,30 @@ namespace lsp
         {
             protected:
                 Wrapper         *pWrapper;
+                size_t           nIndex;            // Index of the port in the wrapper
+
+            protected:
+                /**
+                 * Notify the UI that the state of the port has changed
+                 */
+                inline void mark_dirty()
+                {
+                    pWrapper->dirty_ports()->mark(nIndex);
+                }
+
+                /**
+                 * Notify the DSP that the port should be pre-processed
+                 */
+                inline void mark_changed()
+                {
+                    pWrapper->changed_ports()->mark(nIndex);
+                }
 
             public:
                 explicit Port(const meta::port_t *meta, Wrapper *w): IPort(meta)
                 {
                     pWrapper        = w;
+                    nIndex          = size_t(-1);
                 }
 
                 virtual ~Port()
@@ -59,6 +78,10 @@ namespace lsp
                     pWrapper        = NULL;
                 }
 
+            public:
+                inline size_t   index() const               { return nIndex;    }
+                inline void     set_index(size_t index)     { nIndex = index;   }
+
                 virtual int init()
                 {
                     return STATUS_OK;
@@ -416,6 +439,7 @@ namespace lsp
                 virtual void update_value(float value)
                 {
                     fNewValue   = meta::limit_value(pMetadata, value);
+                    mark_changed();
                 }
         };
 
@@ -446,6 +470,7 @@ namespace lsp
                 virtual void set_value(float value)
                 {
                     value   = meta::limit_value(pMetadata, value);
+                    float prev  = fValue;
 
                     if (pMetadata->flags & meta::F_PEAK)
                     {
@@ -457,6 +482,9 @@ namespace lsp
                     }
                     else
                         fValue = value;
+
+                    if (fValue != prev)
+                        mark_dirty();
                 }
 
                 float sync_value()
@@ -498,6 +526,12 @@ namespace lsp
                     pMesh = NULL;
                 }
 
+                virtual void post_process(size_t samples)
+                {
+                    if ((pMesh != NULL) && (pMesh->containsData()))
+                        mark_dirty();
+                }
+
             public:
                 virtual void *buffer()
                 {
@@ -509,11 +543,13 @@ namespace lsp
         {
             private:
                 plug::stream_t     *pStream;
+                uint32_t            nFrameID;
 
             public:
                 explicit StreamPort(const meta::port_t *meta, Wrapper *w): Port(meta, w)
                 {
                     pStream     = NULL;
+                    nFrameID    = 0;
                 }
 
                 virtual ~StreamPort()
@@ -538,16 +574,31 @@ namespace lsp
                     plug::stream_t::destroy(pStream);
                     pStream     = NULL;
                 }
+
+                virtual void post_process(size_t samples)
+                {
+                    if (pStream == NULL)
+                        return;
+
+                    uint32_t frame_id   = pStream->frame_id();
+                    if (frame_id == nFrameID)
+                        return;
+
+                    nFrameID    = frame_id;
+                    mark_dirty();
+                }
         };
 
         class FrameBufferPort: public Port
         {
             private:
                 plug::frame_buffer_t        sFB;
+                uint32_t                    nRowID;
 
             public:
                 explicit FrameBufferPort(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
                 {
+                    nRowID      = 0;
                 }
 
                 virtual ~FrameBufferPort()
@@ -564,6 +615,16 @@ namespace lsp
                     sFB.destroy();
                 }
 
+                virtual void post_process(size_t samples)
+                {
+                    uint32_t row_id     = sFB.next_rowid();
+                    if (row_id == nRowID)
+                        return;
+
+                    nRowID      = row_id;
+                    mark_dirty();
+                }
+
             public:
                 virtual void *buffer()
                 {
@@ -601,6 +662,12 @@ namespace lsp
                     pFB     = NULL;
                 }
 
+                virtual void post_process(size_t samples)
+                {
+                    if ((pFB != NULL) && (meta::is_out_port(pMetadata)) && (pFB->size() > 0))
+                        mark_dirty();
+                }
+
             public:
                 virtual void *buffer()
                 {
@@ -172,7 +172,7 @@ namespace lsp
             public:
                 explicit UIMeshPort(jack::Port *port): UIPort(port)
                 {
-                    pMesh       = jack::create_mesh(port->metadata());
+                    pMesh       = jack::create_mesh(port->metadata(), true);
                 }
 
                 virtual ~UIMeshPort()
@@ -185,16 +185,11 @@ namespace lsp
                 virtual bool sync()
                 {
                     plug::mesh_t *mesh = pPort->buffer<plug::mesh_t>();
-                    if ((mesh == NULL) || (!mesh->containsData()))
+                    if ((mesh == NULL) || (pMesh == NULL) || (!mesh->consume()))
                         return false;
 
-                    // Copy mesh data
-                    for (size_t i=0; i < mesh->nBuffers; ++i)
-                        dsp::copy_saturated(pMesh->pvData[i], mesh->pvData[i], mesh->nItems);
-                    pMesh->data(mesh->nBuffers, mesh->nItems);
-
-                    // Clean source mesh
-                    mesh->cleanup();
+                    // Refer the newest frame without copying
+                    mesh->view(pMesh);
                     return true;
                 }
 
@@ -49,8 +49,10 @@ namespace lsp
                 atomic_t                        nPosition;          // Position counter
                 tk::Label                      *pJackStatus;        // Jack status
                 bool                            bJackConnected;     // Jack is connected
+                ws::timestamp_t                 nFeedbackTime;      // Time of the last UI feedback report
+                size_t                          nFeedbackTicks;     // Number of synchronizations since the last report
 
-                lltl::parray<jack::UIPort>      vSyncPorts;         // Ports for synchronization
+                lltl::parray<jack::UIPort>      vSyncPorts;         // Ports for synchronization indexed by DSP port index
                 lltl::parray<meta::port_t>      vGenMetadata;       // Generated metadata for virtual ports
 
             public:
@@ -62,12 +64,15 @@ namespace lsp
 
             protected:
                 status_t        create_port(const meta::port_t *port, const char *postfix);
+                void            add_sync_port(jack::Port *port, jack::UIPort *uport);
                 static ssize_t  compare_ports(const jack::UIPort *a, const jack::UIPort *b);
                 size_t          rebuild_sorted_ports();
                 void            sync_kvt(core::KVTStorage *kvt);
                 void            ui_activated();
                 void            ui_deactivated();
                 void            set_connection_status(bool connected);
+                void            report_feedback(float rate);
+                void            reset_feedback();
 
             protected:
                 static status_t             slot_ui_hide(tk::Widget *sender, void *ptr, void *data);
@@ -28,6 +28,7 @@
 #include <lsp-plug.in/plug-fw/meta/manifest.h>
 #include <lsp-plug.in/plug-fw/core/config.h>
 #include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+#include <lsp-plug.in/plug-fw/core/DirtyBitmap.h>
 
 #include <lsp-plug.in/common/debug.h>
 #include <lsp-plug.in/stdlib/string.h>
@@ -75,6 +76,8 @@ namespace lsp
                 ipc::IExecutor                 *pExecutor;          // Off-line task executor
                 core::KVTStorage                sKVT;               // Key-value tree
                 ipc::Mutex                      sKVTMutex;          // Key-value tree mutex
+                core::DirtyBitmap               sDirtyPorts;        // Ports changed by DSP since the last UI sync
+                core::DirtyBitmap               sChangedPorts;      // Ports changed by UI since the last processing cycle
 
                 volatile uatomic_t              nPosition;          // Position counter
                 volatile bool                   bUIActive;          // UI activity flag
@@ -87,6 +90,7 @@ namespace lsp
                 lltl::parray<jack::Port>        vAllPorts;          // All ports
                 lltl::parray<jack::Port>        vSortedPorts;       // Alphabetically-sorted ports
                 lltl::parray<jack::DataPort>    vDataPorts;         // Data ports (audio, MIDI)
+                lltl::parray<jack::Port>        vProcPorts;         // Ports that require processing at each cycle
                 lltl::parray<meta::port_t>      vGenMetadata;       // Generated metadata for virtual ports
 
                 meta::package_t                *pPackage;           // Package descriptor
@@ -115,6 +119,8 @@ namespace lsp
                 status_t                            init();
                 void                                destroy();
 
+                void                                request_state_dump();
+
             public:
                 virtual ipc::IExecutor             *executor();
 
@@ -134,6 +140,8 @@ namespace lsp
                 inline bool                         connected() const;
                 inline bool                         disconnected() const;
                 inline bool                         connection_lost() const;
+                inline core::DirtyBitmap           *dirty_ports();
+                inline core::DirtyBitmap           *changed_ports();
 
                 status_t                            connect();
                 status_t                            disconnect();
@@ -148,7 +156,7 @@ namespace lsp
 
                 bool                                set_ui_active(bool active);
 
-                // Inline display interface
+                // Inline display interface, returns NULL if the display has not been updated since the last call
                 plug::canvas_data_t                *render_inline_display(size_t width, size_t height);
 
                 inline bool                         test_display_draw();
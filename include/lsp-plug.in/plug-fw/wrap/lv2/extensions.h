@@ -186,6 +186,7 @@ namespace lsp
                 LV2_URID                uridFrameBufferFirstRowID;  // First row identifier
                 LV2_URID                uridFrameBufferLastRowID;   // Last row identifier
                 LV2_URID                uridFrameBufferData;        // Frame buffer row data
+                LV2_URID                uridFrameBufferRowType;     // Encoded frame buffer row vector element type
                 LV2_URID                uridStreamType;             // Stream data type
                 LV2_URID                uridStreamDimensions;       // Stream dimensions
                 LV2_URID                uridStreamFrame;            // Stream frame
@@ -193,6 +194,9 @@ namespace lsp
                 LV2_URID                uridStreamFrameId;          // Number of frame
                 LV2_URID                uridStreamFrameSize;        // Size of frame
                 LV2_URID                uridStreamFrameData;        // Frame data
+                LV2_URID                uridStreamFrameScale;       // Scale of quantized frame data
+                LV2_URID                uridTypeInt16;              // 16-bit integer vector element type
+                LV2_URID                uridTypeHalf;               // Half-precision floating-point vector element type
 
                 LV2UI_Controller        ctl;
                 LV2UI_Write_Function    wf;
@@ -355,6 +359,7 @@ namespace lsp
                     uridFrameBufferFirstRowID   = map_field("FrameBuffer", "firstRowID");
                     uridFrameBufferLastRowID    = map_field("FrameBuffer", "lastRowID");
                     uridFrameBufferData         = map_field("FrameBuffer", "data");
+                    uridFrameBufferRowType      = map_type("FrameBufferRow");
 
                     uridStreamType              = map_type_legacy("Stream");
                     uridStreamDimensions        = map_field("Stream", "dimensions");
@@ -363,6 +368,9 @@ namespace lsp
                     uridStreamFrameId           = map_field("StreamFrame", "id");
                     uridStreamFrameSize         = map_field("StreamFrame", "size");
                     uridStreamFrameData         = map_field("StreamFrame", "data");
+                    uridStreamFrameScale        = map_field("StreamFrame", "scale");
+                    uridTypeInt16               = map_type("Int16");
+                    uridTypeHalf                = map_type("Half");
 
                     // Decode passed options if they are present
                     if (opts != NULL)
@@ -854,7 +862,7 @@ namespace lsp
                         else if (meta::is_in_port(p) && (!in))
                             break;
 
-                        size_t vector_len   = sizeof(LV2_Atom_Vector) + 4 * sizeof(LV2_Atom_Int) + sizeof(float) * STREAM_MAX_FRAME_SIZE;
+                        size_t vector_len   = sizeof(LV2_Atom_Vector) + 2 * sizeof(LV2_Atom_Float) + 4 * sizeof(LV2_Atom_Int) + sizeof(float) * STREAM_MAX_FRAME_SIZE;
                         size_t frm_size     = sizeof(LV2_Atom_Object) + 8 * sizeof(LV2_Atom_Int) + size_t(p->min) * vector_len;
                         size_t data_size    = sizeof(LV2_Atom_Object) + 8 * sizeof(LV2_Atom_Int) + STREAM_BULK_MAX * frm_size;
                         size               += data_size;
@@ -502,51 +502,59 @@ namespace lsp
         void UIWrapper::parse_raw_osc_event(osc::parse_frame_t *frame)
         {
             osc::parse_token_t token;
-            status_t res = osc::parse_token(frame, &token);
-            if (res != STATUS_OK)
-                return;
 
-            if (token == osc::PT_BUNDLE)
+            // Process all elements of the frame, the KVT dispatcher packs multiple
+            // changes into one bundle
+            while (true)
             {
-                osc::parse_frame_t child;
-                uint64_t time_tag;
-                status_t res = osc::parse_begin_bundle(&child, frame, &time_tag);
+                status_t res = osc::parse_token(frame, &token);
                 if (res != STATUS_OK)
                     return;
-                parse_raw_osc_event(&child); // Perform recursive call
-                osc::parse_end(&child);
-            }
-            else if (token == osc::PT_MESSAGE)
-            {
-                const void *msg_start;
-                size_t msg_size;
-                const char *msg_addr;
 
-                // Perform address lookup and routing
-                status_t res = osc::parse_raw_message(frame, &msg_start, &msg_size, &msg_addr);
-                if (res != STATUS_OK)
-                    return;
+                if (token == osc::PT_BUNDLE)
+                {
+                    osc::parse_frame_t child;
+                    uint64_t time_tag;
+                    status_t res = osc::parse_begin_bundle(&child, frame, &time_tag);
+                    if (res != STATUS_OK)
+                        return;
+                    parse_raw_osc_event(&child); // Perform recursive call
+                    osc::parse_end(&child);
+                }
+                else if (token == osc::PT_MESSAGE)
+                {
+                    const void *msg_start;
+                    size_t msg_size;
+                    const char *msg_addr;
 
-                lsp_trace("Received OSC message, address=%s, size=%d", msg_addr, int(msg_size));
-                osc::dump_packet(msg_start, msg_size);
+                    // Perform address lookup and routing
+                    status_t res = osc::parse_raw_message(frame, &msg_start, &msg_size, &msg_addr);
+                    if (res != STATUS_OK)
+                        return;
 
-                // Try to parse KVT message first
-                res = core::KVTDispatcher::parse_message(&sKVT, msg_start, msg_size, core::KVT_TX);
-                if (res != STATUS_SKIP)
-                    return;
+                    lsp_trace("Received OSC message, address=%s, size=%d", msg_addr, int(msg_size));
+                    osc::dump_packet(msg_start, msg_size);
 
-                // Not a KVT message, submit to OSC ports (if present)
-                for (size_t i=0, n=vOscInPorts.size(); i<n; ++i)
-                {
-                    lv2::UIPort *p = vOscInPorts.uget(i);
-                    if (p == NULL)
+                    // Try to parse KVT message first
+                    res = core::KVTDispatcher::parse_message(&sKVT, msg_start, msg_size, core::KVT_TX);
+                    if (res != STATUS_SKIP)
                         continue;
 
-                    // Submit message to the buffer
-                    plug::osc_buffer_t *buf = p->buffer<plug::osc_buffer_t>();
-                    if (buf != NULL)
-                        buf->submit(msg_start, msg_size);
+                    // Not a KVT message, submit to OSC ports (if present)
+                    for (size_t i=0, n=vOscInPorts.size(); i<n; ++i)
+                    {
+                        lv2::UIPort *p = vOscInPorts.uget(i);
+                        if (p == NULL)
+                            continue;
+
+                        // Submit message to the buffer
+                        plug::osc_buffer_t *buf = p->buffer<plug::osc_buffer_t>();
+                        if (buf != NULL)
+                            buf->submit(msg_start, msg_size);
+                    }
                 }
+                else
+                    return;
             }
         }
 
@@ -778,6 +786,7 @@ namespace lsp
             if (skvt == NULL)
                 return;
 
+            const void *data;
             size_t size;
             if (sKVTMutex.lock())
             {
@@ -785,33 +794,31 @@ namespace lsp
 
                 do
                 {
-                    // Try to fetch record from buffer
-                    res = d->fetch(pOscBuffer, &size, OSC_PACKET_MAX);
+                    // Try to fetch record from buffer, parse it directly in the buffer
+                    res = d->peek(&data, &size);
 
                     switch (res)
                     {
                         case STATUS_OK:
                         {
                             lsp_trace("Fetched OSC packet of %d bytes", int(size));
-                            osc::dump_packet(pOscBuffer, size);
-                            core::KVTDispatcher::parse_message(&sKVT, pOscBuffer, size, core::KVT_TX);
+                            osc::dump_packet(data, size);
+                            core::KVTDispatcher::parse_message(&sKVT, data, size, core::KVT_TX);
+                            d->release();
                             break;
                         }
 
                         case STATUS_NO_DATA: // No more data to transmit
                             break;
 
-                        case STATUS_OVERFLOW:
-                        {
-                            lsp_warn("Too large OSC packet in the buffer, skipping");
-                            d->skip();
-                            break;
-                        }
-
                         default:
                         {
-                            lsp_warn("OSC packet parsing error %d, skipping", int(res));
-                            d->skip();
+                            lsp_warn("Error reading OSC packet from buffer: %d", int(res));
+
+                            // Skip the bad record, drop all pending records if it can not be located
+                            if (d->release() != STATUS_OK)
+                                d->clear_tx();
+                            res = STATUS_NO_DATA;
                             break;
                         }
                     }
@@ -909,7 +916,12 @@ namespace lsp
 
         void UIWrapper::dump_state_request()
         {
-            pExt->request_state_dump();
+            // Prepare the deferred dump outside of the realtime thread if possible
+            lv2::Wrapper *w = pExt->wrapper();
+            if (w != NULL)
+                w->request_state_dump();
+            else
+                pExt->request_state_dump();
         }
 
         status_t UIWrapper::slot_ui_hide(tk::Widget *sender, void *ptr, void *data)
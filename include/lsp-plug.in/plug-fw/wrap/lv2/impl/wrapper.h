@@ -49,6 +49,11 @@ namespace lsp
             pWrapper->state_changed();
         }
 
+        void Wrapper::LV2KVTListener::updated(core::KVTStorage *storage, const char *branch, size_t count, size_t pending)
+        {
+            pWrapper->state_changed();
+        }
+
         //---------------------------------------------------------------------
         ssize_t Wrapper::compare_ports_by_urid(const lv2::Port *a, const lv2::Port *b)
         {
@@ -79,7 +84,6 @@ namespace lsp
             bQueueDraw      = false;
             bUpdateSettings = true;
             fSampleRate     = DEFAULT_SAMPLE_RATE;
-            pOscPacket      = reinterpret_cast<uint8_t *>(::malloc(OSC_PACKET_MAX));
             nStateMode      = SM_LOADING;
             nDumpReq        = 0;
             nDumpResp       = 0;
@@ -175,6 +179,10 @@ namespace lsp
             for (const meta::port_t *meta = m->ports ; meta->id != NULL; ++meta)
                 create_port(&plugin_ports, meta, NULL, false);
 
+            // Initialize the list of changed ports
+            if ((res = sChangedPorts.init(vAllPorts.size())) != STATUS_OK)
+                return res;
+
             // Sort port lists
             vPluginPorts.qsort(compare_ports_by_urid);
             vMeshPorts.qsort(compare_ports_by_urid);
@@ -189,6 +197,7 @@ namespace lsp
                 sKVT.bind(&sKVTListener);
                 lsp_trace("Creating KVT dispatcher thread...");
                 pKVTDispatcher         = new core::KVTDispatcher(&sKVT, &sKVTMutex);
+                pKVTDispatcher->set_coalescing(LSP_LV2_KVT_COALESCE);
                 lsp_trace("Starting KVT dispatcher thread...");
                 pKVTDispatcher->start();
             }
@@ -197,10 +206,14 @@ namespace lsp
             lsp_trace("Initializing plugin");
             pPlugin->init(this, plugin_ports.array());
             pPlugin->set_sample_rate(srate);
+            init_perf_stats();
+            init_inline_display();
             bUpdateSettings     = true;
 
-            // Update refresh rate
+            // Update refresh rate, the UI runs in a separate instance and can not
+            // report the visibility of ports, so only the overall rate is reported
             nSyncSamples        = srate / pExt->ui_refresh_rate();
+            pPlugin->ui_feedback()->report(pExt->ui_refresh_rate());
             nClients            = 0;
 
             return STATUS_OK;
@@ -213,6 +226,7 @@ namespace lsp
             {
                 lsp_trace("Stopping KVT dispatcher thread...");
                 pKVTDispatcher->cancel();
+                pKVTDispatcher->wakeup();
                 pKVTDispatcher->join();
                 delete pKVTDispatcher;
 
@@ -232,6 +246,9 @@ namespace lsp
                 delete pExecutor;
                 pExecutor   = NULL;
             }
+            destroy_state_dump();
+            destroy_perf_stats();
+            destroy_inline_display();
 
             // Drop plugin
             if (pPlugin != NULL)
@@ -271,14 +288,10 @@ namespace lsp
             vOscPorts.flush();
             vFrameBufferPorts.flush();
             vPluginPorts.flush();
+            vCtlPorts.flush();
+            vProcPorts.flush();
             vGenMetadata.flush();
-
-            // Delete temporary buffer for OSC serialization
-            if (pOscPacket != NULL)
-            {
-                ::free(pOscPacket);
-                pOscPacket = NULL;
-            }
+            sChangedPorts.destroy();
 
             // Drop extensions
             if (pExt != NULL)
@@ -422,6 +435,7 @@ namespace lsp
 
                     // Add Port Set immediately
                     vPluginPorts.add(pg);
+                    pg->bind_changed(&sChangedPorts, vAllPorts.size());
                     vAllPorts.add(pg);
                     plugin_ports->add(pg);
 
@@ -460,8 +474,31 @@ namespace lsp
 
             // Register created port for garbage collection
             if (result != NULL)
+            {
+                result->bind_changed(&sChangedPorts, vAllPorts.size());
                 vAllPorts.add(result);
 
+                // Distribute the port between processing lists
+                switch (p->role)
+                {
+                    case meta::R_CONTROL:
+                    case meta::R_METER:
+                    case meta::R_BYPASS:
+                        // The host writes input ports directly, so the changes can not be tracked.
+                        // Virtual input ports are processed only when they are marked as changed.
+                        if (meta::is_out_port(p))
+                            vProcPorts.add(result);
+                        else if (result->get_id() >= 0)
+                            vCtlPorts.add(result);
+                        break;
+                    case meta::R_AUDIO:
+                        break;
+                    default:
+                        vProcPorts.add(result);
+                        break;
+                }
+            }
+
             return result;
         }
 
@@ -500,28 +537,34 @@ namespace lsp
             else if (pPlugin->ui_active())
                 pPlugin->deactivate_ui();
 
+            // Sample-accurate control changes require splitting of the block at
+            // timestamps of parameter change events
+            size_t sub_block        = (pAtomIn != NULL) ? pPlugin->sub_block() : 0;
+            const LV2_Atom_Event *ev= NULL;
+
             // First pre-process transport ports
+            perf_begin();
             clear_midi_ports();
-            receive_atoms(samples);
+            receive_atoms(samples, sub_block <= 0);
+            if (sub_block > 0)
+                ev                  = receive_patches(next_patch_set(NULL), 0);
 
-            // Pre-rocess regular ports
+            // MIDI events and time position are distributed between sub-blocks
+            for (size_t i=0, n=vMidiPorts.size(); i<n; ++i)
+                static_cast<lv2::MidiPort *>(vMidiPorts.uget(i))->begin_block();
+            plug::position_t pos    = sPosition;
+
+            // Pre-process ports changed by UI or state restore since the last cycle
+            size_t index;
             size_t smode            = nStateMode;
-            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
-            {
-                // Get port
-                lv2::Port *port = vAllPorts.uget(i);
-                if (port == NULL)
-                    continue;
+            while (sChangedPorts.next(&index))
+                pre_process_port(vAllPorts.uget(index), samples, smode);
 
-                // Pre-process data in port
-                if (port->pre_process(samples))
-                {
-                    lsp_trace("port changed: %s, value=%f", port->metadata()->id, port->value());
-                    bUpdateSettings = true;
-                    if ((smode != SM_LOADING) && (port->is_virtual()))
-                        change_state_atomic(SM_SYNC, SM_CHANGED);
-                }
-            }
+            // Pre-process ports connected to the host and ports that require processing at each cycle
+            for (size_t i=0, n=vCtlPorts.size(); i<n; ++i)
+                pre_process_port(vCtlPorts.uget(i), samples, smode);
+            for (size_t i=0, n=vProcPorts.size(); i<n; ++i)
+                pre_process_port(vProcPorts.uget(i), samples, smode);
 
             // Commit state
             if (smode == SM_LOADING)
@@ -542,11 +585,71 @@ namespace lsp
                 nDumpResp           = dump_req;
             }
 
+            perf_mark(core::PERF_PRE);
+            if (ev == NULL)
+            {
+                // Call the main processing unit for the whole block
+                process_block(&pos, 0, samples);
+            }
+            else
+            {
+                // Split the block at timestamps of parameter changes
+                for (size_t off=0; off < samples; )
+                {
+                    // Compute the size of the sub-block
+                    size_t end      = (ev != NULL) ? lsp_max(size_t(ev->time.frames), off + sub_block) : samples;
+                    end             = lsp_min(end, samples);
+                    process_block(&pos, off, end - off);
+                    off             = end;
+                    if (off >= samples)
+                        break;
+
+                    // Apply parameter changes that have occurred before the current position
+                    ev              = receive_patches(ev, off);
+                    while (sChangedPorts.next(&index))
+                        pre_process_port(vAllPorts.uget(index), samples - off, smode);
+
+                    if (bUpdateSettings)
+                    {
+                        pPlugin->update_settings();
+                        bUpdateSettings     = false;
+                    }
+                }
+            }
+
+            perf_mark(core::PERF_PROCESS);
+            sPosition               = pos;
+
+            // Transmit atoms (if possible)
+            transmit_atoms(samples);
+            clear_midi_ports();
+
+            // Post-process ports that require processing at each cycle
+            for (size_t i=0, n=vProcPorts.size(); i<n; ++i)
+                vProcPorts.uget(i)->post_process(samples);
+
+            // Transmit latency (if possible)
+            if (pLatency != NULL)
+                *pLatency   = pPlugin->latency();
+
+            perf_mark(core::PERF_POST);
+            perf_end(samples);
+        }
+
+        void Wrapper::process_block(const plug::position_t *pos, size_t off, size_t samples)
+        {
             // Call the main processing unit (split data buffers into chunks not greater than MaxBlockLength)
             size_t n_audio_ports = vAudioPorts.size();
-            for (size_t off=0; off < samples; )
+            size_t n_midi_ports  = vMidiPorts.size();
+            for (size_t end = off + samples; off < end; )
             {
-                size_t to_process = lsp_min(samples - off, pExt->nMaxBlockLength);
+                size_t to_process = lsp_min(end - off, pExt->nMaxBlockLength);
+
+                // Advance time position and rebase MIDI events to the start of the chunk
+                sPosition       = *pos;
+                plug::position_t::advance(&sPosition, off);
+                for (size_t i=0; i<n_midi_ports; ++i)
+                    static_cast<lv2::MidiPort *>(vMidiPorts.uget(i))->begin_chunk(off, to_process);
 
                 // Sanitize input data
                 for (size_t i=0; i<n_audio_ports; ++i)
@@ -564,28 +667,22 @@ namespace lsp
                     if (port != NULL)
                         port->sanitize_after(off, to_process);
                 }
+                for (size_t i=0; i<n_midi_ports; ++i)
+                    static_cast<lv2::MidiPort *>(vMidiPorts.uget(i))->end_chunk(off);
 
                 off += to_process;
             }
+        }
 
-            // Transmit atoms (if possible)
-            transmit_atoms(samples);
-            clear_midi_ports();
-
-            // Post-process regular ports for changes
-            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
-            {
-                // Get port
-                lv2::Port *port = vAllPorts.uget(i);
-                if (port == NULL)
-                    continue;
-                if (port != NULL)
-                    port->post_process(samples);
-            }
+        void Wrapper::pre_process_port(lv2::Port *port, size_t samples, size_t smode)
+        {
+            if (!port->pre_process(samples))
+                return;
 
-            // Transmit latency (if possible)
-            if (pLatency != NULL)
-                *pLatency   = pPlugin->latency();
+            lsp_trace("port changed: %s, value=%f", port->metadata()->id, port->value());
+            bUpdateSettings = true;
+            if ((smode != SM_LOADING) && (port->is_virtual()))
+                change_state_atomic(SM_SYNC, SM_CHANGED);
         }
 
         void Wrapper::clear_midi_ports()
@@ -678,50 +775,57 @@ namespace lsp
         void Wrapper::receive_raw_osc_event(osc::parse_frame_t *frame)
         {
             osc::parse_token_t token;
-            status_t res = osc::parse_token(frame, &token);
-            if (res != STATUS_OK)
-                return;
 
-            if (token == osc::PT_BUNDLE)
+            // Process all elements of the frame
+            while (true)
             {
-                osc::parse_frame_t child;
-                uint64_t time_tag;
-                status_t res = osc::parse_begin_bundle(&child, frame, &time_tag);
+                status_t res = osc::parse_token(frame, &token);
                 if (res != STATUS_OK)
                     return;
-                receive_raw_osc_event(&child); // Perform recursive call
-                osc::parse_end(&child);
-            }
-            else if (token == osc::PT_MESSAGE)
-            {
-                const void *msg_start;
-                size_t msg_size;
-                const char *msg_addr;
 
-                // Perform address lookup and routing
-                status_t res = osc::parse_raw_message(frame, &msg_start, &msg_size, &msg_addr);
-                if (res != STATUS_OK)
-                    return;
+                if (token == osc::PT_BUNDLE)
+                {
+                    osc::parse_frame_t child;
+                    uint64_t time_tag;
+                    status_t res = osc::parse_begin_bundle(&child, frame, &time_tag);
+                    if (res != STATUS_OK)
+                        return;
+                    receive_raw_osc_event(&child); // Perform recursive call
+                    osc::parse_end(&child);
+                }
+                else if (token == osc::PT_MESSAGE)
+                {
+                    const void *msg_start;
+                    size_t msg_size;
+                    const char *msg_addr;
 
-                lsp_trace("Received OSC message of %d bytes, address=%s", int(msg_size), msg_addr);
-                osc::dump_packet(msg_start, msg_size);
+                    // Perform address lookup and routing
+                    status_t res = osc::parse_raw_message(frame, &msg_start, &msg_size, &msg_addr);
+                    if (res != STATUS_OK)
+                        return;
 
-                if (::strstr(msg_addr, "/KVT/") == msg_addr)
-                    pKVTDispatcher->submit(msg_start, msg_size);
-                else
-                {
-                    for (size_t i=0, n=vOscPorts.size(); i<n; ++i)
-                    {
-                        lv2::Port *p = vOscPorts.uget(i);
-                        if (!meta::is_osc_in_port(p->metadata()))
-                            continue;
+                    lsp_trace("Received OSC message of %d bytes, address=%s", int(msg_size), msg_addr);
+                    osc::dump_packet(msg_start, msg_size);
 
-                        // Submit message to the buffer
-                        plug::osc_buffer_t *buf = p->buffer<plug::osc_buffer_t>();
-                        if (buf != NULL)
-                            buf->submit(msg_start, msg_size);
+                    if (::strstr(msg_addr, "/KVT/") == msg_addr)
+                        pKVTDispatcher->submit(msg_start, msg_size);
+                    else
+                    {
+                        for (size_t i=0, n=vOscPorts.size(); i<n; ++i)
+                        {
+                            lv2::Port *p = vOscPorts.uget(i);
+                            if (!meta::is_osc_in_port(p->metadata()))
+                                continue;
+
+                            // Submit message to the buffer
+                            plug::osc_buffer_t *buf = p->buffer<plug::osc_buffer_t>();
+                            if (buf != NULL)
+                                buf->submit(msg_start, msg_size);
+                        }
                     }
                 }
+                else
+                    return;
             }
         }
 
@@ -879,21 +983,44 @@ namespace lsp
             }
         }
 
-        void Wrapper::receive_atoms(size_t samples)
+        bool Wrapper::is_patch_set(const LV2_Atom_Event *ev)
+        {
+            if ((ev->body.type != pExt->uridObject) && (ev->body.type != pExt->uridBlank))
+                return false;
+
+            const LV2_Atom_Object *obj = reinterpret_cast<const LV2_Atom_Object*>(&ev->body);
+            return obj->body.otype == pExt->uridPatchSet;
+        }
+
+        const LV2_Atom_Event *Wrapper::next_patch_set(const LV2_Atom_Event *ev)
         {
-            // Update synchronization
-            if (nSyncTime <= 0)
+            const LV2_Atom_Sequence *seq = reinterpret_cast<const LV2_Atom_Sequence *>(pAtomIn);
+
+            // Start from the beginning of the sequence if no event has been specified
+            ev = (ev != NULL) ? lv2_atom_sequence_next(ev) : lv2_atom_sequence_begin(&seq->body);
+            for ( ; !lv2_atom_sequence_is_end(&seq->body, seq->atom.size, ev); ev = lv2_atom_sequence_next(ev))
             {
-                size_t n_ports  = vMeshPorts.size();
-                for (size_t i=0; i<n_ports; ++i)
-                {
-                    plug::mesh_t *mesh  = vMeshPorts[i]->buffer<plug::mesh_t>();
-    //                lsp_trace("Mesh id=%s is waiting=%s", vMeshPorts[i]->metadata()->id, (mesh->isWaiting()) ? "true" : "false");
-                    if ((mesh != NULL) && (mesh->isWaiting()))
-                        mesh->cleanup();
-                }
+                if (is_patch_set(ev))
+                    return ev;
             }
 
+            return NULL;
+        }
+
+        const LV2_Atom_Event *Wrapper::receive_patches(const LV2_Atom_Event *ev, size_t offset)
+        {
+            // Apply all parameter changes with timestamps not after the offset
+            while ((ev != NULL) && (ev->time.frames <= int64_t(offset)))
+            {
+                receive_atom_object(ev);
+                ev = next_patch_set(ev);
+            }
+
+            return ev;
+        }
+
+        void Wrapper::receive_atoms(size_t samples, bool patches)
+        {
             // Get sequence
             if (pAtomIn == NULL)
                 return;
@@ -925,7 +1052,11 @@ namespace lsp
                     }
                 }
                 else if ((ev->body.type == pExt->uridObject) || (ev->body.type == pExt->uridBlank))
-                    receive_atom_object(ev);
+                {
+                    // Parameter changes are deferred to their timestamps in sample-accurate mode
+                    if ((patches) || (!is_patch_set(ev)))
+                        receive_atom_object(ev);
+                }
             }
         }
 
@@ -1022,7 +1153,7 @@ namespace lsp
             // Serialize meshes (it's own primitive MESH)
             for (size_t i=0, n=vMeshPorts.size(); i<n; ++i)
             {
-                lv2::Port *p = vMeshPorts[i];
+                lv2::MeshPort *p = static_cast<lv2::MeshPort *>(vMeshPorts[i]);
                 if (p == NULL)
                     continue;
                 if ((!sync_req) && (!p->tx_pending()))
@@ -1030,15 +1161,15 @@ namespace lsp
                 plug::mesh_t *mesh  = p->buffer<plug::mesh_t>();
                 if ((mesh == NULL) || (!mesh->containsData()))
                     continue;
+                if (!p->acquire_consumer()) // The mesh is being read by the UI with direct access
+                    continue;
 
 //                lsp_trace("transmit mesh id=%s", p->metadata()->id);
                 pExt->forge_frame_time(0);  // Event header
                 pExt->forge_object(&frame, p->get_urid(), pExt->uridMeshType);
                 p->serialize();
                 pExt->forge_pop(&frame);
-
-                // Cleanup data of the mesh for refill
-                mesh->markEmpty();
+                p->release_consumer();
             }
 
             // Serialize streams (it's own primitive STREAM)
@@ -1151,38 +1282,40 @@ namespace lsp
         {
             LV2_Atom atom;
 
+            const void *data;
             size_t size;
             while (true)
             {
-                status_t res = pKVTDispatcher->fetch(pOscPacket, &size, OSC_PACKET_MAX);
+                // Forge the packet directly from the buffer
+                status_t res = pKVTDispatcher->peek(&data, &size);
 
                 switch (res)
                 {
                     case STATUS_OK:
                     {
                         lsp_trace("Transmitting OSC packet of %d bytes", int(size));
-                        osc::dump_packet(pOscPacket, size);
+                        osc::dump_packet(data, size);
 
                         atom.size       = size;
                         atom.type       = pExt->uridOscRawPacket;
 
                         pExt->forge_frame_time(0);
                         pExt->forge_raw(&atom, sizeof(LV2_Atom));
-                        pExt->forge_raw(pOscPacket, size);
+                        pExt->forge_raw(data, size);
                         pExt->forge_pad(sizeof(LV2_Atom) + size);
+                        pKVTDispatcher->release();
                         break;
                     }
 
-                    case STATUS_OVERFLOW:
-                        lsp_warn("Received too big OSC packet, skipping");
-                        pKVTDispatcher->skip();
-                        break;
-
                     case STATUS_NO_DATA:
                         return;
 
                     default:
                         lsp_warn("Received error while deserializing KVT changes: %d", int(res));
+
+                        // Skip the bad record, drop all pending records if it can not be located
+                        if (pKVTDispatcher->release() != STATUS_OK)
+                            pKVTDispatcher->clear_tx();
                         return;
                 }
             }
@@ -1201,11 +1334,14 @@ namespace lsp
             {
                 nSyncTime      += nSyncSamples;
 
-                // Check that queue_draw() request for inline display is pending
-                if ((bQueueDraw) && (pExt->iDisplay != NULL))
+                // Check that queue_draw() request for inline display is pending,
+                // with deferred rendering the host is notified when the frame is ready
+                if (pExt->iDisplay != NULL)
                 {
-                    pExt->iDisplay->queue_draw(pExt->iDisplay->handle);
+                    bool draw       = update_inline_display(bQueueDraw);
                     bQueueDraw      = false;
+                    if (draw)
+                        pExt->iDisplay->queue_draw(pExt->iDisplay->handle);
                 }
             }
 
@@ -1275,46 +1411,41 @@ namespace lsp
             if (osc == NULL)  // There are no events ?
                 return;
 
+            const void *data;
             size_t size;
             LV2_Atom atom;
 
             while (true)
             {
-                // Try to fetch record from buffer
-                status_t res = osc->fetch(pOscPacket, &size, OSC_PACKET_MAX);
+                // Try to fetch record from buffer, forge it directly from the buffer
+                status_t res = osc->peek_packet(&data, &size);
 
                 switch (res)
                 {
                     case STATUS_OK:
                     {
                         lsp_trace("Transmitting OSC packet of %d bytes", int(size));
-                        osc::dump_packet(pOscPacket, size);
+                        osc::dump_packet(data, size);
 
                         atom.size       = size;
                         atom.type       = pExt->uridOscRawPacket;
 
                         pExt->forge_frame_time(0);
                         pExt->forge_raw(&atom, sizeof(LV2_Atom));
-                        pExt->forge_raw(pOscPacket, size);
+                        pExt->forge_raw(data, size);
                         pExt->forge_pad(sizeof(LV2_Atom) + size);
+                        osc->release_packet();
                         break;
                     }
 
                     case STATUS_NO_DATA: // No more data to transmit
                         return;
 
-                    case STATUS_OVERFLOW:
-                    {
-                        lsp_warn("Too large OSC packet in the buffer, skipping");
-                        osc->skip();
-                        break;
-                    }
-
                     default:
                     {
-                        lsp_warn("OSC packet parsing error %d, skipping", int(res));
-                        osc->skip();
-                        break;
+                        lsp_warn("OSC packet parsing error %d, dropping buffer contents", int(res));
+                        osc->clear();
+                        return;
                     }
                 }
             }
@@ -1886,9 +2017,11 @@ namespace lsp
             // Restore KVT state
             if (sKVTMutex.lock())
             {
-                // Clear KVT
+                // Clear KVT and load new state as a single batch
+                sKVT.begin_batch();
                 sKVT.clear();
                 restore_kvt_parameters();
+                sKVT.end_batch();
                 sKVT.gc();
                 sKVTMutex.unlock();
             }
@@ -1932,6 +2065,12 @@ namespace lsp
                 pKVTDispatcher->disconnect_client();
         }
 
+        void Wrapper::request_state_dump()
+        {
+            prepare_state_dump();
+            atomic_add(&nDumpReq, 1);
+        }
+
         void Wrapper::job_run(
             LV2_Worker_Respond_Handle   handle,
             LV2_Worker_Respond_Function respond,
@@ -1974,19 +2113,31 @@ namespace lsp
 
         LV2_Inline_Display_Image_Surface *Wrapper::render_inline_display(size_t width, size_t height)
         {
-            // Allocate canvas for drawing
-            plug::ICanvas *canvas       = create_canvas(width, height);
-            if (canvas == NULL)
-                return NULL;
-
-            // Call plugin for rendering and return canvas data
-            bool res = pPlugin->inline_display(canvas, width, height);
-            canvas->sync();
-
-            // Obtain canvas data
-            plug::canvas_data_t *data   = canvas->data();
-            if ((!res) || (data == NULL) || (data->pData == NULL))
-                return NULL;
+            plug::canvas_data_t *data   = NULL;
+
+            if (pDisplayTask != NULL)
+            {
+                // Return the last frame rendered by the executor
+                data    = inline_display_frame(width, height);
+                if (data == NULL)
+                    return NULL;
+            }
+            else
+            {
+                // Allocate canvas for drawing
+                plug::ICanvas *canvas       = create_canvas(width, height);
+                if (canvas == NULL)
+                    return NULL;
+
+                // Call plugin for rendering and return canvas data
+                bool res = pPlugin->inline_display(canvas, width, height);
+                canvas->sync();
+
+                // Obtain canvas data
+                data    = canvas->data();
+                if ((!res) || (data == NULL) || (data->pData == NULL))
+                    return NULL;
+            }
 
             // Fill-in surface and return
             sSurface.data           = reinterpret_cast<unsigned char *>(data->pData);
@@ -27,6 +27,8 @@
 #include <lsp-plug.in/common/atomic.h>
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/core/DirtyBitmap.h>
+#include <lsp-plug.in/plug-fw/core/quantize.h>
 #include <lsp-plug.in/plug-fw/meta/func.h>
 #include <lsp-plug.in/plug-fw/meta/ports.h>
 #include <lsp-plug.in/plug-fw/meta/types.h>
@@ -47,6 +49,18 @@ namespace lsp
                  LV2_URID                urid;
                  ssize_t                 nID;
                  bool                    bVirtual;
+                 core::DirtyBitmap      *pChanged;      // Bitmap of ports changed since the last processing cycle
+                 size_t                  nIndex;        // Index of the port in the wrapper
+
+             protected:
+                 /**
+                  * Notify the DSP that the port should be pre-processed
+                  */
+                 inline void mark_changed()
+                 {
+                     if (pChanged != NULL)
+                         pChanged->mark(nIndex);
+                 }
 
              public:
                  explicit Port(const meta::port_t *meta, lv2::Extensions *ext, bool virt): IPort(meta)
@@ -55,12 +69,15 @@ namespace lsp
                      urid            =   (meta != NULL) ? pExt->map_port(meta->id) : -1;
                      nID             =   -1;
                      bVirtual        =   virt;
+                     pChanged        =   NULL;
+                     nIndex          =   size_t(-1);
                  }
                  virtual ~Port()
                  {
                      pExt            =   NULL;
                      urid            =   -1;
                      nID             =   -1;
+                     pChanged        =   NULL;
                  }
 
              public:
@@ -137,6 +154,17 @@ namespace lsp
                   * @return true if port is virtual (non controlled by DAW and stored in PLUGIN STATE)
                   */
                  inline bool            is_virtual() const  { return bVirtual; }
+
+                 /**
+                  * Bind the port to the bitmap of changed ports
+                  * @param changed bitmap of changed ports
+                  * @param index index of the port in the bitmap
+                  */
+                 inline void            bind_changed(core::DirtyBitmap *changed, size_t index)
+                 {
+                     pChanged        = changed;
+                     nIndex          = index;
+                 }
          };
 
          class PortGroup: public Port
@@ -322,6 +350,7 @@ namespace lsp
                  virtual void set_value(float value)
                  {
                      fValue      = value;
+                     mark_changed();
                  }
 
                  virtual void bind(void *data)
@@ -356,7 +385,10 @@ namespace lsp
                      size_t count            = 0;
                      const void *data        = pExt->restore_value(urid, pExt->forge.Float, &count);
                      if ((count == sizeof(float)) && (data != NULL))
+                     {
                          fValue      = meta::limit_value(pMetadata, *(reinterpret_cast<const float *>(data)));
+                         mark_changed();
+                     }
                  }
 
                  virtual bool deserialize(const void *data, size_t flags)
@@ -366,6 +398,7 @@ namespace lsp
                          return false;
 
                      fValue      = atom->body;
+                     mark_changed();
                      return true;
                  }
 
@@ -398,6 +431,7 @@ namespace lsp
                  virtual void set_value(float value)
                  {
                      fValue      = pMetadata->max - value;
+                     mark_changed();
                  }
 
                  virtual void save()
@@ -417,7 +451,10 @@ namespace lsp
                      size_t count            = 0;
                      const void *data        = pExt->restore_value(urid, pExt->forge.Float, &count);
                      if ((count == sizeof(float)) && (data != NULL))
+                     {
                          fValue      = meta::limit_value(pMetadata, pMetadata->max - *(reinterpret_cast<const float *>(data)));
+                         mark_changed();
+                     }
                  }
 
                  virtual bool deserialize(const void *data, size_t flags)
@@ -428,6 +465,7 @@ namespace lsp
                          return false;
 
                      fValue      = v;
+                     mark_changed();
                      return true;
                  }
          };
@@ -519,11 +557,13 @@ namespace lsp
          {
              protected:
                  lv2_mesh_t                 sMesh;
+                 volatile atomic_t          nConsumer;   // Non-zero while the mesh is being consumed
 
              public:
                  explicit MeshPort(const meta::port_t *meta, lv2::Extensions *ext): Port(meta, ext, false)
                  {
                      sMesh.init(meta);
+                     nConsumer   = 0;
                  }
 
                  virtual ~MeshPort()
@@ -548,27 +588,46 @@ namespace lsp
                      return mesh->containsData();
                  };
 
+                 /**
+                  * Try to become the consumer of the mesh. The mesh allows only one consumer
+                  * at a time, so the serializer and the UI with direct access take turns
+                  * @return true if the consumer role has been acquired, should be followed
+                  *   by release_consumer() call
+                  */
+                 inline bool acquire_consumer()
+                 {
+                     return atomic_cas(&nConsumer, 0, 1);
+                 }
+
+                 /**
+                  * Release the consumer role acquired by acquire_consumer()
+                  */
+                 inline void release_consumer()
+                 {
+                     atomic_swap(&nConsumer, 0);
+                 }
+
                  virtual void serialize()
                  {
+                     // Take the newest frame published by the plugin
                      plug::mesh_t *mesh = sMesh.pMesh;
+                     mesh->consume();
+                     const plug::mesh_frame_t *f = mesh->front();
 
                      // Forge number of vectors (dimensions)
                      pExt->forge_key(pExt->uridMeshDimensions);
-                     pExt->forge_int(mesh->nBuffers);
+                     pExt->forge_int(f->nBuffers);
 
                      // Forge number of items per vector
                      pExt->forge_key(pExt->uridMeshItems);
-                     pExt->forge_int(mesh->nItems);
+                     pExt->forge_int(f->nItems);
 
                      // Forge vectors
-                     for (size_t i=0; i < mesh->nBuffers; ++i)
+                     for (size_t i=0; i < f->nBuffers; ++i)
                      {
                          pExt->forge_key(pExt->uridMeshData);
-                         pExt->forge_vector(sizeof(float), pExt->forge.Float, mesh->nItems, mesh->pvData[i]);
+                         pExt->forge_vector(sizeof(float), pExt->forge.Float, f->nItems, f->vData[i]);
                      }
-
-                     // Set mesh waiting until next frame is allowed
-                     mesh->setWaiting();
                  }
          };
 
@@ -578,12 +637,14 @@ namespace lsp
                  plug::stream_t     *pStream;
                  uint32_t            nFrameID;
                  float              *pData;
+                 uint16_t           *pQuant;
 
              public:
                  explicit StreamPort(const meta::port_t *meta, lv2::Extensions *ext): Port(meta, ext, false)
                  {
                      pStream     = plug::stream_t::create(pMetadata->min, pMetadata->max, pMetadata->start);
-                     pData       = reinterpret_cast<float *>(::malloc(sizeof(float) * STREAM_MAX_FRAME_SIZE));
+                     pData       = reinterpret_cast<float *>(::malloc((sizeof(float) + sizeof(uint16_t)) * STREAM_MAX_FRAME_SIZE));
+                     pQuant      = (pData != NULL) ? reinterpret_cast<uint16_t *>(&pData[STREAM_MAX_FRAME_SIZE]) : NULL;
                      nFrameID    = 0;
                  }
 
@@ -596,9 +657,43 @@ namespace lsp
                      {
                          ::free(pData);
                          pData       = NULL;
+                         pQuant      = NULL;
                      }
                  };
 
+             protected:
+                 void forge_channel(size_t channel, uint32_t frame_id, size_t size)
+                 {
+                     ssize_t count   = pStream->read_frame(channel, frame_id, pData, 0, size);
+                     if (count < 0)
+                         count           = 0;
+
+                     if (pMetadata->flags & meta::F_QINT16)
+                     {
+                         int16_t *q      = reinterpret_cast<int16_t *>(pQuant);
+                         float scale     = core::quantize_int16(q, pData, count);
+
+                         pExt->forge_key(pExt->uridStreamFrameScale);
+                         pExt->forge_float(scale);
+                         pExt->forge_key(pExt->uridStreamFrameData);
+                         pExt->forge_vector(sizeof(int16_t), pExt->uridTypeInt16, count, q);
+                     }
+                     else if (pMetadata->flags & meta::F_QHALF)
+                     {
+                         float scale     = core::quantize_half(pQuant, pData, count);
+
+                         pExt->forge_key(pExt->uridStreamFrameScale);
+                         pExt->forge_float(scale);
+                         pExt->forge_key(pExt->uridStreamFrameData);
+                         pExt->forge_vector(sizeof(uint16_t), pExt->uridTypeHalf, count, pQuant);
+                     }
+                     else
+                     {
+                         pExt->forge_key(pExt->uridStreamFrameData);
+                         pExt->forge_vector(sizeof(float), pExt->forge.Float, count, pData);
+                     }
+                 }
+
              public:
                  virtual LV2_URID get_type_urid()        { return pExt->uridFrameBufferType; };
 
@@ -621,17 +716,27 @@ namespace lsp
 
                  virtual void serialize()
                  {
-                     // Serialize not more than number of predefined frames
-                     uint32_t frame_id   = nFrameID;
-                     size_t src_id       = pStream->frame_id();
-                     size_t delta        = src_id - nFrameID;
-                     if (delta > pStream->frames())
-                         frame_id            = src_id - pStream->frames();
-                     if (delta > STREAM_BULK_MAX)
-                         delta = STREAM_BULK_MAX;
-                     size_t last_id          = frame_id + delta;
+                     // Estimate the number of new frames, not more than predefined
+                     uint32_t src_id     = pStream->frame_id();
+                     size_t count        = lsp_min(uint32_t(src_id - nFrameID), uint32_t(pStream->frames()));
+                     count               = lsp_min(count, size_t(STREAM_BULK_MAX));
 
-                     lsp_trace("id = %s, first=%d, last=%d", pMetadata->id, int(frame_id), int(last_id));
+                     // Do not transfer frames which will be displaced from the UI
+                     // stream by newer frames, walk from the newest frame back
+                     size_t frames       = 0;
+                     size_t length       = 0;
+                     while (frames < count)
+                     {
+                         ssize_t size        = pStream->get_size(src_id - frames);
+                         if (size < 0)
+                             break;
+                         ++frames;
+                         if ((length += size) >= pStream->capacity())
+                             break;
+                     }
+
+                     uint32_t frame_id   = src_id - frames + 1;
+                     lsp_trace("id = %s, first=%d, last=%d", pMetadata->id, int(frame_id), int(src_id));
 
                      // Forge frame buffer parameters
                      size_t nbuffers = pStream->channels();
@@ -639,12 +744,11 @@ namespace lsp
                      pExt->forge_key(pExt->uridStreamDimensions);
                      pExt->forge_int(nbuffers);
 
-                     // Forge vectors
-                     for ( ; frame_id != last_id; ++frame_id)
+                     // Forge only incremental blocks of frames
+                     for ( ; frames > 0; --frames, ++frame_id)
                      {
                          LV2_Atom_Forge_Frame frame;
                          size_t size = pStream->get_size(frame_id);
-     //                    lsp_trace("frame id=%d, size=%d", int(frame_id), int(size));
 
                          pExt->forge_key(pExt->uridStreamFrame);
                          pExt->forge_object(&frame, pExt->uridBlank, pExt->uridStreamFrameType);
@@ -657,18 +761,13 @@ namespace lsp
 
                              // Forge vectors
                              for (size_t i=0; i < nbuffers; ++i)
-                             {
-                                 pStream->read(i, pData, 0, size);
-
-                                 pExt->forge_key(pExt->uridStreamFrameData);
-                                 pExt->forge_vector(sizeof(float), pExt->forge.Float, size, pData);
-                             }
+                                 forge_channel(i, frame_id, size);
                          }
                          pExt->forge_pop(&frame);
                      }
 
-                     // Update current RowID
-                     nFrameID    = frame_id;
+                     // Update current frame identifier
+                     nFrameID    = src_id;
                  }
          };
 
@@ -678,18 +777,77 @@ namespace lsp
              protected:
                  plug::frame_buffer_t   sFB;
                  size_t                 nRowID;
+                 size_t                 nBits;          // Bits per quantized value, 0 for floating-point rows
+                 size_t                 nKeyRows;       // Number of rows until the next key row
+                 uint16_t              *vRow;           // Quantized row
+                 uint16_t              *vPrev;          // Previous transmitted quantized row
+                 uint8_t               *pEncoded;       // Encoded row
+                 uint8_t               *pData;          // Allocated data
 
              public:
                  explicit FrameBufferPort(const meta::port_t *meta, lv2::Extensions *ext): Port(meta, ext, false)
                  {
                      sFB.init(meta->start, meta->step);
-                     nRowID = 0;
+                     nRowID      = 0;
+                     nBits       = (meta->flags & meta::F_QINT8) ? 8 : (meta->flags & meta::F_QINT16) ? 16 : 0;
+                     nKeyRows    = 0;
+                     vRow        = NULL;
+                     vPrev       = NULL;
+                     pEncoded    = NULL;
+                     pData       = NULL;
+
+                     if (nBits > 0)
+                     {
+                         size_t cols     = sFB.cols();
+                         size_t szof_row = align_size(cols * sizeof(uint16_t), DEFAULT_ALIGN);
+                         size_t szof_enc = align_size(core::encoded_row_size(cols, nBits), DEFAULT_ALIGN);
+                         uint8_t *ptr    = alloc_aligned<uint8_t>(pData, szof_row * 2 + szof_enc);
+                         if (ptr != NULL)
+                         {
+                             vRow            = reinterpret_cast<uint16_t *>(ptr);
+                             ptr            += szof_row;
+                             vPrev           = reinterpret_cast<uint16_t *>(ptr);
+                             ptr            += szof_row;
+                             pEncoded        = ptr;
+                         }
+                         else
+                             nBits           = 0;
+                     }
                  }
 
                  virtual ~FrameBufferPort()
                  {
+                     if (pData != NULL)
+                     {
+                         free_aligned(pData);
+                         pData       = NULL;
+                     }
+                     vRow        = NULL;
+                     vPrev       = NULL;
+                     pEncoded    = NULL;
                  };
 
+             protected:
+                 void forge_row(const float *row)
+                 {
+                     pExt->forge_key(pExt->uridFrameBufferData);
+
+                     if (nBits <= 0)
+                     {
+                         pExt->forge_vector(sizeof(float), pExt->forge.Float, sFB.cols(), row);
+                         return;
+                     }
+
+                     // Emit the key row periodically to recover after lost messages
+                     core::quantize_log(vRow, row, sFB.cols(), nBits);
+                     const uint16_t *prev = (nKeyRows > 0) ? vPrev : NULL;
+                     nKeyRows        = (nKeyRows > 0) ? nKeyRows - 1 : FRAMEBUFFER_KEY_PERIOD - 1;
+
+                     size_t size     = core::encode_row(pEncoded, vRow, prev, sFB.cols(), nBits);
+                     pExt->forge_vector(sizeof(uint8_t), pExt->uridFrameBufferRowType, size, pEncoded);
+                     lsp::swap(vRow, vPrev);
+                 }
+
              public:
                  virtual LV2_URID get_type_urid()        { return pExt->uridFrameBufferType; };
 
@@ -708,6 +866,7 @@ namespace lsp
                      // We need to replay buffer contents for the connected client
                      lsp_trace("UI connected event");
                      nRowID      = sFB.next_rowid() - sFB.rows();
+                     nKeyRows    = 0;
                  }
 
                  virtual void serialize()
@@ -733,10 +892,7 @@ namespace lsp
 
                      // Forge vectors
                      while (first_row != last_row)
-                     {
-                         pExt->forge_key(pExt->uridFrameBufferData);
-                         pExt->forge_vector(sizeof(float), pExt->forge.Float, sFB.cols(), sFB.get_row(first_row++));
-                     }
+                         forge_row(sFB.get_row(first_row++));
 
                      // Update current RowID
                      nRowID = first_row;
@@ -898,11 +1054,15 @@ namespace lsp
          {
              protected:
                  plug::midi_t           sQueue;
+                 plug::midi_t           sBlock;      // All input events of the processing block
+                 size_t                 nFirst;      // First output event produced by the current chunk
 
              public:
                  explicit MidiPort(const meta::port_t *meta, lv2::Extensions *ext): Port(meta, ext, false)
                  {
                      sQueue.clear();
+                     sBlock.clear();
+                     nFirst      = 0;
                  }
 
              public:
@@ -910,6 +1070,42 @@ namespace lsp
                  {
                      return &sQueue;
                  }
+
+             public:
+                 /**
+                  * Save input events received for the whole processing block
+                  */
+                 inline void begin_block()
+                 {
+                     if (meta::is_in_port(pMetadata))
+                         sBlock.copy_from(&sQueue);
+                 }
+
+                 /**
+                  * Prepare the queue for processing of the chunk of the block:
+                  * input events of the chunk are rebased to its start
+                  *
+                  * @param off offset of the chunk from the start of the block
+                  * @param samples length of the chunk
+                  */
+                 inline void begin_chunk(size_t off, size_t samples)
+                 {
+                     if (meta::is_in_port(pMetadata))
+                         sQueue.slice(&sBlock, off, samples);
+                     else
+                         nFirst      = sQueue.nEvents;
+                 }
+
+                 /**
+                  * Rebase output events produced by the chunk to the start of the block
+                  *
+                  * @param off offset of the chunk from the start of the block
+                  */
+                 inline void end_chunk(size_t off)
+                 {
+                     if (meta::is_out_port(pMetadata))
+                         sQueue.shift(nFirst, off);
+                 }
          };
 
          class OscPort: public Port
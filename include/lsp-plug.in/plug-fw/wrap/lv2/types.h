@@ -40,6 +40,7 @@ namespace lsp
 
         #define LSP_LV2_ATOM_KEY_SIZE       (sizeof(uint32_t) * 2)
         #define LSP_LV2_SIZE_PAD(size)      ::lsp::align_size((size + 0x200), 0x200)
+        #define LSP_LV2_KVT_COALESCE        10      /* KVT dispatcher coalescing window in milliseconds */
 
         #define LSP_LV2_LATENCY_PORT        "out_latency"
         #define LSP_LV2_ATOM_PORT_IN        "in_ui"
@@ -65,63 +66,27 @@ namespace lsp
             size_t                  nMaxItems;
             size_t                  nBuffers;
             plug::mesh_t           *pMesh;
-            uint8_t                *pData;
 
             lv2_mesh_t()
             {
                 nMaxItems       = 0;
                 nBuffers        = 0;
                 pMesh           = NULL;
-                pData           = NULL;
             }
 
             ~lv2_mesh_t()
             {
-                // Simply delete root structure
-                if (pData != NULL)
-                {
-                    delete [] (pData);
-                    pData       = NULL;
-                }
+                plug::mesh_t::destroy(pMesh);
                 pMesh       = NULL;
             }
 
             void init(const meta::port_t *meta)
             {
-                // Calculate sizes
                 nBuffers            = meta->step;
                 nMaxItems           = meta->start;
+                pMesh               = plug::mesh_t::create(nBuffers, nMaxItems);
 
-                size_t hdr_size     = align_size(sizeof(plug::mesh_t) + sizeof(float *) * nBuffers, DEFAULT_ALIGN);
-                size_t urid_size    = align_size(sizeof(LV2_URID) * nBuffers, DEFAULT_ALIGN);
-                size_t buf_size     = align_size(sizeof(float) * nMaxItems, DEFAULT_ALIGN);
-                size_t to_alloc     = hdr_size + urid_size + buf_size * nBuffers;
-
-                lsp_trace("buffers = %d, max_items=%d, hdr_size=%d, urid_size=%d, buf_size=%d, to_alloc=%d",
-                        int(nBuffers), int(nMaxItems), int(hdr_size), int(urid_size), int(buf_size), int(to_alloc));
-                pData               = new uint8_t[to_alloc + DEFAULT_ALIGN];
-                if (pData == NULL)
-                    return;
-                uint8_t *ptr        = align_ptr(pData, DEFAULT_ALIGN);
-                pMesh               = reinterpret_cast<plug::mesh_t *>(ptr);
-                ptr                += hdr_size;
-
-                lsp_trace("ptr = %p, pMesh = %p", ptr, pMesh);
-
-                for (size_t i=0; i<nBuffers; ++i)
-                {
-                    lsp_trace("bufs[%d] = %p", int(i), ptr);
-                    pMesh->pvData[i]    = reinterpret_cast<float *>(ptr);
-                    ptr                += buf_size;
-                }
-
-                lsp_assert(ptr <= &pData[to_alloc + DEFAULT_ALIGN]);
-
-                pMesh->nState       = plug::M_WAIT;
-                pMesh->nBuffers     = 0;
-                pMesh->nItems       = 0;
-
-                lsp_trace("Initialized");
+                lsp_trace("buffers = %d, max_items=%d, mesh=%p", int(nBuffers), int(nMaxItems), pMesh);
             }
 
             static size_t size_of_port(const meta::port_t *meta)
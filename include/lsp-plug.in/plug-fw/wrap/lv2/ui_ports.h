@@ -297,8 +297,6 @@ namespace lsp
                     if (meta::is_mesh_port(xmeta))
                     {
                         pPort                   = static_cast<lv2::MeshPort *>(xport);
-                        plug::mesh_t *mesh      = static_cast<plug::mesh_t *>(pPort->buffer());
-                        mesh->cleanup();  // Mark mesh as empty to force the DSP to write data to mesh
                         lsp_trace("Connected direct mesh port id=%s", xmeta->id);
                     }
                 }
@@ -396,21 +394,33 @@ namespace lsp
                     if (pPort == NULL)
                         return false;
 
-                    plug::mesh_t *mesh = reinterpret_cast<plug::mesh_t *>(pPort->buffer());
+                    plug::mesh_t *mesh = pPort->buffer<plug::mesh_t>();
                     if ((mesh == NULL) || (!mesh->containsData()))
                         return false;
 
-                    // Copy mesh data
-                    for (size_t i=0; i < mesh->nBuffers; ++i)
-                        dsp::copy_saturated(sMesh.pMesh->pvData[i], mesh->pvData[i], mesh->nItems);
-                    sMesh.pMesh->data(mesh->nBuffers, mesh->nItems);
+                    // The serializer of the DSP side may be consuming the mesh at this moment
+                    if (!pPort->acquire_consumer())
+                        return false;
+
+                    // Copy the newest frame published by the plugin
+                    bool fresh = mesh->consume();
+                    if (fresh)
+                    {
+                        const plug::mesh_frame_t *f = mesh->front();
+                        size_t bufs = lsp_min(f->nBuffers, sMesh.nBuffers);
+                        size_t items= lsp_min(f->nItems, sMesh.nMaxItems);
+                        for (size_t i=0; i < bufs; ++i)
+                            dsp::copy_saturated(sMesh.pMesh->pvData[i], f->vData[i], items);
+                        sMesh.pMesh->nBuffers   = bufs;
+                        sMesh.pMesh->nItems     = items;
+                    }
+                    pPort->release_consumer();
+
     //                lsp_trace("Directly received mesh port id=%s, buffers=%d, items=%d",
     //                        pPort->metadata()->id, int(sMesh.pMesh->nBuffers), int(sMesh.pMesh->nItems));
-
-                    // Clean source mesh
-                    mesh->cleanup();
-                    bParsed = true;
-                    return sMesh.pMesh->containsData();
+                    if (fresh)
+                        bParsed     = true;
+                    return fresh;
                 }
         };
 
@@ -419,12 +429,14 @@ namespace lsp
             protected:
                 plug::stream_t         *pStream;
                 lv2::StreamPort        *pPort;
+                float                  *pData;
 
             public:
                 explicit UIStreamPort(const meta::port_t *meta, lv2::Extensions *ext, lv2::Port *xport) : UIPort(meta, ext)
                 {
                     pStream         = plug::stream_t::create(pMetadata->min, pMetadata->max, pMetadata->start);
                     pPort           = NULL;
+                    pData           = reinterpret_cast<float *>(::malloc(sizeof(float) * STREAM_MAX_FRAME_SIZE));
 
                     // Try to perform direct access to the port using LV2:Instance interface
                     const meta::port_t *xmeta = (xport != NULL) ? xport->metadata() : NULL;
@@ -439,6 +451,12 @@ namespace lsp
                 {
                     plug::stream_t::destroy(pStream);
                     pStream         = NULL;
+
+                    if (pData != NULL)
+                    {
+                        ::free(pData);
+                        pData           = NULL;
+                    }
                 };
 
             protected:
@@ -482,7 +500,8 @@ namespace lsp
 
                     // Now we are able to commit the frame
                     frame_size          = pStream->add_frame(frame_size);
-                    for (size_t i=0, n=pStream->channels(); i<n; ++i)
+                    float scale         = 1.0f;
+                    for (size_t i=0, n=pStream->channels(); i<n; )
                     {
                         // Read vector as array of floats
                         body = lv2_atom_object_next(body);
@@ -491,16 +510,41 @@ namespace lsp
     //                    lsp_trace("body->key (%d) = %s", int(body->key), pExt->unmap_urid(body->key));
     //                    lsp_trace("body->value.type (%d) = %s", int(body->value.type), pExt->unmap_urid(body->value.type));
 
+                        // Scale of quantized data precedes the vector
+                        if (body->key == pExt->uridStreamFrameScale)
+                        {
+                            if (body->value.type != pExt->forge.Float)
+                                return;
+                            scale               = (reinterpret_cast<const LV2_Atom_Float *>(&body->value))->body;
+                            continue;
+                        }
+
                         if ((body->key != pExt->uridStreamFrameData) || (body->value.type != pExt->forge.Vector))
                             return;
                         const LV2_Atom_Vector *v = reinterpret_cast<const LV2_Atom_Vector *>(&body->value);
     //                    lsp_trace("body->child_size = %d, body->child_type (%d) = %s", int(v->body.child_size), int(v->body.child_type), pExt->unmap_urid(v->body.child_type));
-                        if ((v->body.child_size != sizeof(float)) || (v->body.child_type != pExt->forge.Float))
+                        if (v->body.child_size <= 0)
                             return;
 
-                        ssize_t v_items     = lsp_min(frame_size, ssize_t((v->atom.size - sizeof(LV2_Atom_Vector_Body)) / sizeof(float)));
-    //                    lsp_trace("channel = %d, floats = %d", int(i), int(v_items));
-                        pStream->write_frame(i, reinterpret_cast<const float *>(v + 1), 0, v_items);
+                        ssize_t v_items     = lsp_min(frame_size, ssize_t((v->atom.size - sizeof(LV2_Atom_Vector_Body)) / v->body.child_size));
+    //                    lsp_trace("channel = %d, items = %d", int(i), int(v_items));
+                        if ((v->body.child_size == sizeof(float)) && (v->body.child_type == pExt->forge.Float))
+                            pStream->write_frame(i, reinterpret_cast<const float *>(v + 1), 0, v_items);
+                        else if ((v->body.child_size == sizeof(int16_t)) && (v->body.child_type == pExt->uridTypeInt16) && (pData != NULL))
+                        {
+                            core::dequantize_int16(pData, reinterpret_cast<const int16_t *>(v + 1), scale, v_items);
+                            pStream->write_frame(i, pData, 0, v_items);
+                        }
+                        else if ((v->body.child_size == sizeof(uint16_t)) && (v->body.child_type == pExt->uridTypeHalf) && (pData != NULL))
+                        {
+                            core::dequantize_half(pData, reinterpret_cast<const uint16_t *>(v + 1), scale, v_items);
+                            pStream->write_frame(i, pData, 0, v_items);
+                        }
+                        else
+                            return;
+
+                        scale               = 1.0f;
+                        ++i;
                     }
 
                     // Commit the frame
@@ -570,6 +614,12 @@ namespace lsp
             protected:
                 plug::frame_buffer_t    sFB;
                 lv2::FrameBufferPort   *pPort;
+                size_t                  nBits;      // Bits per quantized value, 0 for floating-point rows
+                bool                    bPrev;      // Previous quantized row is valid
+                uint16_t               *vRow;       // Quantized row
+                uint16_t               *vPrev;      // Previous quantized row
+                float                  *vDecoded;   // Decoded row
+                uint8_t                *pData;      // Allocated data
 
             public:
                 explicit UIFrameBufferPort(const meta::port_t *meta, lv2::Extensions *ext, lv2::Port *xport):
@@ -577,6 +627,28 @@ namespace lsp
                 {
                     sFB.init(meta->start, meta->step);
                     pPort       = NULL;
+                    nBits       = (meta->flags & meta::F_QINT8) ? 8 : (meta->flags & meta::F_QINT16) ? 16 : 0;
+                    bPrev       = false;
+                    vRow        = NULL;
+                    vPrev       = NULL;
+                    vDecoded    = NULL;
+                    pData       = NULL;
+
+                    if (nBits > 0)
+                    {
+                        size_t cols     = sFB.cols();
+                        size_t szof_row = align_size(cols * sizeof(uint16_t), DEFAULT_ALIGN);
+                        size_t szof_dec = align_size(cols * sizeof(float), DEFAULT_ALIGN);
+                        uint8_t *ptr    = alloc_aligned<uint8_t>(pData, szof_row * 2 + szof_dec);
+                        if (ptr != NULL)
+                        {
+                            vDecoded        = reinterpret_cast<float *>(ptr);
+                            ptr            += szof_dec;
+                            vRow            = reinterpret_cast<uint16_t *>(ptr);
+                            ptr            += szof_row;
+                            vPrev           = reinterpret_cast<uint16_t *>(ptr);
+                        }
+                    }
 
                     lsp_trace("id=%s, ext=%p, xport=%p", meta->id, ext, xport);
 
@@ -591,6 +663,42 @@ namespace lsp
 
                 virtual ~UIFrameBufferPort()
                 {
+                    if (pData != NULL)
+                    {
+                        free_aligned(pData);
+                        pData       = NULL;
+                    }
+                    vRow        = NULL;
+                    vPrev       = NULL;
+                    vDecoded    = NULL;
+                }
+
+            protected:
+                bool decode_row(uint32_t row_id, const LV2_Atom_Vector *v)
+                {
+                    if (vDecoded == NULL)
+                        return false;
+
+                    size_t size         = v->atom.size - sizeof(LV2_Atom_Vector_Body);
+                    status_t res        = core::decode_row(
+                        vRow, (bPrev) ? vPrev : NULL,
+                        reinterpret_cast<const uint8_t *>(v + 1), size,
+                        sFB.cols(), nBits);
+
+                    if (res != STATUS_OK)
+                    {
+                        // Wait for the next key row
+                        lsp_trace("could not decode row %d, code=%d", int(row_id), int(res));
+                        bPrev               = false;
+                        return true;
+                    }
+
+                    core::dequantize_log(vDecoded, vRow, sFB.cols(), nBits);
+                    sFB.write_row(row_id, vDecoded);
+                    lsp::swap(vRow, vPrev);
+                    bPrev               = true;
+
+                    return true;
                 }
 
             public:
@@ -700,6 +808,14 @@ namespace lsp
 
     //                    lsp_trace("body->child_size = %d, body->child_type (%d) = %s", int(v->body.child_size), int(v->body.child_type), pExt->unmap_urid(v->body.child_type));
 
+                        // Encoded row
+                        if ((v->body.child_size == sizeof(uint8_t)) && (v->body.child_type == pExt->uridFrameBufferRowType))
+                        {
+                            if (!decode_row(first_row++, v))
+                                return;
+                            continue;
+                        }
+
                         if ((v->body.child_size != sizeof(float)) || (v->body.child_type != pExt->forge.Float))
                             return;
                         ssize_t v_items     = (v->atom.size - sizeof(LV2_Atom_Vector_Body)) / sizeof(float);
@@ -27,6 +27,7 @@
 #include <lsp-plug.in/ipc/NativeExecutor.h>
 #include <lsp-plug.in/lltl/parray.h>
 #include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/core/DirtyBitmap.h>
 #include <lsp-plug.in/plug-fw/core/KVTDispatcher.h>
 #include <lsp-plug.in/plug-fw/core/KVTStorage.h>
 #include <lsp-plug.in/plug-fw/wrap/lv2/executor.h>
@@ -72,6 +73,7 @@ namespace lsp
                         virtual void created(core::KVTStorage *storage, const char *id, const core::kvt_param_t *param, size_t pending);
                         virtual void changed(core::KVTStorage *storage, const char *id, const core::kvt_param_t *oval, const core::kvt_param_t *nval, size_t pending);
                         virtual void removed(core::KVTStorage *storage, const char *id, const core::kvt_param_t *param, size_t pending);
+                        virtual void updated(core::KVTStorage *storage, const char *branch, size_t count, size_t pending);
                 };
 
             protected:
@@ -84,6 +86,8 @@ namespace lsp
                 lltl::parray<lv2::Port>         vMidiPorts;
                 lltl::parray<lv2::Port>         vOscPorts;
                 lltl::parray<lv2::AudioPort>    vAudioPorts;
+                lltl::parray<lv2::Port>         vCtlPorts;      // Control ports connected to the host, polled at each cycle
+                lltl::parray<lv2::Port>         vProcPorts;     // Ports that require processing at each cycle
                 lltl::parray<meta::port_t>      vGenMetadata;   // Generated metadata
 
                 lv2::Extensions        *pExt;
@@ -100,7 +104,6 @@ namespace lsp
                 bool                    bQueueDraw;     // Queue draw request
                 bool                    bUpdateSettings;// Settings update
                 float                   fSampleRate;
-                uint8_t                *pOscPacket;     // OSC packet data
                 volatile uatomic_t      nStateMode;     // State change flag
                 volatile uatomic_t      nDumpReq;
                 uatomic_t               nDumpResp;
@@ -110,12 +113,15 @@ namespace lsp
                 LV2KVTListener          sKVTListener;
                 ipc::Mutex              sKVTMutex;
                 core::KVTDispatcher    *pKVTDispatcher;
+                core::DirtyBitmap       sChangedPorts;  // Ports changed by UI or state since the last cycle
 
                 LV2_Inline_Display_Image_Surface sSurface; // Canvas surface
 
             protected:
                 lv2::Port                      *create_port(lltl::parray<plug::IPort> *plugin_ports, const meta::port_t *meta, const char *postfix, bool virt);
                 void                            clear_midi_ports();
+                inline void                     pre_process_port(lv2::Port *port, size_t samples, size_t smode);
+                void                            process_block(const plug::position_t *pos, size_t off, size_t samples);
                 void                            save_kvt_parameters();
                 void                            restore_kvt_parameters();
 
@@ -135,7 +141,10 @@ namespace lsp
                 void                            receive_midi_event(const LV2_Atom_Event *ev);
                 void                            receive_raw_osc_event(osc::parse_frame_t *frame);
                 void                            receive_atom_object(const LV2_Atom_Event *ev);
-                void                            receive_atoms(size_t samples);
+                void                            receive_atoms(size_t samples, bool patches);
+                inline bool                     is_patch_set(const LV2_Atom_Event *ev);
+                const LV2_Atom_Event           *next_patch_set(const LV2_Atom_Event *ev);
+                const LV2_Atom_Event           *receive_patches(const LV2_Atom_Event *ev, size_t offset);
 
                 static ssize_t                  compare_ports_by_urid(const lv2::Port *a, const lv2::Port *b);
 
@@ -194,6 +203,8 @@ namespace lsp
 
                 void                            disconnect_direct_ui();
 
+                void                            request_state_dump();
+
                 inline float                    get_sample_rate() const { return fSampleRate; }
 
                 virtual core::KVTStorage       *kvt_lock();
@@ -0,0 +1,684 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 23 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_IMPL_WRAPPER_H_
+#define LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_IMPL_WRAPPER_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/wrapper.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/ports.h>
+
+namespace lsp
+{
+    namespace offline
+    {
+        inline Wrapper::Wrapper(plug::Module *plugin, resource::ILoader *loader): IWrapper(plugin, loader)
+        {
+            nBlockSize      = 0;
+            bUpdateSettings = true;
+            pExecutor       = NULL;
+            pPackage        = NULL;
+        }
+
+        inline Wrapper::~Wrapper()
+        {
+            nBlockSize      = 0;
+            pExecutor       = NULL;
+            pPackage        = NULL;
+        }
+
+        inline status_t Wrapper::init(size_t block_size)
+        {
+            status_t res;
+            nBlockSize      = lsp_limit(block_size, size_t(OFFLINE_BLOCK_SIZE_MIN), size_t(OFFLINE_BLOCK_SIZE_MAX));
+
+            // Load package information
+            io::IInStream *is = resources()->read_stream(LSP_BUILTIN_PREFIX "manifest.json");
+            if (is == NULL)
+            {
+                lsp_error("No manifest.json found in resources");
+                return STATUS_BAD_STATE;
+            }
+
+            res = meta::load_manifest(&pPackage, is);
+            is->close();
+            delete is;
+
+            if (res != STATUS_OK)
+            {
+                lsp_error("Error while reading manifest file, error: %d", int(res));
+                return res;
+            }
+
+            // Obtain plugin metadata
+            const meta::plugin_t *meta = pPlugin->metadata();
+            if (meta == NULL)
+                return STATUS_BAD_STATE;
+
+            // Create ports
+            lsp_trace("Creating ports for %s - %s", meta->name, meta->description);
+            lltl::parray<plug::IPort> plugin_ports;
+            for (const meta::port_t *port = meta->ports ; port->id != NULL; ++port)
+                create_port(&plugin_ports, port, NULL);
+
+            // Check that all ports have been initialized
+            if (plugin_ports.size() != vAllPorts.size())
+                return STATUS_NO_MEM;
+
+            // Initialize plugin
+            pPlugin->init(this, plugin_ports.array());
+
+            return STATUS_OK;
+        }
+
+        inline void Wrapper::destroy()
+        {
+            // Destroy ports
+            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+            {
+                Port *p = vAllPorts.uget(i);
+                p->destroy();
+                delete p;
+            }
+            vAllPorts.flush();
+            vAudioIn.flush();
+            vAudioOut.flush();
+
+            // Cleanup generated metadata
+            for (size_t i=0, n=vGenMetadata.size(); i<n; ++i)
+            {
+                meta::port_t *port = vGenMetadata.uget(i);
+                meta::drop_port_metadata(port);
+            }
+            vGenMetadata.flush();
+
+            // Forget the plugin instance
+            pPlugin     = NULL;
+
+            // Destroy executor service
+            if (pExecutor != NULL)
+            {
+                pExecutor->shutdown();
+                delete pExecutor;
+                pExecutor   = NULL;
+            }
+
+            // Destroy package
+            meta::free_manifest(pPackage);
+            pPackage    = NULL;
+        }
+
+        inline void Wrapper::create_port(lltl::parray<plug::IPort> *plugin_ports, const meta::port_t *port, const char *postfix)
+        {
+            offline::Port *op   = NULL;
+
+            switch (port->role)
+            {
+                case meta::R_MESH:
+                    op      = new offline::MeshPort(port, this);
+                    break;
+
+                case meta::R_FBUFFER:
+                    op      = new offline::FrameBufferPort(port, this);
+                    break;
+
+                case meta::R_STREAM:
+                    op      = new offline::StreamPort(port, this);
+                    break;
+
+                case meta::R_MIDI:
+                    op      = new offline::MidiPort(port, this);
+                    break;
+
+                case meta::R_AUDIO:
+                {
+                    offline::AudioPort *ap = new offline::AudioPort(port, this, nBlockSize);
+                    if (ap != NULL)
+                    {
+                        if (meta::is_in_port(port))
+                            vAudioIn.add(ap);
+                        else
+                            vAudioOut.add(ap);
+                    }
+                    op      = ap;
+                    break;
+                }
+
+                case meta::R_OSC:
+                    op      = new offline::OscPort(port, this);
+                    break;
+
+                case meta::R_PATH:
+                    op      = new offline::PathPort(port, this);
+                    break;
+
+                case meta::R_CONTROL:
+                case meta::R_BYPASS:
+                    op      = new offline::ControlPort(port, this);
+                    break;
+
+                case meta::R_METER:
+                    op      = new offline::MeterPort(port, this);
+                    break;
+
+                case meta::R_PORT_SET:
+                {
+                    LSPString postfix_str;
+                    offline::PortGroup  *pg      = new offline::PortGroup(port, this);
+                    pg->init();
+                    vAllPorts.add(pg);
+                    plugin_ports->add(pg);
+
+                    for (size_t row=0; row<pg->rows(); ++row)
+                    {
+                        // Generate postfix
+                        postfix_str.fmt_ascii("%s_%d", (postfix != NULL) ? postfix : "", int(row));
+                        const char *port_post   = postfix_str.get_ascii();
+
+                        // Clone port metadata
+                        meta::port_t *cm        = clone_port_metadata(port->members, port_post);
+                        if (cm != NULL)
+                        {
+                            vGenMetadata.add(cm);
+
+                            for (; cm->id != NULL; ++cm)
+                            {
+                                if (meta::is_growing_port(cm))
+                                    cm->start    = cm->min + ((cm->max - cm->min) * row) / float(pg->rows());
+                                else if (meta::is_lowering_port(cm))
+                                    cm->start    = cm->max - ((cm->max - cm->min) * row) / float(pg->rows());
+
+                                create_port(plugin_ports, cm, port_post);
+                            }
+                        }
+                    }
+
+                    break;
+                }
+
+                default:
+                    break;
+            }
+
+            if (op != NULL)
+            {
+                if (op->init() != STATUS_OK)
+                    lsp_error("Could not initialize port %s", port->id);
+                vAllPorts.add(op);
+                plugin_ports->add(op);
+            }
+        }
+
+        inline void Wrapper::start(size_t sample_rate)
+        {
+            // Deactivate the plugin to drop the state left from the previous stream
+            if (pPlugin->active())
+                pPlugin->deactivate();
+
+            // Clear buffers of audio ports
+            for (size_t i=0, n=vAudioIn.size(); i<n; ++i)
+            {
+                offline::AudioPort *p = vAudioIn.uget(i);
+                dsp::fill_zero(p->data(), p->size());
+            }
+            for (size_t i=0, n=vAudioOut.size(); i<n; ++i)
+            {
+                offline::AudioPort *p = vAudioOut.uget(i);
+                dsp::fill_zero(p->data(), p->size());
+            }
+
+            // Update sample rate and position
+            if (pPlugin->get_sample_rate() != long(sample_rate))
+                pPlugin->set_sample_rate(sample_rate);
+            plug::position_t::init(&sPosition);
+            sPosition.sampleRate    = sample_rate;
+            sPosition.speed         = 1.0f;
+            pPlugin->set_position(&sPosition);
+
+            // Activate the plugin and request for settings update
+            pPlugin->activate();
+            bUpdateSettings         = true;
+
+            wait_resources();
+        }
+
+        inline bool Wrapper::paths_pending()
+        {
+            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+            {
+                offline::Port *p = vAllPorts.uget(i);
+                if (!meta::is_path_port(p->metadata()))
+                    continue;
+                plug::path_t *path = p->buffer<plug::path_t>();
+                if ((path != NULL) && (path->pending()))
+                    return true;
+            }
+            return false;
+        }
+
+        inline bool Wrapper::paths_loading()
+        {
+            // The plugin accepts the path when it starts loading and commits it when done
+            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+            {
+                offline::Port *p = vAllPorts.uget(i);
+                if (!meta::is_path_port(p->metadata()))
+                    continue;
+                plug::path_t *path = p->buffer<plug::path_t>();
+                if ((path != NULL) && (path->accepted()))
+                    return true;
+            }
+            return false;
+        }
+
+        inline bool Wrapper::flush_executor()
+        {
+            if (pExecutor == NULL)
+                return true;
+
+            FlushTask task;
+            if (!pExecutor->submit(&task))
+                return false;
+
+            // The executor does not drop submitted tasks, so wait for completion unconditionally
+            while (!task.completed())
+                ipc::Thread::sleep(OFFLINE_LOAD_POLL);
+            return true;
+        }
+
+        inline void Wrapper::wait_resources()
+        {
+            if (!paths_pending())
+                return;
+
+            // Plugins accept path changes and commit them after loading within the process()
+            // call, so silent blocks are processed until all accepted paths are committed
+            size_t block    = lsp_min(nBlockSize, size_t(OFFLINE_LOAD_BLOCK_SIZE));
+            for (size_t waited = 0; ; )
+            {
+                process(block);
+                if (paths_loading())
+                {
+                    if (waited >= OFFLINE_LOAD_TIMEOUT)
+                    {
+                        lsp_warn("Timeout waiting for resources to be loaded");
+                        break;
+                    }
+                    ipc::Thread::sleep(OFFLINE_LOAD_POLL);
+                    waited         += OFFLINE_LOAD_POLL;
+                    continue;
+                }
+
+                // Let the plugin commit results of the tasks completed by the executor
+                if (!flush_executor())
+                    break;
+                process(block);
+                if (!paths_loading())
+                    break;
+            }
+
+            // Drop the state left by silent blocks but keep the loaded resources
+            pPlugin->deactivate();
+            for (size_t i=0, n=vAudioOut.size(); i<n; ++i)
+            {
+                offline::AudioPort *p = vAudioOut.uget(i);
+                dsp::fill_zero(p->data(), p->size());
+            }
+            plug::position_t::init(&sPosition);
+            sPosition.sampleRate    = pPlugin->get_sample_rate();
+            pPlugin->set_position(&sPosition);
+            pPlugin->activate();
+            bUpdateSettings         = true;
+        }
+
+        inline void Wrapper::process(size_t samples)
+        {
+            // Pre-process ports
+            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+            {
+                offline::Port *port = vAllPorts.uget(i);
+                if (port->pre_process(samples))
+                {
+                    lsp_trace("port changed: %s", port->metadata()->id);
+                    bUpdateSettings = true;
+                }
+            }
+
+            // Check that input parameters have changed
+            if (bUpdateSettings)
+            {
+                lsp_trace("updating settings");
+                pPlugin->update_settings();
+                bUpdateSettings = false;
+            }
+
+            // Call the main processing unit
+            pPlugin->process(samples);
+
+            // Post-process ports
+            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+            {
+                offline::Port *port = vAllPorts.uget(i);
+                port->post_process(samples);
+            }
+
+            // Advance the position
+            sPosition.frame        += samples;
+        }
+
+        inline const meta::package_t *Wrapper::package() const
+        {
+            return pPackage;
+        }
+
+        inline ipc::IExecutor *Wrapper::executor()
+        {
+            lsp_trace("executor = %p", reinterpret_cast<void *>(pExecutor));
+            if (pExecutor != NULL)
+                return pExecutor;
+
+            lsp_trace("Creating native executor service");
+            ipc::NativeExecutor *exec = new ipc::NativeExecutor();
+            if (exec == NULL)
+                return NULL;
+            if (exec->start() != STATUS_OK)
+            {
+                delete exec;
+                return NULL;
+            }
+            return pExecutor = exec;
+        }
+
+        inline core::KVTStorage *Wrapper::kvt_lock()
+        {
+            return (sKVTMutex.lock()) ? &sKVT : NULL;
+        }
+
+        inline core::KVTStorage *Wrapper::kvt_trylock()
+        {
+            return (sKVTMutex.try_lock()) ? &sKVT : NULL;
+        }
+
+        inline bool Wrapper::kvt_release()
+        {
+            return sKVTMutex.unlock();
+        }
+
+        inline offline::Port *Wrapper::port_by_id(const char *id)
+        {
+            for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+            {
+                offline::Port *p = vAllPorts.uget(i);
+                const meta::port_t *meta = p->metadata();
+                if ((meta != NULL) && (!strcmp(meta->id, id)))
+                    return p;
+            }
+
+            return NULL;
+        }
+
+        inline status_t Wrapper::import_settings(const char *file)
+        {
+            io::Path path;
+            status_t res = path.set(file);
+            if (res != STATUS_OK)
+                return res;
+
+            return import_settings(&path);
+        }
+
+        inline status_t Wrapper::import_settings(const io::Path *file)
+        {
+            // Relative paths stored in the file are resolved against its directory
+            io::Path base;
+            const io::Path *xbase = (file->get_parent(&base) == STATUS_OK) ? &base : NULL;
+
+            config::PullParser parser;
+            status_t res = parser.open(file);
+            if (res == STATUS_OK)
+                res = import_settings(&parser, xbase);
+            status_t res2 = parser.close();
+            return (res == STATUS_OK) ? res2 : res;
+        }
+
+        inline status_t Wrapper::import_settings(config::PullParser *parser, const io::Path *base)
+        {
+            status_t res;
+            config::param_t param;
+            core::KVTStorage *kvt = kvt_lock();
+            if (kvt != NULL)
+                kvt->begin_batch();
+
+            while ((res = parser->next(&param)) == STATUS_OK)
+            {
+                if ((param.name.starts_with('/')) && (kvt != NULL)) // KVT
+                {
+                    core::kvt_param_t kp;
+
+                    switch (param.type())
+                    {
+                        case config::SF_TYPE_I32:
+                            kp.type         = core::KVT_INT32;
+                            kp.i32          = param.v.i32;
+                            break;
+                        case config::SF_TYPE_U32:
+                            kp.type         = core::KVT_UINT32;
+                            kp.u32          = param.v.u32;
+                            break;
+                        case config::SF_TYPE_I64:
+                            kp.type         = core::KVT_INT64;
+                            kp.i64          = param.v.i64;
+                            break;
+                        case config::SF_TYPE_U64:
+                            kp.type         = core::KVT_UINT64;
+                            kp.u64          = param.v.u64;
+                            break;
+                        case config::SF_TYPE_F32:
+                            kp.type         = core::KVT_FLOAT32;
+                            kp.f32          = param.v.f32;
+                            break;
+                        case config::SF_TYPE_F64:
+                            kp.type         = core::KVT_FLOAT64;
+                            kp.f64          = param.v.f64;
+                            break;
+                        case config::SF_TYPE_BOOL:
+                            kp.type         = core::KVT_FLOAT32;
+                            kp.f32          = (param.v.bval) ? 1.0f : 0.0f;
+                            break;
+                        case config::SF_TYPE_STR:
+                            kp.type         = core::KVT_STRING;
+                            kp.str          = param.v.str;
+                            break;
+                        case config::SF_TYPE_BLOB:
+                            kp.type         = core::KVT_BLOB;
+                            kp.blob.size    = param.v.blob.length;
+                            kp.blob.ctype   = param.v.blob.ctype;
+                            kp.blob.data    = NULL;
+                            if (param.v.blob.data != NULL)
+                            {
+                                // Allocate memory
+                                size_t src_left = strlen(param.v.blob.data);
+                                size_t dst_left = 0x10 + param.v.blob.length;
+                                void *blob      = ::malloc(dst_left);
+                                if (blob != NULL)
+                                {
+                                    kp.blob.data    = blob;
+
+                                    // Decode
+                                    size_t n = dsp::base64_dec(blob, &dst_left, param.v.blob.data, &src_left);
+                                    if ((n != param.v.blob.length) || (src_left != 0))
+                                    {
+                                        ::free(blob);
+                                        kp.type         = core::KVT_ANY;
+                                        kp.blob.data    = NULL;
+                                    }
+                                }
+                                else
+                                    kp.type         = core::KVT_ANY;
+                            }
+                            break;
+                        default:
+                            kp.type         = core::KVT_ANY;
+                            break;
+                    }
+
+                    if (kp.type != core::KVT_ANY)
+                    {
+                        const char *id = param.name.get_utf8();
+                        kvt->put(id, &kp, core::KVT_RX);
+                    }
+
+                    // Free previously allocated data
+                    if ((kp.type == core::KVT_BLOB) && (kp.blob.data != NULL))
+                        free(const_cast<void *>(kp.blob.data));
+                }
+                else
+                {
+                    for (size_t i=0, n=vAllPorts.size(); i<n; ++i)
+                    {
+                        offline::Port *p = vAllPorts.uget(i);
+                        if (p == NULL)
+                            continue;
+                        const meta::port_t *meta = p->metadata();
+                        if ((meta != NULL) && (param.name.equals_ascii(meta->id)))
+                        {
+                            set_port_value(p, &param, plug::PF_STATE_IMPORT, base);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // Release KVT
+            if (kvt != NULL)
+            {
+                kvt->end_batch();
+                kvt->gc();
+                kvt_release();
+            }
+
+            return (res == STATUS_EOF) ? STATUS_OK : res;
+        }
+
+        inline bool Wrapper::set_port_value(offline::Port *port, const config::param_t *param, size_t flags, const io::Path *base)
+        {
+            // Get metadata
+            const meta::port_t *p = (port != NULL) ? port->metadata() : NULL;
+            if (p == NULL)
+                return false;
+
+            // Check that it's a control port
+            if (!meta::is_in_port(p))
+                return false;
+
+            // Apply changes
+            switch (p->role)
+            {
+                case meta::R_PORT_SET:
+                case meta::R_CONTROL:
+                {
+                    if (meta::is_discrete_unit(p->unit))
+                    {
+                        if (meta::is_bool_unit(p->unit))
+                            port->update_value((param->to_bool()) ? 1.0f : 0.0f);
+                        else
+                            port->update_value(param->to_int());
+                    }
+                    else
+                    {
+                        float v = param->to_float();
+
+                        // Decode decibels to values
+                        if ((meta::is_decibel_unit(p->unit)) && (param->is_decibel()))
+                        {
+                            if ((p->unit == meta::U_GAIN_AMP) || (p->unit == meta::U_GAIN_POW))
+                            {
+                                if (v < -250.0f)
+                                    v       = 0.0f;
+                                else if (v > 250.0f)
+                                    v       = (p->unit == meta::U_GAIN_AMP) ? dspu::db_to_gain(250.0f) : dspu::db_to_power(250.0f);
+                                else
+                                    v       = (p->unit == meta::U_GAIN_AMP) ? dspu::db_to_gain(v) : dspu::db_to_power(v);
+                            }
+                        }
+
+                        port->update_value(v);
+                    }
+                    break;
+                }
+                case meta::R_PATH:
+                {
+                    // Check type of argument
+                    if (!param->is_string())
+                        return false;
+
+                    const char *value = param->v.str;
+                    size_t len      = ::strlen(value);
+                    io::Path path;
+
+                    if (core::parse_relative_path(&path, base, value, len))
+                    {
+                        // Update value and it's length
+                        value   = path.as_utf8();
+                        len     = strlen(value);
+                    }
+
+                    path_t *bpath = (meta::is_path_port(port->metadata())) ? port->buffer<path_t>() : NULL;
+                    if (bpath != NULL)
+                        bpath->submit(value, flags);
+                    break;
+                }
+                default:
+                    return false;
+            }
+            return true;
+        }
+
+        inline size_t Wrapper::block_size() const
+        {
+            return nBlockSize;
+        }
+
+        inline size_t Wrapper::audio_inputs() const
+        {
+            return vAudioIn.size();
+        }
+
+        inline size_t Wrapper::audio_outputs() const
+        {
+            return vAudioOut.size();
+        }
+
+        inline float *Wrapper::input_buffer(size_t index)
+        {
+            offline::AudioPort *p = vAudioIn.get(index);
+            return (p != NULL) ? p->data() : NULL;
+        }
+
+        inline float *Wrapper::output_buffer(size_t index)
+        {
+            offline::AudioPort *p = vAudioOut.get(index);
+            return (p != NULL) ? p->data() : NULL;
+        }
+    } /* namespace offline */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_IMPL_WRAPPER_H_ */
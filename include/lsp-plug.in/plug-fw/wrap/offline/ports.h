@@ -0,0 +1,467 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 23 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_PORTS_H_
+#define LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_PORTS_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/plug-fw/meta/types.h>
+#include <lsp-plug.in/plug-fw/meta/func.h>
+#include <lsp-plug.in/plug-fw/plug.h>
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#include <lsp-plug.in/plug-fw/wrap/offline/types.h>
+
+namespace lsp
+{
+    namespace offline
+    {
+        class Wrapper;
+
+        class Port: public plug::IPort
+        {
+            protected:
+                Wrapper         *pWrapper;
+
+            public:
+                explicit Port(const meta::port_t *meta, Wrapper *w): IPort(meta)
+                {
+                    pWrapper        = w;
+                }
+
+                virtual ~Port()
+                {
+                    pWrapper        = NULL;
+                }
+
+            public:
+                virtual int init()
+                {
+                    return STATUS_OK;
+                }
+
+                virtual void destroy()
+                {
+                }
+
+                virtual void update_value(float value)
+                {
+                    set_value(value);
+                }
+        };
+
+        class PortGroup: public Port
+        {
+            private:
+                float                   nCurrRow;
+                size_t                  nCols;
+                size_t                  nRows;
+
+            public:
+                explicit PortGroup(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
+                {
+                    nCurrRow            = meta->start;
+                    nCols               = meta::port_list_size(meta->members);
+                    nRows               = meta::list_size(meta->items);
+                }
+
+                virtual ~PortGroup()
+                {
+                    nCurrRow            = 0.0f;
+                    nCols               = 0;
+                    nRows               = 0;
+                }
+
+            public:
+                virtual void set_value(float value)
+                {
+                    int32_t v = value;
+                    if ((v >= 0) && (v < ssize_t(nRows)))
+                        nCurrRow        = v;
+                }
+
+                virtual float value()
+                {
+                    return nCurrRow;
+                }
+
+            public:
+                inline size_t rows() const      { return nRows; }
+                inline size_t cols() const      { return nCols; }
+                inline size_t curr_row() const  { return nCurrRow; }
+        };
+
+        class AudioPort: public Port
+        {
+            private:
+                float          *pBuffer;            // Audio buffer of the block size
+                uint8_t        *pData;              // Allocated data
+                size_t          nBufSize;           // Size of buffer in samples
+
+            public:
+                explicit AudioPort(const meta::port_t *meta, Wrapper *w, size_t size) : Port(meta, w)
+                {
+                    pBuffer     = NULL;
+                    pData       = NULL;
+                    nBufSize    = size;
+                }
+
+                virtual ~AudioPort()
+                {
+                    pBuffer     = NULL;
+                    pData       = NULL;
+                    nBufSize    = 0;
+                }
+
+                virtual int init()
+                {
+                    pBuffer     = alloc_aligned<float>(pData, nBufSize, DEFAULT_ALIGN);
+                    if (pBuffer == NULL)
+                        return STATUS_NO_MEM;
+
+                    dsp::fill_zero(pBuffer, nBufSize);
+                    return STATUS_OK;
+                }
+
+                virtual void destroy()
+                {
+                    if (pData == NULL)
+                        return;
+
+                    free_aligned(pData);
+                    pBuffer     = NULL;
+                    pData       = NULL;
+                }
+
+            public:
+                virtual void *buffer()
+                {
+                    return pBuffer;
+                }
+
+                virtual void post_process(size_t samples)
+                {
+                    if (meta::is_out_port(pMetadata))
+                        dsp::sanitize1(pBuffer, samples);
+                }
+
+            public:
+                inline float   *data()          { return pBuffer;   }
+                inline size_t   size() const    { return nBufSize;  }
+        };
+
+        class MidiPort: public Port
+        {
+            private:
+                plug::midi_t   *pMidi;
+
+            public:
+                explicit MidiPort(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
+                {
+                    pMidi       = NULL;
+                }
+
+                virtual ~MidiPort()
+                {
+                    pMidi       = NULL;
+                }
+
+                virtual int init()
+                {
+                    pMidi       = static_cast<plug::midi_t *>(::malloc(sizeof(plug::midi_t)));
+                    if (pMidi == NULL)
+                        return STATUS_NO_MEM;
+
+                    pMidi->clear();
+                    return STATUS_OK;
+                }
+
+                virtual void destroy()
+                {
+                    if (pMidi == NULL)
+                        return;
+
+                    ::free(pMidi);
+                    pMidi       = NULL;
+                }
+
+            public:
+                virtual void *buffer()
+                {
+                    return pMidi;
+                }
+
+                virtual void post_process(size_t samples)
+                {
+                    // There is no MIDI sink in the offline mode, just drop events
+                    pMidi->clear();
+                }
+        };
+
+        class ControlPort: public Port
+        {
+            private:
+                float       fNewValue;
+                float       fCurrValue;
+
+            public:
+                explicit ControlPort(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
+                {
+                    fNewValue   = meta->start;
+                    fCurrValue  = meta->start;
+                }
+
+                virtual ~ControlPort()
+                {
+                    fNewValue   = pMetadata->start;
+                    fCurrValue  = pMetadata->start;
+                };
+
+            public:
+                virtual bool pre_process(size_t samples)
+                {
+                    if (fNewValue == fCurrValue)
+                        return false;
+
+                    fCurrValue   = fNewValue;
+                    return true;
+                }
+
+                virtual float value()
+                {
+                    return fCurrValue;
+                }
+
+                virtual void update_value(float value)
+                {
+                    fNewValue   = meta::limit_value(pMetadata, value);
+                }
+        };
+
+        class MeterPort: public Port
+        {
+            private:
+                float       fValue;
+
+            public:
+                explicit MeterPort(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
+                {
+                    fValue      = meta->start;
+                }
+
+                virtual ~MeterPort()
+                {
+                    fValue      = pMetadata->start;
+                };
+
+            public:
+                virtual float value()
+                {
+                    return fValue;
+                }
+
+                virtual void set_value(float value)
+                {
+                    fValue      = meta::limit_value(pMetadata, value);
+                }
+        };
+
+        class MeshPort: public Port
+        {
+            private:
+                plug::mesh_t       *pMesh;
+
+            public:
+                explicit MeshPort(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
+                {
+                    pMesh   = NULL;
+                }
+
+                virtual ~MeshPort()
+                {
+                    pMesh   = NULL;
+                }
+
+                virtual int init()
+                {
+                    pMesh   = plug::mesh_t::create(pMetadata->step, pMetadata->start);
+                    return (pMesh == NULL) ? STATUS_NO_MEM : STATUS_OK;
+                }
+
+                virtual void destroy()
+                {
+                    if (pMesh == NULL)
+                        return;
+
+                    plug::mesh_t::destroy(pMesh);
+                    pMesh = NULL;
+                }
+
+            public:
+                virtual void *buffer()
+                {
+                    return pMesh;
+                }
+        };
+
+        class StreamPort: public Port
+        {
+            private:
+                plug::stream_t     *pStream;
+
+            public:
+                explicit StreamPort(const meta::port_t *meta, Wrapper *w): Port(meta, w)
+                {
+                    pStream     = NULL;
+                }
+
+                virtual ~StreamPort()
+                {
+                    pStream     = NULL;
+                }
+
+            public:
+                virtual void *buffer()
+                {
+                    return pStream;
+                }
+
+                virtual int init()
+                {
+                    pStream = plug::stream_t::create(pMetadata->min, pMetadata->max, pMetadata->start);
+                    return (pStream == NULL) ? STATUS_NO_MEM : STATUS_OK;
+                }
+
+                virtual void destroy()
+                {
+                    plug::stream_t::destroy(pStream);
+                    pStream     = NULL;
+                }
+        };
+
+        class FrameBufferPort: public Port
+        {
+            private:
+                plug::frame_buffer_t        sFB;
+
+            public:
+                explicit FrameBufferPort(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
+                {
+                }
+
+                virtual ~FrameBufferPort()
+                {
+                }
+
+                virtual int init()
+                {
+                    return sFB.init(pMetadata->start, pMetadata->step);
+                }
+
+                virtual void destroy()
+                {
+                    sFB.destroy();
+                }
+
+            public:
+                virtual void *buffer()
+                {
+                    return &sFB;
+                }
+        };
+
+        class OscPort: public Port
+        {
+            private:
+                plug::osc_buffer_t     *pFB;
+
+            public:
+                explicit OscPort(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
+                {
+                    pFB     = NULL;
+                }
+
+                virtual ~OscPort()
+                {
+                }
+
+                virtual int init()
+                {
+                    pFB = plug::osc_buffer_t::create(OSC_BUFFER_MAX);
+                    return (pFB == NULL) ? STATUS_NO_MEM : STATUS_OK;
+                }
+
+                virtual void destroy()
+                {
+                    if (pFB == NULL)
+                        return;
+
+                    plug::osc_buffer_t::destroy(pFB);
+                    pFB     = NULL;
+                }
+
+                virtual void post_process(size_t samples)
+                {
+                    // There is no OSC consumer in the offline mode, just drop messages
+                    if ((pFB != NULL) && (meta::is_out_port(pMetadata)))
+                        pFB->clear();
+                }
+
+            public:
+                virtual void *buffer()
+                {
+                    return pFB;
+                }
+        };
+
+        class PathPort: public Port
+        {
+            private:
+                offline::path_t     sPath;
+
+            public:
+                explicit PathPort(const meta::port_t *meta, Wrapper *w) : Port(meta, w)
+                {
+                    sPath.init();
+                }
+
+                virtual ~PathPort()
+                {
+                }
+
+            public:
+                virtual void *buffer()
+                {
+                    return static_cast<plug::path_t *>(&sPath);
+                }
+
+                virtual bool pre_process(size_t samples)
+                {
+                    return sPath.pending();
+                }
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_PORTS_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 23 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_TYPES_H_
+#define LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_TYPES_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/plug-fw/const.h>
+#include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/meta/types.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#define OFFLINE_BLOCK_SIZE_MIN          0x100
+#define OFFLINE_BLOCK_SIZE_DFL          0x10000
+#define OFFLINE_BLOCK_SIZE_MAX          0x100000
+#define OFFLINE_LOAD_BLOCK_SIZE         0x400       /* Size of silent blocks processed while resources are loading */
+#define OFFLINE_LOAD_POLL               10          /* Period of polling the state of loading, ms */
+#define OFFLINE_LOAD_TIMEOUT            60000       /* Maximum time to wait for resources, ms */
+
+namespace lsp
+{
+    namespace offline
+    {
+        /**
+         * Path port data. The offline wrapper accesses all ports from the single
+         * worker thread that owns the plugin instance, so no synchronization is required
+         */
+        typedef struct path_t: public plug::path_t
+        {
+            enum flags_t
+            {
+                F_PENDING       = 1 << 0,
+                F_ACCEPTED      = 1 << 1
+            };
+
+            size_t      nFlags;
+            size_t      nXFlags;
+
+            char        sPath[PATH_MAX];
+
+            virtual void init()
+            {
+                nFlags          = 0;
+                nXFlags         = 0;
+                sPath[0]        = '\0';
+            }
+
+            virtual const char *path() const
+            {
+                return sPath;
+            }
+
+            virtual size_t flags() const
+            {
+                return nXFlags;
+            }
+
+            virtual void accept()
+            {
+                if (nFlags & F_PENDING)
+                    nFlags     |= F_ACCEPTED;
+            }
+
+            virtual void commit()
+            {
+                if (nFlags & (F_PENDING | F_ACCEPTED))
+                    nFlags      = 0;
+            }
+
+            virtual bool pending()
+            {
+                if (nFlags & F_PENDING)
+                    return !(nFlags & F_ACCEPTED);
+                return false;
+            }
+
+            virtual bool accepted()
+            {
+                return nFlags & F_ACCEPTED;
+            }
+
+            void submit(const char *path, size_t flags)
+            {
+                ::strncpy(sPath, path, PATH_MAX);
+                sPath[PATH_MAX-1]   = '\0';
+                nFlags              = F_PENDING;
+                nXFlags             = flags;
+            }
+
+        } path_t;
+    }
+}
+
+#endif /* LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_TYPES_H_ */
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 23 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_WRAPPER_H_
+#define LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_WRAPPER_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/meta/func.h>
+#include <lsp-plug.in/plug-fw/meta/manifest.h>
+#include <lsp-plug.in/plug-fw/core/config.h>
+#include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/ipc/IExecutor.h>
+#include <lsp-plug.in/ipc/NativeExecutor.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/dsp-units/units.h>
+
+namespace lsp
+{
+    namespace offline
+    {
+        class Port;
+        class AudioPort;
+
+        /**
+         * Wrapper for the plugin module that processes audio data supplied by the caller
+         * instead of the audio server. The wrapper and the plugin are not thread-safe and
+         * should be used by the single thread, parallel processing is achieved by creating
+         * one wrapper and one plugin instance per each thread.
+         */
+        class Wrapper: public plug::IWrapper
+        {
+            private:
+                Wrapper(const Wrapper &);
+                Wrapper & operator = (const Wrapper &);
+
+            private:
+                /**
+                 * Empty task: the completion of the task means that all tasks
+                 * submitted to the executor before it have been completed
+                 */
+                class FlushTask: public ipc::ITask
+                {
+                    public:
+                        virtual status_t    run()   { return STATUS_OK; }
+                };
+
+            private:
+                size_t                          nBlockSize;         // Maximum number of samples per process() call
+                bool                            bUpdateSettings;    // Plugin settings are required to be updated
+                ipc::IExecutor                 *pExecutor;          // Off-line task executor
+                core::KVTStorage                sKVT;               // Key-value tree
+                ipc::Mutex                      sKVTMutex;          // Key-value tree mutex
+
+                lltl::parray<offline::Port>     vAllPorts;          // All ports
+                lltl::parray<offline::AudioPort> vAudioIn;          // Audio input ports
+                lltl::parray<offline::AudioPort> vAudioOut;         // Audio output ports
+                lltl::parray<meta::port_t>      vGenMetadata;       // Generated metadata for virtual ports
+
+                meta::package_t                *pPackage;           // Package descriptor
+
+            protected:
+                void            create_port(lltl::parray<plug::IPort> *plugin_ports, const meta::port_t *port, const char *postfix);
+                status_t        import_settings(config::PullParser *parser, const io::Path *base);
+                bool            paths_pending();
+                bool            paths_loading();
+                bool            flush_executor();
+                void            wait_resources();
+
+            protected:
+                static bool     set_port_value(offline::Port *port, const config::param_t *param, size_t flags, const io::Path *base);
+
+            public:
+                explicit Wrapper(plug::Module *plugin, resource::ILoader *loader);
+                virtual ~Wrapper();
+
+                /**
+                 * Initialize wrapper
+                 * @param block_size maximum number of samples passed to the process() call
+                 * @return status of operation
+                 */
+                status_t                            init(size_t block_size);
+                void                                destroy();
+
+            public:
+                virtual ipc::IExecutor             *executor();
+
+                virtual core::KVTStorage           *kvt_lock();
+
+                virtual core::KVTStorage           *kvt_trylock();
+
+                virtual bool                        kvt_release();
+
+                virtual const meta::package_t      *package() const;
+
+            public:
+                inline size_t                       block_size() const;
+                inline size_t                       audio_inputs() const;
+                inline size_t                       audio_outputs() const;
+                inline float                       *input_buffer(size_t index);
+                inline float                       *output_buffer(size_t index);
+
+                offline::Port                      *port_by_id(const char *id);
+
+                status_t                            import_settings(const char *path);
+                status_t                            import_settings(const io::Path *path);
+
+                /**
+                 * Start processing of the new stream: update the sample rate and reset
+                 * the internal state of the plugin by deactivating and activating it.
+                 * If path ports have pending changes, the method waits until the plugin
+                 * loads the referenced resources, so the first block is rendered with them
+                 * @param sample_rate sample rate of the stream
+                 */
+                void                                start(size_t sample_rate);
+
+                /**
+                 * Process the block of audio data stored in the input buffers,
+                 * the result is stored in the output buffers
+                 * @param samples number of samples to process, should not be greater than block size
+                 */
+                void                                process(size_t samples);
+        };
+    } /* namespace offline */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_PLUG_FW_WRAP_OFFLINE_WRAPPER_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 26 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_PLUG_FW_WRAP_RASTER_CANVAS_H_
+#define LSP_PLUG_IN_PLUG_FW_WRAP_RASTER_CANVAS_H_
+
+#include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/plug-fw/plug.h>
+
+namespace lsp
+{
+    namespace wrap
+    {
+        /**
+         * Self-contained software rasterizer for the inline display. Shapes are converted
+         * into edges which accumulate the signed area covered in each pixel, then each row
+         * of the shape's bounding box is resolved into the coverage and composited into the
+         * premultiplied ARGB32 buffer compatible with the cairo image surface.
+         */
+        class RasterCanvas: public plug::ICanvas
+        {
+            private:
+                RasterCanvas & operator = (const RasterCanvas &);
+                RasterCanvas(const RasterCanvas &);
+
+            protected:
+                typedef struct paint_t
+                {
+                    float       vColor[4];      // Premultiplied A, R, G, B at the center, 0..255
+                    float       vDelta[4];      // Difference between premultiplied color at the radius and the center
+                    float       fX, fY;         // Center of the radial gradient
+                    float       fKR;            // Inverse radius of the radial gradient
+                    bool        bGradient;      // Radial gradient flag
+                } paint_t;
+
+            protected:
+                uint32_t       *pPixels;        // Premultiplied ARGB32 pixels
+                float          *vAccum;         // Accumulated signed area, (width + 2) items per row
+                float          *vCoverage;      // Coverage of the row being composited
+                uint8_t        *pData;          // Allocated data
+                size_t          nAccStride;     // Number of items per row of the accumulation buffer
+                ssize_t         nMinX;          // Bounding box of the accumulated shape
+                ssize_t         nMinY;
+                ssize_t         nMaxX;
+                ssize_t         nMaxY;
+                paint_t         sPaint;         // Current color
+                float           fLineWidth;     // Current line width
+                bool            bAntiAliasing;  // Anti-aliasing flag
+                bool            bLocked;        // Size update lock
+
+            protected:
+                static void     set_paint(paint_t *p, float r, float g, float b, float a);
+                static void     set_paint(paint_t *p, const Color &c);
+
+                void            destroy_data();
+                void            reset_bbox();
+                void            accumulate(float x0, float y0, float x1, float y1);
+                void            add_edge(float x0, float y0, float x1, float y1);
+                void            add_triangle(float x0, float y0, float x1, float y1, float x2, float y2);
+                void            add_polygon(const float *x, const float *y, size_t count);
+                void            add_stroke(const float *x, const float *y, size_t count);
+                void            add_circle(float x, float y, float r);
+                void            composite(uint32_t *dst, const float *cov, const paint_t *p, ssize_t x, ssize_t y, size_t count);
+                void            fill(const paint_t *p);
+
+            public:
+                explicit RasterCanvas();
+                virtual ~RasterCanvas();
+
+            public:
+                virtual bool init(size_t width, size_t height);
+                virtual void destroy();
+                virtual void set_color(float r, float g, float b, float a=1.0f);
+                virtual void paint();
+                virtual void set_line_width(float w);
+                virtual void line(float x1, float y1, float x2, float y2);
+                virtual void draw_poly(float *x, float *y, size_t count, const Color &stroke, const Color &fill);
+                virtual bool set_anti_aliasing(bool enable);
+                virtual void draw_lines(float *x, float *y, size_t count);
+                virtual void circle(ssize_t x, ssize_t y, ssize_t r);
+                virtual void radial_gradient(ssize_t x, ssize_t y, const Color &c1, const Color &c2, ssize_t r);
+
+                virtual void draw_alpha(ICanvas *s, float x, float y, float sx, float sy, float a);
+
+                virtual plug::canvas_data_t *data();
+                virtual void *row(size_t row);
+                virtual void *start_direct();
+                virtual void end_direct();
+                virtual void sync();
+        };
+    } /* namespace wrap */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_PLUG_FW_WRAP_RASTER_CANVAS_H_ */
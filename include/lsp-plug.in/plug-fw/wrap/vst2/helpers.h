@@ -36,40 +36,14 @@ namespace lsp
 {
     namespace vst2
     {
-        inline plug::mesh_t *create_mesh(const meta::port_t *meta)
+        inline plug::mesh_t *create_mesh(const meta::port_t *meta, bool view = false)
         {
-            size_t buffers      = meta->step;
-            size_t buf_size     = meta->start * sizeof(float);
-            size_t mesh_size    = sizeof(plug::mesh_t) + sizeof(float *) * buffers;
-
-            // Align values to 64-byte boundaries
-            buf_size            = align_size(buf_size, 0x40);
-            mesh_size           = align_size(mesh_size, 0x40);
-
-            // Allocate pointer
-            uint8_t *ptr        = new uint8_t[mesh_size + buf_size * buffers];
-            if (ptr == NULL)
-                return NULL;
-
-            // Initialize references
-            plug::mesh_t *mesh  = reinterpret_cast<plug::mesh_t *>(ptr);
-            mesh->nState        = plug::M_EMPTY;
-            mesh->nBuffers      = 0;
-            mesh->nItems        = 0;
-            ptr                += mesh_size;
-            for (size_t i=0; i<buffers; ++i)
-            {
-                mesh->pvData[i]     = reinterpret_cast<float *>(ptr);
-                ptr                += buf_size;
-            }
-
-            return mesh;
+            return plug::mesh_t::create(meta->step, (view) ? 0 : meta->start);
         }
 
         inline void destroy_mesh(plug::mesh_t *mesh)
         {
-            if (mesh != NULL)
-                delete [] reinterpret_cast<uint8_t *>(mesh);
+            plug::mesh_t::destroy(mesh);
         }
 
         inline ssize_t serialize_string(const char *str, uint8_t *buf, size_t len)
@@ -25,6 +25,7 @@
 #include <lsp-plug.in/plug-fw/version.h>
 #include <lsp-plug.in/plug-fw/wrap/vst2/ui_wrapper.h>
 #include <lsp-plug.in/plug-fw/wrap/vst2/ui_ports.h>
+#include <lsp-plug.in/runtime/system.h>
 
 namespace lsp
 {
@@ -39,6 +40,8 @@ namespace lsp
             sRect.left      = 0;
             sRect.bottom    = 0;
             sRect.right     = 0;
+            nFeedbackTime   = 0;
+            nFeedbackTicks  = 0;
         }
 
         UIWrapper::~UIWrapper()
@@ -102,6 +105,7 @@ namespace lsp
 
                     // Add immediately port group to list
                     vPorts.add(upg);
+                    add_sync_port(vp, upg);
 
                     // Add nested ports
                     lsp_trace("  rows = %d", int(upg->rows()));
@@ -135,11 +139,26 @@ namespace lsp
 
             // Add port to the list of UI ports
             if (vup != NULL)
+            {
                 vPorts.add(vup);
 
+                // Path ports can not report changes, they are polled
+                if (port->role == meta::R_PATH)
+                    vPollPorts.add(vup);
+                else
+                    add_sync_port(vp, vup);
+            }
+
             return vup;
         }
 
+        void UIWrapper::add_sync_port(vst2::Port *port, vst2::UIPort *uport)
+        {
+            size_t index = port->index();
+            if (index < vSyncPorts.size())
+                vSyncPorts.array()[index]   = uport;
+        }
+
         status_t UIWrapper::init(void *root_widget)
         {
             status_t res = STATUS_OK;
@@ -149,11 +168,21 @@ namespace lsp
             if (pUI->metadata() == NULL)
                 return STATUS_BAD_STATE;
 
+            // Reserve the synchronization slot for each DSP port
+            for (size_t i=0, n=pWrapper->vPorts.size(); i<n; ++i)
+            {
+                if (!vSyncPorts.add(static_cast<vst2::UIPort *>(NULL)))
+                    return STATUS_NO_MEM;
+            }
+
             // Create list of ports and sort it in ascending order by the identifier
             lsp_trace("Creating ports for %s - %s", meta->name, meta->description);
             for (const meta::port_t *port = meta->ports ; port->id != NULL; ++port)
                 create_port(port, NULL);
 
+            // Force synchronization of all ports at startup
+            pWrapper->sDirtyPorts.mark_all();
+
             // Initialize parent
             if ((res = IWrapper::init(root_widget)) != STATUS_OK)
                 return res;
@@ -212,9 +241,16 @@ namespace lsp
 
         void UIWrapper::destroy()
         {
+            // Nothing is consumed by the UI anymore
+            reset_feedback();
+
             // Call parent instance
             IWrapper::destroy();
 
+            // Forget synchronized ports
+            vSyncPorts.flush();
+            vPollPorts.flush();
+
             // Destroy UI
             if (pUI != NULL)
             {
@@ -247,29 +283,91 @@ namespace lsp
         void UIWrapper::main_iteration()
         {
             transfer_dsp_to_ui();
+            sync_feedback();
             IWrapper::main_iteration();
         }
 
+        void UIWrapper::sync_feedback()
+        {
+            system::time_t ctime;
+            system::get_time(&ctime);
+            ws::timestamp_t ts  = ws::timestamp_t(ctime.seconds) * 1000 + ctime.nanos / 1000000;
+
+            // Report the actual rate of idle calls issued by the host to the plugin
+            ++nFeedbackTicks;
+            if (nFeedbackTime == 0)
+                nFeedbackTime       = ts;
+            else if ((ts - nFeedbackTime) >= UI_FEEDBACK_PERIOD)
+            {
+                report_feedback((nFeedbackTicks * 1000.0f) / (ts - nFeedbackTime));
+                nFeedbackTime       = ts;
+                nFeedbackTicks      = 0;
+            }
+        }
+
+        void UIWrapper::report_feedback(float rate)
+        {
+            plug::Module *plugin    = pWrapper->module();
+            if (plugin != NULL)
+                plugin->ui_feedback()->report(rate);
+
+            // Ports which are not displayed by any visible widget are not consumed
+            for (size_t i=0, n=pWrapper->vPorts.size(); i<n; ++i)
+            {
+                vst2::Port *vp          = pWrapper->vPorts.uget(i);
+                plug::ui_feedback_t *fb = (vp != NULL) ? vp->feedback() : NULL;
+                if (fb == NULL)
+                    continue;
+
+                vst2::UIPort *vup       = vSyncPorts.get(i);
+                fb->report(((vup != NULL) && (vup->visible())) ? rate : 0.0f);
+            }
+        }
+
+        void UIWrapper::reset_feedback()
+        {
+            plug::Module *plugin    = pWrapper->module();
+            if (plugin != NULL)
+                plugin->ui_feedback()->reset();
+
+            for (size_t i=0, n=pWrapper->vPorts.size(); i<n; ++i)
+            {
+                vst2::Port *vp          = pWrapper->vPorts.uget(i);
+                plug::ui_feedback_t *fb = (vp != NULL) ? vp->feedback() : NULL;
+                if (fb != NULL)
+                    fb->reset();
+            }
+        }
+
         const meta::package_t *UIWrapper::package() const
         {
             return pWrapper->package();
         }
 
+        void UIWrapper::sync_port(vst2::UIPort *port)
+        {
+            if (port == NULL)
+                return;
+
+            do {
+                if (port->sync())
+                    port->notify_all();
+            } while (port->sync_again());
+        }
+
         void UIWrapper::transfer_dsp_to_ui()
         {
             // Try to sync position
             IWrapper::position_updated(pWrapper->position());
 
-            // DSP -> UI communication
-            for (size_t i=0, nports=vPorts.size(); i < nports; ++i)
-            {
-                // Get UI port
-                vst2::UIPort *vup   = static_cast<vst2::UIPort *>(vPorts.uget(i));
-                do {
-                    if (vup->sync())
-                        vup->notify_all();
-                } while (vup->sync_again());
-            } // for port_id
+            // DSP -> UI communication of changed ports
+            size_t index;
+            while (pWrapper->sDirtyPorts.next(&index))
+                sync_port(vSyncPorts.get(index));
+
+            // DSP -> UI communication of ports that can not report changes
+            for (size_t i=0, nports=vPollPorts.size(); i < nports; ++i)
+                sync_port(vPollPorts.uget(i));
 
             // Perform KVT synchronization
             core::KVTStorage *kvt = pWrapper->kvt_lock();
@@ -109,6 +109,12 @@ namespace lsp
                 return STATUS_NO_MEM;
             vSortedPorts.qsort(cmp_port_identifiers);
 
+            // Initialize the lists of changed ports
+            if ((res = sDirtyPorts.init(vPorts.size())) != STATUS_OK)
+                return res;
+            if ((res = sChangedPorts.init(vPorts.size())) != STATUS_OK)
+                return res;
+
             // Get buffer size
             ssize_t blk_size = pMaster(pEffect, audioMasterGetBlockSize, 0, 0, 0, 0);
             if (blk_size > 0)
@@ -138,6 +144,7 @@ namespace lsp
 
             // Initialize plugin
             pPlugin->init(this, plugin_ports.array());
+            init_perf_stats();
 
             return STATUS_OK;
         }
@@ -151,6 +158,8 @@ namespace lsp
                 delete pExecutor;
                 pExecutor   = NULL;
             }
+            destroy_state_dump();
+            destroy_perf_stats();
 
             // Destrop plugin
             lsp_trace("destroying plugin");
@@ -169,6 +178,9 @@ namespace lsp
                 delete vPorts[i];
             }
             vPorts.clear();
+            vProcPorts.clear();
+            sDirtyPorts.destroy();
+            sChangedPorts.destroy();
 
             // Cleanup generated metadata
             for (size_t i=0; i<vGenMetadata.size(); ++i)
@@ -282,6 +294,7 @@ namespace lsp
                     // Add immediately to port list
                     lsp_trace("creating port_set port %s", port->id);
                     plugin_ports->add(pg);
+                    pg->bind_dirty(&sDirtyPorts, &sChangedPorts, vPorts.size());
                     vPorts.add(pg);
 
                     // Add nested ports
@@ -317,8 +330,18 @@ namespace lsp
             }
 
             if (vp != NULL)
+            {
+                vp->bind_dirty(&sDirtyPorts, &sChangedPorts, vPorts.size());
                 vPorts.add(vp);
 
+                // Parameters are processed only when changed, meters and audio ports do not need processing
+                if ((port->role != meta::R_CONTROL) &&
+                    (port->role != meta::R_METER) &&
+                    (port->role != meta::R_BYPASS) &&
+                    (port->role != meta::R_AUDIO))
+                    vProcPorts.add(vp);
+            }
+
             return vp;
         }
 
@@ -474,6 +497,7 @@ namespace lsp
             }
 
             // Synchronize position
+            perf_begin();
             sync_position();
 
             // Bind input audio data and sanitize ports
@@ -488,18 +512,25 @@ namespace lsp
                 port->sanitize_before(samples);
             }
 
-            // Process ALL ports for changes
-            size_t n_ports      = vPorts.size();
+            // Process ports changed by host or UI since the last cycle
+            size_t index;
             vst2::Port **v_ports= vPorts.array();
+            while (sChangedPorts.next(&index))
+            {
+                vst2::Port *port = v_ports[index];
+                if (port->pre_process(samples))
+                {
+                    lsp_trace("port changed: %s", port->metadata()->id);
+                    bUpdateSettings = true;
+                }
+            }
 
+            // Process ports that require processing at each cycle
+            size_t n_ports      = vProcPorts.size();
+            v_ports             = vProcPorts.array();
             for (size_t i=0; i<n_ports; ++i)
             {
-                // Get port
                 vst2::Port *port = v_ports[i];
-                if (port == NULL)
-                    continue;
-
-                // Pre-process data in port
                 if (port->pre_process(samples))
                 {
                     lsp_trace("port changed: %s", port->metadata()->id);
@@ -524,7 +555,9 @@ namespace lsp
             }
 
             // Process samples
+            perf_mark(core::PERF_PRE);
             pPlugin->process(samples);
+            perf_mark(core::PERF_PROCESS);
 
             // Sanitize output audio data
             for (size_t i=0, n=vAudioPorts.size(); i<n; ++i)
@@ -547,13 +580,12 @@ namespace lsp
                 }
             }
 
-            // Post-process ALL ports
+            // Post-process ports that require processing at each cycle
             for (size_t i=0; i<n_ports; ++i)
-            {
-                vst2::Port *port = v_ports[i];
-                if (port != NULL)
-                    port->post_process(samples);
-            }
+                v_ports[i]->post_process(samples);
+
+            perf_mark(core::PERF_POST);
+            perf_end(samples);
         }
 
         void Wrapper::process_events(const VstEvents *e)
@@ -1293,6 +1325,7 @@ namespace lsp
 
         void Wrapper::request_state_dump()
         {
+            prepare_state_dump();
             atomic_add(&nDumpReq, 1);
         }
 
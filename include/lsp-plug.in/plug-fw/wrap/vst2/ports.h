@@ -23,6 +23,7 @@
 #define LSP_PLUG_IN_PLUG_FW_WRAP_VST2_PORTS_H_
 
 #include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/plug-fw/core/DirtyBitmap.h>
 #include <lsp-plug.in/plug-fw/meta/func.h>
 #include <lsp-plug.in/plug-fw/meta/types.h>
 #include <lsp-plug.in/plug-fw/plug.h>
@@ -49,8 +50,29 @@ namespace lsp
                 AEffect                *pEffect;
                 audioMasterCallback     hCallback;
                 ssize_t                 nID;
+                core::DirtyBitmap      *pDirty;         // Bitmap of ports changed since the last UI sync
+                core::DirtyBitmap      *pChanged;       // Bitmap of ports changed since the last processing cycle
+                size_t                  nIndex;         // Index of the port in the wrapper
 
             protected:
+                /**
+                 * Notify the UI that the state of the port has changed
+                 */
+                inline void mark_dirty()
+                {
+                    if (pDirty != NULL)
+                        pDirty->mark(nIndex);
+                }
+
+                /**
+                 * Notify the DSP that the port should be pre-processed
+                 */
+                inline void mark_changed()
+                {
+                    if (pChanged != NULL)
+                        pChanged->mark(nIndex);
+                }
+
                 float from_vst(float value)
                 {
     //                lsp_trace("input = %.3f", value);
@@ -101,12 +123,17 @@ namespace lsp
                     pEffect         = effect;
                     hCallback       = callback;
                     nID             = -1;
+                    pDirty          = NULL;
+                    pChanged        = NULL;
+                    nIndex          = size_t(-1);
                 }
                 virtual ~Port()
                 {
                     pEffect         = NULL;
                     hCallback       = NULL;
                     nID             = -1;
+                    pDirty          = NULL;
+                    pChanged        = NULL;
                 }
 
             public:
@@ -114,6 +141,14 @@ namespace lsp
                 inline audioMasterCallback      callback()          { return hCallback;             };
                 inline ssize_t                  id() const          { return nID;                   };
                 inline void                     set_id(ssize_t id)  { nID = id;                     };
+                inline size_t                   index() const       { return nIndex;                };
+
+                inline void                     bind_dirty(core::DirtyBitmap *dirty, core::DirtyBitmap *changed, size_t index)
+                {
+                    pDirty          = dirty;
+                    pChanged        = changed;
+                    nIndex          = index;
+                }
 
                 inline VstIntPtr                masterCallback(VstInt32 opcode, VstInt32 index, VstIntPtr value, void* ptr, float opt)
                 {
@@ -222,6 +257,7 @@ namespace lsp
                     {
                         nCurrRow        = value;
                         atomic_add(&nSID, 1);
+                        mark_dirty();
                     }
                     return sizeof(int32_t);
                 }
@@ -243,6 +279,7 @@ namespace lsp
                     {
                         nCurrRow        = v;
                         atomic_add(&nSID, 1);
+                        mark_dirty();
                     }
 
                     return true;
@@ -372,6 +409,7 @@ namespace lsp
                 {
                     fValue      = meta::limit_value(pMetadata, value);
                     fVstValue   = to_vst(fValue);
+                    mark_changed();
                 }
 
                 virtual bool pre_process(size_t samples)
@@ -400,6 +438,8 @@ namespace lsp
                     fValue          = meta::limit_value(pMetadata, from_vst(value));
                     fVstValue       = value;
                     atomic_add(&nSID, 1);
+                    mark_dirty();
+                    mark_changed();
                 }
 
                 inline float vst_value()
@@ -427,6 +467,7 @@ namespace lsp
                     float value     = BE_TO_CPU(*(reinterpret_cast<const float *>(data)));
                     write_value(value);
                     atomic_add(&nSID, 1);
+                    mark_dirty();
                     return sizeof(float);
                 }
 
@@ -438,6 +479,7 @@ namespace lsp
                     float v         = BE_TO_CPU(*(reinterpret_cast<const float *>(data)));
                     write_value(v);
                     atomic_add(&nSID, 1);
+                    mark_dirty();
                     return true;
                 }
         };
@@ -471,6 +513,7 @@ namespace lsp
                 virtual void set_value(float value)
                 {
                     value       = meta::limit_value(pMetadata, value);
+                    float prev  = fValue;
 
                     if (pMetadata->flags & meta::F_PEAK)
                     {
@@ -482,6 +525,9 @@ namespace lsp
                     }
                     else
                         fValue = value;
+
+                    if (fValue != prev)
+                        mark_dirty();
                 }
 
                 float sync_value()
@@ -515,18 +561,26 @@ namespace lsp
                 {
                     return pMesh;
                 }
+
+                virtual void post_process(size_t samples)
+                {
+                    if ((pMesh != NULL) && (pMesh->containsData()))
+                        mark_dirty();
+                }
         };
 
         class StreamPort: public Port
         {
             private:
                 plug::stream_t     *pStream;
+                uint32_t            nFrameID;
 
             public:
                 explicit StreamPort(const meta::port_t *meta, AEffect *effect, audioMasterCallback callback):
                     Port(meta, effect, callback)
                 {
                     pStream     = plug::stream_t::create(pMetadata->min, pMetadata->max, pMetadata->start);
+                    nFrameID    = 0;
                 }
 
                 virtual ~StreamPort()
@@ -543,18 +597,33 @@ namespace lsp
                 {
                     return pStream;
                 }
+
+                virtual void post_process(size_t samples)
+                {
+                    if (pStream == NULL)
+                        return;
+
+                    uint32_t frame_id   = pStream->frame_id();
+                    if (frame_id == nFrameID)
+                        return;
+
+                    nFrameID    = frame_id;
+                    mark_dirty();
+                }
         };
 
         class FrameBufferPort: public Port
         {
             private:
                 plug::frame_buffer_t    sFB;
+                uint32_t                nRowID;
 
             public:
                 explicit FrameBufferPort(const meta::port_t *meta, AEffect *effect, audioMasterCallback callback):
                     Port(meta, effect, callback)
                 {
                     sFB.init(pMetadata->start, pMetadata->step);
+                    nRowID      = 0;
                 }
 
                 virtual ~FrameBufferPort()
@@ -572,6 +641,16 @@ namespace lsp
                 {
                     sFB.destroy();
                 }
+
+                virtual void post_process(size_t samples)
+                {
+                    uint32_t row_id     = sFB.next_rowid();
+                    if (row_id == nRowID)
+                        return;
+
+                    nRowID      = row_id;
+                    mark_dirty();
+                }
         };
 
         class MidiInputPort: public Port
@@ -915,6 +994,12 @@ namespace lsp
                         pFB     = NULL;
                     }
                 }
+
+                virtual void post_process(size_t samples)
+                {
+                    if ((pFB != NULL) && (meta::is_out_port(pMetadata)) && (pFB->size() > 0))
+                        mark_dirty();
+                }
         };
     } /* namespace vst2 */
 } /* namespace lsp */
@@ -213,7 +213,7 @@ namespace lsp
                 explicit UIMeshPort(const meta::port_t *meta, vst2::Port *port):
                     UIPort(meta, port)
                 {
-                    pMesh       = vst2::create_mesh(meta);
+                    pMesh       = vst2::create_mesh(meta, true);
                 }
 
                 virtual ~UIMeshPort()
@@ -226,17 +226,11 @@ namespace lsp
                 virtual bool sync()
                 {
                     plug::mesh_t *mesh = reinterpret_cast<plug::mesh_t *>(pPort->buffer());
-                    if ((mesh == NULL) || (!mesh->containsData()))
+                    if ((mesh == NULL) || (pMesh == NULL) || (!mesh->consume()))
                         return false;
 
-                    // Copy mesh data
-                    for (size_t i=0; i < mesh->nBuffers; ++i)
-                        dsp::copy_saturated(pMesh->pvData[i], mesh->pvData[i], mesh->nItems);
-                    pMesh->data(mesh->nBuffers, mesh->nItems);
-
-                    // Clean source mesh
-                    mesh->cleanup();
-
+                    // Refer the newest frame without copying
+                    mesh->view(pMesh);
                     return true;
                 }
 
@@ -39,6 +39,10 @@ namespace lsp
                 vst2::Wrapper                      *pWrapper;       // VST Wrapper
                 size_t                              nKeyState;      // State of the keys
                 ERect                               sRect;
+                lltl::parray<vst2::UIPort>          vSyncPorts;     // Ports for synchronization indexed by DSP port index
+                lltl::parray<vst2::UIPort>          vPollPorts;     // Ports which are polled for changes at each iteration
+                ws::timestamp_t                     nFeedbackTime;  // Time of the last UI feedback report
+                size_t                              nFeedbackTicks; // Number of synchronizations since the last report
 
             protected:
                 static status_t slot_ui_resize(tk::Widget *sender, void *ptr, void *data);
@@ -48,6 +52,11 @@ namespace lsp
             protected:
                 void                            transfer_dsp_to_ui();
                 vst2::UIPort                   *create_port(const meta::port_t *port, const char *postfix);
+                void                            add_sync_port(vst2::Port *port, vst2::UIPort *uport);
+                static void                     sync_port(vst2::UIPort *port);
+                void                            sync_feedback();
+                void                            report_feedback(float rate);
+                void                            reset_feedback();
 
             public:
                 explicit UIWrapper(ui::Module *ui, vst2::Wrapper *wrapper);
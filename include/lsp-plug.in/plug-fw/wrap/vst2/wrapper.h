@@ -23,6 +23,7 @@
 #define LSP_PLUG_IN_PLUG_FW_WRAP_VST2_WRAPPER_H_
 
 #include <lsp-plug.in/plug-fw/version.h>
+#include <lsp-plug.in/plug-fw/core/DirtyBitmap.h>
 #include <lsp-plug.in/plug-fw/core/KVTDispatcher.h>
 #include <lsp-plug.in/plug-fw/core/KVTStorage.h>
 #include <lsp-plug.in/plug-fw/meta/types.h>
@@ -66,10 +67,13 @@ namespace lsp
                 lltl::parray<vst2::Port>            vPorts;         // List of all created VST ports
                 lltl::parray<vst2::Port>            vSortedPorts;   // List of all created VST ports ordered by unique id
                 lltl::parray<vst2::Port>            vProxyPorts;    // List of all created VST proxy ports
+                lltl::parray<vst2::Port>            vProcPorts;     // List of ports that require processing at each cycle
                 lltl::parray<meta::port_t>          vGenMetadata;   // Generated metadata
 
                 core::KVTStorage                    sKVT;
                 ipc::Mutex                          sKVTMutex;
+                core::DirtyBitmap                   sDirtyPorts;    // Ports changed since the last UI sync
+                core::DirtyBitmap                   sChangedPorts;  // Ports changed by host or UI since the last processing cycle
 
                 meta::package_t                    *pPackage;
 
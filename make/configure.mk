@@ -40,6 +40,7 @@ TEST                       := 0
 DEBUG                      := 0
 PROFILE                    := 0
 TRACE                      := 0
+ALLOC_COUNTER              := 0
 
 ifeq ($(DEVEL),1)
   X_URL_SUFFIX                = _RW
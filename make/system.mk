@@ -200,13 +200,15 @@ COMMON_VARS = \
 	TEST \
 	DEBUG \
 	PROFILE \
-	TRACE
+	TRACE \
+	ALLOC_COUNTER
 
 .PHONY: sysvars
 
 sysvars:
 	echo "List of available system variables:"
 	echo "  ADD_FEATURES              list of features enabled in the build as an addition to default"
+	echo "  ALLOC_COUNTER             count memory allocations in performance tests of test build"
 	echo "  ARCHITECTURE              target architecture to perform build"
 	echo "  ARCHITECTURE_CFLAGS       compiler flags to specify architecture"
 	echo "  ARCHITECTURE_LDFLAGS      linker flags to specify architecture"
@@ -102,6 +102,9 @@ endif
 ifeq ($(TEST),1)
   CFLAGS_EXT         += -DLSP_TESTING
   CXXFLAGS_EXT       += -DLSP_TESTING
+  ifeq ($(ALLOC_COUNTER),1)
+    CXXFLAGS_EXT       += -DLSP_PTEST_ALLOC_COUNTER
+  endif
 else
   ifneq ($(ARTIFACT_EXPORT_ALL),1)
     CFLAGS_EXT         += -fvisibility=hidden
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 21 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/plug-fw/core/DirtyBitmap.h>
+#include <lsp-plug.in/plug-fw/core/atomic.h>
+#include <lsp-plug.in/common/alloc.h>
+
+namespace lsp
+{
+    namespace core
+    {
+        DirtyBitmap::DirtyBitmap()
+        {
+            nItems      = 0;
+            nWords      = 0;
+            nGroups     = 0;
+            vWords      = NULL;
+            vGroups     = NULL;
+            pData       = NULL;
+
+            nNextGroup  = 0;
+            nGroup      = 0;
+            nGroupBits  = 0;
+            nWord       = 0;
+            nWordBits   = 0;
+        }
+
+        DirtyBitmap::~DirtyBitmap()
+        {
+            destroy();
+        }
+
+        status_t DirtyBitmap::init(size_t items)
+        {
+            size_t words    = (items + WORD_MASK) >> WORD_SHIFT;
+            size_t groups   = (words + WORD_MASK) >> WORD_SHIFT;
+            size_t szof_w   = align_size(sizeof(uint32_t) * words, DEFAULT_ALIGN);
+            size_t szof_g   = align_size(sizeof(uint32_t) * groups, DEFAULT_ALIGN);
+
+            uint8_t *data   = NULL;
+            uint8_t *ptr    = alloc_aligned<uint8_t>(data, lsp_max(szof_w + szof_g, size_t(DEFAULT_ALIGN)));
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            destroy();
+
+            vWords          = reinterpret_cast<uint32_t *>(ptr);
+            ptr            += szof_w;
+            vGroups         = reinterpret_cast<uint32_t *>(ptr);
+
+            for (size_t i=0; i<words; ++i)
+                vWords[i]       = 0;
+            for (size_t i=0; i<groups; ++i)
+                vGroups[i]      = 0;
+
+            nItems          = items;
+            nWords          = words;
+            nGroups         = groups;
+            pData           = data;
+
+            nNextGroup      = 0;
+            nGroup          = 0;
+            nGroupBits      = 0;
+            nWord           = 0;
+            nWordBits       = 0;
+
+            return STATUS_OK;
+        }
+
+        void DirtyBitmap::destroy()
+        {
+            nItems      = 0;
+            nWords      = 0;
+            nGroups     = 0;
+            vWords      = NULL;
+            vGroups     = NULL;
+
+            nNextGroup  = 0;
+            nGroupBits  = 0;
+            nWordBits   = 0;
+
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData       = NULL;
+            }
+        }
+
+        void DirtyBitmap::mark(size_t index)
+        {
+            if (index >= nItems)
+                return;
+
+            // The word should be marked before the group: the consumer takes
+            // the group first and then takes the word
+            size_t word     = index >> WORD_SHIFT;
+            uint32_t prev   = atomic_fetch_or(&vWords[word], uint32_t(1) << (index & WORD_MASK));
+            if (prev == 0)
+                atomic_fetch_or(&vGroups[word >> WORD_SHIFT], uint32_t(1) << (word & WORD_MASK));
+        }
+
+        void DirtyBitmap::mark_all()
+        {
+            for (size_t i=0; i<nWords; ++i)
+            {
+                size_t tail     = nItems - (i << WORD_SHIFT);
+                uint32_t mask   = (tail >= WORD_BITS) ? ~uint32_t(0) : (uint32_t(1) << tail) - 1;
+                uint32_t prev   = atomic_fetch_or(&vWords[i], mask);
+                if (prev == 0)
+                    atomic_fetch_or(&vGroups[i >> WORD_SHIFT], uint32_t(1) << (i & WORD_MASK));
+            }
+        }
+
+        bool DirtyBitmap::next(size_t *index)
+        {
+            while (true)
+            {
+                // Return pending items of the current word
+                if (nWordBits != 0)
+                {
+                    size_t bit      = __builtin_ctz(nWordBits);
+                    nWordBits      &= nWordBits - 1;
+                    *index          = (nWord << WORD_SHIFT) + bit;
+                    return true;
+                }
+
+                // Take the next word of the current group
+                if (nGroupBits != 0)
+                {
+                    size_t bit      = __builtin_ctz(nGroupBits);
+                    nGroupBits     &= nGroupBits - 1;
+                    nWord           = (nGroup << WORD_SHIFT) + bit;
+                    nWordBits       = atomic_exchange(&vWords[nWord], uint32_t(0));
+                    continue;
+                }
+
+                // Take the next group, end the pass if there are no more groups
+                if (nNextGroup >= nGroups)
+                {
+                    nNextGroup      = 0;
+                    return false;
+                }
+
+                nGroup          = nNextGroup++;
+                nGroupBits      = atomic_exchange(&vGroups[nGroup], uint32_t(0));
+            }
+        }
+    }
+}
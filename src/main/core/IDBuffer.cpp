@@ -22,6 +22,8 @@
 #include <lsp-plug.in/plug-fw/core/IDBuffer.h>
 #include <lsp-plug.in/stdlib/stdlib.h>
 #include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
 
 namespace lsp
 {
@@ -68,6 +70,69 @@ namespace lsp
             free(this);
         }
 
+        void IDBuffer::decimate_minmax(size_t min_line, size_t max_line, const float *src, size_t count)
+        {
+            if ((min_line >= lines) || (max_line >= lines) || (count <= 0))
+                return;
+
+            float *vmin     = v[min_line];
+            float *vmax     = v[max_line];
+
+            for (size_t i=0, first=0; i<items; ++i)
+            {
+                // Each item takes at least one sample if there are less samples than items
+                size_t last     = ((i + 1) * count) / items;
+                size_t n        = (last > first) ? last - first : 1;
+                dsp::minmax(&src[first], n, &vmin[i], &vmax[i]);
+                first           = last;
+            }
+        }
+
+        void IDBuffer::decimate_peak(size_t line, const float *src, size_t count, bool hold)
+        {
+            if ((line >= lines) || (count <= 0))
+                return;
+
+            float *dst      = v[line];
+
+            for (size_t i=0, first=0; i<items; ++i)
+            {
+                size_t last     = ((i + 1) * count) / items;
+                size_t n        = (last > first) ? last - first : 1;
+                float peak      = dsp::abs_max(&src[first], n);
+                dst[i]          = ((hold) && (dst[i] > peak)) ? dst[i] : peak;
+                first           = last;
+            }
+        }
+
+        void IDBuffer::resample_log(size_t line, const float *src, size_t count, float f_src, float f_min, float f_max)
+        {
+            if ((line >= lines) || (count <= 0) || (items <= 0) || (f_src <= 0.0f) || (f_min <= 0.0f) || (f_max < f_min))
+                return;
+
+            float *dst      = v[line];
+            float kf        = count / f_src;                                // Frequency to bin index
+            float k         = f_min * kf;                                   // Bin index of the current item
+            float step      = (items > 1) ? expf(logf(f_max / f_min) / (items - 1)) : 1.0f;
+
+            for (size_t i=0; i<items; ++i)
+            {
+                float kn        = k * step;                                 // Bin index of the next item
+                size_t first    = ceilf(k);
+                size_t last     = lsp_min(size_t(ceilf(kn)), count);
+
+                if (last > first)
+                    dst[i]          = dsp::max(&src[first], last - first);  // Bins within [k, kn)
+                else
+                {
+                    size_t j        = k;
+                    dst[i]          = (j + 1 < count) ? src[j] + (src[j + 1] - src[j]) * (k - j) : src[count - 1];
+                }
+
+                k               = kn;
+            }
+        }
+
         void IDBuffer::dump(dspu::IStateDumper *v) const
         {
             v->write("lines", lines);
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 16 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/plug-fw/core/KVTAllocator.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace lsp
+{
+    namespace core
+    {
+        KVTAllocator::KVTAllocator()
+        {
+            for (size_t i=0; i<SIZE_CLASSES; ++i)
+                vFree[i]        = NULL;
+
+            pChunks         = NULL;
+            pHead           = NULL;
+            pTail           = NULL;
+            nChunks         = 0;
+            nLarge          = 0;
+        }
+
+        KVTAllocator::~KVTAllocator()
+        {
+            destroy();
+        }
+
+        void KVTAllocator::destroy()
+        {
+            while (pChunks != NULL)
+            {
+                chunk_t *next   = pChunks->next;
+                ::free(pChunks);
+                pChunks         = next;
+            }
+
+            for (size_t i=0; i<SIZE_CLASSES; ++i)
+                vFree[i]        = NULL;
+
+            pHead           = NULL;
+            pTail           = NULL;
+            nChunks         = 0;
+        }
+
+        size_t KVTAllocator::size_class(size_t size)
+        {
+            return (size > 0) ? (size - 1) / GRANULARITY : 0;
+        }
+
+        void *KVTAllocator::bump_alloc(size_t bytes)
+        {
+            if ((pTail - pHead) < ptrdiff_t(bytes))
+            {
+                // Put the rest of the current chunk to the free list
+                size_t left     = pTail - pHead;
+                if (left >= GRANULARITY)
+                {
+                    block_t *b      = reinterpret_cast<block_t *>(pHead);
+                    size_t sc       = left / GRANULARITY - 1;
+                    b->next         = vFree[sc];
+                    vFree[sc]       = b;
+                }
+
+                // Allocate new chunk
+                chunk_t *chunk  = static_cast<chunk_t *>(::malloc(CHUNK_SIZE));
+                if (chunk == NULL)
+                    return NULL;
+
+                chunk->next     = pChunks;
+                pChunks         = chunk;
+                pHead           = reinterpret_cast<uint8_t *>(chunk) + align_size(sizeof(chunk_t), GRANULARITY);
+                pTail           = reinterpret_cast<uint8_t *>(chunk) + CHUNK_SIZE;
+                ++nChunks;
+            }
+
+            void *ptr       = pHead;
+            pHead          += bytes;
+            return ptr;
+        }
+
+        void *KVTAllocator::alloc(size_t size)
+        {
+            if (size > SMALL_MAX)
+            {
+                void *ptr       = ::malloc(size);
+                if (ptr != NULL)
+                    ++nLarge;
+                return ptr;
+            }
+
+            // Try to obtain the block from the free list first
+            size_t sc       = size_class(size);
+            block_t *b      = vFree[sc];
+            if (b != NULL)
+            {
+                vFree[sc]       = b->next;
+                return b;
+            }
+
+            return bump_alloc((sc + 1) * GRANULARITY);
+        }
+
+        void KVTAllocator::free(void *ptr, size_t size)
+        {
+            if (ptr == NULL)
+                return;
+
+            if (size > SMALL_MAX)
+            {
+                ::free(ptr);
+                --nLarge;
+                return;
+            }
+
+            // Recycle the block
+            size_t sc       = size_class(size);
+            block_t *b      = static_cast<block_t *>(ptr);
+            b->next         = vFree[sc];
+            vFree[sc]       = b;
+        }
+
+        char *KVTAllocator::strdup(const char *s)
+        {
+            size_t len      = ::strlen(s) + 1;
+            char *dst       = static_cast<char *>(alloc(len));
+            if (dst != NULL)
+                ::memcpy(dst, s, len);
+            return dst;
+        }
+
+        void KVTAllocator::free_string(char *s)
+        {
+            if (s != NULL)
+                free(s, ::strlen(s) + 1);
+        }
+    }
+}
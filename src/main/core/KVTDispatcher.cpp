@@ -22,24 +22,65 @@
 #include <lsp-plug.in/plug-fw/const.h>
 #include <lsp-plug.in/plug-fw/core/KVTDispatcher.h>
 #include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/common/atomic.h>
 
 namespace lsp
 {
     namespace core
     {
-        KVTDispatcher::KVTDispatcher(KVTStorage *kvt, ipc::Mutex *mutex)
+        void KVTDispatcher::KVTTxListener::created(KVTStorage *storage, const char *id, const kvt_param_t *param, size_t pending)
+        {
+            if (pending & KVT_TX)
+                pDispatcher->sNotifier.notify();
+        }
+
+        void KVTDispatcher::KVTTxListener::changed(KVTStorage *storage, const char *id, const kvt_param_t *oval, const kvt_param_t *nval, size_t pending)
+        {
+            if (pending & KVT_TX)
+                pDispatcher->sNotifier.notify();
+        }
+
+        void KVTDispatcher::KVTTxListener::removed(KVTStorage *storage, const char *id, const kvt_param_t *param, size_t pending)
+        {
+            if (pending & KVT_TX)
+                pDispatcher->sNotifier.notify();
+        }
+
+        void KVTDispatcher::KVTTxListener::updated(KVTStorage *storage, const char *branch, size_t count, size_t pending)
+        {
+            if (pending & KVT_TX)
+                pDispatcher->sNotifier.notify();
+        }
+
+        KVTDispatcher::KVTDispatcher(KVTStorage *kvt, ipc::Mutex *mutex):
+            sListener(this)
         {
             pRx         = plug::osc_buffer_t::create(OSC_BUFFER_MAX);
             pTx         = plug::osc_buffer_t::create(OSC_BUFFER_MAX);
             pKVT        = kvt;
             pKVTMutex   = mutex;
-            pPacket     = reinterpret_cast<uint8_t *>(::malloc(OSC_PACKET_MAX));
             nClients    = 0;
             nTxRequest  = 0;
+            nTxStalled  = 0;
+            nCoalesce   = 0;
+
+            if (sNotifier.init() != STATUS_OK)
+                lsp_warn("Could not initialize KVT dispatcher notifier");
+
+            // Listen for KVT changes that require transmission
+            pKVTMutex->lock();
+            pKVT->bind(&sListener);
+            pKVTMutex->unlock();
         }
 
         KVTDispatcher::~KVTDispatcher()
         {
+            pKVTMutex->lock();
+            pKVT->unbind(&sListener);
+            pKVTMutex->unlock();
+
+            sNotifier.destroy();
+
             if (pRx != NULL)
             {
                 plug::osc_buffer_t::destroy(pRx);
@@ -50,31 +91,29 @@ namespace lsp
                 plug::osc_buffer_t::destroy(pTx);
                 pTx     = NULL;
             }
-            if (pPacket != NULL)
-            {
-                ::free(pPacket);
-                pPacket = NULL;
-            }
         }
 
         size_t  KVTDispatcher::receive_changes()
         {
             size_t size, changes = 0;
+            const void *data;
 
             while (true)
             {
-                // Fetch the packet
-                status_t res    = pRx->fetch(pPacket, &size, OSC_PACKET_MAX);
+                // Fetch the packet, parse it directly in the buffer
+                status_t res    = pRx->peek_packet(&data, &size);
 
                 switch (res)
                 {
                     case STATUS_OK:
                     {
                         lsp_trace("Received OSC message (%d bytes)", int(size));
-                        osc::dump_packet(pPacket, size);
+                        osc::dump_packet(data, size);
 
                         // Analyze parsing result
-                        if ((res = parse_message(pKVT, pPacket, size, KVT_RX)) != STATUS_OK)
+                        res     = parse_message(pKVT, data, size, KVT_RX);
+                        pRx->release_packet();
+                        if (res != STATUS_OK)
                         {
                             // Skipped message?
                             if (res != STATUS_SKIP)
@@ -84,23 +123,87 @@ namespace lsp
                         break;
                     }
 
-                    case STATUS_OVERFLOW:
-                        ++changes;
-                        lsp_warn("Received too big OSC packet, skipping");
-                        pRx->skip();
-                        break;
-
                     case STATUS_NO_DATA:
                         return changes;
 
                     default:
                         lsp_warn("Received error while deserializing KVT changes: %d", int(res));
+
+                        // Skip the bad record, drop all pending records if it can not be located
+                        if (pRx->release_packet() != STATUS_OK)
+                            pRx->clear();
                         return changes;
 
                 }
             }
         }
 
+        status_t KVTDispatcher::pack_message(tx_packet_t *pkt, const char *kvt_name, const kvt_param_t *p)
+        {
+            status_t res;
+            size_t size, off;
+
+            // The first message is stored as a plain OSC message
+            if (pkt->count <= 0)
+            {
+                if ((res = build_message(kvt_name, p, pkt->data, &size, pkt->avail)) != STATUS_OK)
+                    return res;
+
+                pkt->size       = size;
+                pkt->first      = size;
+                pkt->count      = 1;
+                return STATUS_OK;
+            }
+
+            // Each next message is stored as a bundle element
+            off     = (pkt->count > 1) ?
+                        pkt->size + sizeof(uint32_t) :
+                        OSC_BUNDLE_HEADER + sizeof(uint32_t) + pkt->first + sizeof(uint32_t);
+            if (off >= pkt->avail)
+                return STATUS_OVERFLOW;
+            if ((res = build_message(kvt_name, p, &pkt->data[off], &size, pkt->avail - off)) != STATUS_OK)
+                return res;
+
+            // Convert plain message into bundle if it is the second message
+            if (pkt->count == 1)
+            {
+                ::memmove(&pkt->data[OSC_BUNDLE_HEADER + sizeof(uint32_t)], pkt->data, pkt->first);
+                ::memcpy(pkt->data, "#bundle", 8);
+                uint32_t *tag   = reinterpret_cast<uint32_t *>(&pkt->data[8]);
+                tag[0]          = 0;
+                tag[1]          = CPU_TO_BE(uint32_t(OSC_TIMETAG_IMMEDIATE));
+                *(reinterpret_cast<uint32_t *>(&pkt->data[OSC_BUNDLE_HEADER])) = CPU_TO_BE(uint32_t(pkt->first));
+            }
+
+            *(reinterpret_cast<uint32_t *>(&pkt->data[off - sizeof(uint32_t)])) = CPU_TO_BE(uint32_t(size));
+            pkt->size       = off + size;
+            ++pkt->count;
+
+            return STATUS_OK;
+        }
+
+        status_t KVTDispatcher::flush_packet(tx_packet_t *pkt)
+        {
+            status_t res = STATUS_OK;
+
+            if (pkt->count > 0)
+            {
+                lsp_trace("Transmitting OSC packet of %d messages (%d bytes)", int(pkt->count), int(pkt->size));
+                osc::dump_packet(pkt->data, pkt->size);
+                res     = pTx->commit_packet(pkt->size);
+            }
+            else
+                pTx->cancel_packet();
+
+            pkt->data       = NULL;
+            pkt->avail      = 0;
+            pkt->size       = 0;
+            pkt->first      = 0;
+            pkt->count      = 0;
+
+            return res;
+        }
+
         size_t  KVTDispatcher::transmit_changes()
         {
             status_t res;
@@ -110,69 +213,112 @@ namespace lsp
             if (iter == NULL)
                 return changes;
 
-            const kvt_param_t *p;
-            const char *kvt_name;
-            size_t size;
+            const kvt_param_t *p = NULL;
+            const char *kvt_name = NULL;
+            bool fetch = true;
+            void *data;
+
+            tx_packet_t pkt;
+            pkt.data        = NULL;
+            pkt.avail       = 0;
+            pkt.size        = 0;
+            pkt.first       = 0;
+            pkt.count       = 0;
 
-            while (iter->next() == STATUS_OK)
+            while (true)
             {
-                // Do not transfer private properties
-                if (iter->is_private())
-                    continue;
+                if (fetch)
+                {
+                    if (iter->next() != STATUS_OK)
+                        break;
 
-                // Fetch next change
-                res     = iter->get(&p);
-                if (res == STATUS_NOT_FOUND)
-                    continue;
-                else if (res != STATUS_OK)
-                    break;
+                    // Do not transfer private properties
+                    if (iter->is_private())
+                        continue;
+
+                    // Fetch next change
+                    res     = iter->get(&p);
+                    if (res == STATUS_NOT_FOUND)
+                        continue;
+                    else if (res != STATUS_OK)
+                        break;
 
-                kvt_name = iter->name();
-                if (kvt_name == NULL)
-                    continue;;
+                    kvt_name = iter->name();
+                    if (kvt_name == NULL)
+                        continue;
+                }
+                fetch   = true;
 
-                // Try to serialize changes
-                res = build_message(kvt_name, p, pPacket, &size, OSC_PACKET_MAX);
-                if (res != STATUS_OK)
+                // Reserve space in the queue for the new packet
+                if (pkt.data == NULL)
+                {
+                    res = pTx->reserve_packet(&data, &pkt.avail, OSC_PACKET_MAX);
+                    if (res != STATUS_OK) // Not enough space to store the packet
+                        return tx_stalled(changes);
+                    pkt.data    = static_cast<uint8_t *>(data);
+                }
+
+                // Try to serialize changes directly to the queue
+                res = pack_message(&pkt, kvt_name, p);
+                if (res == STATUS_OK)
                 {
                     iter->commit(KVT_TX);
+                    ++changes;
                     continue;
                 }
 
-                lsp_trace("Transmitting OSC message (%d bytes)", int(size));
-                osc::dump_packet(pPacket, size);
-
-                // Submit to queue
-                res = pTx->submit(pPacket, size);
-
-                switch (res)
+                // The packet is full? Submit it and retry with the new one
+                if ((res == STATUS_OVERFLOW) && (pkt.count > 0))
                 {
-                    case STATUS_OK:
-                        iter->commit(KVT_TX);
-                        break;
-
-                    case STATUS_TOO_BIG: // Packet too big
-                        lsp_warn("Too large packet for parameter %s: %d bytes, skipping", kvt_name, int(size));
-                        iter->commit(KVT_TX);
-                        break;
-
-                    case STATUS_OVERFLOW: // Not enough space to store the packet
-                        return changes;
-
-                    default:
+                    if (flush_packet(&pkt) != STATUS_OK)
                         return changes;
+                    fetch       = false;
+                    continue;
                 }
+
+                // The message does not fit into the empty packet
+                size_t avail    = pkt.avail;
+                flush_packet(&pkt);
+                if ((res == STATUS_OVERFLOW) && (avail < OSC_PACKET_MAX)) // Not enough space to store the packet
+                    return tx_stalled(changes);
+
+                lsp_warn("Could not serialize parameter %s: error %d, skipping", kvt_name, int(res));
+                iter->commit(KVT_TX);
             }
 
+            // Submit the last packet
+            if (pkt.data != NULL)
+                flush_packet(&pkt);
+
             return changes;
         }
 
+        size_t KVTDispatcher::tx_stalled(size_t changes)
+        {
+            // Ask the consumer to wake us up after it releases the packet.
+            // If the consumer has already drained the queue, do not fall asleep
+            atomic_swap(&nTxStalled, 1);
+            return (pTx->size() > 0) ? changes : changes + 1;
+        }
+
         status_t KVTDispatcher::run()
         {
-            size_t changes;
+            size_t changes  = 0;
 
             while (!cancelled())
             {
+                // Nothing has been changed at previous iteration? Wait for notification
+                if (changes <= 0)
+                {
+                    sNotifier.wait();
+                    if (cancelled())
+                        break;
+
+                    // Let the producers accumulate more changes
+                    if (nCoalesce > 0)
+                        Thread::sleep(nCoalesce);
+                }
+
                 changes     = 0;
 
                 // Lock KVT storage and perform transfer
@@ -196,23 +342,31 @@ namespace lsp
                 }
                 pKVT->gc();                         // Perform garbage collection
                 pKVTMutex->unlock();
-
-                if (changes <= 0)
-                    Thread::sleep(100);     // No changes? Sleep for a while
             }
 
             return STATUS_OK;
         }
 
 
+        void KVTDispatcher::wakeup()
+        {
+            sNotifier.notify();
+        }
+
         status_t KVTDispatcher::submit(const void *data, size_t size)
         {
-            return pRx->submit(data, size);
+            status_t res = pRx->submit(data, size);
+            if (res == STATUS_OK)
+                sNotifier.notify();
+            return res;
         }
 
         status_t KVTDispatcher::submit(const osc::packet_t *packet)
         {
-            return pRx->submit(packet);
+            status_t res = pRx->submit(packet);
+            if (res == STATUS_OK)
+                sNotifier.notify();
+            return res;
         }
 
         status_t KVTDispatcher::fetch(void *data, size_t *size, size_t limit)
@@ -230,26 +384,44 @@ namespace lsp
             return pTx->skip();
         }
 
+        status_t KVTDispatcher::peek(const void **data, size_t *size)
+        {
+            return pTx->peek_packet(data, size);
+        }
+
+        status_t KVTDispatcher::release()
+        {
+            status_t res = pTx->release_packet();
+            if (atomic_cas(&nTxStalled, 1, 0))
+                sNotifier.notify();
+            return res;
+        }
+
+        void KVTDispatcher::clear_tx()
+        {
+            pTx->clear();
+            if (atomic_cas(&nTxStalled, 1, 0))
+                sNotifier.notify();
+        }
+
         void KVTDispatcher::connect_client()
         {
             atomic_add(&nClients, 1);
             atomic_add(&nTxRequest, 1);
+            sNotifier.notify();
         }
 
         void KVTDispatcher::disconnect_client()
         {
             if (atomic_add(&nClients, -1) == 0)
                 nTxRequest  = 0;
+            sNotifier.notify();
         }
 
         status_t KVTDispatcher::parse_message(KVTStorage *kvt, const void *data, size_t size, size_t flags)
         {
             osc::parser_t parser;
-            osc::parse_frame_t root, message;
-            osc::parse_token_t token;
-
-            const char *address;
-            kvt_param_t p;
+            osc::parse_frame_t root;
             status_t res;
 
             if ((res = osc::parse_begin(&root, &parser, data, size)) != STATUS_OK)
@@ -258,19 +430,83 @@ namespace lsp
                 return res;
             }
 
-            if ((res = osc::parse_begin_message(&message, &root, &address)) != STATUS_OK)
+            res = parse_frame(kvt, &root, flags);
+
+            osc::parse_end(&root);
+            osc::parse_destroy(&parser);
+
+            return res;
+        }
+
+        status_t KVTDispatcher::parse_frame(KVTStorage *kvt, osc::parse_frame_t *frame, size_t flags)
+        {
+            osc::parse_token_t token;
+            status_t res, result = STATUS_SKIP;
+
+            while (true)
+            {
+                if ((res = osc::parse_token(frame, &token)) != STATUS_OK)
+                {
+                    lsp_trace("Could not fetch token");
+                    return res;
+                }
+
+                switch (token)
+                {
+                    case osc::PT_EOR:
+                        return result;
+
+                    case osc::PT_BUNDLE:
+                    {
+                        osc::parse_frame_t bundle;
+                        uint64_t time_tag;
+
+                        if ((res = osc::parse_begin_bundle(&bundle, frame, &time_tag)) != STATUS_OK)
+                        {
+                            lsp_trace("Failed parse_begin_bundle()");
+                            return res;
+                        }
+                        res = parse_frame(kvt, &bundle, flags); // Perform recursive call
+                        osc::parse_end(&bundle);
+                        break;
+                    }
+
+                    case osc::PT_MESSAGE:
+                        res = parse_kvt_message(kvt, frame, flags);
+                        break;
+
+                    default:
+                        lsp_trace("Unexpected token type = %d", int(token));
+                        return STATUS_CORRUPTED;
+                }
+
+                // Stop at first error, report STATUS_SKIP only if all messages have been skipped
+                if (res == STATUS_OK)
+                    result  = STATUS_OK;
+                else if (res != STATUS_SKIP)
+                    return res;
+            }
+        }
+
+        status_t KVTDispatcher::parse_kvt_message(KVTStorage *kvt, osc::parse_frame_t *frame, size_t flags)
+        {
+            osc::parse_frame_t message;
+            osc::parse_token_t token;
+
+            const char *address;
+            kvt_param_t p;
+            status_t res;
+
+            if ((res = osc::parse_begin_message(&message, frame, &address)) != STATUS_OK)
             {
                 lsp_trace("Failed parse_begin_message()");
-                osc::parse_end(&root);
-                osc::parse_destroy(&parser);
                 return res;
             }
 
             if (::strstr(address, "/KVT/") != address) // Non-KVT destination?
             {
                 lsp_trace("Prefix does not match /KVT/");
-                osc::parse_end(&root);
-                osc::parse_destroy(&parser);
+                osc::parse_end(&message);
                 return STATUS_SKIP;
             }
 
@@ -281,8 +517,6 @@ namespace lsp
             {
                 lsp_trace("Could not fetch token");
                 osc::parse_end(&message);
-                osc::parse_end(&root);
-                osc::parse_destroy(&parser);
                 return res;
             }
             lsp_trace("Token type = %d", int(token));
@@ -368,7 +602,7 @@ namespace lsp
                         lsp_trace("Message has been fully read, submitting to KVT");
 
                         // Put the change to the KVT storage with RX/TX flags set
-                        // We can freely use the address pointer while the pPacket is valid
+                        // We can freely use the address pointer while the packet data is valid
                         res = kvt->put(address, &p, flags);
                     }
                 }
@@ -376,8 +610,6 @@ namespace lsp
 
             // Finalize the message parser
             osc::parse_end(&message);
-            osc::parse_end(&root);
-            osc::parse_destroy(&parser);
 
             return res;
         }
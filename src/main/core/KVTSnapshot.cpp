@@ -0,0 +1,596 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 18 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/common/endian.h>
+#include <lsp-plug.in/plug-fw/core/KVTSnapshot.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define KVT_SNAPSHOT_HDR_SIZE       16
+#define KVT_SNAPSHOT_REC_SIZE       12
+#define KVT_SNAPSHOT_NULL           0xffffffff
+
+namespace lsp
+{
+    namespace core
+    {
+        static inline void put_u32(uint8_t *dst, uint32_t v)
+        {
+            v       = CPU_TO_BE(v);
+            ::memcpy(dst, &v, sizeof(v));
+        }
+
+        static inline void put_u16(uint8_t *dst, uint16_t v)
+        {
+            v       = CPU_TO_BE(v);
+            ::memcpy(dst, &v, sizeof(v));
+        }
+
+        static inline void put_u64(uint8_t *dst, uint64_t v)
+        {
+            v       = CPU_TO_BE(v);
+            ::memcpy(dst, &v, sizeof(v));
+        }
+
+        static inline uint32_t get_u32(const uint8_t *src)
+        {
+            uint32_t v;
+            ::memcpy(&v, src, sizeof(v));
+            return BE_TO_CPU(v);
+        }
+
+        static inline uint16_t get_u16(const uint8_t *src)
+        {
+            uint16_t v;
+            ::memcpy(&v, src, sizeof(v));
+            return BE_TO_CPU(v);
+        }
+
+        static inline uint64_t get_u64(const uint8_t *src)
+        {
+            uint64_t v;
+            ::memcpy(&v, src, sizeof(v));
+            return BE_TO_CPU(v);
+        }
+
+        //---------------------------------------------------------------------
+        KVTSnapshot::KVTSnapshot()
+        {
+            pBuffer     = NULL;
+            nBufSize    = 0;
+            nBufCap     = 0;
+            nSize       = 0;
+            nCount      = 0;
+        }
+
+        KVTSnapshot::~KVTSnapshot()
+        {
+            clear();
+            if (pBuffer != NULL)
+            {
+                ::free(pBuffer);
+                pBuffer     = NULL;
+            }
+            nBufCap     = 0;
+        }
+
+        void KVTSnapshot::clear()
+        {
+            vSegments.flush();
+            nBufSize    = 0;
+            nSize       = 0;
+            nCount      = 0;
+        }
+
+        uint8_t *KVTSnapshot::append(size_t size)
+        {
+            size_t need     = nBufSize + size;
+            if (need > nBufCap)
+            {
+                size_t cap      = align_size(lsp_max(need, nBufCap << 1), 0x1000);
+                uint8_t *buf    = static_cast<uint8_t *>(::realloc(pBuffer, cap));
+                if (buf == NULL)
+                    return NULL;
+                pBuffer         = buf;
+                nBufCap         = cap;
+            }
+
+            uint8_t *res    = &pBuffer[nBufSize];
+            nBufSize        = need;
+            return res;
+        }
+
+        status_t KVTSnapshot::add_internal(size_t offset, size_t size)
+        {
+            // Merge with the previous internal segment if possible
+            size_t n        = vSegments.size();
+            if (n > 0)
+            {
+                segment_t *s    = vSegments.uget(n - 1);
+                if ((s->data == NULL) && (s->offset + s->size == offset))
+                {
+                    s->size        += size;
+                    nSize          += size;
+                    return STATUS_OK;
+                }
+            }
+
+            segment_t *s    = vSegments.add();
+            if (s == NULL)
+                return STATUS_NO_MEM;
+            s->data         = NULL;
+            s->offset       = offset;
+            s->size         = size;
+            nSize          += size;
+
+            return STATUS_OK;
+        }
+
+        status_t KVTSnapshot::add_external(const void *data, size_t size)
+        {
+            if (size <= 0)
+                return STATUS_OK;
+
+            segment_t *s    = vSegments.add();
+            if (s == NULL)
+                return STATUS_NO_MEM;
+            s->data         = static_cast<const uint8_t *>(data);
+            s->offset       = 0;
+            s->size         = size;
+            nSize          += size;
+
+            return STATUS_OK;
+        }
+
+        status_t KVTSnapshot::add_record(const char *name, const kvt_param_t *p, size_t flags)
+        {
+            status_t res;
+            size_t nlen     = ::strlen(name);
+            size_t start    = nBufSize;
+
+            // Compute the size of the fixed part of the record
+            size_t fixed    = KVT_SNAPSHOT_REC_SIZE + nlen + 1;
+            const void *ext = NULL;
+            size_t ext_size = 0;
+            size_t clen     = 0;
+
+            switch (p->type)
+            {
+                case KVT_INT32:
+                case KVT_UINT32:
+                case KVT_FLOAT32:
+                    fixed          += sizeof(uint32_t);
+                    break;
+                case KVT_INT64:
+                case KVT_UINT64:
+                case KVT_FLOAT64:
+                    fixed          += sizeof(uint64_t);
+                    break;
+                case KVT_STRING:
+                    fixed          += sizeof(uint32_t);
+                    if (p->str != NULL)
+                    {
+                        ext             = p->str;
+                        ext_size        = ::strlen(p->str) + 1;
+                    }
+                    break;
+                case KVT_BLOB:
+                    if ((p->blob.size > 0) && (p->blob.data == NULL))
+                        return STATUS_INVALID_VALUE;
+                    clen            = (p->blob.ctype != NULL) ? ::strlen(p->blob.ctype) + 1 : 0;
+                    fixed          += sizeof(uint32_t) * 2 + clen;
+                    ext             = p->blob.data;
+                    ext_size        = p->blob.size;
+                    break;
+                default:
+                    return STATUS_BAD_TYPE;
+            }
+
+            if ((fixed + ext_size - sizeof(uint32_t)) > KVT_SNAPSHOT_NULL)
+                return STATUS_OVERFLOW;
+
+            // Emit header and name
+            uint8_t *dst    = append(fixed);
+            if (dst == NULL)
+                return STATUS_NO_MEM;
+
+            put_u32(&dst[0], uint32_t(fixed + ext_size - sizeof(uint32_t)));
+            dst[4]          = uint8_t(p->type);
+            dst[5]          = uint8_t(flags & KVT_PRIVATE);
+            put_u16(&dst[6], 0);
+            put_u32(&dst[8], uint32_t(nlen));
+            dst            += KVT_SNAPSHOT_REC_SIZE;
+            ::memcpy(dst, name, nlen + 1);
+            dst            += nlen + 1;
+
+            // Emit value
+            switch (p->type)
+            {
+                case KVT_INT32:     put_u32(dst, uint32_t(p->i32)); break;
+                case KVT_UINT32:    put_u32(dst, p->u32); break;
+                case KVT_FLOAT32:
+                {
+                    uint32_t v;
+                    ::memcpy(&v, &p->f32, sizeof(v));
+                    put_u32(dst, v);
+                    break;
+                }
+                case KVT_INT64:     put_u64(dst, uint64_t(p->i64)); break;
+                case KVT_UINT64:    put_u64(dst, p->u64); break;
+                case KVT_FLOAT64:
+                {
+                    uint64_t v;
+                    ::memcpy(&v, &p->f64, sizeof(v));
+                    put_u64(dst, v);
+                    break;
+                }
+                case KVT_STRING:
+                    put_u32(dst, (ext != NULL) ? uint32_t(ext_size - 1) : KVT_SNAPSHOT_NULL);
+                    break;
+                case KVT_BLOB:
+                    if (p->blob.ctype != NULL)
+                    {
+                        put_u32(dst, uint32_t(clen - 1));
+                        ::memcpy(&dst[sizeof(uint32_t)], p->blob.ctype, clen);
+                    }
+                    else
+                        put_u32(dst, KVT_SNAPSHOT_NULL);
+                    put_u32(&dst[sizeof(uint32_t) + clen], uint32_t(ext_size));
+                    break;
+                default:
+                    break;
+            }
+
+            // Register segments
+            if ((res = add_internal(start, fixed)) != STATUS_OK)
+                return res;
+            if ((res = add_external(ext, ext_size)) != STATUS_OK)
+                return res;
+
+            ++nCount;
+            return STATUS_OK;
+        }
+
+        status_t KVTSnapshot::build(KVTStorage *kvt, const char *branch)
+        {
+            if ((kvt == NULL) || (branch == NULL))
+                return STATUS_BAD_ARGUMENTS;
+
+            clear();
+
+            // Reserve space for the header
+            if (append(KVT_SNAPSHOT_HDR_SIZE) == NULL)
+                return STATUS_NO_MEM;
+            status_t res    = add_internal(0, KVT_SNAPSHOT_HDR_SIZE);
+            if (res != STATUS_OK)
+                return res;
+
+            // Emit all records
+            const kvt_param_t *p;
+            KVTIterator *it = kvt->enum_branch(branch, true);
+            if (it == NULL)
+                return STATUS_NO_MEM;
+
+            while (it->next() == STATUS_OK)
+            {
+                res             = it->get(&p);
+                if (res == STATUS_NOT_FOUND) // Not a parameter
+                    continue;
+                else if (res != STATUS_OK)
+                    break;
+                else if (it->is_transient()) // Skip transient parameters
+                    continue;
+
+                const char *name = it->name();
+                if (name == NULL)
+                {
+                    res             = STATUS_NO_MEM;
+                    break;
+                }
+
+                if ((res = add_record(name, p, it->flags())) != STATUS_OK)
+                {
+                    lsp_warn("Could not serialize KVT parameter %s, code=%d", name, int(res));
+                    break;
+                }
+            }
+
+            if ((res != STATUS_OK) && (res != STATUS_NOT_FOUND))
+            {
+                clear();
+                return res;
+            }
+            if (nSize - KVT_SNAPSHOT_HDR_SIZE > KVT_SNAPSHOT_NULL)
+            {
+                clear();
+                return STATUS_OVERFLOW;
+            }
+
+            // Emit the header
+            uint8_t *hdr    = pBuffer;
+            put_u32(&hdr[0], KVT_SNAPSHOT_MAGIC);
+            put_u16(&hdr[4], KVT_SNAPSHOT_VERSION);
+            put_u16(&hdr[6], 0);
+            put_u32(&hdr[8], uint32_t(nCount));
+            put_u32(&hdr[12], uint32_t(nSize - KVT_SNAPSHOT_HDR_SIZE));
+
+            return STATUS_OK;
+        }
+
+        const void *KVTSnapshot::segment(size_t index, size_t *size) const
+        {
+            const segment_t *s  = vSegments.get(index);
+            if (s == NULL)
+                return NULL;
+            if (size != NULL)
+                *size               = s->size;
+            return (s->data != NULL) ? s->data : &pBuffer[s->offset];
+        }
+
+        status_t KVTSnapshot::write(io::IOutStream *os)
+        {
+            if (os == NULL)
+                return STATUS_BAD_ARGUMENTS;
+
+            for (size_t i=0, n=vSegments.size(); i<n; ++i)
+            {
+                const segment_t *s  = vSegments.uget(i);
+                const uint8_t *src  = (s->data != NULL) ? s->data : &pBuffer[s->offset];
+                ssize_t written     = os->write(src, s->size);
+                if (written < 0)
+                    return status_t(-written);
+                else if (size_t(written) != s->size)
+                    return STATUS_IO_ERROR;
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t KVTSnapshot::write(void *dst, size_t size)
+        {
+            if (dst == NULL)
+                return STATUS_BAD_ARGUMENTS;
+            if (size < nSize)
+                return STATUS_OVERFLOW;
+
+            uint8_t *ptr    = static_cast<uint8_t *>(dst);
+            for (size_t i=0, n=vSegments.size(); i<n; ++i)
+            {
+                const segment_t *s  = vSegments.uget(i);
+                const uint8_t *src  = (s->data != NULL) ? s->data : &pBuffer[s->offset];
+                ::memcpy(ptr, src, s->size);
+                ptr                += s->size;
+            }
+
+            return STATUS_OK;
+        }
+
+        //---------------------------------------------------------------------
+        KVTSnapshotReader::KVTSnapshotReader()
+        {
+            close();
+        }
+
+        KVTSnapshotReader::~KVTSnapshotReader()
+        {
+            close();
+        }
+
+        void KVTSnapshotReader::close()
+        {
+            pHead       = NULL;
+            pTail       = NULL;
+            pValue      = NULL;
+            pEnd        = NULL;
+            pName       = NULL;
+            nType       = KVT_ANY;
+            nFlags      = 0;
+            nCount      = 0;
+            nIndex      = 0;
+        }
+
+        status_t KVTSnapshotReader::open(const void *data, size_t size)
+        {
+            if (data == NULL)
+                return STATUS_BAD_ARGUMENTS;
+            if (size < KVT_SNAPSHOT_HDR_SIZE)
+                return STATUS_CORRUPTED;
+
+            const uint8_t *hdr  = static_cast<const uint8_t *>(data);
+            if (get_u32(&hdr[0]) != KVT_SNAPSHOT_MAGIC)
+                return STATUS_BAD_FORMAT;
+            if (get_u16(&hdr[4]) != KVT_SNAPSHOT_VERSION)
+                return STATUS_UNSUPPORTED_FORMAT;
+
+            size_t count        = get_u32(&hdr[8]);
+            size_t bytes        = get_u32(&hdr[12]);
+            if (bytes > size - KVT_SNAPSHOT_HDR_SIZE)
+                return STATUS_CORRUPTED;
+
+            close();
+            pHead       = &hdr[KVT_SNAPSHOT_HDR_SIZE];
+            pTail       = &pHead[bytes];
+            nCount      = count;
+
+            return STATUS_OK;
+        }
+
+        status_t KVTSnapshotReader::next()
+        {
+            if (pHead == NULL)
+                return STATUS_CLOSED;
+            if (nIndex >= nCount)
+                return (pHead == pTail) ? STATUS_EOF : STATUS_CORRUPTED;
+
+            // Validate the record header
+            size_t avail        = pTail - pHead;
+            if (avail < KVT_SNAPSHOT_REC_SIZE)
+                return STATUS_CORRUPTED;
+            size_t size         = get_u32(pHead);
+            if ((size > avail - sizeof(uint32_t)) || (size < KVT_SNAPSHOT_REC_SIZE - sizeof(uint32_t)))
+                return STATUS_CORRUPTED;
+
+            const uint8_t *end  = &pHead[size + sizeof(uint32_t)];
+            size_t nlen         = get_u32(&pHead[8]);
+            const uint8_t *name = &pHead[KVT_SNAPSHOT_REC_SIZE];
+            if ((nlen >= size_t(end - name)) || (name[nlen] != '\0'))
+                return STATUS_CORRUPTED;
+
+            // Commit the record
+            nType               = pHead[4];
+            nFlags              = (pHead[5] & KVT_PRIVATE);
+            pName               = reinterpret_cast<const char *>(name);
+            pValue              = &name[nlen + 1];
+            pEnd                = end;
+            pHead               = end;
+            ++nIndex;
+
+            return STATUS_OK;
+        }
+
+        status_t KVTSnapshotReader::get(kvt_param_t *p) const
+        {
+            if (pName == NULL)
+                return STATUS_BAD_STATE;
+            if (p == NULL)
+                return STATUS_BAD_ARGUMENTS;
+
+            const uint8_t *src  = pValue;
+            size_t avail        = pEnd - pValue;
+
+            switch (nType)
+            {
+                case KVT_INT32:
+                case KVT_UINT32:
+                case KVT_FLOAT32:
+                {
+                    if (avail != sizeof(uint32_t))
+                        return STATUS_CORRUPTED;
+                    uint32_t v      = get_u32(src);
+                    ::memcpy(&p->u32, &v, sizeof(v));
+                    break;
+                }
+                case KVT_INT64:
+                case KVT_UINT64:
+                case KVT_FLOAT64:
+                {
+                    if (avail != sizeof(uint64_t))
+                        return STATUS_CORRUPTED;
+                    uint64_t v      = get_u64(src);
+                    ::memcpy(&p->u64, &v, sizeof(v));
+                    break;
+                }
+                case KVT_STRING:
+                {
+                    if (avail < sizeof(uint32_t))
+                        return STATUS_CORRUPTED;
+                    size_t len      = get_u32(src);
+                    src            += sizeof(uint32_t);
+                    avail          -= sizeof(uint32_t);
+                    if (len == KVT_SNAPSHOT_NULL)
+                    {
+                        if (avail != 0)
+                            return STATUS_CORRUPTED;
+                        p->str          = NULL;
+                    }
+                    else
+                    {
+                        if ((avail != len + 1) || (src[len] != '\0'))
+                            return STATUS_CORRUPTED;
+                        p->str          = reinterpret_cast<const char *>(src);
+                    }
+                    break;
+                }
+                case KVT_BLOB:
+                {
+                    if (avail < sizeof(uint32_t))
+                        return STATUS_CORRUPTED;
+                    size_t len      = get_u32(src);
+                    src            += sizeof(uint32_t);
+                    avail          -= sizeof(uint32_t);
+                    if (len == KVT_SNAPSHOT_NULL)
+                        p->blob.ctype   = NULL;
+                    else
+                    {
+                        if ((avail <= len) || (src[len] != '\0'))
+                            return STATUS_CORRUPTED;
+                        p->blob.ctype   = reinterpret_cast<const char *>(src);
+                        src            += len + 1;
+                        avail          -= len + 1;
+                    }
+
+                    if (avail < sizeof(uint32_t))
+                        return STATUS_CORRUPTED;
+                    len             = get_u32(src);
+                    src            += sizeof(uint32_t);
+                    avail          -= sizeof(uint32_t);
+                    if (avail != len)
+                        return STATUS_CORRUPTED;
+                    p->blob.data    = (len > 0) ? src : NULL;
+                    p->blob.size    = len;
+                    break;
+                }
+                default:
+                    return STATUS_BAD_TYPE;
+            }
+
+            p->type             = kvt_param_type_t(nType);
+            return STATUS_OK;
+        }
+
+        status_t KVTSnapshotReader::apply(KVTStorage *kvt, size_t flags)
+        {
+            if (kvt == NULL)
+                return STATUS_BAD_ARGUMENTS;
+
+            kvt_param_t p;
+            status_t res    = kvt->begin_batch();
+            if (res != STATUS_OK)
+                return res;
+
+            while ((res = next()) == STATUS_OK)
+            {
+                if ((res = get(&p)) != STATUS_OK)
+                    break;
+
+                // The decoded data belongs to the reader and can not be delegated to the storage
+                size_t pflags   = flags & (~KVT_DELEGATE);
+                if (nFlags & KVT_PRIVATE)
+                    pflags         |= KVT_PRIVATE;
+
+                if ((res = kvt->put(pName, &p, pflags)) != STATUS_OK)
+                {
+                    lsp_warn("Could not restore KVT parameter %s, code=%d", pName, int(res));
+                    break;
+                }
+            }
+
+            status_t res2   = kvt->end_batch();
+            if (res == STATUS_EOF)
+                res             = res2;
+
+            return res;
+        }
+    }
+}
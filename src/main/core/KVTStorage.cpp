@@ -23,6 +23,12 @@
 #include <lsp-plug.in/common/debug.h>
 #include <lsp-plug.in/plug-fw/core/KVTStorage.h>
 
+#include <stdlib.h>
+
+#define KVT_HASH_BASIS          0x811c9dc5U     /* FNV-1a offset basis */
+#define KVT_HASH_PRIME          0x01000193U     /* FNV-1a prime */
+#define KVT_INDEX_MIN           0x100           /* Minimum number of buckets in the index */
+
 namespace lsp
 {
     namespace core
@@ -59,6 +65,10 @@ namespace lsp
         {
         }
 
+        void KVTListener::updated(KVTStorage *storage, const char *branch, size_t count, size_t pending)
+        {
+        }
+
         void KVTListener::access(KVTStorage *storage, const char *id, const kvt_param_t *param, size_t pending)
         {
         }
@@ -93,8 +103,14 @@ namespace lsp
             nValues             = 0;
             nTxPending          = 0;
             nRxPending          = 0;
+            vIndex              = NULL;
+            nIndexCap           = 0;
+            nIndexItems         = 0;
+            bIndex              = true;
+            nBatch              = 0;
 
             init_node(&sRoot, NULL, 0);
+            sRoot.hash          = KVT_HASH_BASIS;
             ++sRoot.refs;
         }
 
@@ -107,6 +123,10 @@ namespace lsp
         {
             unbind_all();
 
+            // Drop the batch
+            vBatch.flush();
+            nBatch              = 0;
+
             // Destroy trash
             while (pTrash != NULL)
             {
@@ -123,6 +143,9 @@ namespace lsp
                 pIterators          = next;
             }
 
+            // Drop the index, there is no need to remove each node from it
+            index_drop();
+
             // Destroy all nodes
             kvt_link_t *link = sValid.next;
             while (link != NULL)
@@ -158,6 +181,7 @@ namespace lsp
             }
             sRoot.nchildren     = 0;
             sRoot.capacity      = 0;
+            sRoot.unsorted      = false;
 
             sValid.next         = NULL;
             sValid.prev         = NULL;
@@ -178,6 +202,9 @@ namespace lsp
             nValues             = 0;
             nTxPending          = 0;
             nRxPending          = 0;
+
+            // Release all memory chunks
+            sAllocator.destroy();
         }
 
         status_t KVTStorage::clear()
@@ -205,6 +232,11 @@ namespace lsp
             node->children      = NULL;
             node->nchildren     = 0;
             node->capacity      = 0;
+            node->unsorted      = false;
+            node->hash          = 0;
+            node->hnext         = NULL;
+            node->batch         = 0;
+            node->bpending      = 0;
 
             // Copy name
             if (node->id != NULL)
@@ -219,10 +251,15 @@ namespace lsp
             return vListeners.size();
         }
 
+        size_t KVTStorage::node_size(size_t len)
+        {
+            return align_size(sizeof(kvt_node_t) + len + 1, DEFAULT_ALIGN);
+        }
+
         KVTStorage::kvt_node_t *KVTStorage::allocate_node(const char *name, size_t len)
         {
-            size_t to_alloc     = align_size(sizeof(kvt_node_t) + len + 1, DEFAULT_ALIGN);
-            kvt_node_t *node    = static_cast<kvt_node_t *>(::malloc(to_alloc));
+            // The node and it's identifier are allocated as a single block
+            kvt_node_t *node    = static_cast<kvt_node_t *>(sAllocator.alloc(node_size(len)));
             if (node != NULL)
             {
                 init_node(node, name, len);
@@ -377,6 +414,16 @@ namespace lsp
             }
         }
 
+        void KVTStorage::notify_updated(const char *branch, size_t count, size_t pending)
+        {
+            for (size_t i=0, n=vListeners.size(); i<n; ++i)
+            {
+                KVTListener *listener = vListeners.uget(i);
+                if (listener != NULL)
+                    listener->updated(this, branch, count, pending);
+            }
+        }
+
         void KVTStorage::notify_access(const char *id, const kvt_param_t *param, size_t pending)
         {
             for (size_t i=0, n=vListeners.size(); i<n; ++i)
@@ -413,19 +460,30 @@ namespace lsp
             if (param->type == KVT_STRING)
             {
                 if (param->str != NULL)
-                    ::free(const_cast<char *>(param->str));
+                {
+                    if (param->delegated)
+                        ::free(const_cast<char *>(param->str));
+                    else
+                        sAllocator.free_string(const_cast<char *>(param->str));
+                }
                 param->u64      = 0;
             }
             else if (param->type == KVT_BLOB)
             {
                 if (param->blob.ctype != NULL)
                 {
-                    ::free(const_cast<char *>(param->blob.ctype));
+                    if (param->delegated)
+                        ::free(const_cast<char *>(param->blob.ctype));
+                    else
+                        sAllocator.free_string(const_cast<char *>(param->blob.ctype));
                     param->blob.ctype   = NULL;
                 }
                 if (param->blob.data != NULL)
                 {
-                    ::free(const_cast<void *>(param->blob.data));
+                    if (param->delegated)
+                        ::free(const_cast<void *>(param->blob.data));
+                    else
+                        sAllocator.free(const_cast<void *>(param->blob.data), param->blob.size);
                     param->blob.data    = NULL;
                 }
                 param->blob.size    = 0;
@@ -434,7 +492,7 @@ namespace lsp
                 param->u64      = 0;
 
             param->type         = KVT_ANY;
-            ::free(param);
+            sAllocator.free(param, sizeof(kvt_gcparam_t));
         }
 
         char *KVTStorage::build_path(char **path, size_t *capacity, const kvt_node_t *node)
@@ -467,30 +525,245 @@ namespace lsp
             return dst;
         }
 
-        KVTStorage::kvt_node_t *KVTStorage::create_node(kvt_node_t *base, const char *name, size_t len)
+        int KVTStorage::compare_nodes(const void *a, const void *b)
         {
-            kvt_node_t *node;
-            ssize_t first = 0, last = base->nchildren-1;
+            const kvt_node_t *na    = *static_cast<const kvt_node_t * const *>(a);
+            const kvt_node_t *nb    = *static_cast<const kvt_node_t * const *>(b);
 
-            // Seek for existing node
-            while (first <= last)
+            ssize_t cmp             = na->idlen - nb->idlen;
+            if (cmp == 0)
+                cmp                     = ::memcmp(na->id, nb->id, na->idlen);
+
+            return (cmp < 0) ? -1 : (cmp > 0) ? 1 : 0;
+        }
+
+        void KVTStorage::sort_children(kvt_node_t *node)
+        {
+            if (!node->unsorted)
+                return;
+
+            ::qsort(node->children, node->nchildren, sizeof(kvt_node_t *), compare_nodes);
+            node->unsorted      = false;
+        }
+
+        uint32_t KVTStorage::hash_append(uint32_t hash, const char *s, size_t len)
+        {
+            for (size_t i=0; i<len; ++i)
+                hash                = (hash ^ uint8_t(s[i])) * KVT_HASH_PRIME;
+            return hash;
+        }
+
+        uint32_t KVTStorage::child_hash(const kvt_node_t *base, const char *name, size_t len) const
+        {
+            return hash_append(hash_append(base->hash, &cSeparator, 1), name, len);
+        }
+
+        bool KVTStorage::path_hash(const char *name, uint32_t *hash, size_t *len) const
+        {
+            // Compute the hash and ensure that the path is well-formed: it starts
+            // with separator, does not end with separator and has no empty names
+            const char *p   = name;
+            if (*p != cSeparator)
+                return false;
+
+            uint32_t h      = KVT_HASH_BASIS;
+            char prev       = '\0';
+            for ( ; *p != '\0'; ++p)
             {
-                ssize_t middle      = (first + last) >> 1;
-                node                = base->children[middle];
+                if ((*p == cSeparator) && (prev == cSeparator))
+                    return false;
+                h               = (h ^ uint8_t(*p)) * KVT_HASH_PRIME;
+                prev            = *p;
+            }
+            if (prev == cSeparator)
+                return false;
 
-                // Compare strings
-                ssize_t cmp         = len - node->idlen;
-                if (cmp == 0)
-                    cmp                 = ::memcmp(name, node->id, len);
+            *hash           = h;
+            *len            = p - name;
+            return true;
+        }
 
-                // Check result
-                if (cmp < 0)
-                    last    = middle - 1;
-                else if (cmp > 0)
-                    first   = middle + 1;
-                else // Node does exist?
+        bool KVTStorage::path_matches(const kvt_node_t *node, const char *name, size_t len) const
+        {
+            // Compare the path starting from the leaf node
+            const char *end = &name[len];
+            for (const kvt_node_t *n = node; n != &sRoot; n = n->parent)
+            {
+                if ((n == NULL) || (size_t(end - name) <= n->idlen))
+                    return false;
+
+                end    -= n->idlen;
+                if (::memcmp(end, n->id, n->idlen) != 0)
+                    return false;
+                if (*(--end) != cSeparator)
+                    return false;
+            }
+
+            return end == name;
+        }
+
+        KVTStorage::kvt_node_t *KVTStorage::index_find(const char *name, size_t len, uint32_t hash) const
+        {
+            if (vIndex == NULL)
+                return NULL;
+
+            for (kvt_node_t *n = vIndex[hash & (nIndexCap - 1)]; n != NULL; n = n->hnext)
+            {
+                if ((n->hash == hash) && (path_matches(n, name, len)))
+                    return n;
+            }
+
+            return NULL;
+        }
+
+        KVTStorage::kvt_node_t *KVTStorage::index_find_child(const kvt_node_t *base, const char *name, size_t len, uint32_t hash) const
+        {
+            if (vIndex == NULL)
+                return NULL;
+
+            for (kvt_node_t *n = vIndex[hash & (nIndexCap - 1)]; n != NULL; n = n->hnext)
+            {
+                if ((n->hash == hash) && (n->parent == base) && (n->idlen == len) &&
+                    (::memcmp(n->id, name, len) == 0))
+                    return n;
+            }
+
+            return NULL;
+        }
+
+        bool KVTStorage::index_grow(size_t capacity)
+        {
+            kvt_node_t **index  = static_cast<kvt_node_t **>(::calloc(capacity, sizeof(kvt_node_t *)));
+            if (index == NULL)
+                return false;
+
+            // Re-hash all nodes
+            for (size_t i=0; i<nIndexCap; ++i)
+            {
+                for (kvt_node_t *n = vIndex[i]; n != NULL; )
+                {
+                    kvt_node_t *next    = n->hnext;
+                    kvt_node_t **bucket = &index[n->hash & (capacity - 1)];
+                    n->hnext            = *bucket;
+                    *bucket             = n;
+                    n                   = next;
+                }
+            }
+
+            if (vIndex != NULL)
+                ::free(vIndex);
+
+            vIndex              = index;
+            nIndexCap           = capacity;
+
+            return true;
+        }
+
+        void KVTStorage::index_add(kvt_node_t *node)
+        {
+            if (nIndexItems >= nIndexCap)
+            {
+                // Keep the previous index if there is not enough memory to grow it,
+                // it is still valid but is less effective
+                if ((!index_grow(lsp_max(nIndexCap << 1, size_t(KVT_INDEX_MIN)))) && (vIndex == NULL))
+                {
+                    lsp_warn("Could not allocate KVT index, disabling it");
+                    bIndex              = false;
+                    return;
+                }
+            }
+
+            kvt_node_t **bucket = &vIndex[node->hash & (nIndexCap - 1)];
+            node->hnext         = *bucket;
+            *bucket             = node;
+            ++nIndexItems;
+        }
+
+        void KVTStorage::index_remove(kvt_node_t *node)
+        {
+            if (vIndex == NULL)
+                return;
+
+            for (kvt_node_t **pn = &vIndex[node->hash & (nIndexCap - 1)]; *pn != NULL; pn = &(*pn)->hnext)
+            {
+                if (*pn == node)
+                {
+                    *pn                 = node->hnext;
+                    node->hnext         = NULL;
+                    --nIndexItems;
+                    return;
+                }
+            }
+        }
+
+        void KVTStorage::index_drop()
+        {
+            if (vIndex != NULL)
+            {
+                ::free(vIndex);
+                vIndex              = NULL;
+            }
+            nIndexCap           = 0;
+            nIndexItems         = 0;
+        }
+
+        status_t KVTStorage::set_indexed(bool enable)
+        {
+            if (bIndex == enable)
+                return STATUS_OK;
+
+            index_drop();
+            bIndex              = enable;
+            if (!enable)
+                return STATUS_OK;
+
+            // Add all existing nodes to the index
+            for (kvt_link_t *lnk = sValid.next; (lnk != NULL) && (bIndex); lnk = lnk->next)
+                index_add(lnk->node);
+            for (kvt_link_t *lnk = sGarbage.next; (lnk != NULL) && (bIndex); lnk = lnk->next)
+                index_add(lnk->node);
+
+            return (bIndex) ? STATUS_OK : STATUS_NO_MEM;
+        }
+
+        KVTStorage::kvt_node_t *KVTStorage::create_node(kvt_node_t *base, const char *name, size_t len)
+        {
+            kvt_node_t *node;
+            uint32_t hash       = child_hash(base, name, len);
+            ssize_t first       = base->nchildren;
+
+            if (bIndex)
+            {
+                // Lookup the index for existing node
+                if ((node = index_find_child(base, name, len, hash)) != NULL)
                     return node;
             }
+            else
+            {
+                ssize_t last        = base->nchildren-1;
+                first               = 0;
+                sort_children(base);
+
+                // Seek for existing node
+                while (first <= last)
+                {
+                    ssize_t middle      = (first + last) >> 1;
+                    node                = base->children[middle];
+
+                    // Compare strings
+                    ssize_t cmp         = len - node->idlen;
+                    if (cmp == 0)
+                        cmp                 = ::memcmp(name, node->id, len);
+
+                    // Check result
+                    if (cmp < 0)
+                        last    = middle - 1;
+                    else if (cmp > 0)
+                        first   = middle + 1;
+                    else // Node does exist?
+                        return node;
+                }
+            }
 
             // Create new node and add to the tree
             node        = allocate_node(name, len);
@@ -511,20 +784,33 @@ namespace lsp
                 base->capacity      = ncap;
             }
 
+            // When the index is enabled, the node is just appended to the end of
+            // the list, and the list is sorted later on demand
+            if ((bIndex) && (first > 0) && (!base->unsorted))
+                base->unsorted      = compare_nodes(&base->children[first - 1], &node) > 0;
+
             // Link node to parent
             ::memmove(&base->children[first + 1], &base->children[first], sizeof(kvt_node_t *) * (base->nchildren - first));
             base->children[first]   = node;
             node->parent            = base;
+            node->hash              = hash;
             ++base->nchildren;
 
+            if (bIndex)
+                index_add(node);
+
             // Return node
             return node;
         }
 
         KVTStorage::kvt_node_t *KVTStorage::get_node(kvt_node_t *base, const char *name, size_t len)
         {
+            if (bIndex)
+                return index_find_child(base, name, len, child_hash(base, name, len));
+
             kvt_node_t *node        = NULL;
             ssize_t first = 0, last = base->nchildren-1;
+            sort_children(base);
 
             // Seek for existing node
             while (first <= last)
@@ -551,8 +837,11 @@ namespace lsp
 
         KVTStorage::kvt_gcparam_t *KVTStorage::copy_parameter(const kvt_param_t *src, size_t flags)
         {
-            kvt_gcparam_t *gcp  = reinterpret_cast<kvt_gcparam_t *>(::malloc(sizeof(kvt_gcparam_t)));
+            kvt_gcparam_t *gcp  = static_cast<kvt_gcparam_t *>(sAllocator.alloc(sizeof(kvt_gcparam_t)));
+            if (gcp == NULL)
+                return NULL;
             gcp->flags          = flags & (KVT_PRIVATE | KVT_TRANSIENT);
+            gcp->delegated      = flags & KVT_DELEGATE;
             gcp->next           = NULL;
 
             kvt_param_t *dst    = gcp;
@@ -566,9 +855,9 @@ namespace lsp
             {
                 if (src->str != NULL)
                 {
-                    if (!(dst->str = ::strdup(src->str)))
+                    if (!(dst->str = sAllocator.strdup(src->str)))
                     {
-                        ::free(gcp);
+                        sAllocator.free(gcp, sizeof(kvt_gcparam_t));
                         return NULL;
                     }
                 }
@@ -577,19 +866,18 @@ namespace lsp
             {
                 if (src->blob.ctype != NULL)
                 {
-                    if (!(dst->blob.ctype = ::strdup(src->blob.ctype)))
+                    if (!(dst->blob.ctype = sAllocator.strdup(src->blob.ctype)))
                     {
-                        ::free(gcp);
+                        sAllocator.free(gcp, sizeof(kvt_gcparam_t));
                         return NULL;
                     }
                 }
                 if (src->blob.data != NULL)
                 {
-                    if (!(dst->blob.data = ::malloc(src->blob.size)))
+                    if (!(dst->blob.data = sAllocator.alloc(src->blob.size)))
                     {
-                        if (dst->blob.ctype != NULL)
-                            ::free(const_cast<char *>(dst->blob.ctype));
-                        ::free(gcp);
+                        sAllocator.free_string(const_cast<char *>(dst->blob.ctype));
+                        sAllocator.free(gcp, sizeof(kvt_gcparam_t));
                         return NULL;
                     }
                     ::memcpy(const_cast<void *>(dst->blob.data), src->blob.data, src->blob.size);
@@ -616,7 +904,8 @@ namespace lsp
                 node->param     = copy;
                 ++nValues;
 
-                notify_created(name, copy, pending);
+                if (!batch_event(node, pending))
+                    notify_created(name, copy, pending);
                 return STATUS_OK;
             }
 
@@ -638,7 +927,8 @@ namespace lsp
             pTrash              = curr;
             node->param         = copy;
 
-            notify_changed(name, curr, copy, pending);
+            if (!batch_event(node, pending))
+                notify_changed(name, curr, copy, pending);
             return STATUS_OK;
         }
 
@@ -653,6 +943,19 @@ namespace lsp
             else if (*(path++) != cSeparator)
                 return STATUS_INVALID_VALUE;
 
+            // Lookup the index for existing node first
+            if (bIndex)
+            {
+                uint32_t hash;
+                size_t len;
+                if (path_hash(name, &hash, &len))
+                {
+                    kvt_node_t *node = index_find(name, len, hash);
+                    if (node != NULL)
+                        return commit_parameter(name, node, value, flags);
+                }
+            }
+
             kvt_node_t *curr = &sRoot;
 
             while (true)
@@ -686,6 +989,22 @@ namespace lsp
 
         status_t KVTStorage::walk_node(kvt_node_t **out, const char *name)
         {
+            // The well-formed path can be looked up directly in the index
+            if (bIndex)
+            {
+                uint32_t hash;
+                size_t len;
+                if (path_hash(name, &hash, &len))
+                {
+                    kvt_node_t *node = index_find(name, len, hash);
+                    if ((node == NULL) || (node->refs <= 0))
+                        return STATUS_NOT_FOUND;
+
+                    *out    = node;
+                    return STATUS_OK;
+                }
+            }
+
             const char *path    = name;
             if (*(path++) != cSeparator)
                 return STATUS_INVALID_VALUE;
@@ -817,7 +1136,8 @@ namespace lsp
             node->param         = NULL;
             --nValues;
 
-            notify_removed(name, param, pending);
+            if (!batch_event(node, pending))
+                notify_removed(name, param, pending);
 
             // All seems to be OK
             if (value != NULL)
@@ -862,6 +1182,8 @@ namespace lsp
             // Add parameter to trash
             size_t op = node->pending;
             size_t np = set_pending_state(node, op | flags);
+            if ((op != np) && (batch_event(node, op ^ np)))
+                return STATUS_OK;
 
             if ((op ^ np) & KVT_TX) // TX flag has set?
                 notify_changed(name, param, param, KVT_TX);
@@ -960,7 +1282,7 @@ namespace lsp
     //            lsp_trace("%s op=0x%x, np=0x%x", node->id, int(op), int(np));
 
                 // State has changed?
-                if (op != np)
+                if ((op != np) && (!batch_event(node, op ^ np)))
                 {
                     // Build path to node
                     path = build_path(&str, &capacity, node);
@@ -1085,17 +1407,20 @@ namespace lsp
                     node->param         = NULL;
                     --nValues;
 
-                    // Build path to node
-                    path = build_path(&str, &capacity, node);
-                    if (path == NULL)
+                    if (!batch_event(node, pending))
                     {
-                        if (str != NULL)
-                            ::free(str);
-                        return STATUS_NO_MEM;
-                    }
+                        // Build path to node
+                        path = build_path(&str, &capacity, node);
+                        if (path == NULL)
+                        {
+                            if (str != NULL)
+                                ::free(str);
+                            return STATUS_NO_MEM;
+                        }
 
-                    // Notify listeners
-                    notify_removed(path, param, pending);
+                        // Notify listeners
+                        notify_removed(path, param, pending);
+                    }
                 }
 
                 // Generate tasks for recursive search
@@ -1499,6 +1824,9 @@ namespace lsp
 
         void KVTStorage::destroy_node(kvt_node_t *node)
         {
+            index_remove(node);
+
+            size_t size     = node_size(node->idlen);
             node->id        = NULL;
             node->idlen     = 0;
             node->parent    = NULL;
@@ -1518,11 +1846,15 @@ namespace lsp
             node->nchildren = 0;
             node->capacity  = 0;
 
-            ::free(node);
+            sAllocator.free(node, size);
         }
 
         status_t KVTStorage::gc()
         {
+            // Branches modified by the batch should not be collected
+            if (nBatch > 0)
+                return STATUS_BAD_STATE;
+
             // Part 0: Destroy all iterators
             while (pIterators != NULL)
             {
@@ -1596,6 +1928,69 @@ namespace lsp
             return STATUS_OK;
         }
 
+        bool KVTStorage::batch_event(kvt_node_t *node, size_t pending)
+        {
+            if (nBatch <= 0)
+                return false;
+
+            // Account the change in the branch that contains the parameter
+            kvt_node_t *branch  = node->parent;
+            if ((branch->batch <= 0) && (!vBatch.add(branch)))
+                return false;
+
+            ++branch->batch;
+            branch->bpending   |= pending;
+
+            return true;
+        }
+
+        status_t KVTStorage::begin_batch()
+        {
+            ++nBatch;
+            return STATUS_OK;
+        }
+
+        status_t KVTStorage::end_batch()
+        {
+            if (nBatch <= 0)
+                return STATUS_BAD_STATE;
+            if ((--nBatch) > 0)
+                return STATUS_OK;
+
+            // Emit one notification per each modified branch
+            char *str = NULL, *path;
+            size_t capacity = 0;
+            const char root[2] = { cSeparator, '\0' };
+            status_t res = STATUS_OK;
+
+            for (size_t i=0, n=vBatch.size(); i<n; ++i)
+            {
+                kvt_node_t *branch  = vBatch.uget(i);
+                size_t count        = branch->batch;
+                size_t pending      = branch->bpending;
+                branch->batch       = 0;
+                branch->bpending    = 0;
+
+                if (res != STATUS_OK)
+                    continue;
+
+                path = (branch != &sRoot) ? build_path(&str, &capacity, branch) : const_cast<char *>(root);
+                if (path == NULL)
+                {
+                    res     = STATUS_NO_MEM;
+                    continue;
+                }
+
+                notify_updated(path, count, pending);
+            }
+
+            vBatch.clear();
+            if (str != NULL)
+                ::free(str);
+
+            return res;
+        }
+
         KVTIterator *KVTStorage::enum_tx_pending()
         {
             kvt_link_t *lnk = sTx.next;
@@ -1650,6 +2045,11 @@ namespace lsp
             sFake.children  = NULL;
             sFake.nchildren = 0;
             sFake.capacity  = 0;
+            sFake.unsorted  = false;
+            sFake.hash      = 0;
+            sFake.hnext     = NULL;
+            sFake.batch     = 0;
+            sFake.bpending  = 0;
 
             enMode          = mode;
             pCurr           = &sFake;
@@ -1662,6 +2062,10 @@ namespace lsp
 
             pGcNext         = storage->pIterators;
             storage->pIterators = this; // Link to the garbage
+
+            // Branch enumeration requires children to be sorted
+            if ((node != NULL) && ((mode == KVTStorage::IT_BRANCH) || (mode == KVTStorage::IT_RECURSIVE)))
+                storage->sort_children(node);
         }
 
         KVTIterator::~KVTIterator()
@@ -1812,6 +2216,7 @@ namespace lsp
                                 return STATUS_NO_MEM;
                             path->index = nIndex + 1;
                             path->node  = pCurr;
+                            pStorage->sort_children(pCurr);
                             pCurr       = pCurr->children[0];
                             nIndex      = 0;
                         }
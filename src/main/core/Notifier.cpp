@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 14 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/plug-fw/core/Notifier.h>
+#include <lsp-plug.in/plug-fw/core/atomic.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/ipc/Thread.h>
+
+#include <errno.h>
+
+namespace lsp
+{
+    namespace core
+    {
+        Notifier::Notifier()
+        {
+            nSerial     = 0;
+            nWaiting    = 0;
+            nSeen       = 0;
+            bInit       = false;
+        }
+
+        Notifier::~Notifier()
+        {
+            destroy();
+        }
+
+        status_t Notifier::init()
+        {
+            if (bInit)
+                return STATUS_OK;
+
+        #if defined(PLATFORM_WINDOWS)
+            hSem        = CreateSemaphoreW(NULL, 0, 0x7fffffff, NULL);
+            if (hSem == NULL)
+                return STATUS_NO_MEM;
+        #else
+            if (::sem_init(&hSem, 0, 0) != 0)
+                return STATUS_NO_MEM;
+        #endif /* PLATFORM_WINDOWS */
+
+            nSerial     = 0;
+            nWaiting    = 0;
+            nSeen       = 0;
+            bInit       = true;
+
+            return STATUS_OK;
+        }
+
+        void Notifier::destroy()
+        {
+            if (!bInit)
+                return;
+
+        #if defined(PLATFORM_WINDOWS)
+            CloseHandle(hSem);
+            hSem        = NULL;
+        #else
+            ::sem_destroy(&hSem);
+        #endif /* PLATFORM_WINDOWS */
+
+            bInit       = false;
+        }
+
+        void Notifier::sem_wait()
+        {
+        #if defined(PLATFORM_WINDOWS)
+            WaitForSingleObject(hSem, INFINITE);
+        #else
+            while ((::sem_wait(&hSem) != 0) && (errno == EINTR))
+                /* nothing */ ;
+        #endif /* PLATFORM_WINDOWS */
+        }
+
+        void Notifier::sem_post()
+        {
+        #if defined(PLATFORM_WINDOWS)
+            ReleaseSemaphore(hSem, 1, NULL);
+        #else
+            ::sem_post(&hSem);
+        #endif /* PLATFORM_WINDOWS */
+        }
+
+        void Notifier::notify()
+        {
+            atomic_add(&nSerial, 1);
+
+            // Perform the system call only if there is sleeping thread,
+            // the flag is reset by the first notifier only
+            if (bInit && atomic_cas(&nWaiting, 1, 0))
+                sem_post();
+        }
+
+        bool Notifier::pending() const
+        {
+            return atomic_load_acquire(&nSerial) != nSeen;
+        }
+
+        void Notifier::wait()
+        {
+            atomic_t serial     = atomic_load_acquire(&nSerial);
+            if (serial != nSeen)
+            {
+                nSeen               = serial;
+                return;
+            }
+
+            // No semaphore available, poll for notifications
+            if (!bInit)
+            {
+                ipc::Thread::sleep(NOTIFIER_POLL_PERIOD);
+                nSeen               = atomic_load_acquire(&nSerial);
+                return;
+            }
+
+            // Announce that we're going to sleep and check the serial again
+            // to not to miss the notification issued in between
+            atomic_swap(&nWaiting, 1);
+            if (atomic_load_acquire(&nSerial) != serial)
+            {
+                // Retract the flag. If it has already been reset by the notifier,
+                // there is a pending semaphore post that should be consumed
+                if (!atomic_cas(&nWaiting, 1, 0))
+                    sem_wait();
+            }
+            else
+                sem_wait();
+
+            nSeen               = atomic_load_acquire(&nSerial);
+        }
+    }
+}
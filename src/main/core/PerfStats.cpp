@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 24 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/plug-fw/core/PerfStats.h>
+#include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#if defined(PLATFORM_WINDOWS)
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif /* PLATFORM_WINDOWS */
+
+namespace lsp
+{
+    namespace core
+    {
+        static const char *perf_stage_names[] =
+        {
+            "pre",
+            "process",
+            "post"
+        };
+
+        PerfStats::PerfStats()
+        {
+            nPeriod         = PERF_PUBLISH_PERIOD;
+            clear();
+        }
+
+        PerfStats::~PerfStats()
+        {
+        }
+
+        uint64_t PerfStats::time()
+        {
+        #if defined(PLATFORM_WINDOWS)
+            LARGE_INTEGER freq, count;
+            ::QueryPerformanceFrequency(&freq);
+            ::QueryPerformanceCounter(&count);
+            return (uint64_t(count.QuadPart) / uint64_t(freq.QuadPart)) * 1000000000u +
+                   ((uint64_t(count.QuadPart) % uint64_t(freq.QuadPart)) * 1000000000u) / uint64_t(freq.QuadPart);
+        #else
+            struct timespec ts;
+            ::clock_gettime(CLOCK_MONOTONIC, &ts);
+            return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+        #endif /* PLATFORM_WINDOWS */
+        }
+
+        void PerfStats::clear()
+        {
+            ::memset(&sCurr, 0, sizeof(sCurr));
+            for (size_t i=0; i<=PERF_STAGES; ++i)
+                vStamp[i]       = 0;
+        }
+
+        bool PerfStats::end(size_t samples, float sample_rate)
+        {
+            if ((samples <= 0) || (sample_rate <= 0.0f))
+                return false;
+
+            // Compute time of each stage
+            uint64_t cycle      = 0;
+            for (size_t i=0; i<PERF_STAGES; ++i)
+            {
+                uint64_t t          = (vStamp[i+1] > vStamp[i]) ? vStamp[i+1] - vStamp[i] : 0;
+                sCurr.vTime[i]     += t;
+                if (sCurr.vMaxTime[i] < t)
+                    sCurr.vMaxTime[i]   = t;
+                cycle              += t;
+            }
+
+            // Compute the load against the budget
+            uint64_t budget     = (uint64_t(samples) * 1000000000u) / uint64_t(sample_rate);
+            float load          = (budget > 0) ? float(cycle) / float(budget) : 0.0f;
+            if (sCurr.fMaxLoad < load)
+                sCurr.fMaxLoad      = load;
+
+            // Update the histogram and xrun risk counters
+            ssize_t bucket      = load * (PERF_HIST_BUCKETS - 1);
+            if (load >= 1.0f)
+            {
+                bucket              = PERF_HIST_BUCKETS - 1;
+                ++sCurr.nOverruns;
+                ++sCurr.nTotalOverruns;
+            }
+            else if (bucket >= PERF_HIST_BUCKETS - 1)
+                bucket              = PERF_HIST_BUCKETS - 2;
+            if (load >= PERF_RISK_LOAD)
+            {
+                ++sCurr.nRisk;
+                ++sCurr.nTotalRisk;
+            }
+            ++sCurr.vHist[bucket];
+
+            // Update counters
+            ++sCurr.nCycles;
+            sCurr.nSamples     += samples;
+            sCurr.nBudget      += budget;
+
+            return sCurr.nBudget >= nPeriod;
+        }
+
+        void PerfStats::publish(perf_stats_t *dst)
+        {
+            *dst                = sCurr;
+            restart();
+        }
+
+        void PerfStats::restart()
+        {
+            // Reset counters of the period but keep total counters
+            uint64_t risk       = sCurr.nTotalRisk;
+            uint64_t overruns   = sCurr.nTotalOverruns;
+            ::memset(&sCurr, 0, sizeof(sCurr));
+            sCurr.nTotalRisk    = risk;
+            sCurr.nTotalOverruns= overruns;
+        }
+
+        status_t PerfStats::write(KVTStorage *kvt, const char *base, const perf_stats_t *stats)
+        {
+            char id[0x80];
+            status_t res;
+            const size_t flags  = KVT_TX | KVT_TRANSIENT;
+
+            #define PUT_VALUE(name, value) \
+                snprintf(id, sizeof(id), "%s%s", base, name); \
+                if ((res = kvt->put(id, value, flags)) != STATUS_OK) \
+                    return res;
+
+            // Overall statistics
+            float budget        = float(stats->nBudget);
+            uint64_t cycle      = 0;
+            for (size_t i=0; i<PERF_STAGES; ++i)
+                cycle              += stats->vTime[i];
+
+            PUT_VALUE("cycles", uint32_t(stats->nCycles));
+            PUT_VALUE("samples", uint64_t(stats->nSamples));
+            PUT_VALUE("load/avg", (budget > 0.0f) ? float(cycle) / budget : 0.0f);
+            PUT_VALUE("load/max", float(stats->fMaxLoad));
+            PUT_VALUE("xrun/risk", uint32_t(stats->nRisk));
+            PUT_VALUE("xrun/overruns", uint32_t(stats->nOverruns));
+            PUT_VALUE("xrun/total_risk", uint64_t(stats->nTotalRisk));
+            PUT_VALUE("xrun/total_overruns", uint64_t(stats->nTotalOverruns));
+
+            // Time of each stage in microseconds
+            char name[0x40];
+            for (size_t i=0; i<PERF_STAGES; ++i)
+            {
+                float avg           = (stats->nCycles > 0) ? float(stats->vTime[i]) / float(stats->nCycles) : 0.0f;
+
+                snprintf(name, sizeof(name), "time/%s/avg", perf_stage_names[i]);
+                PUT_VALUE(name, avg * 1e-3f);
+                snprintf(name, sizeof(name), "time/%s/max", perf_stage_names[i]);
+                PUT_VALUE(name, float(stats->vMaxTime[i]) * 1e-3f);
+            }
+
+            // Histogram of the load
+            for (size_t i=0; i<PERF_HIST_BUCKETS; ++i)
+            {
+                snprintf(name, sizeof(name), "hist/%02d", int(i));
+                PUT_VALUE(name, uint32_t(stats->vHist[i]));
+            }
+
+            #undef PUT_VALUE
+
+            return STATUS_OK;
+        }
+    }
+}
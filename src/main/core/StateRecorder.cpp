@@ -0,0 +1,432 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 22 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/plug-fw/core/StateRecorder.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RECORD_ALIGN        sizeof(uint64_t)
+
+namespace lsp
+{
+    namespace core
+    {
+        StateRecorder::StateRecorder()
+        {
+            vData       = NULL;
+            nSize       = 0;
+            nCapacity   = 0;
+            bOverflow   = false;
+        }
+
+        StateRecorder::~StateRecorder()
+        {
+            destroy();
+        }
+
+        status_t StateRecorder::init(size_t capacity)
+        {
+            capacity        = align_size(capacity, RECORD_ALIGN);
+            uint8_t *data   = static_cast<uint8_t *>(::malloc(capacity));
+            if (data == NULL)
+                return STATUS_NO_MEM;
+
+            destroy();
+
+            vData       = data;
+            nSize       = 0;
+            nCapacity   = capacity;
+            bOverflow   = false;
+
+            return STATUS_OK;
+        }
+
+        void StateRecorder::destroy()
+        {
+            if (vData != NULL)
+            {
+                ::free(vData);
+                vData       = NULL;
+            }
+
+            nSize       = 0;
+            nCapacity   = 0;
+            bOverflow   = false;
+        }
+
+        void StateRecorder::clear()
+        {
+            nSize       = 0;
+            bOverflow   = false;
+        }
+
+        uint8_t *StateRecorder::append(op_t op, type_t type, const char *name, size_t payload)
+        {
+            if (bOverflow)
+                return NULL;
+
+            size_t nlen     = (name != NULL) ? lsp_min(::strlen(name) + 1, size_t(0xffff)) : 0;
+            size_t szof     = align_size(sizeof(record_t) + nlen + payload, RECORD_ALIGN);
+            if ((nSize + szof > nCapacity) || (payload > 0xffffffff))
+            {
+                bOverflow       = true;
+                return NULL;
+            }
+
+            // Emit the header and the name
+            uint8_t *ptr    = &vData[nSize];
+            record_t *rec   = reinterpret_cast<record_t *>(ptr);
+            rec->op         = op;
+            rec->type       = type;
+            rec->name       = uint16_t(nlen);
+            rec->size       = uint32_t(payload);
+            ptr            += sizeof(record_t);
+            if (nlen > 0)
+            {
+                ::memcpy(ptr, name, nlen - 1);
+                ptr[nlen - 1]   = '\0';
+                ptr            += nlen;
+            }
+
+            nSize          += szof;
+            return ptr;
+        }
+
+        void StateRecorder::emit_scope(op_t op, const char *name, const void *ptr, size_t size)
+        {
+            uint8_t *dst    = append(op, T_NONE, name, sizeof(scope_t));
+            if (dst == NULL)
+                return;
+
+            scope_t s;
+            s.ptr           = ptr;
+            s.size          = size;
+            ::memcpy(dst, &s, sizeof(scope_t));
+        }
+
+        void StateRecorder::emit_value(type_t type, const char *name, const void *value, size_t size)
+        {
+            uint8_t *dst    = append(OP_VALUE, type, name, size);
+            if (dst != NULL)
+                ::memcpy(dst, value, size);
+        }
+
+        void StateRecorder::emit_string(const char *name, const char *value)
+        {
+            // NULL strings are emitted with empty payload
+            size_t len      = (value != NULL) ? ::strlen(value) + 1 : 0;
+            uint8_t *dst    = append(OP_VALUE, T_STRING, name, len);
+            if ((dst != NULL) && (len > 0))
+                ::memcpy(dst, value, len);
+        }
+
+        void StateRecorder::emit_vector(type_t type, const char *name, const void *value, size_t count, size_t szof)
+        {
+            // NULL vectors are emitted as NULL pointers
+            if (value == NULL)
+            {
+                emit_value(T_PTR, name, &value, sizeof(value));
+                return;
+            }
+
+            uint8_t *dst    = append(OP_VECTOR, type, name, sizeof(scope_t) + count * szof);
+            if (dst == NULL)
+                return;
+
+            scope_t s;
+            s.ptr           = value;
+            s.size          = count;
+            ::memcpy(dst, &s, sizeof(scope_t));
+            ::memcpy(&dst[sizeof(scope_t)], value, count * szof);
+        }
+
+        template <class T>
+            static inline T read_value(const uint8_t *data)
+            {
+                T v;
+                ::memcpy(&v, data, sizeof(T));
+                return v;
+            }
+
+        template <class T>
+            static inline void replay_typed_value(JsonDumper *dst, const char *name, const uint8_t *data)
+            {
+                if (name != NULL)
+                    dst->write(name, read_value<T>(data));
+                else
+                    dst->write(read_value<T>(data));
+            }
+
+        template <class T>
+            static inline void replay_typed_vector(JsonDumper *dst, const char *name, const void *ptr, size_t count, const uint8_t *data)
+            {
+                if (name != NULL)
+                    dst->begin_array(name, ptr, count);
+                else
+                    dst->begin_array(ptr, count);
+
+                for (size_t i=0; i<count; ++i, data += sizeof(T))
+                    dst->write(read_value<T>(data));
+
+                dst->end_array();
+            }
+
+        void StateRecorder::replay_value(JsonDumper *dst, type_t type, const char *name, const uint8_t *data, size_t size)
+        {
+            switch (type)
+            {
+                case T_PTR:     replay_typed_value<const void *>(dst, name, data); break;
+                case T_BOOL:    replay_typed_value<bool>(dst, name, data); break;
+                case T_U8:      replay_typed_value<uint8_t>(dst, name, data); break;
+                case T_I8:      replay_typed_value<int8_t>(dst, name, data); break;
+                case T_U16:     replay_typed_value<uint16_t>(dst, name, data); break;
+                case T_I16:     replay_typed_value<int16_t>(dst, name, data); break;
+                case T_U32:     replay_typed_value<uint32_t>(dst, name, data); break;
+                case T_I32:     replay_typed_value<int32_t>(dst, name, data); break;
+                case T_U64:     replay_typed_value<uint64_t>(dst, name, data); break;
+                case T_I64:     replay_typed_value<int64_t>(dst, name, data); break;
+                case T_F32:     replay_typed_value<float>(dst, name, data); break;
+                case T_F64:     replay_typed_value<double>(dst, name, data); break;
+                case T_STRING:
+                {
+                    const char *value   = (size > 0) ? reinterpret_cast<const char *>(data) : NULL;
+                    if (name != NULL)
+                        dst->write(name, value);
+                    else
+                        dst->write(value);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        void StateRecorder::replay_vector(JsonDumper *dst, type_t type, const char *name, const uint8_t *data)
+        {
+            scope_t s       = read_value<scope_t>(data);
+            data           += sizeof(scope_t);
+
+            switch (type)
+            {
+                case T_PTR:     replay_typed_vector<const void *>(dst, name, s.ptr, s.size, data); break;
+                case T_BOOL:    replay_typed_vector<bool>(dst, name, s.ptr, s.size, data); break;
+                case T_U8:      replay_typed_vector<uint8_t>(dst, name, s.ptr, s.size, data); break;
+                case T_I8:      replay_typed_vector<int8_t>(dst, name, s.ptr, s.size, data); break;
+                case T_U16:     replay_typed_vector<uint16_t>(dst, name, s.ptr, s.size, data); break;
+                case T_I16:     replay_typed_vector<int16_t>(dst, name, s.ptr, s.size, data); break;
+                case T_U32:     replay_typed_vector<uint32_t>(dst, name, s.ptr, s.size, data); break;
+                case T_I32:     replay_typed_vector<int32_t>(dst, name, s.ptr, s.size, data); break;
+                case T_U64:     replay_typed_vector<uint64_t>(dst, name, s.ptr, s.size, data); break;
+                case T_I64:     replay_typed_vector<int64_t>(dst, name, s.ptr, s.size, data); break;
+                case T_F32:     replay_typed_vector<float>(dst, name, s.ptr, s.size, data); break;
+                case T_F64:     replay_typed_vector<double>(dst, name, s.ptr, s.size, data); break;
+                default:
+                    break;
+            }
+        }
+
+        status_t StateRecorder::replay(JsonDumper *dst) const
+        {
+            lltl::darray<uint8_t> scopes;
+            uint8_t *scope;
+
+            for (size_t off = 0; off < nSize; )
+            {
+                const record_t *rec = reinterpret_cast<const record_t *>(&vData[off]);
+                const uint8_t *data = &vData[off + sizeof(record_t)];
+                const char *name    = (rec->name > 0) ? reinterpret_cast<const char *>(data) : NULL;
+                data               += rec->name;
+                off                += align_size(sizeof(record_t) + rec->name + rec->size, RECORD_ALIGN);
+
+                switch (rec->op)
+                {
+                    case OP_BEGIN_OBJECT:
+                    case OP_BEGIN_ARRAY:
+                    {
+                        scope_t s       = read_value<scope_t>(data);
+                        if (rec->op == OP_BEGIN_OBJECT)
+                        {
+                            if (name != NULL)
+                                dst->begin_object(name, s.ptr, s.size);
+                            else
+                                dst->begin_object(s.ptr, s.size);
+                        }
+                        else
+                        {
+                            if (name != NULL)
+                                dst->begin_array(name, s.ptr, s.size);
+                            else
+                                dst->begin_array(s.ptr, s.size);
+                        }
+                        if ((scope = scopes.push()) == NULL)
+                            return STATUS_NO_MEM;
+                        *scope          = rec->op;
+                        break;
+                    }
+                    case OP_BEGIN_RAW_OBJECT:
+                        if (name != NULL)
+                            dst->begin_raw_object(name);
+                        else
+                            dst->begin_raw_object();
+                        if ((scope = scopes.push()) == NULL)
+                            return STATUS_NO_MEM;
+                        *scope          = rec->op;
+                        break;
+                    case OP_END_OBJECT:
+                        dst->end_object();
+                        scopes.pop();
+                        break;
+                    case OP_END_ARRAY:
+                        dst->end_array();
+                        scopes.pop();
+                        break;
+                    case OP_END_RAW_OBJECT:
+                        dst->end_raw_object();
+                        scopes.pop();
+                        break;
+                    case OP_VALUE:
+                        replay_value(dst, type_t(rec->type), name, data, rec->size);
+                        break;
+                    case OP_VECTOR:
+                        replay_vector(dst, type_t(rec->type), name, data);
+                        break;
+                    default:
+                        return STATUS_CORRUPTED;
+                }
+            }
+
+            // Close all scopes that remain open after overflow
+            for (ssize_t i=scopes.size() - 1; i >= 0; --i)
+            {
+                switch (*scopes.uget(i))
+                {
+                    case OP_BEGIN_OBJECT:       dst->end_object(); break;
+                    case OP_BEGIN_ARRAY:        dst->end_array(); break;
+                    default:                    dst->end_raw_object(); break;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
+        void StateRecorder::begin_raw_object(const char *name)
+        {
+            append(OP_BEGIN_RAW_OBJECT, T_NONE, name, 0);
+        }
+
+        void StateRecorder::begin_raw_object()
+        {
+            append(OP_BEGIN_RAW_OBJECT, T_NONE, NULL, 0);
+        }
+
+        void StateRecorder::end_raw_object()
+        {
+            append(OP_END_RAW_OBJECT, T_NONE, NULL, 0);
+        }
+
+        void StateRecorder::begin_object(const char *name, const void *ptr, size_t szof)
+        {
+            emit_scope(OP_BEGIN_OBJECT, name, ptr, szof);
+        }
+
+        void StateRecorder::begin_object(const void *ptr, size_t szof)
+        {
+            emit_scope(OP_BEGIN_OBJECT, NULL, ptr, szof);
+        }
+
+        void StateRecorder::end_object()
+        {
+            append(OP_END_OBJECT, T_NONE, NULL, 0);
+        }
+
+        void StateRecorder::begin_array(const char *name, const void *ptr, size_t length)
+        {
+            emit_scope(OP_BEGIN_ARRAY, name, ptr, length);
+        }
+
+        void StateRecorder::begin_array(const void *ptr, size_t length)
+        {
+            emit_scope(OP_BEGIN_ARRAY, NULL, ptr, length);
+        }
+
+        void StateRecorder::end_array()
+        {
+            append(OP_END_ARRAY, T_NONE, NULL, 0);
+        }
+
+        void StateRecorder::write(const void *value)                        { emit_value(T_PTR, NULL, &value, sizeof(value));       }
+        void StateRecorder::write(const char *value)                        { emit_string(NULL, value);                             }
+        void StateRecorder::write(bool value)                               { emit_value(T_BOOL, NULL, &value, sizeof(value));      }
+        void StateRecorder::write(uint8_t value)                            { emit_value(T_U8, NULL, &value, sizeof(value));        }
+        void StateRecorder::write(int8_t value)                             { emit_value(T_I8, NULL, &value, sizeof(value));        }
+        void StateRecorder::write(uint16_t value)                           { emit_value(T_U16, NULL, &value, sizeof(value));       }
+        void StateRecorder::write(int16_t value)                            { emit_value(T_I16, NULL, &value, sizeof(value));       }
+        void StateRecorder::write(uint32_t value)                           { emit_value(T_U32, NULL, &value, sizeof(value));       }
+        void StateRecorder::write(int32_t value)                            { emit_value(T_I32, NULL, &value, sizeof(value));       }
+        void StateRecorder::write(uint64_t value)                           { emit_value(T_U64, NULL, &value, sizeof(value));       }
+        void StateRecorder::write(int64_t value)                            { emit_value(T_I64, NULL, &value, sizeof(value));       }
+        void StateRecorder::write(float value)                              { emit_value(T_F32, NULL, &value, sizeof(value));       }
+        void StateRecorder::write(double value)                             { emit_value(T_F64, NULL, &value, sizeof(value));       }
+
+        void StateRecorder::write(const char *name, const void *value)      { emit_value(T_PTR, name, &value, sizeof(value));       }
+        void StateRecorder::write(const char *name, const char *value)      { emit_string(name, value);                             }
+        void StateRecorder::write(const char *name, bool value)             { emit_value(T_BOOL, name, &value, sizeof(value));      }
+        void StateRecorder::write(const char *name, uint8_t value)          { emit_value(T_U8, name, &value, sizeof(value));        }
+        void StateRecorder::write(const char *name, int8_t value)           { emit_value(T_I8, name, &value, sizeof(value));        }
+        void StateRecorder::write(const char *name, uint16_t value)         { emit_value(T_U16, name, &value, sizeof(value));       }
+        void StateRecorder::write(const char *name, int16_t value)          { emit_value(T_I16, name, &value, sizeof(value));       }
+        void StateRecorder::write(const char *name, uint32_t value)         { emit_value(T_U32, name, &value, sizeof(value));       }
+        void StateRecorder::write(const char *name, int32_t value)          { emit_value(T_I32, name, &value, sizeof(value));       }
+        void StateRecorder::write(const char *name, uint64_t value)         { emit_value(T_U64, name, &value, sizeof(value));       }
+        void StateRecorder::write(const char *name, int64_t value)          { emit_value(T_I64, name, &value, sizeof(value));       }
+        void StateRecorder::write(const char *name, float value)            { emit_value(T_F32, name, &value, sizeof(value));       }
+        void StateRecorder::write(const char *name, double value)           { emit_value(T_F64, name, &value, sizeof(value));       }
+
+        void StateRecorder::writev(const void * const *value, size_t count) { emit_vector(T_PTR, NULL, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const bool *value, size_t count)         { emit_vector(T_BOOL, NULL, value, count, sizeof(*value));  }
+        void StateRecorder::writev(const uint8_t *value, size_t count)      { emit_vector(T_U8, NULL, value, count, sizeof(*value));    }
+        void StateRecorder::writev(const int8_t *value, size_t count)       { emit_vector(T_I8, NULL, value, count, sizeof(*value));    }
+        void StateRecorder::writev(const uint16_t *value, size_t count)     { emit_vector(T_U16, NULL, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const int16_t *value, size_t count)      { emit_vector(T_I16, NULL, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const uint32_t *value, size_t count)     { emit_vector(T_U32, NULL, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const int32_t *value, size_t count)      { emit_vector(T_I32, NULL, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const uint64_t *value, size_t count)     { emit_vector(T_U64, NULL, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const int64_t *value, size_t count)      { emit_vector(T_I64, NULL, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const float *value, size_t count)        { emit_vector(T_F32, NULL, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const double *value, size_t count)       { emit_vector(T_F64, NULL, value, count, sizeof(*value));   }
+
+        void StateRecorder::writev(const char *name, const void * const *value, size_t count)   { emit_vector(T_PTR, name, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const char *name, const bool *value, size_t count)           { emit_vector(T_BOOL, name, value, count, sizeof(*value));  }
+        void StateRecorder::writev(const char *name, const uint8_t *value, size_t count)        { emit_vector(T_U8, name, value, count, sizeof(*value));    }
+        void StateRecorder::writev(const char *name, const int8_t *value, size_t count)         { emit_vector(T_I8, name, value, count, sizeof(*value));    }
+        void StateRecorder::writev(const char *name, const uint16_t *value, size_t count)       { emit_vector(T_U16, name, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const char *name, const int16_t *value, size_t count)        { emit_vector(T_I16, name, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const char *name, const uint32_t *value, size_t count)       { emit_vector(T_U32, name, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const char *name, const int32_t *value, size_t count)        { emit_vector(T_I32, name, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const char *name, const uint64_t *value, size_t count)       { emit_vector(T_U64, name, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const char *name, const int64_t *value, size_t count)        { emit_vector(T_I64, name, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const char *name, const float *value, size_t count)          { emit_vector(T_F32, name, value, count, sizeof(*value));   }
+        void StateRecorder::writev(const char *name, const double *value, size_t count)         { emit_vector(T_F64, name, value, count, sizeof(*value));   }
+    }
+}
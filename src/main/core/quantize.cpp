@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 19 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/plug-fw/core/quantize.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <string.h>
+
+namespace lsp
+{
+    namespace core
+    {
+        uint16_t float_to_half(float value)
+        {
+            uint32_t u;
+            ::memcpy(&u, &value, sizeof(u));
+
+            uint32_t sign   = (u >> 16) & 0x8000;
+            u              &= 0x7fffffff;
+
+            // Infinity and NaN
+            if (u >= 0x7f800000)
+                return sign | 0x7c00 | ((u > 0x7f800000) ? 0x200 : 0);
+            // Values that overflow the half-precision range after rounding
+            if (u >= 0x477ff000)
+                return sign | 0x7c00;
+
+            // Denormalized values
+            if (u < 0x38800000)
+            {
+                uint32_t shift  = 126 - (u >> 23);
+                if (shift > 24)
+                    return sign;
+
+                uint32_t m      = (u & 0x7fffff) | 0x800000;
+                uint32_t h      = m >> shift;
+                uint32_t rem    = m & ((1 << shift) - 1);
+                uint32_t half   = 1 << (shift - 1);
+                if ((rem > half) || ((rem == half) && (h & 1)))
+                    ++h;
+                return sign | h;
+            }
+
+            // Normalized values, rounding may carry into the exponent
+            uint32_t h      = (u - 0x38000000) >> 13;
+            uint32_t rem    = u & 0x1fff;
+            if ((rem > 0x1000) || ((rem == 0x1000) && (h & 1)))
+                ++h;
+
+            return sign | h;
+        }
+
+        float half_to_float(uint16_t value)
+        {
+            uint32_t sign   = uint32_t(value & 0x8000) << 16;
+            uint32_t e      = (value >> 10) & 0x1f;
+            uint32_t m      = value & 0x3ff;
+            uint32_t u;
+
+            if (e == 0)
+            {
+                // Zero and denormalized values
+                float f         = m * (1.0f / 16777216.0f);
+                ::memcpy(&u, &f, sizeof(u));
+                u              |= sign;
+            }
+            else if (e == 0x1f)
+                u               = sign | 0x7f800000 | (m << 13);
+            else
+                u               = sign | ((e + 112) << 23) | (m << 13);
+
+            float res;
+            ::memcpy(&res, &u, sizeof(res));
+            return res;
+        }
+
+        float quantize_int16(int16_t *dst, const float *src, size_t count)
+        {
+            float peak      = (count > 0) ? dsp::abs_max(src, count) : 0.0f;
+            if (!(peak > 0.0f) || (peak > 1e+30f))
+            {
+                // Silence or non-finite data
+                ::memset(dst, 0, count * sizeof(int16_t));
+                return 0.0f;
+            }
+
+            float k         = 32767.0f / peak;
+            for (size_t i=0; i<count; ++i)
+            {
+                // Comparisons are written to map NaN values to zero
+                float v         = src[i] * k;
+                dst[i]          = (v >= 0.0f) ? int16_t(lsp_min(v + 0.5f, 32767.0f)) :
+                                  (v < 0.0f) ? int16_t(lsp_max(v - 0.5f, -32767.0f)) : 0;
+            }
+
+            return peak / 32767.0f;
+        }
+
+        void dequantize_int16(float *dst, const int16_t *src, float scale, size_t count)
+        {
+            for (size_t i=0; i<count; ++i)
+                dst[i]          = src[i] * scale;
+        }
+
+        float quantize_half(uint16_t *dst, const float *src, size_t count)
+        {
+            float peak      = (count > 0) ? dsp::abs_max(src, count) : 0.0f;
+            if (!(peak > 0.0f) || (peak > 1e+30f))
+            {
+                // Silence or non-finite data
+                ::memset(dst, 0, count * sizeof(uint16_t));
+                return 0.0f;
+            }
+
+            float k         = 1.0f / peak;
+            for (size_t i=0; i<count; ++i)
+                dst[i]          = float_to_half(src[i] * k);
+
+            return peak;
+        }
+
+        void dequantize_half(float *dst, const uint16_t *src, float scale, size_t count)
+        {
+            for (size_t i=0; i<count; ++i)
+                dst[i]          = half_to_float(src[i]) * scale;
+        }
+
+        void quantize_log(uint16_t *dst, const float *src, size_t count, size_t bits)
+        {
+            const float qmax    = (bits > 8) ? 65535.0f : 255.0f;
+            const float vmin    = expf(LOG_QUANT_DB_MIN * M_LN10 / 20.0f);
+            const float kdb     = (qmax - 1.0f) * 20.0f / (M_LN10 * (LOG_QUANT_DB_MAX - LOG_QUANT_DB_MIN));
+            const float lmin    = LOG_QUANT_DB_MIN * M_LN10 / 20.0f;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                // Comparisons are written to map NaN values to zero
+                float v         = src[i];
+                if (!(v > vmin))
+                {
+                    dst[i]          = 0;
+                    continue;
+                }
+                float q         = (logf(v) - lmin) * kdb + 1.5f;
+                dst[i]          = uint16_t(lsp_min(q, qmax));
+            }
+        }
+
+        void dequantize_log(float *dst, const uint16_t *src, size_t count, size_t bits)
+        {
+            const float qmax    = (bits > 8) ? 65535.0f : 255.0f;
+            const float kdb     = (M_LN10 * (LOG_QUANT_DB_MAX - LOG_QUANT_DB_MIN)) / ((qmax - 1.0f) * 20.0f);
+            const float lmin    = LOG_QUANT_DB_MIN * M_LN10 / 20.0f;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                uint16_t q      = src[i];
+                dst[i]          = (q > 0) ? expf(lmin + (q - 1) * kdb) : 0.0f;
+            }
+        }
+
+        /*
+         * Encoded row starts with the header byte which contains the number of bytes
+         * per code and the delta flag. Then follows the sequence of runs, each run
+         * starts with the control byte:
+         *   0x00-0x7f: (c + 1) codes are equal to the codes of the previous row
+         *   0x80-0xff: (c - 0x7f) differences against the previous row follow
+         */
+        #define ROW_DELTA           0x01
+        #define ROW_BYTES_SHIFT     1
+        #define ROW_RUN_MAX         0x80
+
+        static inline void put_code(uint8_t *dst, uint16_t code, size_t bytes)
+        {
+            dst[0]      = uint8_t(code);
+            if (bytes > 1)
+                dst[1]      = uint8_t(code >> 8);
+        }
+
+        static inline uint16_t get_code(const uint8_t *src, size_t bytes)
+        {
+            return (bytes > 1) ? uint16_t(src[0] | (src[1] << 8)) : src[0];
+        }
+
+        size_t encoded_row_size(size_t count, size_t bits)
+        {
+            size_t bytes    = (bits > 8) ? 2 : 1;
+            return 1 + count * bytes + (count + ROW_RUN_MAX - 1) / ROW_RUN_MAX;
+        }
+
+        size_t encode_row(uint8_t *dst, const uint16_t *row, const uint16_t *prev, size_t count, size_t bits)
+        {
+            size_t bytes    = (bits > 8) ? 2 : 1;
+            uint16_t mask   = (bits > 8) ? 0xffff : 0xff;
+            uint8_t *p      = dst;
+
+            *(p++)          = uint8_t((bytes << ROW_BYTES_SHIFT) | ((prev != NULL) ? ROW_DELTA : 0));
+
+            for (size_t i=0; i<count; )
+            {
+                // Count unchanged codes
+                size_t n        = 0;
+                if (prev != NULL)
+                {
+                    while ((i + n < count) && (n < ROW_RUN_MAX) && (row[i + n] == prev[i + n]))
+                        ++n;
+                }
+                else
+                {
+                    while ((i + n < count) && (n < ROW_RUN_MAX) && (row[i + n] == 0))
+                        ++n;
+                }
+
+                // Single unchanged code is cheaper to emit as a part of the literal run
+                if ((n > 1) || (i + n >= count))
+                {
+                    *(p++)          = uint8_t(n - 1);
+                    i              += n;
+                    continue;
+                }
+
+                // Emit the literal run until at least two unchanged codes are met
+                uint8_t *ctl    = p++;
+                n               = 0;
+                while ((i < count) && (n < ROW_RUN_MAX))
+                {
+                    uint16_t ref    = (prev != NULL) ? prev[i] : 0;
+                    if ((i + 1 < count) && (row[i] == ref) && (row[i + 1] == ((prev != NULL) ? prev[i + 1] : 0)))
+                        break;
+                    put_code(p, uint16_t(row[i] - ref) & mask, bytes);
+                    p              += bytes;
+                    ++i;
+                    ++n;
+                }
+                *ctl            = uint8_t(0x7f + n);
+            }
+
+            return p - dst;
+        }
+
+        status_t decode_row(uint16_t *row, const uint16_t *prev, const uint8_t *src, size_t size, size_t count, size_t bits)
+        {
+            size_t bytes    = (bits > 8) ? 2 : 1;
+            uint16_t mask   = (bits > 8) ? 0xffff : 0xff;
+            if (size < 1)
+                return STATUS_CORRUPTED;
+
+            // Check the header
+            uint8_t hdr     = *(src++);
+            --size;
+            if ((hdr >> ROW_BYTES_SHIFT) != bytes)
+                return STATUS_BAD_FORMAT;
+            if (!(hdr & ROW_DELTA))
+                prev            = NULL;
+            else if (prev == NULL)
+                return STATUS_NO_DATA;
+
+            // Decode runs
+            for (size_t i=0; i<count; )
+            {
+                if (size < 1)
+                    return STATUS_CORRUPTED;
+                size_t c        = *(src++);
+                --size;
+
+                if (c < 0x80)
+                {
+                    size_t n        = c + 1;
+                    if (n > count - i)
+                        return STATUS_CORRUPTED;
+                    for ( ; n > 0; --n, ++i)
+                        row[i]          = (prev != NULL) ? prev[i] : 0;
+                }
+                else
+                {
+                    size_t n        = c - 0x7f;
+                    if ((n > count - i) || (n * bytes > size))
+                        return STATUS_CORRUPTED;
+                    for ( ; n > 0; --n, ++i, src += bytes, size -= bytes)
+                        row[i]          = (get_code(src, bytes) + ((prev != NULL) ? prev[i] : 0)) & mask;
+                }
+            }
+
+            return (size == 0) ? STATUS_OK : STATUS_CORRUPTED;
+        }
+    }
+}
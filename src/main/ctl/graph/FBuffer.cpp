@@ -62,6 +62,10 @@ namespace lsp
 
             pPort           = NULL;
             nRowID          = 0;
+            nRows           = 0;
+            nCols           = 0;
+            bHidden         = false;
+            bViewer         = false;
         }
 
         FBuffer::~FBuffer()
@@ -82,11 +86,23 @@ namespace lsp
                 sHScale.init(pWrapper, fb->hscale());
                 sVScale.init(pWrapper, fb->vscale());
                 sMode.init(pWrapper, this);
+
+                fb->slots()->bind(tk::SLOT_SHOW, slot_show, this);
+                fb->slots()->bind(tk::SLOT_HIDE, slot_hide, this);
             }
 
             return STATUS_OK;
         }
 
+        void FBuffer::destroy()
+        {
+            if ((bViewer) && (pPort != NULL))
+                pPort->remove_viewer(!bHidden);
+            bViewer         = false;
+
+            Widget::destroy();
+        }
+
         void FBuffer::set(ui::UIContext *ctx, const char *name, const char *value)
         {
             tk::GraphFrameBuffer *fb   = tk::widget_cast<tk::GraphFrameBuffer>(wWidget);
@@ -125,33 +141,78 @@ namespace lsp
                 if (sMode.depends(port))
                     fb->function()->set_index(sMode.evaluate_int());
 
-                // Deploy new value for framebuffer
-                const meta::port_t *mdata = (pPort != NULL) ? pPort->metadata() : NULL;
-                if (meta::is_framebuffer_port(mdata))
-                {
-                    plug::frame_buffer_t *data  = pPort->buffer<plug::frame_buffer_t>();
-                    if (data != NULL)
-                    {
-                        // Set the proper size of the buffer
-                        fb->data()->set_size(data->rows(), data->cols());
-
-                        // Append the desired number of rows
-                        size_t rowid                = data->next_rowid();
-                        size_t delta                = rowid - nRowID;
-                        if (delta > fb->data()->rows())
-                            nRowID                      = rowid - fb->data()->rows();
-
-                        while (nRowID != rowid)
-                        {
-                            float *row = data->get_row(nRowID++);
-                            if (row != NULL)
-                                fb->data()->set_row(nRowID, row);
-                        }
-                    }
-                }
+                // Deploy new rows of the framebuffer
+                if (port == pPort)
+                    sync_rows();
             }
         }
 
+        void FBuffer::sync_rows()
+        {
+            // Rows of the hidden widget are uploaded when it becomes visible
+            if (bHidden)
+                return;
+
+            tk::GraphFrameBuffer *fb   = tk::widget_cast<tk::GraphFrameBuffer>(wWidget);
+            const meta::port_t *mdata   = (pPort != NULL) ? pPort->metadata() : NULL;
+            if ((fb == NULL) || (!meta::is_framebuffer_port(mdata)))
+                return;
+
+            plug::frame_buffer_t *data  = pPort->buffer<plug::frame_buffer_t>();
+            if (data == NULL)
+                return;
+
+            // Set the proper size of the buffer, resizing clears the widget data
+            if ((nRows != data->rows()) || (nCols != data->cols()))
+            {
+                nRows                       = data->rows();
+                nCols                       = data->cols();
+                fb->data()->set_size(nRows, nCols);
+            }
+
+            // Append only rows which are not committed yet, rows which would be
+            // overwritten in the widget by the following ones are skipped
+            size_t rowid                = data->next_rowid();
+            size_t delta                = rowid - nRowID;
+            if (delta > fb->data()->rows())
+                nRowID                      = rowid - fb->data()->rows();
+
+            while (nRowID != rowid)
+            {
+                float *row = data->get_row(nRowID++);
+                if (row != NULL)
+                    fb->data()->set_row(nRowID, row);
+            }
+        }
+
+        void FBuffer::set_hidden(bool hidden)
+        {
+            if (bHidden == hidden)
+                return;
+
+            bHidden         = hidden;
+            if ((bViewer) && (pPort != NULL))
+                pPort->set_viewer_visible(!hidden);
+            if (!hidden)
+                sync_rows();
+        }
+
+        status_t FBuffer::slot_show(tk::Widget *sender, void *ptr, void *data)
+        {
+            FBuffer *_this = static_cast<FBuffer *>(ptr);
+            if (_this != NULL)
+                _this->set_hidden(false);
+            return STATUS_OK;
+        }
+
+        status_t FBuffer::slot_hide(tk::Widget *sender, void *ptr, void *data)
+        {
+            FBuffer *_this = static_cast<FBuffer *>(ptr);
+            if (_this != NULL)
+                _this->set_hidden(true);
+            return STATUS_OK;
+        }
+
         void FBuffer::trigger_expr()
         {
             tk::GraphFrameBuffer *fb   = tk::widget_cast<tk::GraphFrameBuffer>(wWidget);
@@ -164,6 +225,13 @@ namespace lsp
 
         void FBuffer::end(ui::UIContext *ctx)
         {
+            // Report the visibility of the widget to let the plugin skip computation of rows
+            if ((!bViewer) && (pPort != NULL))
+            {
+                pPort->add_viewer(!bHidden);
+                bViewer         = true;
+            }
+
             trigger_expr();
         }
 
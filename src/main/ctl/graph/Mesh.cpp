@@ -73,6 +73,8 @@ namespace lsp
             nYIndex         = -1;
             nSIndex         = -1;
             nMaxDots        = -1;
+            bHidden         = false;
+            bViewer         = false;
         }
 
         Mesh::~Mesh()
@@ -99,11 +101,23 @@ namespace lsp
                 sSIndex.init(pWrapper, this);
                 sMaxDots.init(pWrapper, this);
                 sStrobe.init(pWrapper, this);
+
+                gm->slots()->bind(tk::SLOT_SHOW, slot_show, this);
+                gm->slots()->bind(tk::SLOT_HIDE, slot_hide, this);
             }
 
             return STATUS_OK;
         }
 
+        void Mesh::destroy()
+        {
+            if ((bViewer) && (pPort != NULL))
+                pPort->remove_viewer(!bHidden);
+            bViewer         = false;
+
+            Widget::destroy();
+        }
+
         void Mesh::set(ui::UIContext *ctx, const char *name, const char *value)
         {
             tk::GraphMesh *gm   = tk::widget_cast<tk::GraphMesh>(wWidget);
@@ -294,9 +308,43 @@ namespace lsp
             }
         }
 
+        void Mesh::set_hidden(bool hidden)
+        {
+            if (bHidden == hidden)
+                return;
+
+            bHidden         = hidden;
+            if ((bViewer) && (pPort != NULL))
+                pPort->set_viewer_visible(!hidden);
+        }
+
+        status_t Mesh::slot_show(tk::Widget *sender, void *ptr, void *data)
+        {
+            Mesh *_this = static_cast<Mesh *>(ptr);
+            if (_this != NULL)
+                _this->set_hidden(false);
+            return STATUS_OK;
+        }
+
+        status_t Mesh::slot_hide(tk::Widget *sender, void *ptr, void *data)
+        {
+            Mesh *_this = static_cast<Mesh *>(ptr);
+            if (_this != NULL)
+                _this->set_hidden(true);
+            return STATUS_OK;
+        }
+
         void Mesh::end(ui::UIContext *ctx)
         {
             Widget::end(ctx);
+
+            // Report the visibility of the widget to let the plugin skip computation of the mesh
+            if ((!bViewer) && (pPort != NULL))
+            {
+                pPort->add_viewer(!bHidden);
+                bViewer         = true;
+            }
+
             trigger_expr();
         }
 
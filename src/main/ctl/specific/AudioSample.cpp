@@ -25,6 +25,12 @@
 #include <lsp-plug.in/fmt/url.h>
 #include <lsp-plug.in/io/InStringSequence.h>
 #include <lsp-plug.in/expr/Tokenizer.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+#define LOD_BUCKET_SIZE         4       /* Number of source samples per min/max pair at the finest level */
+#define LOD_SAMPLES_PER_PIXEL   2       /* Maximum number of points per pixel passed to the widget */
+#define LOD_DEFAULT_WIDTH       1024    /* Estimated width of the widget if it is not realized yet */
 
 namespace lsp
 {
@@ -183,6 +189,13 @@ namespace lsp
             pMenu           = NULL;
             pDataSink       = NULL;
             pDragInSink     = NULL;
+
+            vLod            = NULL;
+            nLodChannels    = 0;
+            nLodSamples     = 0;
+            nLodStride      = 0;
+            nLodCapacity    = 0;
+            nLodLevel       = -1;
         }
 
         AudioSample::~AudioSample()
@@ -229,6 +242,13 @@ namespace lsp
             }
 
             vClipboardBind.flush();
+
+            // Destroy pyramid
+            if (vLod != NULL)
+            {
+                free(vLod);
+                vLod        = NULL;
+            }
         }
 
         status_t AudioSample::init()
@@ -285,6 +305,7 @@ namespace lsp
                 // Bind slot
                 as->slots()->bind(tk::SLOT_SUBMIT, slot_audio_sample_submit, this);
                 as->slots()->bind(tk::SLOT_DRAG_REQUEST, slot_drag_request, this);
+                as->slots()->bind(tk::SLOT_RESIZE, slot_resize, this);
                 as->active()->set(true);
 
                 // Create menu item
@@ -489,14 +510,19 @@ namespace lsp
                 sync_status();
 
             if ((port == pMeshPort) ||
-                (port == pPort) ||
-                (sFadeIn.depends(port)) ||
+                (port == pPort))
+            {
+                sync_mesh();
+                sync_labels();
+            }
+            else if ((sFadeIn.depends(port)) ||
                 (sFadeOut.depends(port)) ||
                 (sHeadCut.depends(port)) ||
                 (sTailCut.depends(port)) ||
                 (sLength.depends(port)))
             {
-                sync_mesh();
+                // The pyramid does not depend on these values
+                sync_samples(true);
                 sync_labels();
             }
         }
@@ -639,13 +665,130 @@ namespace lsp
                 as->channels()->madd(ac);
             }
 
+            // Build the pyramid and synchronize mesh state
+            build_lod(mesh);
+            sync_samples(true);
+        }
+
+        void AudioSample::build_lod(const plug::mesh_t *mesh)
+        {
+            size_t channels = mesh->nBuffers;
+            size_t samples  = mesh->nItems;
+
+            nLodChannels    = 0;
+            nLodSamples     = samples;
+            nLodStride      = 0;
+            nLodLevel       = -1;
+
+            // Estimate the size of the pyramid
+            size_t stride   = 0;
+            for (size_t bucket = LOD_BUCKET_SIZE; samples > bucket; bucket <<= 1)
+                stride         += ((samples + bucket - 1) / bucket) * 2;
+            if ((stride <= 0) || (channels <= 0))
+                return;
+
+            size_t capacity = stride * channels;
+            if (capacity > nLodCapacity)
+            {
+                float *buf      = static_cast<float *>(realloc(vLod, capacity * sizeof(float)));
+                if (buf == NULL)
+                    return;
+                vLod            = buf;
+                nLodCapacity    = capacity;
+            }
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                const float *src    = mesh->pvData[i];
+                float *dst          = &vLod[i * stride];
+
+                // The finest level is computed from the source data
+                size_t pairs        = 0;
+                for (size_t off=0; off < samples; off += LOD_BUCKET_SIZE, ++pairs)
+                    dsp::minmax(&src[off], lsp_min(size_t(LOD_BUCKET_SIZE), samples - off), &dst[pairs*2], &dst[pairs*2 + 1]);
+
+                // Each coarser level is computed from the previous one
+                for (size_t bucket = LOD_BUCKET_SIZE << 1; samples > bucket; bucket <<= 1)
+                {
+                    const float *prev   = dst;
+                    size_t prev_pairs   = pairs;
+                    dst                += pairs * 2;
+                    pairs               = (prev_pairs + 1) >> 1;
+
+                    for (size_t j=0; j<pairs; ++j, prev += 4)
+                    {
+                        if ((j*2 + 1) < prev_pairs)
+                        {
+                            dst[j*2]            = lsp_min(prev[0], prev[2]);
+                            dst[j*2 + 1]        = lsp_max(prev[1], prev[3]);
+                        }
+                        else
+                        {
+                            dst[j*2]            = prev[0];
+                            dst[j*2 + 1]        = prev[1];
+                        }
+                    }
+                }
+            }
+
+            nLodChannels    = channels;
+            nLodStride      = stride;
+        }
+
+        ssize_t AudioSample::select_lod(size_t width) const
+        {
+            // Pass source data if there are not too many samples
+            if ((nLodChannels <= 0) || (nLodSamples <= width * LOD_SAMPLES_PER_PIXEL))
+                return -1;
+
+            // Select the coarsest level which still has at least one min/max pair per pixel
+            ssize_t level   = 0;
+            for (size_t bucket = LOD_BUCKET_SIZE << 1; nLodSamples > bucket; bucket <<= 1, ++level)
+            {
+                if (((nLodSamples + bucket - 1) / bucket) < width)
+                    break;
+            }
+
+            return level;
+        }
+
+        const float *AudioSample::lod_data(size_t channel, ssize_t level, size_t *count) const
+        {
+            const float *ptr    = &vLod[channel * nLodStride];
+            size_t bucket       = LOD_BUCKET_SIZE;
+
+            for (ssize_t i=0; i<level; ++i, bucket <<= 1)
+                ptr                += ((nLodSamples + bucket - 1) / bucket) * 2;
+
+            *count              = ((nLodSamples + bucket - 1) / bucket) * 2;
+            return ptr;
+        }
+
+        void AudioSample::sync_samples(bool force)
+        {
+            plug::mesh_t *mesh = (pMeshPort != NULL) ? pMeshPort->buffer<plug::mesh_t>() : NULL;
+            if ((mesh == NULL) || (mesh->nBuffers <= 0))
+                return;
+
+            tk::AudioSample *as     = tk::widget_cast<tk::AudioSample>(wWidget);
+            if (as == NULL)
+                return;
+
+            // Select the level of the pyramid which matches the width of the widget
+            ws::rectangle_t r;
+            as->get_rectangle(&r);
+            size_t width    = (r.nWidth > 0) ? r.nWidth : LOD_DEFAULT_WIDTH;
+            ssize_t level   = (mesh->nItems == nLodSamples) ? select_lod(width) : -1;
+            if ((!force) && (level == nLodLevel))
+                return;
+            nLodLevel       = level;
+
             // Synchronize mesh state
-            size_t samples = mesh->nItems;
-            float length   = sLength.evaluate_float() - sHeadCut.evaluate_float() - sTailCut.evaluate_float();
-            float fade_in  = (length > 0) ? samples * (sFadeIn.evaluate_float() / length) : 0.0f;
-            float fade_out = (length > 0) ? samples * (sFadeOut.evaluate_float() / length) : 0.0f;
+            float length    = sLength.evaluate_float() - sHeadCut.evaluate_float() - sTailCut.evaluate_float();
+            float k_fade_in = (length > 0) ? sFadeIn.evaluate_float() / length : 0.0f;
+            float k_fade_out= (length > 0) ? sFadeOut.evaluate_float() / length : 0.0f;
 
-            for (size_t i=0; i<allocate; ++i)
+            for (size_t i=0, n=as->channels()->size(); i<n; ++i)
             {
                 size_t src_idx = lsp_min(i, mesh->nBuffers-1);
                 tk::AudioChannel *ac = as->channels()->get(i);
@@ -653,11 +796,13 @@ namespace lsp
                     continue;
 
                 // Update mesh
-                ac->samples()->set(mesh->pvData[src_idx], samples);
+                size_t samples  = mesh->nItems;
+                const float *v  = (level >= 0) ? lod_data(src_idx, level, &samples) : mesh->pvData[src_idx];
+                ac->samples()->set(v, samples);
 
                 // Update fades
-                ac->fade_in()->set(fade_in);
-                ac->fade_out()->set(fade_out);
+                ac->fade_in()->set(samples * k_fade_in);
+                ac->fade_out()->set(samples * k_fade_out);
             }
         }
 
@@ -860,6 +1005,14 @@ namespace lsp
             return STATUS_OK;
         }
 
+        status_t AudioSample::slot_resize(tk::Widget *sender, void *ptr, void *data)
+        {
+            AudioSample *_this  = static_cast<AudioSample *>(ptr);
+            if (_this != NULL)
+                _this->sync_samples(false);
+            return STATUS_OK;
+        }
+
         status_t AudioSample::slot_drag_request(tk::Widget *sender, void *ptr, void *data)
         {
             AudioSample *_this  = static_cast<AudioSample *>(ptr);
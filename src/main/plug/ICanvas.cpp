@@ -20,6 +20,7 @@
  */
 
 #include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
 
 namespace lsp
 {
@@ -31,11 +32,59 @@ namespace lsp
             sData.nHeight   = 0;
             sData.nStride   = 0;
             sData.pData     = NULL;
+            vGraph          = NULL;
+            nGraphItems     = 0;
         }
 
         ICanvas::~ICanvas()
         {
             destroy();
+
+            if (vGraph != NULL)
+            {
+                free(vGraph);
+                vGraph          = NULL;
+            }
+            nGraphItems     = 0;
+        }
+
+        float *ICanvas::graph_buffer(size_t items)
+        {
+            if (items <= nGraphItems)
+                return vGraph;
+
+            float *buf      = static_cast<float *>(realloc(vGraph, items * 2 * sizeof(float)));
+            if (buf == NULL)
+                return NULL;
+
+            vGraph          = buf;
+            nGraphItems     = items;
+            return buf;
+        }
+
+        void ICanvas::transform_graph(float *dx, float *dy, const float *x, const float *y,
+                const canvas_transform_t *t, size_t count)
+        {
+            const float xx = t->xx, xy = t->xy, yx = t->yx, yy = t->yy;
+            const float x0 = t->x0, y0 = t->y0;
+
+            if ((xy == 0.0f) && (yx == 0.0f))
+            {
+                // Axis-aligned transform, the most common case
+                for (size_t i=0; i<count; ++i)
+                {
+                    dx[i]           = x[i] * xx + x0;
+                    dy[i]           = y[i] * yy + y0;
+                }
+            }
+            else
+            {
+                for (size_t i=0; i<count; ++i)
+                {
+                    dx[i]           = x[i] * xx + y[i] * yx + x0;
+                    dy[i]           = x[i] * xy + y[i] * yy + y0;
+                }
+            }
         }
 
         bool ICanvas::init(size_t width, size_t height)
@@ -115,6 +164,51 @@ namespace lsp
         {
         }
 
+        void ICanvas::draw_graph(const float * const *v, size_t lines, size_t items,
+                const canvas_transform_t *t, const canvas_series_t *series, size_t count)
+        {
+            if ((v == NULL) || (t == NULL) || (series == NULL) || (items < 2))
+                return;
+
+            float *x        = graph_buffer(items);
+            if (x == NULL)
+                return;
+            float *y        = &x[items];
+
+            for (size_t i=0; i<count; ++i)
+            {
+                const canvas_series_t *s = &series[i];
+                if ((s->nX >= lines) || (s->nY >= lines))
+                    continue;
+
+                transform_graph(x, y, v[s->nX], v[s->nY], t, items);
+                set_line_width(s->fWidth);
+                if (s->nFlags & CANVAS_SERIES_FILL)
+                    draw_poly(x, y, items, s->sStroke, s->sFill);
+                else
+                {
+                    set_color(s->sStroke);
+                    draw_lines(x, y, items);
+                }
+            }
+        }
+
+        void ICanvas::draw_buffer(const core::IDBuffer *buf, const canvas_transform_t *t, const canvas_series_t *series, size_t count)
+        {
+            if (buf == NULL)
+                return;
+            draw_graph(buf->v, buf->lines, buf->items, t, series, count);
+        }
+
+        void ICanvas::draw_mesh(mesh_t *mesh, const canvas_transform_t *t, const canvas_series_t *series, size_t count)
+        {
+            if (mesh == NULL)
+                return;
+            mesh->consume();
+            const mesh_frame_t *f = mesh->front();
+            draw_graph(f->vData, f->nBuffers, f->nItems, t, series, count);
+        }
+
         void ICanvas::circle(ssize_t x, ssize_t y, ssize_t r)
         {
         }
@@ -56,5 +56,34 @@ namespace lsp
         void IPort::post_process(size_t samples)
         {
         }
+
+        ui_feedback_t *IPort::feedback()
+        {
+            if (pMetadata == NULL)
+                return NULL;
+
+            switch (pMetadata->role)
+            {
+                case meta::R_MESH:
+                {
+                    mesh_t *mesh = buffer<mesh_t>();
+                    return (mesh != NULL) ? mesh->feedback() : NULL;
+                }
+                case meta::R_STREAM:
+                {
+                    stream_t *stream = buffer<stream_t>();
+                    return (stream != NULL) ? stream->feedback() : NULL;
+                }
+                case meta::R_FBUFFER:
+                {
+                    frame_buffer_t *fb = buffer<frame_buffer_t>();
+                    return (fb != NULL) ? fb->feedback() : NULL;
+                }
+                default:
+                    break;
+            }
+
+            return NULL;
+        }
     }
 } /* namespace lsp */
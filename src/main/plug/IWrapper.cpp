@@ -20,26 +20,189 @@
  */
 
 #include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/common/atomic.h>
 #include <lsp-plug.in/common/debug.h>
 #include <lsp-plug.in/runtime/system.h>
 #include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
 #include <lsp-plug.in/plug-fw/core/JsonDumper.h>
+#include <lsp-plug.in/plug-fw/core/atomic.h>
+
+#define STATE_DUMP_SIZE         0x400000    /* Initial size of the state dump buffer */
+#define STATE_DUMP_MAX_SIZE     0x4000000   /* Maximum size of the state dump buffer */
 
 namespace lsp
 {
     namespace plug
     {
+        IWrapper::StateDumpTask::StateDumpTask(IWrapper *wrapper, ipc::IExecutor *executor)
+        {
+            pWrapper        = wrapper;
+            pExecutor       = executor;
+            pMeta           = NULL;
+            pObject         = NULL;
+        }
+
+        IWrapper::StateDumpTask::~StateDumpTask()
+        {
+            sRecorder.destroy();
+        }
+
+        status_t IWrapper::StateDumpTask::run()
+        {
+            status_t res = pWrapper->write_plugin_state(pMeta, pObject, &sRecorder);
+
+            // Grow the buffer for the next dump if the state did not fit into it
+            size_t capacity = sRecorder.capacity();
+            if ((sRecorder.overflow()) && (capacity < STATE_DUMP_MAX_SIZE))
+            {
+                capacity        = lsp_min(capacity * 4, size_t(STATE_DUMP_MAX_SIZE));
+                lsp_warn("State dump has been truncated, increasing buffer size to %d bytes", int(capacity));
+                if (sRecorder.init(capacity) != STATUS_OK)
+                    lsp_warn("Could not increase size of the state dump buffer");
+            }
+
+            return res;
+        }
+
+        IWrapper::PerfStatsTask::PerfStatsTask(IWrapper *wrapper, ipc::IExecutor *executor)
+        {
+            pWrapper        = wrapper;
+            pExecutor       = executor;
+            ::memset(&sStats, 0, sizeof(sStats));
+        }
+
+        IWrapper::PerfStatsTask::~PerfStatsTask()
+        {
+        }
+
+        status_t IWrapper::PerfStatsTask::run()
+        {
+            core::KVTStorage *kvt = pWrapper->kvt_lock();
+            if (kvt == NULL)
+                return STATUS_OK;
+
+            status_t res = core::PerfStats::write(kvt, PERF_KVT_BRANCH, &sStats);
+            kvt->gc();
+            pWrapper->kvt_release();
+
+            return res;
+        }
+
+        IWrapper::InlineDisplayTask::InlineDisplayTask(IWrapper *wrapper, ipc::IExecutor *executor)
+        {
+            pWrapper        = wrapper;
+            pExecutor       = executor;
+            nDirty          = 1;
+            nSize           = 0;
+            nBack           = 0;
+            nFront          = 1;
+            nMiddle         = 2;
+            bPublished      = false;
+
+            for (size_t i=0; i<3; ++i)
+            {
+                plug::canvas_data_t *f  = &vFrames[i];
+                f->nWidth       = 0;
+                f->nHeight      = 0;
+                f->nStride      = 0;
+                f->pData        = NULL;
+                vCapacity[i]    = 0;
+            }
+        }
+
+        IWrapper::InlineDisplayTask::~InlineDisplayTask()
+        {
+            for (size_t i=0; i<3; ++i)
+            {
+                plug::canvas_data_t *f  = &vFrames[i];
+                if (f->pData != NULL)
+                {
+                    ::free(f->pData);
+                    f->pData        = NULL;
+                }
+                vCapacity[i]    = 0;
+            }
+        }
+
+        status_t IWrapper::InlineDisplayTask::run()
+        {
+            uatomic_t size  = core::atomic_load_acquire(&nSize);
+            size_t width    = size >> 16;
+            size_t height   = size & 0xffff;
+            bPublished      = false;
+
+            // Render the inline display
+            plug::ICanvas *canvas = pWrapper->create_canvas(width, height);
+            if (canvas == NULL)
+                return STATUS_NO_DATA;
+
+            bool res = pWrapper->pPlugin->inline_display(canvas, width, height);
+            canvas->sync();
+
+            plug::canvas_data_t *data = canvas->data();
+            if ((!res) || (data == NULL) || (data->pData == NULL))
+                return STATUS_OK;
+
+            // Copy canvas data to the back frame
+            plug::canvas_data_t *f  = &vFrames[nBack];
+            size_t row_size         = data->nWidth * sizeof(uint32_t);
+            size_t bytes            = row_size * data->nHeight;
+            if (vCapacity[nBack] < bytes)
+            {
+                uint8_t *ptr            = static_cast<uint8_t *>(::realloc(f->pData, bytes));
+                if (ptr == NULL)
+                    return STATUS_NO_MEM;
+                f->pData                = ptr;
+                vCapacity[nBack]        = bytes;
+            }
+
+            for (size_t i=0; i<data->nHeight; ++i)
+                ::memcpy(&f->pData[i * row_size], &data->pData[i * data->nStride], row_size);
+            f->nWidth               = data->nWidth;
+            f->nHeight              = data->nHeight;
+            f->nStride              = row_size;
+
+            // Publish the back frame and take the previous middle frame as the back frame
+            atomic_t prev           = atomic_swap(&nMiddle, atomic_t(nBack | INLINE_DISPLAY_FRESH));
+            nBack                   = prev & (~INLINE_DISPLAY_FRESH);
+            bPublished              = true;
+
+            return STATUS_OK;
+        }
+
+        plug::canvas_data_t *IWrapper::InlineDisplayTask::consume()
+        {
+            if (core::atomic_load_acquire(&nMiddle) & INLINE_DISPLAY_FRESH)
+            {
+                atomic_t prev           = atomic_swap(&nMiddle, atomic_t(nFront));
+                nFront                  = prev & (~INLINE_DISPLAY_FRESH);
+            }
+
+            plug::canvas_data_t *f  = &vFrames[nFront];
+            return (f->pData != NULL) ? f : NULL;
+        }
+
         IWrapper::IWrapper(Module *plugin, resource::ILoader *loader)
         {
             pPlugin         = plugin;
             pLoader         = loader;
             pCanvas         = NULL;
+            pDumpTask       = NULL;
+            pPerfTask       = NULL;
+            pDisplayTask    = NULL;
 
             position_t::init(&sPosition);
         }
 
         IWrapper::~IWrapper()
         {
+            // Drop state dump, performance statistics and inline display tasks
+            destroy_state_dump();
+            destroy_perf_stats();
+            destroy_inline_display();
+
             // Drop canvas
             if (pCanvas != NULL)
             {
@@ -86,11 +249,229 @@ namespace lsp
         {
         }
 
+        void IWrapper::prepare_state_dump()
+        {
+            if ((pPlugin == NULL) || (pDumpTask != NULL))
+                return;
+
+            const meta::plugin_t *meta = pPlugin->metadata();
+            if ((meta == NULL) || (!(meta->extensions & meta::E_DUMP_STATE)))
+                return;
+
+            // Obtain the executor service, the state will be dumped synchronously if it is not available
+            ipc::IExecutor *executor = this->executor();
+            if (executor == NULL)
+            {
+                lsp_warn("No executor service available, state dumps will be performed synchronously");
+                return;
+            }
+
+            StateDumpTask *task = new StateDumpTask(this, executor);
+            if (task == NULL)
+                return;
+            if (task->sRecorder.init(STATE_DUMP_SIZE) != STATUS_OK)
+            {
+                delete task;
+                return;
+            }
+
+            pDumpTask       = task;
+        }
+
+        void IWrapper::destroy_state_dump()
+        {
+            if (pDumpTask == NULL)
+                return;
+
+            delete pDumpTask;
+            pDumpTask       = NULL;
+        }
+
+        void IWrapper::init_perf_stats()
+        {
+            if ((pPlugin == NULL) || (pPerfTask != NULL))
+                return;
+
+            // Check that KVT is supported by the wrapper
+            core::KVTStorage *kvt = kvt_lock();
+            if (kvt == NULL)
+                return;
+            kvt_release();
+
+            // Obtain the executor service, statistics are not collected if it is not available
+            ipc::IExecutor *executor = this->executor();
+            if (executor == NULL)
+                return;
+
+            PerfStatsTask *task = new PerfStatsTask(this, executor);
+            if (task == NULL)
+                return;
+
+            sPerf.clear();
+            pPerfTask       = task;
+        }
+
+        void IWrapper::destroy_perf_stats()
+        {
+            if (pPerfTask == NULL)
+                return;
+
+            delete pPerfTask;
+            pPerfTask       = NULL;
+        }
+
+        void IWrapper::perf_end(size_t samples)
+        {
+            PerfStatsTask *task = pPerfTask;
+            if ((task == NULL) || (pPlugin == NULL))
+                return;
+            if (!sPerf.end(samples, pPlugin->get_sample_rate()))
+                return;
+
+            // Publish statistics only while the UI is connected, there is no consumer otherwise
+            if (!pPlugin->ui_active())
+            {
+                sPerf.restart();
+                return;
+            }
+
+            // Keep collecting statistics if the previous snapshot is still being published
+            if (task->completed())
+                task->reset();
+            if (!task->idle())
+                return;
+
+            // Take the snapshot and submit the task
+            sPerf.publish(&task->sStats);
+            if (!task->pExecutor->submit(task))
+                lsp_warn("Could not submit the performance statistics task");
+        }
+
+        void IWrapper::init_inline_display()
+        {
+            if ((pPlugin == NULL) || (pDisplayTask != NULL))
+                return;
+
+            const meta::plugin_t *meta = pPlugin->metadata();
+            if ((meta == NULL) || (!(meta->extensions & meta::E_INLINE_DISPLAY)))
+                return;
+
+            // Obtain the executor service, the inline display will be rendered synchronously if it is not available
+            ipc::IExecutor *executor = this->executor();
+            if (executor == NULL)
+            {
+                lsp_warn("No executor service available, inline display will be rendered synchronously");
+                return;
+            }
+
+            InlineDisplayTask *task = new InlineDisplayTask(this, executor);
+            if (task == NULL)
+                return;
+
+            pDisplayTask    = task;
+        }
+
+        void IWrapper::destroy_inline_display()
+        {
+            if (pDisplayTask == NULL)
+                return;
+
+            delete pDisplayTask;
+            pDisplayTask    = NULL;
+        }
+
+        bool IWrapper::update_inline_display(bool invalidate)
+        {
+            InlineDisplayTask *task = pDisplayTask;
+            if (task == NULL)
+                return invalidate;
+            if (invalidate)
+                core::atomic_store_release(&task->nDirty, uatomic_t(1));
+
+            // Check that the new frame has been rendered and published
+            bool ready  = false;
+            if (task->completed())
+            {
+                ready       = task->bPublished;
+                task->reset();
+            }
+            if (!task->idle())
+                return ready;
+
+            // Do not render until the host tells the size of the frame, but
+            // notify the host to make it request the frame
+            if (core::atomic_load_acquire(&task->nSize) == 0)
+                return ready || invalidate;
+            if (core::atomic_exchange(&task->nDirty, uatomic_t(0)) == 0)
+                return ready;
+
+            if (!task->pExecutor->submit(task))
+                core::atomic_store_release(&task->nDirty, uatomic_t(1));
+
+            return ready;
+        }
+
+        plug::canvas_data_t *IWrapper::inline_display_frame(size_t width, size_t height)
+        {
+            InlineDisplayTask *task = pDisplayTask;
+            if (task == NULL)
+                return NULL;
+
+            // Request re-rendering if the size of the frame has changed
+            width       = lsp_min(width, size_t(0xffff));
+            height      = lsp_min(height, size_t(0xffff));
+            uatomic_t size  = (width << 16) | height;
+            if (core::atomic_load_acquire(&task->nSize) != size)
+            {
+                core::atomic_store_release(&task->nSize, size);
+                core::atomic_store_release(&task->nDirty, uatomic_t(1));
+            }
+
+            // Return the last rendered frame if it fits the requested size
+            plug::canvas_data_t *f  = task->consume();
+            if ((f == NULL) || (f->nWidth > width) || (f->nHeight > height))
+                return NULL;
+
+            return f;
+        }
+
         void IWrapper::dump_plugin_state()
         {
             if (pPlugin == NULL)
                 return;
 
+            // Dump the state synchronously if deferred dump is not available
+            StateDumpTask *task = pDumpTask;
+            if (task == NULL)
+            {
+                write_plugin_state(pPlugin->metadata(), pPlugin, NULL);
+                return;
+            }
+
+            // Check that the previous dump has been completed
+            if (task->completed())
+                task->reset();
+            if (!task->idle())
+            {
+                lsp_warn("The previous state dump is still in progress");
+                return;
+            }
+
+            // Record the state and submit the task for serialization
+            task->pMeta     = pPlugin->metadata();
+            task->pObject   = pPlugin;
+            task->sRecorder.clear();
+            pPlugin->dump(&task->sRecorder);
+
+            if (!task->pExecutor->submit(task))
+                lsp_warn("Could not submit the state dump task");
+        }
+
+        status_t IWrapper::write_plugin_state(const meta::plugin_t *meta, const void *object, const core::StateRecorder *data)
+        {
+            if (meta == NULL)
+                return STATUS_BAD_ARGUMENTS;
+
             const meta::package_t *pkg = package();
 
             LSPString tmp;
@@ -99,33 +480,29 @@ namespace lsp
             if ((res = system::get_temporary_dir(&path)) != STATUS_OK)
             {
                 lsp_warn("Could not obtain temporary directory: %d", int(res));
-                return;
+                return res;
             }
 
             if (tmp.fmt_utf8("%s-dumps", pkg->artifact) <= 0)
             {
                 lsp_warn("Could not form path to directory: %d", int(res));
-                return;
+                return STATUS_NO_MEM;
             }
             if ((res = path.append_child(&tmp)) != STATUS_OK)
             {
                 lsp_warn("Could not form path to directory: %d", int(res));
-                return;
+                return res;
             }
             if ((res = path.mkdir(true)) != STATUS_OK)
             {
                 lsp_warn("Could not create directory %s: %d", path.as_utf8(), int(res));
-                return;
+                return res;
             }
 
             // Get current time
             system::localtime_t t;
             system::get_localtime(&t);
 
-            const meta::plugin_t *meta = pPlugin->metadata();
-            if (meta == NULL)
-                return;
-
             // Build the file name
             LSPString fname;
             if (!fname.fmt_ascii("%04d%02d%02d-%02d%02d%02d-%03d-%s.json",
@@ -134,13 +511,13 @@ namespace lsp
                 ))
             {
                 lsp_warn("Could not format the file name");
-                return;
+                return STATUS_NO_MEM;
             }
 
             if ((res = path.append_child(&fname)) != STATUS_OK)
             {
                 lsp_warn("Could not form the file name: %d", int(res));
-                return;
+                return res;
             }
 
             lsp_info("Dumping plugin state to file:\n%s...", path.as_utf8());
@@ -149,7 +526,7 @@ namespace lsp
             if ((res = v.open(&path)) != STATUS_OK)
             {
                 lsp_warn("Could not create file %s: %d", path.as_utf8(), int(res));
-                return;
+                return res;
             }
 
             v.begin_raw_object();
@@ -183,18 +560,32 @@ namespace lsp
                 v.write("ladspa_label", meta->ladspa_lbl);
 
                 // Dump object contents
-                v.write("this", pPlugin);
+                v.write("this", object);
                 v.begin_raw_object("data");
                 {
-                    pPlugin->dump(&v);
+                    if (data != NULL)
+                        res     = data->replay(&v);
+                    else
+                        pPlugin->dump(&v);
                 }
                 v.end_raw_object();
+
+                // Notify that the recorded state is incomplete
+                if ((data != NULL) && (data->overflow()))
+                    v.write("truncated", true);
             }
 
             v.end_raw_object();
             v.close();
 
+            if (res != STATUS_OK)
+            {
+                lsp_warn("Could not write the state to file %s: %d", path.as_utf8(), int(res));
+                return res;
+            }
+
             lsp_info("State has been dumped to file:\n%s", path.as_utf8());
+            return STATUS_OK;
         }
 
         const meta::package_t *IWrapper::package() const
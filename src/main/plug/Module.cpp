@@ -32,8 +32,10 @@ namespace lsp
             pWrapper        = NULL;
             fSampleRate     = -1;
             nLatency        = 0;
+            nSubBlock       = 0;
             bActivated      = false;
             bUIActive       = false;
+            sUIFeedback.reset();
         }
 
         Module::~Module()
@@ -60,6 +62,21 @@ namespace lsp
             ui_deactivated();
         }
 
+        float Module::ui_refresh_rate()
+        {
+            return (bUIActive) ? sUIFeedback.rate(MESH_REFRESH_RATE) : 0.0f;
+        }
+
+        float Module::ui_refresh_rate(IPort *port)
+        {
+            float rate          = ui_refresh_rate();
+            if ((rate <= 0.0f) || (port == NULL))
+                return rate;
+
+            ui_feedback_t *fb   = port->feedback();
+            return (fb != NULL) ? lsp_min(rate, fb->rate(rate)) : rate;
+        }
+
         void Module::activate()
         {
             if (bActivated)
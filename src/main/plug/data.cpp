@@ -25,6 +25,7 @@
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/common/atomic.h>
 #include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/stdlib/math.h>
 #include <lsp-plug.in/stdlib/stdlib.h>
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/dsp-units/const.h>
@@ -71,6 +72,136 @@ namespace lsp
             return false;
         }
 
+        //-------------------------------------------------------------------------
+        // ui_feedback_t methods
+        void ui_feedback_t::report(float rate)
+        {
+            uint32_t value  = 0;
+            if (rate > 0.0f)
+                value           = (rate < 1e+6f) ? uint32_t(rate * 1000.0f) : UI_FEEDBACK_UNKNOWN - 1;
+
+            core::atomic_store_relaxed(&nRate, value);
+        }
+
+        float ui_feedback_t::rate(float dfl) const
+        {
+            uint32_t value  = core::atomic_load_relaxed(&nRate);
+            return (value != UI_FEEDBACK_UNKNOWN) ? value / 1000.0f : dfl;
+        }
+
+        //-------------------------------------------------------------------------
+        // mesh_t methods
+        mesh_t *mesh_t::create(size_t buffers, size_t items)
+        {
+            size_t sz_of    = align_size(sizeof(mesh_t) + sizeof(float *) * buffers, DEFAULT_ALIGN);
+            size_t sz_ptr   = align_size(sizeof(float *) * buffers, DEFAULT_ALIGN);
+            size_t sz_buf   = align_size(sizeof(float) * items, DEFAULT_ALIGN);
+            size_t to_alloc = sz_of + (sz_ptr + sz_buf * buffers) * 3;
+
+            uint8_t *pdata  = NULL;
+            uint8_t *ptr    = alloc_aligned<uint8_t>(pdata, to_alloc, DEFAULT_ALIGN);
+            if (ptr == NULL)
+                return NULL;
+
+            mesh_t *mesh            = reinterpret_cast<mesh_t *>(ptr);
+            ptr                    += sz_of;
+
+            mesh->nState            = M_EMPTY;
+            mesh->nBuffers          = 0;
+            mesh->nItems            = 0;
+            mesh->nMaxBuffers       = buffers;
+            mesh->nMaxItems         = items;
+            mesh->nBack             = 0;
+            mesh->nFront            = 1;
+            mesh->nMiddle           = 2;
+            mesh->pData             = pdata;
+            mesh->sFeedback.reset();
+
+            for (size_t i=0; i<3; ++i)
+            {
+                mesh_frame_t *f         = &mesh->vFrames[i];
+                f->nBuffers             = 0;
+                f->nItems               = 0;
+                f->vData                = reinterpret_cast<float **>(ptr);
+                ptr                    += sz_ptr;
+            }
+
+            for (size_t i=0; i<3; ++i)
+            {
+                mesh_frame_t *f         = &mesh->vFrames[i];
+                for (size_t j=0; j<buffers; ++j)
+                {
+                    f->vData[j]             = (items > 0) ? reinterpret_cast<float *>(ptr) : NULL;
+                    ptr                    += sz_buf;
+                }
+            }
+
+            for (size_t j=0; j<buffers; ++j)
+                mesh->pvData[j]         = mesh->vFrames[0].vData[j];
+
+            return mesh;
+        }
+
+        void mesh_t::destroy(mesh_t *mesh)
+        {
+            if (mesh == NULL)
+                return;
+            uint8_t *data   = mesh->pData;
+            if (data == NULL)
+                return;
+
+            mesh->pData     = NULL;
+            free_aligned(data);
+        }
+
+        void mesh_t::data(size_t bufs, size_t items)
+        {
+            mesh_frame_t *f = &vFrames[nBack];
+            f->nBuffers     = bufs;
+            f->nItems       = items;
+            nBuffers        = bufs;
+            nItems          = items;
+
+            // Publish the back frame and take the previous middle frame as the back frame
+            atomic_t prev   = atomic_swap(&nMiddle, atomic_t(nBack | MESH_FRESH));
+            nBack           = prev & (~MESH_FRESH);
+            nState          = M_DATA;
+
+            // Update pointers to the back frame and carry the published data forward:
+            // the producer may update only some buffers before the next publishing
+            mesh_frame_t *b = &vFrames[nBack];
+            for (size_t i=0; i<nMaxBuffers; ++i)
+            {
+                pvData[i]       = b->vData[i];
+                if (nMaxItems > 0)
+                    dsp::copy(b->vData[i], f->vData[i], nMaxItems);
+            }
+            b->nBuffers     = bufs;
+            b->nItems       = items;
+        }
+
+        bool mesh_t::consume()
+        {
+            if (!(core::atomic_load_acquire(&nMiddle) & MESH_FRESH))
+                return false;
+
+            atomic_t prev   = atomic_swap(&nMiddle, atomic_t(nFront));
+            nFront          = prev & (~MESH_FRESH);
+            return true;
+        }
+
+        void mesh_t::view(mesh_t *dst) const
+        {
+            const mesh_frame_t *f   = &vFrames[nFront];
+            size_t bufs             = lsp_min(f->nBuffers, dst->nMaxBuffers);
+
+            for (size_t i=0; i<bufs; ++i)
+                dst->pvData[i]          = f->vData[i];
+            dst->nBuffers           = bufs;
+            dst->nItems             = f->nItems;
+            dst->nState             = M_DATA;
+        }
+
         //-------------------------------------------------------------------------
         // stream_t methods
         stream_t *stream_t::create(size_t channels, size_t frames, size_t capacity)
@@ -104,6 +235,7 @@ namespace lsp
             mesh->nFrameCap         = fcap;
 
             mesh->nFrameId          = 0;
+            mesh->sFeedback.reset();
 
             mesh->vFrames           = reinterpret_cast<frame_t *>(ptr);
             ptr                    += sz_frm;
@@ -305,6 +437,42 @@ namespace lsp
             return count;
         }
 
+        ssize_t stream_t::read_frame(size_t channel, uint32_t frame, float *data, size_t off, size_t count)
+        {
+            if (channel >= nChannels)
+                return -STATUS_INVALID_VALUE;
+
+            // Check that the frame is still present
+            const frame_t *frm  = &vFrames[frame & (nFrameCap - 1)];
+            if (frm->id != frame)
+                return -STATUS_NOT_FOUND;
+
+            // Estimate the offset and number of items to read
+            ssize_t size        = frm->tail - frm->head;
+            if (size < 0)
+                size               += nBufCap;
+            if (off >= size_t(size))
+                return -STATUS_EOF;
+            count               = lsp_min(count, size - off);
+
+            // Determine position of head
+            size_t head         = frm->head + off;
+            if (head >= nBufCap)
+                head               -= nBufCap;
+
+            size_t tail         = head + count;
+            const float *s      = vChannels[channel];
+            if (tail > nBufCap)
+            {
+                dsp::copy(data, &s[head], nBufCap - head);
+                dsp::copy(&data[nBufCap - head], s, tail - nBufCap);
+            }
+            else
+                dsp::copy(data, &s[head], count);
+
+            return count;
+        }
+
         bool stream_t::commit_frame()
         {
             size_t frame_id = nFrameId + 1;
@@ -539,6 +707,7 @@ namespace lsp
             fb->nRowID          = rows;
             fb->vData           = reinterpret_cast<float *>(ptr);
             fb->pData           = data;
+            fb->sFeedback.reset();
 
             dsp::fill_zero(fb->vData, rows * cols);
             return fb;
@@ -568,6 +737,7 @@ namespace lsp
             nRowID              = rows;
             vData               = reinterpret_cast<float *>(ptr);
             pData               = data;
+            sFeedback.reset();
 
             dsp::fill_zero(vData, rows * cols);
             return STATUS_OK;
@@ -603,36 +773,54 @@ namespace lsp
             pos->ticksPerBeat   = DEFAULT_TICKS_PER_BEAT;
         }
 
+        void position_t::advance(position_t *pos, size_t samples)
+        {
+            double frame        = double(pos->frame) + samples * pos->speed;
+            pos->frame          = (frame > 0.0) ? uint64_t(frame) : 0;
+            if ((pos->sampleRate <= 0.0f) || (pos->ticksPerBeat <= 0.0))
+                return;
+
+            double tick         = pos->tick + (samples * pos->speed * pos->beatsPerMinute * pos->ticksPerBeat) / (60.0 * pos->sampleRate);
+            tick                = fmod(tick, pos->ticksPerBeat);
+            pos->tick           = (tick < 0.0) ? tick + pos->ticksPerBeat : tick;
+        }
+
         //-------------------------------------------------------------------------
         // osc_buffer_t methods
+        static const uint32_t OSC_BUFFER_PADDING    = 0xffffffffU;
+
         osc_buffer_t *osc_buffer_t::create(size_t capacity)
         {
-            if (capacity % sizeof(uint32_t))
+            if ((!capacity) || (capacity % sizeof(uint32_t)))
                 return NULL;
 
-            uint8_t *tmp        = reinterpret_cast<uint8_t *>(malloc(0x1000));
-            if (tmp == NULL)
+            // Round capacity to the nearest power of 2 to allow free-running counters
+            size_t cap          = sizeof(uint32_t);
+            while (cap < capacity)
+                cap               <<= 1;
+            if (cap > 0x80000000U)
                 return NULL;
 
-            size_t to_alloc     = sizeof(osc_buffer_t) + capacity + DEFAULT_ALIGN;
+            size_t hdr_size     = align_size(sizeof(osc_buffer_t), OPTIMAL_ALIGN);
+            size_t to_alloc     = hdr_size + cap;
             void *data          = NULL;
-            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc, DEFAULT_ALIGN);
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc, OPTIMAL_ALIGN);
             if (ptr == NULL)
-            {
-                free(tmp);
                 return NULL;
-            }
 
             osc_buffer_t *res   = reinterpret_cast<osc_buffer_t *>(ptr);
-            ptr                += align_size(sizeof(osc_buffer_t), DEFAULT_ALIGN);
+            ptr                += hdr_size;
 
-            res->nSize          = 0;
-            res->nCapacity      = capacity;
             res->nHead          = 0;
+            res->nTailCache     = 0;
             res->nTail          = 0;
+            res->nHeadCache     = 0;
+            res->nResPad        = 0;
+            res->nResSize       = 0;
+            res->nForgeMax      = lsp_min(size_t(0x1000), cap - sizeof(uint32_t));
+            res->nCapacity      = cap;
+            res->nMask          = uint32_t(cap - 1);
             res->pBuffer        = ptr;
-            res->pTempBuf       = tmp;
-            res->nTempSize      = 0x1000;
             res->pData          = data;
 
             return res;
@@ -640,66 +828,124 @@ namespace lsp
 
         void osc_buffer_t::destroy(osc_buffer_t *buf)
         {
-            if (buf->pTempBuf != NULL)
-            {
-                free(buf->pTempBuf);
-                buf->pTempBuf   = NULL;
-            }
             if ((buf != NULL) && (buf->pData != NULL))
                 free_aligned(buf->pData);
         }
 
-        status_t osc_buffer_t::submit(const void *data, size_t size)
+        status_t osc_buffer_t::reserve_packet(void **data, size_t *size, size_t limit)
         {
-            if ((!size) || (size % sizeof(uint32_t)))
+            if ((data == NULL) || (size == NULL))
+                return STATUS_BAD_ARGUMENTS;
+            limit          &= ~size_t(sizeof(uint32_t) - 1);
+            if (limit <= 0)
                 return STATUS_BAD_ARGUMENTS;
 
-            // Ensure that there is enough space in buffer
-            size_t oldsize  = nSize;
-            size_t newsize  = oldsize + size + sizeof(uint32_t);
-            if (newsize > nCapacity)
-                return (oldsize == 0) ? STATUS_TOO_BIG : STATUS_OVERFLOW;
-
-            // Store packet size to the buffer and move the tail
-            *(reinterpret_cast<uint32_t *>(&pBuffer[nTail])) = CPU_TO_BE(uint32_t(size));
-            nTail          += sizeof(uint32_t);
-            if (nTail > nCapacity)
-                nTail          -= nCapacity;
-
-            // Store packet data and move the tail
-            size_t head     = nCapacity - nTail;
-            if (size > head)
+            uint32_t tail   = nTail;
+            size_t off      = tail & nMask;
+            size_t tspace   = nCapacity - off;  // Contiguous space till the end of the ring
+            limit          += sizeof(uint32_t); // Take the record header into account
+
+            // Estimate free space, re-read the head position only if the cached
+            // one does not give enough space
+            size_t space    = nCapacity - uint32_t(tail - nHeadCache);
+            size_t head     = lsp_min(space, tspace);
+            size_t wrap     = (space > tspace) ? space - tspace : 0;
+            if ((head < limit) && (wrap < limit))
             {
-                const uint8_t *src  = reinterpret_cast<const uint8_t *>(data);
-                ::memcpy(&pBuffer[nTail], src, head);
-                ::memcpy(pBuffer, &src[head], size - head);
+                nHeadCache      = core::atomic_load_acquire(&nHead);
+                space           = nCapacity - uint32_t(tail - nHeadCache);
+                head            = lsp_min(space, tspace);
+                wrap            = (space > tspace) ? space - tspace : 0;
+            }
+
+            // Select the region: prefer the tail of the ring, use the beginning
+            // of the ring and emit padding record only if it gives more space
+            if ((head >= limit) || (head >= wrap))
+            {
+                nResPad         = 0;
+                nResSize        = lsp_min(head, limit);
+                *data           = &pBuffer[off + sizeof(uint32_t)];
             }
             else
-                ::memcpy(&pBuffer[nTail], data, size);
+            {
+                nResPad         = tspace;
+                nResSize        = lsp_min(wrap, limit);
+                *data           = &pBuffer[sizeof(uint32_t)];
+            }
+
+            if (nResSize <= sizeof(uint32_t))
+            {
+                cancel_packet();
+                return STATUS_OVERFLOW;
+            }
 
-            nTail          += size;
-            if (nTail > nCapacity)
-                nTail          -= nCapacity;
+            nResSize       -= sizeof(uint32_t);
+            *size           = nResSize;
 
-            // Update the size
-            nSize           = newsize;
             return STATUS_OK;
         }
 
-        status_t osc_buffer_t::reserve(size_t size)
+        status_t osc_buffer_t::commit_packet(size_t size)
         {
-            if (nTempSize >= size)
-                return STATUS_OK;
-            else if (size > nCapacity)
+            if (nResSize <= 0)
+                return STATUS_BAD_STATE;
+            if ((!size) || (size % sizeof(uint32_t)) || (size > nResSize))
+            {
+                cancel_packet();
+                return STATUS_BAD_ARGUMENTS;
+            }
+
+            // Emit padding record if required and store the packet size
+            uint32_t tail   = nTail;
+            size_t off      = tail & nMask;
+            if (nResPad > 0)
+            {
+                *(reinterpret_cast<uint32_t *>(&pBuffer[off])) = OSC_BUFFER_PADDING;
+                off             = 0;
+            }
+            *(reinterpret_cast<uint32_t *>(&pBuffer[off])) = CPU_TO_BE(uint32_t(size));
+            tail           += nResPad + size + sizeof(uint32_t);
+            cancel_packet();
+
+            // Publish the record to the reader
+            core::atomic_store_release(&nTail, tail);
+            return STATUS_OK;
+        }
+
+        void osc_buffer_t::cancel_packet()
+        {
+            nResPad         = 0;
+            nResSize        = 0;
+        }
+
+        status_t osc_buffer_t::submit(const void *data, size_t size)
+        {
+            if ((!size) || (size % sizeof(uint32_t)))
+                return STATUS_BAD_ARGUMENTS;
+            if ((size + sizeof(uint32_t)) > nCapacity)
+                return STATUS_TOO_BIG;
+
+            void *ptr       = NULL;
+            size_t avail    = 0;
+            status_t res    = reserve_packet(&ptr, &avail, size);
+            if (res != STATUS_OK)
+                return res;
+            if (avail < size)
+            {
+                cancel_packet();
                 return STATUS_OVERFLOW;
+            }
 
-            uint8_t *tmp    = reinterpret_cast<uint8_t *>(realloc(pTempBuf, size));
-            if (tmp == NULL)
-                return STATUS_NO_MEM;
+            ::memcpy(ptr, data, size);
+            return commit_packet(size);
+        }
 
-            pTempBuf        = tmp;
-            nTempSize       = size;
+        status_t osc_buffer_t::reserve(size_t size)
+        {
+            if ((size + sizeof(uint32_t)) > nCapacity)
+                return STATUS_OVERFLOW;
 
+            nForgeMax       = size;
             return STATUS_OK;
         }
 
@@ -710,17 +956,21 @@ namespace lsp
 
         void osc_buffer_t::clear()
         {
-            nSize   = 0;
-            nHead   = 0;
-            nTail   = 0;
+            nTailCache      = core::atomic_load_acquire(&nTail);
+            core::atomic_store_release(&nHead, nTailCache);
         }
 
     #define SUBMIT_SIMPLE_IMPL(address, func, ...) \
             osc::packet_t packet; \
             osc::forge_t forge; \
             osc::forge_frame_t sframe, message; \
+            void *ptr; \
+            size_t avail; \
             \
-            status_t res = osc::forge_begin_fixed(&sframe, &forge, pTempBuf, nTempSize); \
+            status_t res = reserve_packet(&ptr, &avail, nForgeMax); \
+            if (res != STATUS_OK) \
+                return res; \
+            res = osc::forge_begin_fixed(&sframe, &forge, ptr, avail); \
             status_t res2; \
             if (res == STATUS_OK) {\
                 res     = osc::forge_begin_message(&message, &sframe, address); \
@@ -734,7 +984,10 @@ namespace lsp
             if (res == STATUS_OK) res = res2; \
             res2   = osc::forge_destroy(&forge); \
             if (res == STATUS_OK) res = res2; \
-            return (res == STATUS_OK) ? submit(&packet) : res;
+            if (res == STATUS_OK) \
+                return commit_packet(packet.size); \
+            cancel_packet(); \
+            return res;
 
         status_t osc_buffer_t::submit_int32(const char *address, int32_t value)
         {
@@ -832,8 +1085,14 @@ namespace lsp
             osc::packet_t packet;
             osc::forge_t forge;
             osc::forge_frame_t sframe;
+            void *ptr;
+            size_t avail;
+
+            status_t res = reserve_packet(&ptr, &avail, nForgeMax);
+            if (res != STATUS_OK)
+                return res;
 
-            status_t res = osc::forge_begin_fixed(&sframe, &forge, pTempBuf, nTempSize);
+            res = osc::forge_begin_fixed(&sframe, &forge, ptr, avail);
             if (res == STATUS_OK)
                 res     = osc::forge_message(&sframe, address, params, args);
 
@@ -848,7 +1107,70 @@ namespace lsp
             if (res == STATUS_OK)
                 res = res2;
 
-            return (res == STATUS_OK) ? submit(&packet) : res;
+            if (res == STATUS_OK)
+                return commit_packet(packet.size);
+
+            cancel_packet();
+            return res;
+        }
+
+        status_t osc_buffer_t::peek_packet(const void **data, size_t *size)
+        {
+            if ((data == NULL) || (size == NULL))
+                return STATUS_BAD_ARGUMENTS;
+
+            while (true)
+            {
+                // There is enough data in the buffer? Re-read the tail position
+                // only if the cached one does not give any record
+                uint32_t head   = nHead;
+                if (uint32_t(nTailCache - head) < sizeof(uint32_t))
+                {
+                    nTailCache      = core::atomic_load_acquire(&nTail);
+                    if (uint32_t(nTailCache - head) < sizeof(uint32_t))
+                        return STATUS_NO_DATA;
+                }
+                size_t bufsz    = uint32_t(nTailCache - head);
+
+                // Read the record header
+                size_t off      = head & nMask;
+                uint32_t hdr    = *(reinterpret_cast<uint32_t *>(&pBuffer[off]));
+
+                // Skip padding record and proceed to the beginning of the ring
+                if (hdr == OSC_BUFFER_PADDING)
+                {
+                    size_t pad      = nCapacity - off;
+                    if (pad > bufsz)
+                        return STATUS_CORRUPTED;
+                    core::atomic_store_release(&nHead, uint32_t(head + pad));
+                    continue;
+                }
+
+                // Analyze state of the record
+                size_t psize    = BE_TO_CPU(hdr);
+                if ((psize + sizeof(uint32_t)) > bufsz) // Record is valid?
+                    return STATUS_CORRUPTED;
+                if ((off + psize + sizeof(uint32_t)) > nCapacity)
+                    return STATUS_CORRUPTED;
+
+                *data           = &pBuffer[off + sizeof(uint32_t)];
+                *size           = psize;
+                return STATUS_OK;
+            }
+        }
+
+        status_t osc_buffer_t::release_packet()
+        {
+            const void *data;
+            size_t size;
+
+            status_t res    = peek_packet(&data, &size);
+            if (res != STATUS_OK)
+                return res;
+
+            // Release the record to the writer
+            core::atomic_store_release(&nHead, uint32_t(nHead + size + sizeof(uint32_t)));
+            return STATUS_OK;
         }
 
         status_t osc_buffer_t::fetch(void *data, size_t *size, size_t limit)
@@ -856,39 +1178,18 @@ namespace lsp
             if ((data == NULL) || (size == NULL) || (!limit))
                 return STATUS_BAD_ARGUMENTS;
 
-            // There is enough space in the buffer?
-            size_t bufsz    = nSize;
-            if (bufsz < sizeof(uint32_t))
-                return STATUS_NO_DATA;
-
-            // Read size, analyze state of the record and update head
-            size_t psize    = BE_TO_CPU(*(reinterpret_cast<uint32_t *>(&pBuffer[nHead])));
+            const void *pdata;
+            size_t psize;
+            status_t res    = peek_packet(&pdata, &psize);
+            if (res != STATUS_OK)
+                return res;
             if (psize > limit) // We have enough space to store the data?
                 return STATUS_OVERFLOW;
-            if ((psize + sizeof(uint32_t)) > bufsz) // Record is valid?
-                return STATUS_CORRUPTED;
-            *size           = psize;
-            nHead          += sizeof(uint32_t);
-            if (nHead > nCapacity)
-                nHead          -= nCapacity;
-
-            // Copy the buffer contents
-            size_t head     = nCapacity - nHead;
-            if (head < psize)
-            {
-                uint8_t *dst    = reinterpret_cast<uint8_t *>(data);
-                ::memcpy(dst, &pBuffer[nHead], head);
-                ::memcpy(&dst[head], pBuffer, psize - head);
-            }
-            else
-                ::memcpy(data, &pBuffer[nHead], psize);
 
-            nHead          += psize;
-            if (nHead > nCapacity)
-                nHead          -= nCapacity;
-
-            // Decrement size
-            atomic_add(&nSize, -(psize + sizeof(uint32_t)));
+            // Copy the buffer contents and release the record
+            ::memcpy(data, pdata, psize);
+            *size           = psize;
+            core::atomic_store_release(&nHead, uint32_t(nHead + psize + sizeof(uint32_t)));
 
             return STATUS_OK;
         }
@@ -900,25 +1201,14 @@ namespace lsp
 
         size_t osc_buffer_t::skip()
         {
-            if (nSize <= sizeof(uint32_t))
-                return 0;
-
-            size_t bufsz    = nSize;
-            if (bufsz < sizeof(uint32_t))
-                return STATUS_NO_DATA;
-
-            size_t ihead    = nHead;
-            uint32_t *head  = reinterpret_cast<uint32_t *>(&pBuffer[ihead]);
-            size_t psize    = BE_TO_CPU(*head);
+            const void *data;
+            size_t size;
 
-            if ((psize + sizeof(uint32_t)) > bufsz) // Record is valid?
+            if (peek_packet(&data, &size) != STATUS_OK)
                 return 0;
 
-            // Decrement the size and update the head
-            nHead           = (ihead + psize + sizeof(uint32_t)) % nCapacity;
-            atomic_add(&nSize, -(psize + sizeof(uint32_t)));
-
-            return psize;
+            core::atomic_store_release(&nHead, uint32_t(nHead + size + sizeof(uint32_t)));
+            return size;
         }
 
         static int compare_midi_events(const void *p1, const void *p2)
@@ -934,6 +1224,27 @@ namespace lsp
             if (nEvents > 1)
                 ::qsort(vEvents, nEvents, sizeof(midi::event_t), compare_midi_events);
         }
+
+        void midi_t::slice(const midi_t *src, size_t off, size_t samples)
+        {
+            nEvents     = 0;
+            for (size_t i=0; i<src->nEvents; ++i)
+            {
+                const midi::event_t *ev = &src->vEvents[i];
+                if ((ev->timestamp < off) || (ev->timestamp >= off + samples))
+                    continue;
+
+                midi::event_t *dst  = &vEvents[nEvents++];
+                *dst                = *ev;
+                dst->timestamp     -= off;
+            }
+        }
+
+        void midi_t::shift(size_t first, size_t off)
+        {
+            for (size_t i=first; i<nEvents; ++i)
+                vEvents[i].timestamp   += off;
+        }
     }
 }
 
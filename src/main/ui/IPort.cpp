@@ -28,6 +28,8 @@ namespace lsp
         IPort::IPort(const meta::port_t *meta)
         {
             pMetadata       = meta;
+            nViewers        = 0;
+            nVisible        = 0;
         }
 
         IPort::~IPort()
@@ -52,6 +54,32 @@ namespace lsp
             vListeners.flush();
         }
 
+        void IPort::add_viewer(bool visible)
+        {
+            ++nViewers;
+            if (visible)
+                ++nVisible;
+        }
+
+        void IPort::remove_viewer(bool visible)
+        {
+            if (nViewers > 0)
+                --nViewers;
+            if ((visible) && (nVisible > 0))
+                --nVisible;
+        }
+
+        void IPort::set_viewer_visible(bool visible)
+        {
+            if (visible)
+            {
+                if (nVisible < nViewers)
+                    ++nVisible;
+            }
+            else if (nVisible > 0)
+                --nVisible;
+        }
+
         void IPort::write(const void *buffer, size_t size)
         {
         }
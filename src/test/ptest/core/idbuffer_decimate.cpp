@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 27 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/plug-fw/core/IDBuffer.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SRC_SIZE            0x10000
+#define ITEMS_MIN           64
+#define ITEMS_MAX           1024
+
+// Compares decimation of the source data into the inline display buffer by
+// per-sample scalar loops like plugins do with the IDBuffer vectorized methods
+PTEST_BEGIN("core", idbuffer_decimate, 5, 1000)
+
+    static void naive_minmax(core::IDBuffer *buf, const float *src, size_t count)
+    {
+        float *vmin = buf->v[0], *vmax = buf->v[1];
+        for (size_t i=0; i<buf->items; ++i)
+        {
+            size_t first = (i * count) / buf->items;
+            size_t last  = ((i + 1) * count) / buf->items;
+            float smin = src[first], smax = src[first];
+            for (size_t j=first+1; j<last; ++j)
+            {
+                if (smin > src[j])
+                    smin = src[j];
+                if (smax < src[j])
+                    smax = src[j];
+            }
+            vmin[i] = smin;
+            vmax[i] = smax;
+        }
+    }
+
+    static void naive_peak(core::IDBuffer *buf, const float *src, size_t count)
+    {
+        float *dst = buf->v[2];
+        for (size_t i=0; i<buf->items; ++i)
+        {
+            size_t first = (i * count) / buf->items;
+            size_t last  = ((i + 1) * count) / buf->items;
+            float peak = fabsf(src[first]);
+            for (size_t j=first+1; j<last; ++j)
+            {
+                float s = fabsf(src[j]);
+                if (peak < s)
+                    peak = s;
+            }
+            if (dst[i] < peak)
+                dst[i] = peak;
+        }
+    }
+
+    static void naive_log(core::IDBuffer *buf, const float *src, size_t count)
+    {
+        float *dst = buf->v[3];
+        float norm = logf(20000.0f / 10.0f) / (buf->items - 1);
+        for (size_t i=0; i<buf->items; ++i)
+        {
+            float k     = 10.0f * expf(i * norm) * count / 24000.0f;
+            float kn    = 10.0f * expf((i + 1) * norm) * count / 24000.0f;
+            size_t first = ceilf(k), last = ceilf(kn);
+            if (last > count)
+                last = count;
+
+            if (last > first)
+            {
+                float v = src[first];
+                for (size_t j=first+1; j<last; ++j)
+                    if (v < src[j])
+                        v = src[j];
+                dst[i] = v;
+            }
+            else
+            {
+                size_t j = k;
+                dst[i] = src[j] + (src[j + 1] - src[j]) * (k - j);
+            }
+        }
+    }
+
+    void call(const char *label, size_t items, const float *src, bool naive)
+    {
+        char name[80];
+        core::IDBuffer *idb = core::IDBuffer::create(4, items);
+        if (idb == NULL)
+            return;
+
+        sprintf(name, "%s minmax x %d", label, int(items));
+        printf("Testing %s...\n", name);
+        if (naive)
+        {
+            PTEST_LOOP(name,
+                naive_minmax(idb, src, SRC_SIZE);
+            );
+        }
+        else
+        {
+            PTEST_LOOP(name,
+                idb->decimate_minmax(0, 1, src, SRC_SIZE);
+            );
+        }
+
+        sprintf(name, "%s peak x %d", label, int(items));
+        printf("Testing %s...\n", name);
+        if (naive)
+        {
+            PTEST_LOOP(name,
+                naive_peak(idb, src, SRC_SIZE);
+            );
+        }
+        else
+        {
+            PTEST_LOOP(name,
+                idb->decimate_peak(2, src, SRC_SIZE, true);
+            );
+        }
+
+        sprintf(name, "%s log x %d", label, int(items));
+        printf("Testing %s...\n", name);
+        if (naive)
+        {
+            PTEST_LOOP(name,
+                naive_log(idb, src, SRC_SIZE);
+            );
+        }
+        else
+        {
+            PTEST_LOOP(name,
+                idb->resample_log(3, src, SRC_SIZE, 24000.0f, 10.0f, 20000.0f);
+            );
+        }
+
+        idb->destroy();
+    }
+
+    PTEST_MAIN
+    {
+        float *src = static_cast<float *>(malloc(SRC_SIZE * sizeof(float)));
+        if (src == NULL)
+            return;
+
+        for (size_t i=0; i<SRC_SIZE; ++i)
+            src[i]  = sinf(i * 0.01f) + (float(rand()) / RAND_MAX - 0.5f) * 0.1f;
+
+        for (size_t items=ITEMS_MIN; items <= ITEMS_MAX; items <<= 2)
+        {
+            call("naive", items, src, true);
+            call("idbuffer", items, src, false);
+            PTEST_SEPARATOR;
+        }
+
+        free(src);
+    }
+
+PTEST_END
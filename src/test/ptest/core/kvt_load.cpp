@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 15 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+
+#include <stdio.h>
+
+#define KEYS_COUNT          100000
+#define KEY_LENGTH          32
+
+// Loads the KVT state the same way lv2::Wrapper::parse_kvt_v2() does: one put()
+// with KVT_TX flag per restored entry, in the arbitrary order of the saved state
+PTEST_BEGIN("core", kvt_load, 10, 5)
+
+    void call(const char *label, const char *keys, size_t count, bool indexed)
+    {
+        char buf[80];
+        sprintf(buf, "%s x %d", label, int(count));
+        printf("Testing %s keys...\n", buf);
+
+        PTEST_LOOP(buf,
+            core::KVTStorage kvt;
+            kvt.set_indexed(indexed);
+            for (size_t i=0; i<count; ++i)
+                kvt.put(&keys[i * KEY_LENGTH], int32_t(i), core::KVT_TX);
+        );
+    }
+
+    PTEST_MAIN
+    {
+        char *keys = static_cast<char *>(malloc(KEYS_COUNT * KEY_LENGTH));
+        if (keys == NULL)
+            return;
+
+        // Generate keys in pseudo-random order like sampler instrument state does
+        for (size_t i=0; i<KEYS_COUNT; ++i)
+            snprintf(&keys[i * KEY_LENGTH], KEY_LENGTH, "/samples/%08x/gain", uint32_t(i * 2654435761U));
+
+        call("indexed", keys, KEYS_COUNT, true);
+        call("tree", keys, KEYS_COUNT, false);
+        PTEST_SEPARATOR;
+
+        call("indexed", keys, KEYS_COUNT / 10, true);
+        call("tree", keys, KEYS_COUNT / 10, false);
+        PTEST_SEPARATOR;
+
+        free(keys);
+    }
+
+PTEST_END
@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 25 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/core/PerfStats.h>
+#include <lsp-plug.in/plug-fw/core/Resources.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/wrapper.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/impl/wrapper.h>
+
+#if defined(PLATFORM_LINUX)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#define BLOCK_SIZE_MAX          8192
+#define MIN_CYCLES              16
+
+// The glibc allows the executable to interpose the malloc() family of functions
+// and forward calls to the original implementation, so we can count memory
+// allocations and deallocations performed by the processing thread. Since this
+// replaces the allocator of the whole test binary, it is enabled only for test
+// builds configured with ALLOC_COUNTER=1
+#if defined(LSP_PTEST_ALLOC_COUNTER) && defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+    #define PTEST_ALLOC_COUNTER
+
+    static __thread bool        alloc_watch     = false;
+    static __thread size_t      alloc_count     = 0;
+    static __thread size_t      free_count      = 0;
+
+    static inline void count_alloc()
+    {
+        if (alloc_watch)
+            ++alloc_count;
+    }
+
+    extern "C"
+    {
+        void *__libc_malloc(size_t size);
+        void *__libc_calloc(size_t nmemb, size_t size);
+        void *__libc_realloc(void *ptr, size_t size);
+        void *__libc_memalign(size_t alignment, size_t size);
+        void *__libc_valloc(size_t size);
+        void *__libc_pvalloc(size_t size);
+        void __libc_free(void *ptr);
+
+        void *malloc(size_t size) __THROW
+        {
+            count_alloc();
+            return __libc_malloc(size);
+        }
+
+        void *calloc(size_t nmemb, size_t size) __THROW
+        {
+            count_alloc();
+            return __libc_calloc(nmemb, size);
+        }
+
+        void *realloc(void *ptr, size_t size) __THROW
+        {
+            count_alloc();
+            return __libc_realloc(ptr, size);
+        }
+
+        void *memalign(size_t alignment, size_t size) __THROW
+        {
+            count_alloc();
+            return __libc_memalign(alignment, size);
+        }
+
+        void *aligned_alloc(size_t alignment, size_t size) __THROW
+        {
+            count_alloc();
+            return __libc_memalign(alignment, size);
+        }
+
+        void *valloc(size_t size) __THROW
+        {
+            count_alloc();
+            return __libc_valloc(size);
+        }
+
+        void *pvalloc(size_t size) __THROW
+        {
+            count_alloc();
+            return __libc_pvalloc(size);
+        }
+
+        int posix_memalign(void **ptr, size_t alignment, size_t size) __THROW
+        {
+            if ((alignment < sizeof(void *)) || (alignment & (alignment - 1)))
+                return EINVAL;
+
+            count_alloc();
+            void *res = __libc_memalign(alignment, size);
+            if (res == NULL)
+                return ENOMEM;
+            *ptr = res;
+            return 0;
+        }
+
+        void free(void *ptr) __THROW
+        {
+            if ((alloc_watch) && (ptr != NULL))
+                ++free_count;
+            __libc_free(ptr);
+        }
+    }
+#endif
+
+namespace
+{
+    using namespace lsp;
+
+    static const size_t sample_rates[] = { 44100, 48000, 96000, 192000, 0 };
+    static const size_t block_sizes[] = { 32, 128, 1024, 8192, 0 };
+
+    /**
+     * Counter of the CPU cache misses of the calling thread, available only
+     * if the kernel and the hardware provide performance counters
+     */
+    class CacheCounter
+    {
+        private:
+            int         hFD;
+
+        public:
+            explicit CacheCounter()
+            {
+                hFD         = -1;
+            #if defined(PLATFORM_LINUX)
+                struct perf_event_attr attr;
+                ::memset(&attr, 0, sizeof(attr));
+                attr.type           = PERF_TYPE_HARDWARE;
+                attr.size           = sizeof(attr);
+                attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+                attr.disabled       = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv     = 1;
+
+                hFD         = ::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            #endif
+            }
+
+            ~CacheCounter()
+            {
+            #if defined(PLATFORM_LINUX)
+                if (hFD >= 0)
+                    ::close(hFD);
+            #endif
+                hFD         = -1;
+            }
+
+        public:
+            inline bool valid() const   { return hFD >= 0; }
+
+            void start()
+            {
+            #if defined(PLATFORM_LINUX)
+                if (hFD < 0)
+                    return;
+                ::ioctl(hFD, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(hFD, PERF_EVENT_IOC_ENABLE, 0);
+            #endif
+            }
+
+            ssize_t stop()
+            {
+            #if defined(PLATFORM_LINUX)
+                if (hFD < 0)
+                    return -1;
+                ::ioctl(hFD, PERF_EVENT_IOC_DISABLE, 0);
+
+                uint64_t value = 0;
+                if (::read(hFD, &value, sizeof(value)) != sizeof(value))
+                    return -1;
+                return value;
+            #else
+                return -1;
+            #endif
+            }
+    };
+
+    ssize_t meta_sort_func(const meta::plugin_t *a, const meta::plugin_t *b)
+    {
+        return strcmp(a->uid, b->uid);
+    }
+
+    plug::Module *create_plugin(const meta::plugin_t *meta)
+    {
+        for (plug::Factory *f = plug::Factory::root(); f != NULL; f = f->next())
+        {
+            for (size_t i=0; ; ++i)
+            {
+                const meta::plugin_t *m = f->enumerate(i);
+                if (m == NULL)
+                    break;
+                if (m == meta)
+                    return f->create(meta);
+            }
+        }
+
+        return NULL;
+    }
+}
+
+// Instantiates each registered plugin with the headless wrapper and measures the
+// cost of the process() call for different sample rates and block sizes. The input
+// signal is the same pseudo-random noise for each run, so results can be compared
+// between runs. Optional arguments are identifiers of plugins to benchmark.
+PTEST_BEGIN("plug", process, 1, 10)
+
+    void fill_inputs(offline::Wrapper *w)
+    {
+        uint32_t seed = 0x5eed1234;
+
+        for (size_t i=0, n=w->audio_inputs(); i<n; ++i)
+        {
+            float *dst = w->input_buffer(i);
+            for (size_t j=0, m=w->block_size(); j<m; ++j)
+            {
+                seed        = seed * 1103515245 + 12345;
+                dst[j]      = int32_t(seed) * (0.5f / 2147483648.0f);
+            }
+        }
+    }
+
+    void call(const meta::plugin_t *meta, offline::Wrapper *w, CacheCounter *cc, size_t sample_rate, size_t block)
+    {
+        char buf[160];
+        snprintf(buf, sizeof(buf), "%s %d Hz x %d", meta->uid, int(sample_rate), int(block));
+        printf("Testing %s...\n", buf);
+
+        // Reset the plugin and apply settings before measurements
+        w->start(sample_rate);
+        fill_inputs(w);
+        w->process(block);
+
+        // Measure one second of audio, but not less than minimum number of cycles
+        size_t cycles   = lsp_max((sample_rate + block - 1) / block, size_t(MIN_CYCLES));
+
+        cc->start();
+    #ifdef PTEST_ALLOC_COUNTER
+        alloc_count     = 0;
+        free_count      = 0;
+        alloc_watch     = true;
+    #endif
+        uint64_t time   = core::PerfStats::time();
+
+        for (size_t i=0; i<cycles; ++i)
+            w->process(block);
+
+        time            = core::PerfStats::time() - time;
+    #ifdef PTEST_ALLOC_COUNTER
+        alloc_watch     = false;
+        size_t allocs   = alloc_count;
+        size_t frees    = free_count;
+    #endif
+        ssize_t misses  = cc->stop();
+
+        // Output statistics
+        size_t samples  = cycles * block;
+        double ns       = double(time) / double(samples);
+        printf("  %.3f ns/sample, DSP load %.2f%%", ns, ns * sample_rate * 1e-7);
+        if (misses >= 0)
+            printf(", cache misses %.4f/sample", double(misses) / double(samples));
+        else
+            printf(", cache misses n/a");
+    #ifdef PTEST_ALLOC_COUNTER
+        printf(", allocations %d, deallocations %d%s\n",
+            int(allocs), int(frees), (allocs + frees > 0) ? " (!)" : "");
+    #else
+        printf(", allocations n/a (build with ALLOC_COUNTER=1)\n");
+    #endif
+
+        // Standard benchmark
+        PTEST_LOOP(buf,
+            w->process(block);
+        );
+    }
+
+    void bench(const meta::plugin_t *meta, resource::ILoader *loader, CacheCounter *cc)
+    {
+        plug::Module *plugin = create_plugin(meta);
+        if (plugin == NULL)
+        {
+            printf("Could not instantiate plugin %s\n", meta->uid);
+            return;
+        }
+
+        offline::Wrapper *w = new offline::Wrapper(plugin, loader);
+        status_t res = (w != NULL) ? w->init(BLOCK_SIZE_MAX) : STATUS_NO_MEM;
+        if (res == STATUS_OK)
+        {
+            for (const size_t *sr = sample_rates; *sr > 0; ++sr)
+                for (const size_t *bs = block_sizes; *bs > 0; ++bs)
+                    call(meta, w, cc, *sr, *bs);
+            PTEST_SEPARATOR;
+        }
+        else
+            printf("Could not initialize wrapper for plugin %s: %s\n", meta->uid, get_status(res));
+
+        // Destroy plugin and wrapper
+        if (plugin->active())
+            plugin->deactivate();
+        plugin->destroy();
+        delete plugin;
+
+        if (w != NULL)
+        {
+            w->destroy();
+            delete w;
+        }
+    }
+
+    bool selected(const meta::plugin_t *meta, int argc, const char **argv)
+    {
+        if (argc <= 0)
+            return true;
+        for (int i=0; i<argc; ++i)
+            if (!strcmp(meta->uid, argv[i]))
+                return true;
+        return false;
+    }
+
+    PTEST_MAIN
+    {
+        // Enumerate plugins in stable order
+        lltl::parray<meta::plugin_t> list;
+        for (plug::Factory *f = plug::Factory::root(); f != NULL; f = f->next())
+        {
+            for (size_t i=0; ; ++i)
+            {
+                const meta::plugin_t *meta = f->enumerate(i);
+                if (meta == NULL)
+                    break;
+                if ((selected(meta, argc, argv)) && (!list.add(const_cast<meta::plugin_t *>(meta))))
+                    return;
+            }
+        }
+        list.qsort(meta_sort_func);
+
+        if (list.size() <= 0)
+        {
+            printf("No plugins to benchmark\n");
+            return;
+        }
+
+        resource::ILoader *loader = core::create_resource_loader();
+        if (loader == NULL)
+        {
+            printf("No resource loader available\n");
+            return;
+        }
+
+        CacheCounter cc;
+        if (!cc.valid())
+            printf("CPU cache counters are not available\n");
+
+        for (size_t i=0, n=list.size(); i<n; ++i)
+            bench(list.uget(i), loader, &cc);
+
+        delete loader;
+    }
+
+PTEST_END
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 21 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/plug-fw/core/DirtyBitmap.h>
+#include <lsp-plug.in/plug-fw/core/atomic.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ITEMS_TOTAL         2500
+#define MARKS_TOTAL         200000
+
+UTEST_BEGIN("core", dirty_bitmap)
+
+    typedef struct context_t
+    {
+        core::DirtyBitmap  *bm;
+        uint8_t            *seen;
+        volatile bool       done;
+        size_t              fetched;
+        size_t              errors;
+    } context_t;
+
+    void fetch_all(core::DirtyBitmap *bm, uint8_t *seen, size_t *count)
+    {
+        size_t index;
+        *count          = 0;
+        while (bm->next(&index))
+        {
+            UTEST_ASSERT_MSG(index < bm->size(), "Index %d out of range", int(index));
+            UTEST_ASSERT_MSG(seen[index] == 0, "Index %d fetched twice", int(index));
+            seen[index] = 1;
+            ++(*count);
+        }
+    }
+
+    static status_t producer(void *arg)
+    {
+        context_t *ctx  = static_cast<context_t *>(arg);
+        for (size_t i=0; i<MARKS_TOTAL; ++i)
+            ctx->bm->mark((i * 7919) % ITEMS_TOTAL);
+        core::atomic_store_release(&ctx->done, true);
+        return STATUS_OK;
+    }
+
+    static status_t consumer(void *arg)
+    {
+        context_t *ctx  = static_cast<context_t *>(arg);
+        size_t index;
+
+        while (true)
+        {
+            bool done       = core::atomic_load_acquire(&ctx->done);
+            while (ctx->bm->next(&index))
+            {
+                if (index >= ITEMS_TOTAL)
+                    ++ctx->errors;
+                else
+                    ctx->seen[index]    = 1;
+                ++ctx->fetched;
+            }
+            // The pass has been started after the producer finished
+            if (done)
+                break;
+            ipc::Thread::sleep(1);
+        }
+
+        return STATUS_OK;
+    }
+
+    void test_single_thread()
+    {
+        core::DirtyBitmap bm;
+        uint8_t seen[ITEMS_TOTAL];
+        size_t index, count;
+
+        UTEST_ASSERT(bm.init(ITEMS_TOTAL) == STATUS_OK);
+        UTEST_ASSERT(bm.size() == ITEMS_TOTAL);
+        UTEST_ASSERT(!bm.next(&index));
+
+        // Mark some items, some of them twice
+        static const size_t marked[] = { 0, 1, 31, 32, 33, 1023, 1024, 1025, 2047, 2048, ITEMS_TOTAL - 1 };
+        for (size_t i=0; i<sizeof(marked)/sizeof(size_t); ++i)
+            bm.mark(marked[i]);
+        bm.mark(31);
+        bm.mark(1024);
+        bm.mark(ITEMS_TOTAL);       // Should be ignored
+        bm.mark(ITEMS_TOTAL * 2);   // Should be ignored
+
+        // Fetch items, they should be returned in ascending order
+        for (size_t i=0; i<sizeof(marked)/sizeof(size_t); ++i)
+        {
+            UTEST_ASSERT(bm.next(&index));
+            UTEST_ASSERT_MSG(index == marked[i], "Expected index %d, got %d", int(marked[i]), int(index));
+        }
+        UTEST_ASSERT(!bm.next(&index));
+        UTEST_ASSERT(!bm.next(&index));
+
+        // Mark all items
+        ::memset(seen, 0, sizeof(seen));
+        bm.mark_all();
+        fetch_all(&bm, seen, &count);
+        UTEST_ASSERT(count == ITEMS_TOTAL);
+        UTEST_ASSERT(!bm.next(&index));
+
+        // Mark the item while fetching
+        bm.mark(10);
+        bm.mark(2000);
+        UTEST_ASSERT(bm.next(&index));
+        UTEST_ASSERT(index == 10);
+        bm.mark(10);
+        UTEST_ASSERT(bm.next(&index));
+        UTEST_ASSERT(index == 2000);
+        UTEST_ASSERT(!bm.next(&index));
+        UTEST_ASSERT(bm.next(&index));
+        UTEST_ASSERT(index == 10);
+        UTEST_ASSERT(!bm.next(&index));
+
+        bm.destroy();
+        UTEST_ASSERT(bm.size() == 0);
+        bm.mark(0);
+        UTEST_ASSERT(!bm.next(&index));
+    }
+
+    void test_concurrent()
+    {
+        core::DirtyBitmap bm;
+        uint8_t seen[ITEMS_TOTAL];
+        ::memset(seen, 0, sizeof(seen));
+        UTEST_ASSERT(bm.init(ITEMS_TOTAL) == STATUS_OK);
+
+        context_t ctx;
+        ctx.bm          = &bm;
+        ctx.seen        = seen;
+        ctx.done        = false;
+        ctx.fetched     = 0;
+        ctx.errors      = 0;
+
+        ipc::Thread tp(producer, &ctx);
+        ipc::Thread tc(consumer, &ctx);
+
+        UTEST_ASSERT(tc.start() == STATUS_OK);
+        UTEST_ASSERT(tp.start() == STATUS_OK);
+        UTEST_ASSERT(tp.join() == STATUS_OK);
+        UTEST_ASSERT(tc.join() == STATUS_OK);
+
+        printf("Marked items: %d, fetched items: %d\n", int(MARKS_TOTAL), int(ctx.fetched));
+        UTEST_ASSERT(ctx.errors == 0);
+        UTEST_ASSERT(ctx.fetched >= ITEMS_TOTAL);
+        UTEST_ASSERT(ctx.fetched <= MARKS_TOTAL);
+        for (size_t i=0; i<ITEMS_TOTAL; ++i)
+            UTEST_ASSERT_MSG(seen[i] != 0, "Item %d has not been fetched", int(i));
+    }
+
+    UTEST_MAIN
+    {
+        printf("Testing single-threaded access...\n");
+        test_single_thread();
+
+        printf("Testing concurrent marking and fetching...\n");
+        test_concurrent();
+    }
+
+UTEST_END
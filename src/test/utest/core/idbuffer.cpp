@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 27 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/plug-fw/core/IDBuffer.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SRC_SIZE        10007
+
+UTEST_BEGIN("core", idbuffer)
+
+    static void range(size_t i, size_t items, size_t count, size_t *first, size_t *last)
+    {
+        *first  = (i * count) / items;
+        *last   = ((i + 1) * count) / items;
+        if (*last <= *first)
+            *last   = *first + 1;
+    }
+
+    void test_decimate(const float *src, size_t items)
+    {
+        printf("Testing decimation of %d samples into %d items\n", int(SRC_SIZE), int(items));
+
+        core::IDBuffer *buf = core::IDBuffer::create(3, items);
+        UTEST_ASSERT(buf != NULL);
+
+        // Min/max envelope
+        buf->decimate_minmax(0, 1, src, SRC_SIZE);
+        for (size_t i=0; i<items; ++i)
+        {
+            size_t first, last;
+            range(i, items, SRC_SIZE, &first, &last);
+            float vmin = src[first], vmax = src[first];
+            for (size_t j=first; j<last; ++j)
+            {
+                vmin    = lsp_min(vmin, src[j]);
+                vmax    = lsp_max(vmax, src[j]);
+            }
+            UTEST_ASSERT_MSG(buf->v[0][i] == vmin, "min[%d] = %f, expected %f", int(i), buf->v[0][i], vmin);
+            UTEST_ASSERT_MSG(buf->v[1][i] == vmax, "max[%d] = %f, expected %f", int(i), buf->v[1][i], vmax);
+        }
+
+        // Peaks with hold
+        for (size_t i=0; i<items; ++i)
+            buf->v[2][i]    = (i & 1) ? 5.0f : 0.0f;
+        buf->decimate_peak(2, src, SRC_SIZE, true);
+        for (size_t i=0; i<items; ++i)
+        {
+            size_t first, last;
+            range(i, items, SRC_SIZE, &first, &last);
+            float peak = (i & 1) ? 5.0f : 0.0f;
+            for (size_t j=first; j<last; ++j)
+                peak    = lsp_max(peak, fabsf(src[j]));
+            UTEST_ASSERT_MSG(buf->v[2][i] == peak, "peak[%d] = %f, expected %f", int(i), buf->v[2][i], peak);
+        }
+
+        // Invalid lines should be ignored
+        buf->decimate_minmax(0, 3, src, SRC_SIZE);
+        buf->decimate_peak(3, src, SRC_SIZE, false);
+        buf->resample_log(3, src, SRC_SIZE, 24000.0f, 10.0f, 20000.0f);
+
+        buf->destroy();
+    }
+
+    void test_resample_log()
+    {
+        float ramp[1024];
+        for (size_t i=0; i<1024; ++i)
+            ramp[i]     = i;
+
+        core::IDBuffer *buf = core::IDBuffer::create(1, 100);
+        UTEST_ASSERT(buf != NULL);
+
+        // Bins are 1 Hz wide, low frequencies are interpolated, high are maximums of bands
+        buf->resample_log(0, ramp, 1024, 1024.0f, 1.0f, 1000.0f);
+        UTEST_ASSERT(buf->v[0][0] == 1.0f);
+        for (size_t i=1; i<100; ++i)
+        {
+            float f     = expf(logf(1000.0f) * i / 99.0f);
+            UTEST_ASSERT_MSG(buf->v[0][i] >= buf->v[0][i-1], "Non-monotonic value at item %d", int(i));
+            UTEST_ASSERT_MSG(fabsf(buf->v[0][i] - f) <= f * 0.1f + 1.0f, "value[%d] = %f, expected about %f", int(i), buf->v[0][i], f);
+        }
+
+        buf->destroy();
+    }
+
+    UTEST_MAIN
+    {
+        float *src = new float[SRC_SIZE];
+        UTEST_ASSERT(src != NULL);
+        for (size_t i=0; i<SRC_SIZE; ++i)
+            src[i]      = sinf(i * 0.013f) * (1 + i % 7);
+
+        test_decimate(src, 1);
+        test_decimate(src, 100);
+        test_decimate(src, 320);
+        test_decimate(src, SRC_SIZE);
+        test_decimate(src, SRC_SIZE * 2);
+        test_resample_log();
+
+        delete [] src;
+    }
+
+UTEST_END
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 17 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+
+#include <string.h>
+
+UTEST_BEGIN("core", kvt_batch)
+
+    class Listener: public core::KVTListener
+    {
+        public:
+            size_t      nCreated;
+            size_t      nChanged;
+            size_t      nRemoved;
+            size_t      nUpdated;
+            char        sBranch[0x100];
+            size_t      nCount;
+            size_t      nPending;
+
+        public:
+            explicit Listener()
+            {
+                nCreated    = 0;
+                nChanged    = 0;
+                nRemoved    = 0;
+                nUpdated    = 0;
+                sBranch[0]  = '\0';
+                nCount      = 0;
+                nPending    = 0;
+            }
+
+        public:
+            virtual void created(core::KVTStorage *storage, const char *id, const core::kvt_param_t *param, size_t pending)
+            {
+                ++nCreated;
+            }
+
+            virtual void changed(core::KVTStorage *storage, const char *id, const core::kvt_param_t *oval, const core::kvt_param_t *nval, size_t pending)
+            {
+                ++nChanged;
+            }
+
+            virtual void removed(core::KVTStorage *storage, const char *id, const core::kvt_param_t *param, size_t pending)
+            {
+                ++nRemoved;
+            }
+
+            virtual void updated(core::KVTStorage *storage, const char *branch, size_t count, size_t pending)
+            {
+                ++nUpdated;
+
+                // Remember the state of the '/a' branch
+                if (!strcmp(branch, "/a"))
+                {
+                    strcpy(sBranch, branch);
+                    nCount      = count;
+                    nPending    = pending;
+                }
+            }
+    };
+
+    UTEST_MAIN
+    {
+        core::KVTStorage kvt;
+        Listener l;
+
+        UTEST_ASSERT(kvt.bind(&l) == STATUS_OK);
+
+        // Individual events outside of the batch
+        UTEST_ASSERT(kvt.put("/a/x", 1.0f, core::KVT_TX) == STATUS_OK);
+        UTEST_ASSERT(l.nCreated == 1);
+
+        // Nested batches
+        UTEST_ASSERT(kvt.begin_batch() == STATUS_OK);
+        UTEST_ASSERT(kvt.begin_batch() == STATUS_OK);
+        UTEST_ASSERT(kvt.in_batch());
+
+        UTEST_ASSERT(kvt.put("/a/y", 1.0f, core::KVT_TX) == STATUS_OK);
+        UTEST_ASSERT(kvt.put("/a/x", 2.0f, core::KVT_TX) == STATUS_OK);
+        UTEST_ASSERT(kvt.put("/b/c/d", 1, core::KVT_RX) == STATUS_OK);
+        UTEST_ASSERT(kvt.put("/top", 1) == STATUS_OK);
+        UTEST_ASSERT(kvt.remove("/a/x") == STATUS_OK);
+        UTEST_ASSERT(kvt.gc() == STATUS_BAD_STATE);
+
+        UTEST_ASSERT(kvt.end_batch() == STATUS_OK);
+        UTEST_ASSERT(l.nUpdated == 0);
+        UTEST_ASSERT(kvt.end_batch() == STATUS_OK);
+        UTEST_ASSERT(!kvt.in_batch());
+
+        // Check the notifications
+        UTEST_ASSERT((l.nCreated == 1) && (l.nChanged == 0) && (l.nRemoved == 0));
+        UTEST_ASSERT(l.nUpdated == 3);
+        UTEST_ASSERT(!strcmp(l.sBranch, "/a"));
+        UTEST_ASSERT(l.nCount == 3);
+        UTEST_ASSERT(l.nPending == core::KVT_TX);
+        UTEST_ASSERT(kvt.end_batch() == STATUS_BAD_STATE);
+
+        // Check the state of storage
+        float v = 0.0f;
+        UTEST_ASSERT(kvt.get("/a/y", &v) == STATUS_OK);
+        UTEST_ASSERT(v == 1.0f);
+        UTEST_ASSERT(kvt.get("/a/x", &v) == STATUS_NOT_FOUND);
+        UTEST_ASSERT(kvt.values() == 3);
+        UTEST_ASSERT(kvt.gc() == STATUS_OK);
+
+        UTEST_ASSERT(kvt.unbind(&l) == STATUS_OK);
+    }
+
+UTEST_END
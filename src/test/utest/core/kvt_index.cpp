@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 15 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+#include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OPERATIONS          100000
+
+UTEST_BEGIN("core", kvt_index)
+
+    static const char *names[] =
+    {
+        "x", "yy", "a", "b", "c", "zz", "q", "long_name"
+    };
+
+    static void make_key(char *dst)
+    {
+        size_t depth    = rand() % 3 + 1;
+        for (size_t i=0; i<depth; ++i)
+            dst        += sprintf(dst, "/%s", names[rand() % (sizeof(names)/sizeof(names[0]))]);
+
+        // Sometimes produce the malformed key
+        if ((rand() % 50) == 0)
+            strcpy(dst, (rand() & 1) ? "/" : "//a");
+    }
+
+    void dump_branch(LSPString *out, core::KVTStorage *kvt, const char *branch, bool recursive)
+    {
+        const core::kvt_param_t *p;
+
+        out->clear();
+        core::KVTIterator *it = kvt->enum_branch(branch, recursive);
+        UTEST_ASSERT(it != NULL);
+
+        while (it->next() == STATUS_OK)
+        {
+            out->append_ascii(it->name());
+            if (it->get(&p) == STATUS_OK)
+                out->fmt_append_ascii("=%d", int(p->i32));
+            out->append(';');
+        }
+    }
+
+    void compare_storages(core::KVTStorage *a, core::KVTStorage *b)
+    {
+        LSPString sa, sb;
+
+        UTEST_ASSERT(a->values() == b->values());
+        UTEST_ASSERT(a->nodes() == b->nodes());
+
+        dump_branch(&sa, a, "/", true);
+        dump_branch(&sb, b, "/", true);
+        UTEST_ASSERT_MSG(sa.equals(&sb), "Recursive enumeration differs:\n  %s\n  %s",
+            sa.get_native(), sb.get_native());
+
+        dump_branch(&sa, a, "/x", false);
+        dump_branch(&sb, b, "/x", false);
+        UTEST_ASSERT_MSG(sa.equals(&sb), "Branch enumeration differs:\n  %s\n  %s",
+            sa.get_native(), sb.get_native());
+    }
+
+    UTEST_MAIN
+    {
+        core::KVTStorage a, b;
+        char key[0x100];
+        status_t ra, rb;
+
+        UTEST_ASSERT(a.indexed());
+        UTEST_ASSERT(b.set_indexed(false) == STATUS_OK);
+        UTEST_ASSERT(!b.indexed());
+
+        // Perform the same random operations on indexed and non-indexed storage
+        srand(1);
+        for (size_t i=0; i<OPERATIONS; ++i)
+        {
+            make_key(key);
+            size_t op   = rand() % 10;
+
+            if (op < 5)
+            {
+                int32_t v   = rand();
+                ra          = a.put(key, v, core::KVT_TX);
+                rb          = b.put(key, v, core::KVT_TX);
+            }
+            else if (op < 7)
+            {
+                int32_t va = 0, vb = 0;
+                ra          = a.get(key, &va);
+                rb          = b.get(key, &vb);
+                UTEST_ASSERT(va == vb);
+            }
+            else if (op < 8)
+            {
+                ra          = a.remove(key);
+                rb          = b.remove(key);
+            }
+            else if (op < 9)
+            {
+                ra          = a.remove_branch(key);
+                rb          = b.remove_branch(key);
+            }
+            else
+            {
+                ra          = a.gc();
+                rb          = b.gc();
+
+                // Toggle the index to check that it is properly rebuilt
+                if ((rand() % 5) == 0)
+                    UTEST_ASSERT(a.set_indexed(!a.indexed()) == STATUS_OK);
+            }
+
+            UTEST_ASSERT_MSG(ra == rb, "Operation %d on key %s returned different results: %d vs %d",
+                int(op), key, int(ra), int(rb));
+
+            if ((i % 997) == 0)
+                compare_storages(&a, &b);
+        }
+
+        UTEST_ASSERT(a.set_indexed(true) == STATUS_OK);
+        compare_storages(&a, &b);
+    }
+
+UTEST_END
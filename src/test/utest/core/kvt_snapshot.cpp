@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 18 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+#include <lsp-plug.in/plug-fw/core/KVTSnapshot.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+UTEST_BEGIN("core", kvt_snapshot)
+
+    void fill_storage(core::KVTStorage *kvt)
+    {
+        static const uint8_t blob[] = { 1, 2, 3, 4, 5, 6, 7 };
+
+        UTEST_ASSERT(kvt->put("/a/i32", int32_t(-123456)) == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/a/u32", uint32_t(0xdeadbeef), core::KVT_PRIVATE) == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/a/i64", int64_t(-1234567890123ll)) == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/a/u64", uint64_t(0x0123456789abcdefull)) == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/b/f32", 440.0f) == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/b/f64", 3.141592653589793) == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/b/c/str", "Hello world!") == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/b/c/empty", "") == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/b/c/blob", sizeof(blob), "application/octet-stream", blob) == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/b/c/nblob", size_t(0), NULL, NULL) == STATUS_OK);
+        UTEST_ASSERT(kvt->put("/b/transient", 1.0f, core::KVT_TRANSIENT) == STATUS_OK);
+    }
+
+    void compare_param(core::KVTStorage *a, core::KVTStorage *b, const char *name)
+    {
+        const core::kvt_param_t *pa, *pb;
+        UTEST_ASSERT_MSG(a->get(name, &pa) == STATUS_OK, "Missing parameter %s", name);
+        UTEST_ASSERT_MSG(b->get(name, &pb) == STATUS_OK, "Missing restored parameter %s", name);
+        UTEST_ASSERT_MSG(pa->type == pb->type, "Type mismatch for %s", name);
+
+        bool eq = false;
+        switch (pa->type)
+        {
+            case core::KVT_INT32:   eq = pa->i32 == pb->i32; break;
+            case core::KVT_UINT32:  eq = pa->u32 == pb->u32; break;
+            case core::KVT_INT64:   eq = pa->i64 == pb->i64; break;
+            case core::KVT_UINT64:  eq = pa->u64 == pb->u64; break;
+            case core::KVT_FLOAT32: eq = pa->f32 == pb->f32; break;
+            case core::KVT_FLOAT64: eq = pa->f64 == pb->f64; break;
+            case core::KVT_STRING:  eq = !strcmp(pa->str, pb->str); break;
+            case core::KVT_BLOB:
+                eq  = (pa->blob.size == pb->blob.size) &&
+                      (((pa->blob.ctype == NULL) && (pb->blob.ctype == NULL)) ||
+                       ((pa->blob.ctype != NULL) && (pb->blob.ctype != NULL) && (!strcmp(pa->blob.ctype, pb->blob.ctype)))) &&
+                      ((pa->blob.size <= 0) || (!memcmp(pa->blob.data, pb->blob.data, pa->blob.size)));
+                break;
+            default:
+                break;
+        }
+        UTEST_ASSERT_MSG(eq, "Value mismatch for %s", name);
+    }
+
+    UTEST_MAIN
+    {
+        core::KVTStorage src, dst;
+        core::KVTSnapshot snap;
+        core::KVTSnapshotReader rd;
+
+        fill_storage(&src);
+
+        // Build the snapshot and flatten it
+        UTEST_ASSERT(snap.build(&src) == STATUS_OK);
+        UTEST_ASSERT(snap.count() == 10);
+        UTEST_ASSERT(snap.segments() > 0);
+
+        size_t size = snap.size();
+        uint8_t *data = static_cast<uint8_t *>(malloc(size + 1));
+        UTEST_ASSERT(data != NULL);
+        UTEST_ASSERT(snap.write(data, size - 1) == STATUS_OVERFLOW);
+        // Use unaligned buffer to check that reader does not depend on the alignment
+        UTEST_ASSERT(snap.write(&data[1], size) == STATUS_OK);
+
+        // Restore the snapshot
+        UTEST_ASSERT(rd.open(&data[1], size) == STATUS_OK);
+        UTEST_ASSERT(rd.count() == 10);
+        UTEST_ASSERT(rd.apply(&dst) == STATUS_OK);
+        UTEST_ASSERT(dst.values() == 10);
+
+        static const char *names[] =
+        {
+            "/a/i32", "/a/u32", "/a/i64", "/a/u64",
+            "/b/f32", "/b/f64",
+            "/b/c/str", "/b/c/empty", "/b/c/blob", "/b/c/nblob",
+            NULL
+        };
+        for (const char **p = names; *p != NULL; ++p)
+            compare_param(&src, &dst, *p);
+
+        UTEST_ASSERT(!dst.exists("/b/transient"));
+
+        // Check the private flag
+        size_t privates = 0;
+        core::KVTIterator *it = dst.enum_branch("/a");
+        UTEST_ASSERT(it != NULL);
+        while (it->next() == STATUS_OK)
+        {
+            if (!it->is_private())
+                continue;
+            UTEST_ASSERT(!strcmp(it->id(), "u32"));
+            ++privates;
+        }
+        UTEST_ASSERT(privates == 1);
+
+        // Snapshot of the branch
+        UTEST_ASSERT(snap.build(&src, "/b/c") == STATUS_OK);
+        UTEST_ASSERT(snap.count() == 4);
+
+        // Damaged snapshots should be rejected
+        UTEST_ASSERT(rd.open(&data[1], 8) == STATUS_CORRUPTED);
+        UTEST_ASSERT(rd.open(&data[1], size - 1) == STATUS_CORRUPTED);
+        data[1] ^= 0xff;
+        UTEST_ASSERT(rd.open(&data[1], size) == STATUS_BAD_FORMAT);
+        data[1] ^= 0xff;
+
+        // Corrupt the length of the first name
+        UTEST_ASSERT(rd.open(&data[1], size) == STATUS_OK);
+        data[1 + 16 + 8] = 0x7f;
+        UTEST_ASSERT(rd.next() == STATUS_CORRUPTED);
+
+        free(data);
+    }
+
+UTEST_END
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 24 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/plug-fw/core/PerfStats.h>
+#include <lsp-plug.in/plug-fw/core/KVTStorage.h>
+
+#include <math.h>
+
+namespace
+{
+    using namespace lsp;
+
+    class TestPerfStats: public core::PerfStats
+    {
+        public:
+            // Emulate the cycle with the specified time of each stage in nanoseconds
+            bool cycle(uint64_t pre, uint64_t process, uint64_t post, size_t samples, float sr)
+            {
+                vStamp[0]   = 1000;
+                vStamp[1]   = vStamp[0] + pre;
+                vStamp[2]   = vStamp[1] + process;
+                vStamp[3]   = vStamp[2] + post;
+                return end(samples, sr);
+            }
+    };
+}
+
+UTEST_BEGIN("core", perf_stats)
+
+    static bool equals(float a, float b, float tol)
+    {
+        return fabsf(a - b) <= tol;
+    }
+
+    void test_histogram()
+    {
+        TestPerfStats ps;
+        core::perf_stats_t st;
+
+        // 1000 samples at 100 kHz give 10 ms budget
+        ps.set_period(40000000u);
+        UTEST_ASSERT(!ps.cycle(500000, 1000000, 500000, 1000, 100000.0f));     // 20% load
+        UTEST_ASSERT(!ps.cycle(1000000, 6000000, 1000000, 1000, 100000.0f));   // 80% load, risk
+        UTEST_ASSERT(!ps.cycle(1000000, 10000000, 1000000, 1000, 100000.0f));  // 120% load, overrun
+        UTEST_ASSERT(ps.cycle(0, 500000, 0, 1000, 100000.0f));                 // 5% load, period complete
+
+        ps.publish(&st);
+        UTEST_ASSERT(st.nCycles == 4);
+        UTEST_ASSERT(st.nSamples == 4000);
+        UTEST_ASSERT(st.nBudget == 40000000u);
+        UTEST_ASSERT(st.vTime[core::PERF_PRE] == 2500000);
+        UTEST_ASSERT(st.vTime[core::PERF_PROCESS] == 17500000);
+        UTEST_ASSERT(st.vTime[core::PERF_POST] == 2500000);
+        UTEST_ASSERT(st.vMaxTime[core::PERF_PROCESS] == 10000000);
+        UTEST_ASSERT(equals(st.fMaxLoad, 1.2f, 1e-4f));
+        UTEST_ASSERT(st.nRisk == 2);
+        UTEST_ASSERT(st.nOverruns == 1);
+        UTEST_ASSERT(st.vHist[0] == 1);
+        UTEST_ASSERT(st.vHist[2] == 1);
+        UTEST_ASSERT(st.vHist[8] == 1);
+        UTEST_ASSERT(st.vHist[PERF_HIST_BUCKETS - 1] == 1);
+
+        // New period keeps only total counters
+        const core::perf_stats_t *cur = ps.current();
+        UTEST_ASSERT(cur->nCycles == 0);
+        UTEST_ASSERT(cur->nBudget == 0);
+        UTEST_ASSERT(cur->nRisk == 0);
+        UTEST_ASSERT(cur->nTotalRisk == 2);
+        UTEST_ASSERT(cur->nTotalOverruns == 1);
+
+        // Invalid cycles are ignored
+        UTEST_ASSERT(!ps.cycle(1000, 1000, 1000, 0, 48000.0f));
+        UTEST_ASSERT(cur->nCycles == 0);
+
+        // Restarting the period without publishing keeps total counters too
+        UTEST_ASSERT(ps.cycle(1000000, 10000000, 1000000, 4000, 100000.0f));   // 30% load, period complete
+        ps.restart();
+        UTEST_ASSERT(cur->nCycles == 0);
+        UTEST_ASSERT(cur->nOverruns == 0);
+        UTEST_ASSERT(cur->nTotalOverruns == 1);
+    }
+
+    void test_kvt()
+    {
+        TestPerfStats ps;
+        core::perf_stats_t st;
+        core::KVTStorage kvt;
+        uint32_t u32;
+        uint64_t u64;
+        float f32;
+        const core::kvt_param_t *p;
+
+        ps.set_period(20000000u);
+        ps.cycle(1000000, 3000000, 1000000, 1000, 100000.0f);
+        UTEST_ASSERT(ps.cycle(1000000, 8000000, 1000000, 1000, 100000.0f));
+        ps.publish(&st);
+
+        UTEST_ASSERT(core::PerfStats::write(&kvt, PERF_KVT_BRANCH, &st) == STATUS_OK);
+
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "cycles", &u32) == STATUS_OK) && (u32 == 2));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "samples", &u64) == STATUS_OK) && (u64 == 2000));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "load/avg", &f32) == STATUS_OK) && (equals(f32, 0.75f, 1e-4f)));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "load/max", &f32) == STATUS_OK) && (equals(f32, 1.0f, 1e-4f)));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "xrun/overruns", &u32) == STATUS_OK) && (u32 == 1));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "xrun/total_risk", &u64) == STATUS_OK) && (u64 == 1));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "time/process/avg", &f32) == STATUS_OK) && (equals(f32, 5500.0f, 1e-2f)));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "time/process/max", &f32) == STATUS_OK) && (equals(f32, 8000.0f, 1e-2f)));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "hist/05", &u32) == STATUS_OK) && (u32 == 1));
+        UTEST_ASSERT((kvt.get(PERF_KVT_BRANCH "hist/10", &u32) == STATUS_OK) && (u32 == 1));
+
+        // All parameters should be transient to not to be serialized
+        size_t values = 0;
+        core::KVTIterator *it = kvt.enum_branch("/internal/perf", true);
+        UTEST_ASSERT(it != NULL);
+        while (it->next() == STATUS_OK)
+        {
+            if (it->get(&p) != STATUS_OK)
+                continue;
+            UTEST_ASSERT_MSG(it->is_transient(), "Parameter %s is not transient", it->name());
+            ++values;
+        }
+        UTEST_ASSERT(values == 8 + core::PERF_STAGES * 2 + PERF_HIST_BUCKETS);
+
+        kvt.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        printf("Testing histogram...\n");
+        test_histogram();
+        printf("Testing KVT output...\n");
+        test_kvt();
+    }
+
+UTEST_END
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 19 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/plug-fw/core/quantize.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <string.h>
+
+#define BUF_SIZE        1024
+
+UTEST_BEGIN("core", quantize)
+
+    void test_half()
+    {
+        // All half-precision values except NaNs should survive the round trip
+        for (size_t i=0; i<0x10000; ++i)
+        {
+            uint16_t h  = uint16_t(i);
+            if (((h & 0x7c00) == 0x7c00) && (h & 0x3ff))
+                continue;
+            float f     = core::half_to_float(h);
+            UTEST_ASSERT_MSG(core::float_to_half(f) == h, "Round trip failed for 0x%04x", int(h));
+        }
+
+        // Check rounding and special values
+        UTEST_ASSERT(core::float_to_half(1.0f) == 0x3c00);
+        UTEST_ASSERT(core::float_to_half(-2.0f) == 0xc000);
+        UTEST_ASSERT(core::float_to_half(65504.0f) == 0x7bff);
+        UTEST_ASSERT(core::float_to_half(65520.0f) == 0x7c00);
+        UTEST_ASSERT(core::float_to_half(1e-10f) == 0x0000);
+        UTEST_ASSERT(core::float_to_half(1.0f + 2.0f / 4096.0f) == 0x3c00);
+        UTEST_ASSERT(core::float_to_half(1.0f + 3.0f / 4096.0f) == 0x3c01);
+        UTEST_ASSERT(core::float_to_half(1.0f + 6.0f / 4096.0f) == 0x3c02);
+    }
+
+    void test_quantize()
+    {
+        float src[BUF_SIZE], dst[BUF_SIZE];
+        int16_t qi[BUF_SIZE];
+        uint16_t qh[BUF_SIZE];
+
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            src[i]      = 0.75f * sinf(i * 0.05f) * expf(-float(i) / BUF_SIZE);
+
+        // 16-bit integers
+        float scale = core::quantize_int16(qi, src, BUF_SIZE);
+        UTEST_ASSERT(scale > 0.0f);
+        core::dequantize_int16(dst, qi, scale, BUF_SIZE);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            UTEST_ASSERT_MSG(fabsf(dst[i] - src[i]) <= scale * 0.5f + 1e-7f,
+                "Sample %d differs: %f vs %f", int(i), dst[i], src[i]);
+
+        // Half-precision floating-point values
+        scale = core::quantize_half(qh, src, BUF_SIZE);
+        UTEST_ASSERT(scale > 0.0f);
+        core::dequantize_half(dst, qh, scale, BUF_SIZE);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            UTEST_ASSERT_MSG(fabsf(dst[i] - src[i]) <= fabsf(src[i]) / 2048.0f + 1e-7f,
+                "Sample %d differs: %f vs %f", int(i), dst[i], src[i]);
+
+        // Silence
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            src[i]      = 0.0f;
+        UTEST_ASSERT(core::quantize_int16(qi, src, BUF_SIZE) == 0.0f);
+        core::dequantize_int16(dst, qi, 0.0f, BUF_SIZE);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            UTEST_ASSERT(dst[i] == 0.0f);
+    }
+
+    void test_log(size_t bits)
+    {
+        float src[BUF_SIZE], dst[BUF_SIZE];
+        uint16_t q[BUF_SIZE];
+
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            src[i]      = expf(-float(i) * 0.015f);
+        src[0]      = 0.0f;
+        src[1]      = 1e-12f;
+
+        // The relative error should not exceed the half of quantization step
+        float step  = (LOG_QUANT_DB_MAX - LOG_QUANT_DB_MIN) / ((1 << bits) - 2);
+        float err   = expf(step * 0.5f * M_LN10 / 20.0f) - 1.0f + 1e-5f;
+
+        core::quantize_log(q, src, BUF_SIZE, bits);
+        core::dequantize_log(dst, q, BUF_SIZE, bits);
+        UTEST_ASSERT((q[0] == 0) && (q[1] == 0));
+        UTEST_ASSERT((dst[0] == 0.0f) && (dst[1] == 0.0f));
+        for (size_t i=2; i<BUF_SIZE; ++i)
+            UTEST_ASSERT_MSG(fabsf(dst[i] - src[i]) <= src[i] * err,
+                "Sample %d differs: %g vs %g", int(i), dst[i], src[i]);
+    }
+
+    void test_rows(size_t bits)
+    {
+        uint16_t prev[BUF_SIZE], row[BUF_SIZE], out[BUF_SIZE];
+        uint8_t buf[BUF_SIZE * 3];
+        uint16_t mask = (bits > 8) ? 0xffff : 0xff;
+
+        UTEST_ASSERT(core::encoded_row_size(BUF_SIZE, bits) <= sizeof(buf));
+
+        // Key row
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            prev[i]     = ((i % 7) < 3) ? 0 : uint16_t(i * 37) & mask;
+        size_t size = core::encode_row(buf, prev, NULL, BUF_SIZE, bits);
+        UTEST_ASSERT(size <= core::encoded_row_size(BUF_SIZE, bits));
+        UTEST_ASSERT(core::decode_row(out, NULL, buf, size, BUF_SIZE, bits) == STATUS_OK);
+        UTEST_ASSERT(memcmp(out, prev, sizeof(out)) == 0);
+
+        // Delta row with mostly unchanged values
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            row[i]      = ((i % 50) == 0) ? uint16_t(prev[i] + i) & mask : prev[i];
+        size = core::encode_row(buf, row, prev, BUF_SIZE, bits);
+        UTEST_ASSERT(size < BUF_SIZE / 8);
+        UTEST_ASSERT(core::decode_row(out, NULL, buf, size, BUF_SIZE, bits) == STATUS_NO_DATA);
+        UTEST_ASSERT(core::decode_row(out, prev, buf, size, BUF_SIZE, bits) == STATUS_OK);
+        UTEST_ASSERT(memcmp(out, row, sizeof(out)) == 0);
+
+        // Damaged data
+        UTEST_ASSERT(core::decode_row(out, prev, buf, size - 1, BUF_SIZE, bits) == STATUS_CORRUPTED);
+        UTEST_ASSERT(core::decode_row(out, prev, buf, size, BUF_SIZE, (bits > 8) ? 8 : 16) == STATUS_BAD_FORMAT);
+    }
+
+    UTEST_MAIN
+    {
+        test_half();
+        test_quantize();
+        test_log(8);
+        test_log(16);
+        test_rows(8);
+        test_rows(16);
+    }
+
+UTEST_END
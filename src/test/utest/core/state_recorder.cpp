@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 22 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/plug-fw/core/JsonDumper.h>
+#include <lsp-plug.in/plug-fw/core/StateRecorder.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TRACE_SIZE          0x10000
+
+namespace
+{
+    using namespace lsp;
+
+    /**
+     * JSON dumper that traces all calls into the text buffer instead of the file
+     */
+    class TraceDumper: public core::JsonDumper
+    {
+        public:
+            char            vBuf[TRACE_SIZE];
+            size_t          nLen;
+
+        public:
+            explicit TraceDumper()
+            {
+                vBuf[0]     = '\0';
+                nLen        = 0;
+            }
+
+            void trace(const char *fmt, ...)
+            {
+                va_list vl;
+                va_start(vl, fmt);
+                int n = vsnprintf(&vBuf[nLen], TRACE_SIZE - nLen, fmt, vl);
+                va_end(vl);
+                if (n > 0)
+                    nLen    = lsp_min(nLen + n, size_t(TRACE_SIZE - 1));
+            }
+
+        public:
+            virtual void begin_object(const char *name, const void *ptr, size_t szof)   { trace("%s:{%p,%d,", name, ptr, int(szof));   }
+            virtual void begin_object(const void *ptr, size_t szof)                     { trace("{%p,%d,", ptr, int(szof));             }
+            virtual void end_object()                                                   { trace("},");                                  }
+            virtual void begin_array(const char *name, const void *ptr, size_t length)  { trace("%s:[%p,%d,", name, ptr, int(length)); }
+            virtual void begin_array(const void *ptr, size_t length)                    { trace("[%p,%d,", ptr, int(length));           }
+            virtual void end_array()                                                    { trace("],");                                  }
+
+            virtual void write(const void *value)                   { trace("p%p,", value);                             }
+            virtual void write(const char *value)                   { trace("s%s,", (value != NULL) ? value : "(null)");}
+            virtual void write(bool value)                          { trace("b%d,", int(value));                        }
+            virtual void write(uint8_t value)                       { trace("u8:%d,", int(value));                      }
+            virtual void write(int8_t value)                        { trace("i8:%d,", int(value));                      }
+            virtual void write(uint16_t value)                      { trace("u16:%d,", int(value));                     }
+            virtual void write(int16_t value)                       { trace("i16:%d,", int(value));                     }
+            virtual void write(uint32_t value)                      { trace("u32:%lu,", (unsigned long)value);          }
+            virtual void write(int32_t value)                       { trace("i32:%ld,", (long)value);                   }
+            virtual void write(uint64_t value)                      { trace("u64:%llu,", (unsigned long long)value);    }
+            virtual void write(int64_t value)                       { trace("i64:%lld,", (long long)value);             }
+            virtual void write(float value)                         { trace("f%g,", value);                             }
+            virtual void write(double value)                        { trace("d%g,", value);                             }
+
+            virtual void write(const char *name, const void *value) { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, const char *value) { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, bool value)        { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, uint8_t value)     { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, int8_t value)      { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, uint16_t value)    { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, int16_t value)     { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, uint32_t value)    { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, int32_t value)     { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, uint64_t value)    { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, int64_t value)     { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, float value)       { trace("%s=", name); write(value);                 }
+            virtual void write(const char *name, double value)      { trace("%s=", name); write(value);                 }
+    };
+}
+
+UTEST_BEGIN("core", state_recorder)
+
+    void dump_state(dspu::IStateDumper *v)
+    {
+        static const float fv[]         = { 1.0f, 2.5f, -3.0f };
+        static const int32_t iv[]       = { -1, 0, 1, 1000000 };
+        static const bool bv[]          = { true, false };
+        static const void *pv[]         = { NULL, fv, iv };
+        const float *nv                 = NULL;
+        char name[32];
+
+        v->write("this", static_cast<const void *>(fv));
+        v->write("name", "state");
+        v->write("null", static_cast<const char *>(NULL));
+        v->write("flag", true);
+        v->write("u8", uint8_t(200));
+        v->write("i8", int8_t(-100));
+        v->write("u16", uint16_t(60000));
+        v->write("i16", int16_t(-30000));
+        v->write("u32", uint32_t(4000000000U));
+        v->write("i32", int32_t(-2000000000));
+        v->write("u64", uint64_t(1) << 40);
+        v->write("i64", -(int64_t(1) << 40));
+        v->write("f32", 0.25f);
+        v->write("f64", 1e-3);
+
+        v->begin_object("obj", fv, sizeof(fv));
+        {
+            v->writev("fv", fv, 3);
+            v->writev("iv", iv, 4);
+            v->writev("bv", bv, 2);
+            v->writev("pv", pv, 3);
+            v->writev("nv", nv, 10);
+
+            v->begin_array("arr", iv, 4);
+            for (size_t i=0; i<4; ++i)
+            {
+                // Names formed on the stack should be copied by the recorder
+                snprintf(name, sizeof(name), "item_%d", int(i));
+                v->begin_object(&iv[i], sizeof(int32_t));
+                {
+                    v->write(name, iv[i]);
+                    v->writev(fv, i);
+                }
+                v->end_object();
+            }
+            v->end_array();
+        }
+        v->end_object();
+    }
+
+    void count_scopes(const char *s, ssize_t *objects, ssize_t *arrays)
+    {
+        *objects    = 0;
+        *arrays     = 0;
+        for ( ; *s != '\0'; ++s)
+        {
+            switch (*s)
+            {
+                case '{': ++(*objects); break;
+                case '}': --(*objects); break;
+                case '[': ++(*arrays); break;
+                case ']': --(*arrays); break;
+                default: break;
+            }
+        }
+    }
+
+    void test_replay()
+    {
+        TraceDumper direct, replayed;
+        core::StateRecorder rec;
+
+        // Dump the state directly and replay the recorded state
+        dump_state(&direct);
+        UTEST_ASSERT(rec.init(0x10000) == STATUS_OK);
+        dump_state(&rec);
+        UTEST_ASSERT(!rec.overflow());
+        UTEST_ASSERT(rec.size() > 0);
+        UTEST_ASSERT(rec.replay(&replayed) == STATUS_OK);
+
+        printf("Direct:   %s\n", direct.vBuf);
+        printf("Replayed: %s\n", replayed.vBuf);
+        UTEST_ASSERT(strcmp(direct.vBuf, replayed.vBuf) == 0);
+
+        // Replay twice gives the same result
+        TraceDumper again;
+        UTEST_ASSERT(rec.replay(&again) == STATUS_OK);
+        UTEST_ASSERT(strcmp(direct.vBuf, again.vBuf) == 0);
+
+        // Clear the recorder
+        rec.clear();
+        UTEST_ASSERT(rec.size() == 0);
+        TraceDumper empty;
+        UTEST_ASSERT(rec.replay(&empty) == STATUS_OK);
+        UTEST_ASSERT(empty.nLen == 0);
+
+        rec.destroy();
+    }
+
+    void test_overflow()
+    {
+        core::StateRecorder rec;
+        ssize_t objects, arrays;
+
+        // Estimate the full size of the dump
+        UTEST_ASSERT(rec.init(0x10000) == STATUS_OK);
+        dump_state(&rec);
+        UTEST_ASSERT(!rec.overflow());
+        size_t full = rec.size();
+
+        // The dump should be truncated at any smaller buffer size but the output should stay balanced
+        for (size_t capacity = 8; capacity < full; capacity += 8)
+        {
+            TraceDumper out;
+            UTEST_ASSERT(rec.init(capacity) == STATUS_OK);
+            dump_state(&rec);
+            UTEST_ASSERT(rec.overflow());
+            UTEST_ASSERT(rec.size() <= rec.capacity());
+            UTEST_ASSERT(rec.replay(&out) == STATUS_OK);
+
+            count_scopes(out.vBuf, &objects, &arrays);
+            UTEST_ASSERT_MSG((objects == 0) && (arrays == 0),
+                "Unbalanced output for capacity=%d: %s", int(capacity), out.vBuf);
+        }
+
+        // Clearing the recorder resets the overflow flag
+        UTEST_ASSERT(rec.overflow());
+        rec.clear();
+        UTEST_ASSERT(!rec.overflow());
+        rec.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        printf("Testing replay of recorded state...\n");
+        test_replay();
+        printf("Testing overflow of the recorder...\n");
+        test_overflow();
+    }
+
+UTEST_END
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 20 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/plug-fw/plug/data.h>
+
+#define MESH_BUFFERS        4
+#define MESH_ITEMS          0x100
+#define FRAMES_TOTAL        100000
+#define SPIN_LIMIT          0x100
+
+UTEST_BEGIN("plug", mesh)
+
+    typedef struct context_t
+    {
+        plug::mesh_t       *mesh;
+        size_t              frames;
+        size_t              errors;
+    } context_t;
+
+    static void fill_frame(plug::mesh_t *mesh, size_t seq, size_t items)
+    {
+        for (size_t i=0; i<MESH_BUFFERS; ++i)
+        {
+            float *dst      = mesh->pvData[i];
+            for (size_t j=0; j<items; ++j)
+                dst[j]          = float(seq * MESH_BUFFERS + i);
+        }
+    }
+
+    static bool check_frame(const plug::mesh_frame_t *f, size_t *seq)
+    {
+        if (f->nBuffers != MESH_BUFFERS)
+            return false;
+
+        size_t first    = size_t(f->vData[0][0]) / MESH_BUFFERS;
+        for (size_t i=0; i<f->nBuffers; ++i)
+        {
+            const float *src    = f->vData[i];
+            float v             = float(first * MESH_BUFFERS + i);
+            for (size_t j=0; j<f->nItems; ++j)
+                if (src[j] != v)
+                    return false;
+        }
+
+        *seq            = first;
+        return true;
+    }
+
+    static void backoff(size_t *spins)
+    {
+        if ((++(*spins)) >= SPIN_LIMIT)
+        {
+            ipc::Thread::sleep(1);
+            *spins      = 0;
+        }
+    }
+
+    static status_t producer(void *arg)
+    {
+        context_t *ctx  = static_cast<context_t *>(arg);
+
+        for (size_t seq=1; seq <= FRAMES_TOTAL; ++seq)
+        {
+            size_t items    = (seq % MESH_ITEMS) + 1;
+            fill_frame(ctx->mesh, seq, items);
+            ctx->mesh->data(MESH_BUFFERS, items);
+            ++ctx->frames;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t consumer(void *arg)
+    {
+        context_t *ctx  = static_cast<context_t *>(arg);
+        size_t last     = 0;
+        size_t spins    = 0;
+
+        while (last < FRAMES_TOTAL)
+        {
+            if (!ctx->mesh->consume())
+            {
+                backoff(&spins);
+                continue;
+            }
+
+            size_t seq      = 0;
+            if ((!check_frame(ctx->mesh->front(), &seq)) || (seq <= last))
+            {
+                ++ctx->errors;
+                break;
+            }
+
+            last            = seq;
+            spins           = 0;
+            ++ctx->frames;
+        }
+
+        return STATUS_OK;
+    }
+
+    void test_single_thread()
+    {
+        plug::mesh_t *mesh  = plug::mesh_t::create(MESH_BUFFERS, MESH_ITEMS);
+        plug::mesh_t *view  = plug::mesh_t::create(MESH_BUFFERS, 0);
+        UTEST_ASSERT(mesh != NULL);
+        UTEST_ASSERT(view != NULL);
+
+        // Nothing has been published yet
+        size_t seq          = 0;
+        UTEST_ASSERT(mesh->isEmpty());
+        UTEST_ASSERT(!mesh->consume());
+
+        // Publish one frame and consume it
+        fill_frame(mesh, 1, MESH_ITEMS);
+        mesh->data(MESH_BUFFERS, MESH_ITEMS);
+        UTEST_ASSERT(mesh->containsData());
+        UTEST_ASSERT(mesh->consume());
+        UTEST_ASSERT(mesh->isEmpty());
+        UTEST_ASSERT(check_frame(mesh->front(), &seq));
+        UTEST_ASSERT(seq == 1);
+        UTEST_ASSERT(!mesh->consume());
+
+        // The producer should never write the front frame
+        const plug::mesh_frame_t *f = mesh->front();
+        for (size_t i=0; i<8; ++i)
+        {
+            UTEST_ASSERT(mesh->pvData[0] != f->vData[0]);
+            fill_frame(mesh, i + 2, MESH_ITEMS);
+            mesh->data(MESH_BUFFERS, MESH_ITEMS);
+        }
+        UTEST_ASSERT(check_frame(f, &seq));
+        UTEST_ASSERT(seq == 1);
+
+        // The newest frame wins
+        UTEST_ASSERT(mesh->consume());
+        UTEST_ASSERT(check_frame(mesh->front(), &seq));
+        UTEST_ASSERT(seq == 9);
+        UTEST_ASSERT(mesh->front()->nItems == MESH_ITEMS);
+
+        // The view refers to the front frame without copying
+        mesh->view(view);
+        UTEST_ASSERT(view->nBuffers == MESH_BUFFERS);
+        UTEST_ASSERT(view->nItems == MESH_ITEMS);
+        for (size_t i=0; i<MESH_BUFFERS; ++i)
+            UTEST_ASSERT(view->pvData[i] == mesh->front()->vData[i]);
+
+        plug::mesh_t::destroy(view);
+        plug::mesh_t::destroy(mesh);
+    }
+
+    void test_partial_update()
+    {
+        plug::mesh_t *mesh  = plug::mesh_t::create(MESH_BUFFERS, MESH_ITEMS);
+        UTEST_ASSERT(mesh != NULL);
+
+        // Fill the static axis once, then update only the other buffers
+        for (size_t j=0; j<MESH_ITEMS; ++j)
+            mesh->pvData[0][j]  = float(j);
+
+        for (size_t seq=1; seq<=8; ++seq)
+        {
+            for (size_t i=1; i<MESH_BUFFERS; ++i)
+                for (size_t j=0; j<MESH_ITEMS; ++j)
+                    mesh->pvData[i][j]  = float(seq);
+            mesh->data(MESH_BUFFERS, MESH_ITEMS);
+
+            UTEST_ASSERT(mesh->consume());
+            const plug::mesh_frame_t *f = mesh->front();
+            for (size_t j=0; j<MESH_ITEMS; ++j)
+            {
+                UTEST_ASSERT_MSG(f->vData[0][j] == float(j),
+                    "Static buffer lost at frame %d, item %d: %f", int(seq), int(j), f->vData[0][j]);
+                for (size_t i=1; i<MESH_BUFFERS; ++i)
+                    UTEST_ASSERT(f->vData[i][j] == float(seq));
+            }
+        }
+
+        plug::mesh_t::destroy(mesh);
+    }
+
+    void test_stress()
+    {
+        plug::mesh_t *mesh  = plug::mesh_t::create(MESH_BUFFERS, MESH_ITEMS);
+        UTEST_ASSERT(mesh != NULL);
+
+        context_t prod, cons;
+        prod.mesh       = mesh;
+        prod.frames     = 0;
+        prod.errors     = 0;
+        cons.mesh       = mesh;
+        cons.frames     = 0;
+        cons.errors     = 0;
+
+        ipc::Thread tp(producer, &prod);
+        ipc::Thread tc(consumer, &cons);
+
+        UTEST_ASSERT(tc.start() == STATUS_OK);
+        UTEST_ASSERT(tp.start() == STATUS_OK);
+        UTEST_ASSERT(tp.join() == STATUS_OK);
+        UTEST_ASSERT(tc.join() == STATUS_OK);
+
+        printf("Transferred frames: produced=%d, consumed=%d, errors=%d\n",
+            int(prod.frames), int(cons.frames), int(cons.errors));
+
+        UTEST_ASSERT(cons.errors == 0);
+        UTEST_ASSERT(prod.frames == FRAMES_TOTAL);
+        UTEST_ASSERT(cons.frames > 0);
+        UTEST_ASSERT(cons.frames <= FRAMES_TOTAL);
+
+        plug::mesh_t::destroy(mesh);
+    }
+
+    UTEST_MAIN
+    {
+        printf("Testing single-threaded access...\n");
+        test_single_thread();
+
+        printf("Testing partial update of buffers...\n");
+        test_partial_update();
+
+        printf("Testing concurrent producer and consumer...\n");
+        test_stress();
+    }
+
+UTEST_END
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 28 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/plug-fw/plug/data.h>
+
+#define BLOCK_SIZE          1024
+#define CHUNK_MAX           128
+#define SAMPLE_RATE         48000
+
+UTEST_BEGIN("plug", midi_split)
+
+    static const size_t split_points[] = { 0, 100, 356, 700, BLOCK_SIZE };
+
+    void test_events()
+    {
+        plug::midi_t block, in, out;
+        block.clear();
+        out.clear();
+
+        // Fill the whole block with note events, some of them are exactly at split points
+        for (size_t i=0; i<BLOCK_SIZE; i += 37)
+        {
+            midi::event_t ev;
+            ::memset(&ev, 0, sizeof(ev));
+            ev.timestamp    = uint32_t(i);
+            ev.type         = midi::MIDI_MSG_NOTE_ON;
+            ev.note.pitch   = uint8_t(i & 0x7f);
+            UTEST_ASSERT(block.push(ev));
+        }
+        for (size_t i=1; i<sizeof(split_points)/sizeof(size_t) - 1; ++i)
+        {
+            midi::event_t ev;
+            ::memset(&ev, 0, sizeof(ev));
+            ev.timestamp    = uint32_t(split_points[i]);
+            ev.type         = midi::MIDI_MSG_NOTE_OFF;
+            UTEST_ASSERT(block.push(ev));
+        }
+        block.sort();
+
+        // Emulate split processing: each sub-block is split further into chunks
+        size_t received = 0;
+        for (size_t i=1; i<sizeof(split_points)/sizeof(size_t); ++i)
+        {
+            for (size_t off = split_points[i-1], end = split_points[i]; off < end; )
+            {
+                size_t to_process = lsp_min(end - off, size_t(CHUNK_MAX));
+                in.slice(&block, off, to_process);
+                size_t first    = out.nEvents;
+
+                // The 'plugin' echoes each input event to the output
+                for (size_t j=0; j<in.nEvents; ++j)
+                {
+                    const midi::event_t *ev = &in.vEvents[j];
+                    UTEST_ASSERT_MSG(ev->timestamp < to_process,
+                        "Event timestamp %d is out of chunk of %d samples at offset %d",
+                        int(ev->timestamp), int(to_process), int(off));
+                    UTEST_ASSERT(out.push(ev));
+                }
+                out.shift(first, off);
+
+                received       += in.nEvents;
+                off            += to_process;
+            }
+        }
+
+        // Each event should be received exactly once and restored at the original position
+        UTEST_ASSERT_MSG(received == block.nEvents,
+            "Received %d events, expected %d", int(received), int(block.nEvents));
+        UTEST_ASSERT(out.nEvents == block.nEvents);
+        for (size_t i=0; i<block.nEvents; ++i)
+        {
+            const midi::event_t *a = &block.vEvents[i];
+            const midi::event_t *b = &out.vEvents[i];
+            UTEST_ASSERT_MSG((a->timestamp == b->timestamp) && (a->type == b->type) && (a->note.pitch == b->note.pitch),
+                "Event %d mismatch: timestamp %d vs %d", int(i), int(a->timestamp), int(b->timestamp));
+        }
+    }
+
+    void test_position()
+    {
+        plug::position_t start, pos;
+        plug::position_t::init(&start);
+        start.sampleRate        = SAMPLE_RATE;
+        start.beatsPerMinute    = 120.0;
+        start.frame             = 1000;
+        start.tick              = start.ticksPerBeat * 0.75;
+
+        // Half a beat at 120 BPM
+        pos                     = start;
+        plug::position_t::advance(&pos, SAMPLE_RATE / 4);
+        UTEST_ASSERT(pos.frame == 1000 + SAMPLE_RATE / 4);
+        UTEST_ASSERT_MSG(fabs(pos.tick - start.ticksPerBeat * 0.25) < 1e-3,
+            "tick = %f, expected %f", pos.tick, start.ticksPerBeat * 0.25);
+
+        // Stopped transport does not move
+        pos                     = start;
+        pos.speed               = 0.0;
+        plug::position_t::advance(&pos, SAMPLE_RATE);
+        UTEST_ASSERT(pos.frame == start.frame);
+        UTEST_ASSERT(fabs(pos.tick - start.tick) < 1e-3);
+    }
+
+    UTEST_MAIN
+    {
+        test_events();
+        test_position();
+    }
+
+UTEST_END
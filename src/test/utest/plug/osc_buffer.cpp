@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 14 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/plug-fw/plug/data.h>
+
+#define BUFFER_SIZE         0x1000
+#define PACKET_MAX          0x400
+#define PACKETS_TOTAL       100000
+#define SPIN_LIMIT          0x100
+
+UTEST_BEGIN("plug", osc_buffer)
+
+    typedef struct context_t
+    {
+        plug::osc_buffer_t *buf;
+        size_t              packets;
+        size_t              errors;
+    } context_t;
+
+    static size_t packet_size(size_t seq)
+    {
+        // Produce packets of variable size which are multiple of 4 bytes
+        return (((seq * 2654435761U) >> 7) % (PACKET_MAX / sizeof(uint32_t)) + 1) * sizeof(uint32_t);
+    }
+
+    static void fill_packet(uint32_t *dst, size_t seq, size_t words)
+    {
+        for (size_t i=0; i<words; ++i)
+            dst[i]      = uint32_t(seq * 31 + i);
+    }
+
+    static void backoff(size_t *spins)
+    {
+        if ((++(*spins)) >= SPIN_LIMIT)
+        {
+            ipc::Thread::sleep(1);
+            *spins      = 0;
+        }
+    }
+
+    static status_t producer(void *arg)
+    {
+        context_t *ctx  = static_cast<context_t *>(arg);
+        uint32_t packet[PACKET_MAX / sizeof(uint32_t)];
+        size_t spins    = 0;
+
+        for (size_t seq=0; seq < PACKETS_TOTAL; )
+        {
+            size_t size     = packet_size(seq);
+            fill_packet(packet, seq, size / sizeof(uint32_t));
+
+            // Alternate copying and zero-copy submission
+            status_t res;
+            if (seq & 1)
+            {
+                void *ptr       = NULL;
+                size_t avail    = 0;
+                res             = ctx->buf->reserve_packet(&ptr, &avail, size);
+                if ((res == STATUS_OK) && (avail < size))
+                {
+                    ctx->buf->cancel_packet();
+                    res             = STATUS_OVERFLOW;
+                }
+                else if (res == STATUS_OK)
+                {
+                    ::memcpy(ptr, packet, size);
+                    res             = ctx->buf->commit_packet(size);
+                }
+            }
+            else
+                res             = ctx->buf->submit(packet, size);
+
+            if (res == STATUS_OK)
+            {
+                ++seq;
+                ++ctx->packets;
+                spins           = 0;
+            }
+            else if (res == STATUS_OVERFLOW)
+                backoff(&spins);
+            else
+            {
+                ++ctx->errors;
+                return res;
+            }
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t consumer(void *arg)
+    {
+        context_t *ctx  = static_cast<context_t *>(arg);
+        uint32_t packet[PACKET_MAX / sizeof(uint32_t)];
+        uint32_t expected[PACKET_MAX / sizeof(uint32_t)];
+        size_t spins    = 0, size = 0;
+        const void *data;
+
+        for (size_t seq=0; seq < PACKETS_TOTAL; )
+        {
+            // Alternate copying and in-place reading
+            status_t res;
+            if (seq & 2)
+                res             = ctx->buf->peek_packet(&data, &size);
+            else
+            {
+                res             = ctx->buf->fetch(packet, &size, sizeof(packet));
+                data            = packet;
+            }
+
+            if (res == STATUS_OK)
+            {
+                size_t required = packet_size(seq);
+                fill_packet(expected, seq, required / sizeof(uint32_t));
+                if ((size != required) || (::memcmp(data, expected, size) != 0))
+                    ++ctx->errors;
+                if ((seq & 2) && (ctx->buf->release_packet() != STATUS_OK))
+                    ++ctx->errors;
+
+                ++seq;
+                ++ctx->packets;
+                spins           = 0;
+            }
+            else if (res == STATUS_NO_DATA)
+                backoff(&spins);
+            else
+            {
+                ++ctx->errors;
+                return res;
+            }
+        }
+
+        return STATUS_OK;
+    }
+
+    void test_single_thread()
+    {
+        plug::osc_buffer_t *buf = plug::osc_buffer_t::create(BUFFER_SIZE);
+        UTEST_ASSERT(buf != NULL);
+
+        uint32_t packet[PACKET_MAX / sizeof(uint32_t)];
+        uint32_t expected[PACKET_MAX / sizeof(uint32_t)];
+        size_t size = 0;
+
+        // Check argument validation
+        UTEST_ASSERT(buf->submit(packet, 0) == STATUS_BAD_ARGUMENTS);
+        UTEST_ASSERT(buf->submit(packet, 3) == STATUS_BAD_ARGUMENTS);
+        UTEST_ASSERT(buf->submit(packet, BUFFER_SIZE) == STATUS_TOO_BIG);
+        UTEST_ASSERT(buf->fetch(packet, &size, sizeof(packet)) == STATUS_NO_DATA);
+        UTEST_ASSERT(buf->skip() == 0);
+
+        // Fill the buffer until overflow, the records should wrap around the end
+        for (size_t pass=0; pass < 8; ++pass)
+        {
+            size_t seq = pass * 1000, submitted = 0;
+            while (true)
+            {
+                size_t psize    = packet_size(seq + submitted);
+                fill_packet(packet, seq + submitted, psize / sizeof(uint32_t));
+                status_t res    = buf->submit(packet, psize);
+                if (res == STATUS_OVERFLOW)
+                    break;
+                UTEST_ASSERT(res == STATUS_OK);
+                ++submitted;
+            }
+            UTEST_ASSERT(submitted > 0);
+            UTEST_ASSERT(buf->size() <= BUFFER_SIZE);
+
+            // Skip first record
+            UTEST_ASSERT(buf->skip() == packet_size(seq));
+
+            // Read all other records
+            for (size_t i=1; i<submitted; ++i)
+            {
+                size_t psize    = packet_size(seq + i);
+                if (psize > sizeof(uint32_t))
+                    UTEST_ASSERT(buf->fetch(packet, &size, sizeof(uint32_t)) == STATUS_OVERFLOW);
+
+                UTEST_ASSERT(buf->fetch(packet, &size, sizeof(packet)) == STATUS_OK);
+                fill_packet(expected, seq + i, psize / sizeof(uint32_t));
+                UTEST_ASSERT(size == psize);
+                UTEST_ASSERT(::memcmp(packet, expected, size) == 0);
+            }
+
+            UTEST_ASSERT(buf->size() == 0);
+        }
+
+        // Check zero-copy access
+        void *ptr = NULL;
+        const void *data = NULL;
+        size_t avail = 0;
+        UTEST_ASSERT(buf->commit_packet(sizeof(uint32_t)) == STATUS_BAD_STATE);
+        UTEST_ASSERT(buf->reserve_packet(&ptr, &avail, PACKET_MAX) == STATUS_OK);
+        UTEST_ASSERT(avail == PACKET_MAX);
+        fill_packet(static_cast<uint32_t *>(ptr), 1, 4);
+        UTEST_ASSERT(buf->commit_packet(sizeof(uint32_t) * 4) == STATUS_OK);
+        UTEST_ASSERT(buf->peek_packet(&data, &size) == STATUS_OK);
+        fill_packet(expected, 1, 4);
+        UTEST_ASSERT(size == sizeof(uint32_t) * 4);
+        UTEST_ASSERT(::memcmp(data, expected, size) == 0);
+        UTEST_ASSERT(buf->release_packet() == STATUS_OK);
+        UTEST_ASSERT(buf->peek_packet(&data, &size) == STATUS_NO_DATA);
+
+        // Check clear
+        UTEST_ASSERT(buf->submit(packet, sizeof(uint32_t) * 4) == STATUS_OK);
+        UTEST_ASSERT(buf->size() == sizeof(uint32_t) * 5);
+        buf->clear();
+        UTEST_ASSERT(buf->size() == 0);
+        UTEST_ASSERT(buf->fetch(packet, &size, sizeof(packet)) == STATUS_NO_DATA);
+
+        plug::osc_buffer_t::destroy(buf);
+    }
+
+    void test_stress()
+    {
+        plug::osc_buffer_t *buf = plug::osc_buffer_t::create(BUFFER_SIZE);
+        UTEST_ASSERT(buf != NULL);
+
+        context_t prod, cons;
+        prod.buf        = buf;
+        prod.packets    = 0;
+        prod.errors     = 0;
+        cons.buf        = buf;
+        cons.packets    = 0;
+        cons.errors     = 0;
+
+        ipc::Thread tp(producer, &prod);
+        ipc::Thread tc(consumer, &cons);
+
+        UTEST_ASSERT(tc.start() == STATUS_OK);
+        UTEST_ASSERT(tp.start() == STATUS_OK);
+        UTEST_ASSERT(tp.join() == STATUS_OK);
+        UTEST_ASSERT(tc.join() == STATUS_OK);
+
+        printf("Transferred packets: produced=%d, consumed=%d, errors=%d\n",
+            int(prod.packets), int(cons.packets), int(prod.errors + cons.errors));
+
+        UTEST_ASSERT(prod.errors == 0);
+        UTEST_ASSERT(cons.errors == 0);
+        UTEST_ASSERT(prod.packets == PACKETS_TOTAL);
+        UTEST_ASSERT(cons.packets == PACKETS_TOTAL);
+        UTEST_ASSERT(buf->size() == 0);
+
+        plug::osc_buffer_t::destroy(buf);
+    }
+
+    UTEST_MAIN
+    {
+        printf("Testing single-threaded access...\n");
+        test_single_thread();
+
+        printf("Testing concurrent producer and consumer...\n");
+        test_stress();
+    }
+
+UTEST_END
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 28 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/plug-fw/plug/data.h>
+
+UTEST_BEGIN("plug", ui_feedback)
+
+    void test_report()
+    {
+        plug::ui_feedback_t fb;
+
+        // Nothing reported: the default value should be returned
+        fb.reset();
+        UTEST_ASSERT(fb.rate(MESH_REFRESH_RATE) == MESH_REFRESH_RATE);
+        UTEST_ASSERT(fb.rate(-1.0f) == -1.0f);
+
+        // The reported rate overrides the default value
+        fb.report(25.0f);
+        UTEST_ASSERT(fb.rate(MESH_REFRESH_RATE) == 25.0f);
+        fb.report(0.5f);
+        UTEST_ASSERT(fb.rate(MESH_REFRESH_RATE) == 0.5f);
+
+        // Hidden data is reported as zero rate
+        fb.report(0.0f);
+        UTEST_ASSERT(fb.rate(MESH_REFRESH_RATE) == 0.0f);
+        fb.report(-10.0f);
+        UTEST_ASSERT(fb.rate(MESH_REFRESH_RATE) == 0.0f);
+
+        // Too large rate should not be treated as unknown
+        fb.report(1e+9f);
+        UTEST_ASSERT(fb.rate(MESH_REFRESH_RATE) > 1e+5f);
+
+        fb.reset();
+        UTEST_ASSERT(fb.rate(MESH_REFRESH_RATE) == MESH_REFRESH_RATE);
+    }
+
+    void test_buffers()
+    {
+        // All kinds of buffers should be created with no feedback reported
+        plug::mesh_t *mesh          = plug::mesh_t::create(2, 16);
+        plug::stream_t *stream      = plug::stream_t::create(2, 16, 256);
+        plug::frame_buffer_t *fb    = plug::frame_buffer_t::create(16, 32);
+        UTEST_ASSERT(mesh != NULL);
+        UTEST_ASSERT(stream != NULL);
+        UTEST_ASSERT(fb != NULL);
+
+        UTEST_ASSERT(mesh->feedback()->rate(-1.0f) == -1.0f);
+        UTEST_ASSERT(stream->feedback()->rate(-1.0f) == -1.0f);
+        UTEST_ASSERT(fb->feedback()->rate(-1.0f) == -1.0f);
+
+        // Publishing of data should not affect the feedback
+        mesh->feedback()->report(0.0f);
+        mesh->data(2, 16);
+        UTEST_ASSERT(mesh->consume());
+        UTEST_ASSERT(mesh->feedback()->rate(-1.0f) == 0.0f);
+
+        plug::frame_buffer_t::destroy(fb);
+        plug::stream_t::destroy(stream);
+        plug::mesh_t::destroy(mesh);
+    }
+
+    UTEST_MAIN
+    {
+        printf("Testing reports of the rate...\n");
+        test_report();
+
+        printf("Testing feedback of port buffers...\n");
+        test_buffers();
+    }
+
+UTEST_END
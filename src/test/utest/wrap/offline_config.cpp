@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 28 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/ITask.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/wrapper.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/impl/wrapper.h>
+
+namespace
+{
+    using namespace lsp;
+
+    static const meta::port_t test_ports[] =
+    {
+        { "gain",   "Gain",         meta::U_GAIN_AMP,   meta::R_CONTROL,    meta::F_IN | meta::F_LOWER | meta::F_UPPER,
+            0.0f, 4.0f, 1.0f, 0.01f, NULL, NULL },
+        { "freq",   "Frequency",    meta::U_HZ,         meta::R_CONTROL,    meta::F_IN | meta::F_LOWER | meta::F_UPPER,
+            10.0f, 20000.0f, 1000.0f, 0.1f, NULL, NULL },
+        { "on",     "Enabled",      meta::U_BOOL,       meta::R_CONTROL,    meta::F_IN,
+            0.0f, 1.0f, 0.0f, 1.0f, NULL, NULL },
+        { "file",   "File",         meta::U_STRING,     meta::R_PATH,       meta::F_IN,
+            0.0f, 0.0f, 0.0f, 0.0f, NULL, NULL },
+        { NULL,     NULL,           meta::U_NONE,       meta::R_CONTROL,    0,
+            0.0f, 0.0f, 0.0f, 0.0f, NULL, NULL }
+    };
+
+    static const int test_classes[] = { -1 };
+
+    static const meta::plugin_t test_plugin =
+    {
+        "Test", "Test plugin", "T", NULL, "test_offline_config",
+        NULL, NULL, NULL, 0, NULL, 0,
+        test_classes, 0, test_ports, NULL, NULL, NULL, NULL
+    };
+
+    // Emulates the plugin that loads the file referenced by the path port in background
+    class LoadTask: public ipc::ITask
+    {
+        public:
+            virtual status_t run()
+            {
+                ipc::Thread::sleep(50);
+                return STATUS_OK;
+            }
+    };
+
+    class TestLoader: public plug::Module
+    {
+        public:
+            plug::IPort    *pFile;
+            LoadTask        sTask;
+            bool            bLoaded;
+            size_t          nBlocks;
+
+        public:
+            explicit TestLoader(const meta::plugin_t *meta): plug::Module(meta)
+            {
+                pFile       = NULL;
+                bLoaded     = false;
+                nBlocks     = 0;
+            }
+
+            virtual void init(plug::IWrapper *wrapper, plug::IPort **ports)
+            {
+                plug::Module::init(wrapper, ports);
+                pFile       = ports[3];
+            }
+
+            virtual void process(size_t samples)
+            {
+                ++nBlocks;
+                plug::path_t *path = pFile->buffer<plug::path_t>();
+                if ((path->pending()) && (sTask.idle()))
+                {
+                    path->accept();
+                    pWrapper->executor()->submit(&sTask);
+                }
+                else if (sTask.completed())
+                {
+                    path->commit();
+                    sTask.reset();
+                    bLoaded     = true;
+                }
+            }
+    };
+
+    class TestWrapper: public offline::Wrapper
+    {
+        public:
+            explicit TestWrapper(plug::Module *plugin): offline::Wrapper(plugin, NULL) {}
+
+        public:
+            // Create ports without loading the manifest from resources
+            void bind_ports()
+            {
+                lltl::parray<plug::IPort> ports;
+                for (const meta::port_t *p = pPlugin->metadata()->ports; p->id != NULL; ++p)
+                    create_port(&ports, p, NULL);
+                pPlugin->init(this, ports.array());
+            }
+    };
+}
+
+UTEST_BEGIN("wrap", offline_config)
+
+    void write_config(const io::Path *path)
+    {
+        FILE *fd = fopen(path->as_native(), "w");
+        UTEST_ASSERT(fd != NULL);
+        fprintf(fd, "# Test configuration\n");
+        fprintf(fd, "gain = 0.5\n");
+        fprintf(fd, "freq = 440.0\n");
+        fprintf(fd, "on = true\n");
+        fprintf(fd, "file = \"samples/kick.wav\"\n");
+        fclose(fd);
+    }
+
+    void test_wait_resources(const io::Path *cfg)
+    {
+        TestLoader module(&test_plugin);
+        TestWrapper wrapper(&module);
+        wrapper.bind_ports();
+
+        // Nothing to load: the stream starts immediately
+        wrapper.start(48000);
+        UTEST_ASSERT(module.nBlocks == 0);
+
+        // The file should be loaded before the first block of the stream
+        UTEST_ASSERT(wrapper.import_settings(cfg) == STATUS_OK);
+        wrapper.start(48000);
+        UTEST_ASSERT(module.bLoaded);
+        UTEST_ASSERT(module.nBlocks > 0);
+
+        plug::path_t *path = module.pFile->buffer<plug::path_t>();
+        UTEST_ASSERT(!path->pending());
+        UTEST_ASSERT(!path->accepted());
+
+        wrapper.destroy();
+        module.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        io::Path cfg, expected;
+        LSPString name;
+        UTEST_ASSERT(name.fmt_utf8("%s.cfg", full_name()) > 0);
+        UTEST_ASSERT(cfg.set(tempdir(), &name) == STATUS_OK);
+        UTEST_ASSERT(expected.set(tempdir(), "samples/kick.wav") == STATUS_OK);
+        UTEST_ASSERT(expected.canonicalize() == STATUS_OK);
+        write_config(&cfg);
+
+        plug::Module module(&test_plugin);
+        TestWrapper wrapper(&module);
+        wrapper.bind_ports();
+
+        UTEST_ASSERT(wrapper.import_settings(&cfg) == STATUS_OK);
+
+        // Apply pending changes as the processing cycle does
+        offline::Port *gain = wrapper.port_by_id("gain");
+        offline::Port *freq = wrapper.port_by_id("freq");
+        offline::Port *on   = wrapper.port_by_id("on");
+        offline::Port *file = wrapper.port_by_id("file");
+        UTEST_ASSERT((gain != NULL) && (freq != NULL) && (on != NULL) && (file != NULL));
+
+        UTEST_ASSERT(gain->pre_process(0));
+        UTEST_ASSERT(freq->pre_process(0));
+        UTEST_ASSERT(on->pre_process(0));
+        UTEST_ASSERT(file->pre_process(0));
+
+        UTEST_ASSERT_MSG(gain->value() == 0.5f, "gain = %f", gain->value());
+        UTEST_ASSERT_MSG(freq->value() == 440.0f, "freq = %f", freq->value());
+        UTEST_ASSERT(on->value() == 1.0f);
+
+        // Relative path should be resolved against the directory of configuration file
+        plug::path_t *path = file->buffer<plug::path_t>();
+        UTEST_ASSERT(path != NULL);
+        UTEST_ASSERT_MSG(strcmp(path->path(), expected.as_utf8()) == 0,
+            "path = '%s', expected = '%s'", path->path(), expected.as_utf8());
+
+        wrapper.destroy();
+        module.destroy();
+
+        test_wait_resources(&cfg);
+        UTEST_ASSERT(cfg.remove() == STATUS_OK);
+    }
+
+UTEST_END
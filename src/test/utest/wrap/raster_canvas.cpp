@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 26 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/wrap/raster/canvas.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define CANVAS_WIDTH        200
+#define CANVAS_HEIGHT       100
+#define MAX_MEAN_DIFF       2.0f        /* Maximum mean difference from other canvas per channel */
+
+UTEST_BEGIN("wrap", raster_canvas)
+
+    static float channel_sum(plug::ICanvas *cv, size_t shift)
+    {
+        plug::canvas_data_t *data = cv->data();
+        float sum = 0.0f;
+
+        for (size_t y=0; y<data->nHeight; ++y)
+        {
+            const uint32_t *row = reinterpret_cast<const uint32_t *>(&data->pData[y * data->nStride]);
+            for (size_t x=0; x<data->nWidth; ++x)
+                sum    += ((row[x] >> shift) & 0xff) / 255.0f;
+        }
+
+        return sum;
+    }
+
+    static float mean_diff(plug::ICanvas *a, plug::ICanvas *b)
+    {
+        plug::canvas_data_t *da = a->data();
+        plug::canvas_data_t *db = b->data();
+        float sum = 0.0f;
+
+        for (size_t y=0; y<da->nHeight; ++y)
+        {
+            const uint32_t *ra  = reinterpret_cast<const uint32_t *>(&da->pData[y * da->nStride]);
+            const uint32_t *rb  = reinterpret_cast<const uint32_t *>(&db->pData[y * db->nStride]);
+            for (size_t x=0; x<da->nWidth; ++x)
+                for (size_t shift=0; shift<32; shift += 8)
+                    sum    += fabsf(float((ra[x] >> shift) & 0xff) - float((rb[x] >> shift) & 0xff));
+        }
+
+        return sum / (da->nWidth * da->nHeight * 4);
+    }
+
+    static void draw_scene(plug::ICanvas *cv)
+    {
+        float xs[5] = { 10.0f, 60.0f, 110.0f, 160.0f, 190.0f };
+        float ys[5] = { 90.0f, 20.0f, 70.0f, 10.0f, 50.0f };
+
+        cv->set_anti_aliasing(true);
+        cv->set_color(0.1f, 0.2f, 0.3f, 0.0f);
+        cv->paint();
+        cv->radial_gradient(100, 50, Color(1.0f, 0.5f, 0.0f, 0.25f), Color(1.0f, 0.5f, 0.0f, 1.0f), 40);
+        cv->set_color(0.0f, 1.0f, 0.0f, 0.5f);
+        cv->circle(40, 40, 25);
+        cv->set_line_width(3.0f);
+        cv->set_color(1.0f, 1.0f, 1.0f, 0.0f);
+        cv->draw_lines(xs, ys, 5);
+        cv->set_line_width(1.0f);
+        cv->line(0.0f, 0.5f, 200.0f, 99.5f);
+        cv->sync();
+    }
+
+    void test_coverage()
+    {
+        wrap::RasterCanvas cv;
+        float xs[4], ys[4];
+
+        // Non-antialiased rectangle should cover only pixels which centers are inside
+        UTEST_ASSERT(cv.init(CANVAS_WIDTH, CANVAS_HEIGHT));
+        xs[0] = 10.25f; xs[1] = 60.75f; xs[2] = 60.75f; xs[3] = 10.25f;
+        ys[0] = 5.25f;  ys[1] = 5.25f;  ys[2] = 45.75f; ys[3] = 45.75f;
+        cv.draw_poly(xs, ys, 4, Color(0.0f, 0.0f, 0.0f, 1.0f), Color(1.0f, 0.0f, 0.0f, 0.0f));
+        cv.sync();
+        UTEST_ASSERT(channel_sum(&cv, 16) == 51.0f * 41.0f);
+        UTEST_ASSERT(channel_sum(&cv, 24) == CANVAS_WIDTH * CANVAS_HEIGHT);
+
+        // Antialiased rectangle should cover the exact area
+        UTEST_ASSERT(cv.init(CANVAS_WIDTH, CANVAS_HEIGHT));
+        cv.set_anti_aliasing(true);
+        cv.draw_poly(xs, ys, 4, Color(0.0f, 0.0f, 0.0f, 1.0f), Color(1.0f, 0.0f, 0.0f, 0.0f));
+        cv.sync();
+        float area = channel_sum(&cv, 16);
+        UTEST_ASSERT_MSG(fabsf(area - 50.5f * 40.5f) < 1.0f, "Rectangle area: %f", area);
+
+        // Circle, also partially outside of the canvas
+        UTEST_ASSERT(cv.init(CANVAS_WIDTH, CANVAS_HEIGHT));
+        cv.set_anti_aliasing(true);
+        cv.set_color(1.0f, 0.0f, 0.0f, 0.0f);
+        cv.circle(100, 50, 30);
+        cv.circle(200, 50, 20);
+        cv.sync();
+        area = channel_sum(&cv, 16);
+        float expected = M_PI * (30.0f * 30.0f + 20.0f * 20.0f * 0.5f);
+        UTEST_ASSERT_MSG(fabsf(area - expected) < expected * 0.01f, "Circle area: %f, expected: %f", area, expected);
+
+        // Self-overlapping stroke should not cut holes
+        UTEST_ASSERT(cv.init(CANVAS_WIDTH, CANVAS_HEIGHT));
+        cv.set_anti_aliasing(true);
+        cv.set_color(1.0f, 0.0f, 0.0f, 0.0f);
+        cv.set_line_width(4.0f);
+        xs[0] = 10.0f; xs[1] = 100.0f; xs[2] = 10.0f;
+        ys[0] = 50.0f; ys[1] = 50.0f;  ys[2] = 50.0f;
+        cv.draw_lines(xs, ys, 3);
+        cv.sync();
+        area = channel_sum(&cv, 16);
+        UTEST_ASSERT_MSG(fabsf(area - 4.0f * 90.0f) < 1.0f, "Stroke area: %f", area);
+
+        // Scaled and mirrored copy of the canvas
+        wrap::RasterCanvas dst;
+        UTEST_ASSERT(dst.init(CANVAS_WIDTH * 2, CANVAS_HEIGHT * 2));
+        dst.draw_alpha(&cv, 0.0f, 0.0f, -2.0f, 2.0f, 0.0f);
+        dst.sync();
+        area = channel_sum(&dst, 16);
+        UTEST_ASSERT_MSG(fabsf(area - 4.0f * 4.0f * 90.0f) < 4.0f, "Scaled stroke area: %f", area);
+    }
+
+    void test_graph()
+    {
+        core::IDBuffer *buf = core::IDBuffer::create(3, CANVAS_WIDTH / 2);
+        UTEST_ASSERT(buf != NULL);
+        for (size_t i=0; i<buf->items; ++i)
+        {
+            buf->v[0][i]    = i;
+            buf->v[1][i]    = sinf(i * 0.1f);
+            buf->v[2][i]    = cosf(i * 0.05f);
+        }
+
+        plug::canvas_transform_t t;
+        t.xx    = 2.0f;
+        t.xy    = 0.0f;
+        t.yx    = 0.0f;
+        t.yy    = -40.0f;
+        t.x0    = 0.0f;
+        t.y0    = CANVAS_HEIGHT * 0.5f;
+
+        plug::canvas_series_t series[3] = {
+            { 0, 1, plug::CANVAS_SERIES_FILL, 1.0f, Color(1.0f, 0.0f, 0.0f, 0.0f), Color(0.0f, 0.0f, 1.0f, 0.5f) },
+            { 0, 2, 0, 2.0f, Color(0.0f, 1.0f, 0.0f, 0.25f), Color(0.0f, 0.0f, 0.0f, 1.0f) },
+            { 0, 3, 0, 2.0f, Color(1.0f, 1.0f, 1.0f, 0.0f), Color(0.0f, 0.0f, 0.0f, 1.0f) }, // Invalid buffer index
+        };
+
+        // Draw the graph with single call
+        wrap::RasterCanvas a;
+        UTEST_ASSERT(a.init(CANVAS_WIDTH, CANVAS_HEIGHT));
+        a.set_anti_aliasing(true);
+        a.draw_buffer(buf, &t, series, 3);
+        a.sync();
+
+        // Draw the same graph series by series
+        wrap::RasterCanvas b;
+        float *x = new float[buf->items * 2];
+        float *y = &x[buf->items];
+        UTEST_ASSERT(b.init(CANVAS_WIDTH, CANVAS_HEIGHT));
+        b.set_anti_aliasing(true);
+
+        plug::ICanvas::transform_graph(x, y, buf->v[0], buf->v[1], &t, buf->items);
+        for (size_t i=0; i<buf->items; ++i)
+        {
+            UTEST_ASSERT(x[i] == i * 2.0f);
+            UTEST_ASSERT(y[i] == buf->v[1][i] * -40.0f + CANVAS_HEIGHT * 0.5f);
+        }
+        b.set_line_width(1.0f);
+        b.draw_poly(x, y, buf->items, series[0].sStroke, series[0].sFill);
+
+        plug::ICanvas::transform_graph(x, y, buf->v[0], buf->v[2], &t, buf->items);
+        b.set_line_width(2.0f);
+        static_cast<plug::ICanvas *>(&b)->set_color(series[1].sStroke);
+        b.draw_lines(x, y, buf->items);
+        b.sync();
+
+        UTEST_ASSERT(channel_sum(&a, 8) > 0.0f);
+        UTEST_ASSERT(mean_diff(&a, &b) == 0.0f);
+
+        delete [] x;
+        buf->destroy();
+    }
+
+    void test_compare()
+    {
+        wrap::RasterCanvas cv;
+        UTEST_ASSERT(cv.init(CANVAS_WIDTH, CANVAS_HEIGHT));
+        draw_scene(&cv);
+
+        // Compare with other canvas implementations available in the build
+        for (plug::ICanvasFactory *f = plug::ICanvasFactory::root(); f != NULL; f = f->next())
+        {
+            plug::ICanvas *other = f->create_canvas(CANVAS_WIDTH, CANVAS_HEIGHT);
+            if (other == NULL)
+                continue;
+
+            if (dynamic_cast<wrap::RasterCanvas *>(other) == NULL)
+            {
+                draw_scene(other);
+                float diff = mean_diff(&cv, other);
+                printf("Mean difference: %f\n", diff);
+                UTEST_ASSERT_MSG(diff <= MAX_MEAN_DIFF, "Mean difference: %f", diff);
+            }
+
+            other->destroy();
+            delete other;
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_coverage();
+        test_graph();
+        test_compare();
+    }
+
+UTEST_END
@@ -74,6 +74,8 @@ namespace lsp
                 virtual void draw_poly(float *x, float *y, size_t count, const Color &stroke, const Color &fill);
                 virtual bool set_anti_aliasing(bool enable);
                 virtual void draw_lines(float *x, float *y, size_t count);
+                virtual void draw_graph(const float * const *v, size_t lines, size_t items,
+                        const plug::canvas_transform_t *t, const plug::canvas_series_t *series, size_t count);
                 virtual void circle(ssize_t x, ssize_t y, ssize_t r);
                 virtual void radial_gradient(ssize_t x, ssize_t y, const Color &c1, const Color &c2, ssize_t r);
 
@@ -256,6 +258,39 @@ namespace lsp
             cairo_stroke(pCR);
         }
 
+        void CairoCanvas::draw_graph(const float * const *v, size_t lines, size_t items,
+                const plug::canvas_transform_t *t, const plug::canvas_series_t *series, size_t count)
+        {
+            if ((v == NULL) || (t == NULL) || (series == NULL) || (items < 2) || (pCR == NULL))
+                return;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                const plug::canvas_series_t *s = &series[i];
+                if ((s->nX >= lines) || (s->nY >= lines))
+                    continue;
+
+                // Transform coordinates while building the path
+                const float *x  = v[s->nX];
+                const float *y  = v[s->nY];
+                cairo_move_to(pCR, x[0]*t->xx + y[0]*t->yx + t->x0, x[0]*t->xy + y[0]*t->yy + t->y0);
+                for (size_t j=1; j < items; ++j)
+                    cairo_line_to(pCR, x[j]*t->xx + y[j]*t->yx + t->x0, x[j]*t->xy + y[j]*t->yy + t->y0);
+
+                cairo_set_line_width(pCR, s->fWidth);
+                if (s->nFlags & plug::CANVAS_SERIES_FILL)
+                {
+                    const Color &fill = s->sFill;
+                    cairo_set_source_rgba(pCR, fill.red(), fill.green(), fill.blue(), 1.0 - fill.alpha());
+                    cairo_fill_preserve(pCR);
+                }
+
+                const Color &stroke = s->sStroke;
+                cairo_set_source_rgba(pCR, stroke.red(), stroke.green(), stroke.blue(), 1.0 - stroke.alpha());
+                cairo_stroke(pCR);
+            }
+        }
+
         void CairoCanvas::sync()
         {
             if (pCR == NULL)
@@ -364,7 +399,9 @@ namespace lsp
         }
 
         //---------------------------------------------------------------------
+    #ifndef LSP_PLUGIN_FW_RASTER_CANVAS
         static CairoCanvasFactory cairo_canvas_factory;
+    #endif /* LSP_PLUGIN_FW_RASTER_CANVAS */
     } /* namespace wrap */
 } /* namespace lsp */
 
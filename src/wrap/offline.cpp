@@ -0,0 +1,697 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 23 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/mm/InAudioFileStream.h>
+#include <lsp-plug.in/mm/OutAudioFileStream.h>
+
+#include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/core/Resources.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/types.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/wrapper.h>
+#include <lsp-plug.in/plug-fw/wrap/offline/impl/wrapper.h>
+
+namespace lsp
+{
+    namespace offline
+    {
+        typedef struct cmdline_t
+        {
+            const char                 *cfg_file;
+            const char                 *plugin_id;
+            const char                 *out_dir;
+            size_t                      block_size;
+            size_t                      jobs;
+            bool                        list;
+            lltl::parray<char>          files;
+        } cmdline_t;
+
+        typedef struct context_t
+        {
+            const cmdline_t            *cmdline;    // Command line
+            ipc::Mutex                  sLock;      // Lock for the job queue
+            size_t                      nNext;      // Index of next file to process
+            size_t                      nFailed;    // Number of failed files
+        } context_t;
+
+        /**
+         * Worker that owns an instance of the plugin and processes files
+         * from the shared queue until the queue becomes empty
+         */
+        class Worker: public ipc::Thread
+        {
+            private:
+                Worker(const Worker &);
+                Worker & operator = (const Worker &);
+
+            protected:
+                context_t              *pCtx;
+                resource::ILoader      *pLoader;
+                plug::Module           *pPlugin;
+                offline::Wrapper       *pWrapper;
+                float                  *vInData;    // Interleaved input data
+                float                  *vOutData;   // Interleaved output data
+                size_t                  nInChannels;// Number of channels in input buffer
+
+            protected:
+                status_t                init();
+                void                    destroy();
+                const char             *next_file();
+                void                    complete(bool success);
+                status_t                process_file(const char *path);
+                status_t                render(mm::InAudioFileStream *is, mm::OutAudioFileStream *os, size_t channels);
+
+            public:
+                explicit Worker(context_t *ctx);
+                virtual ~Worker();
+
+            public:
+                virtual status_t        run();
+        };
+
+        status_t parse_cmdline(cmdline_t *cfg, int argc, const char **argv)
+        {
+            // Initialize config with default values
+            cfg->cfg_file       = NULL;
+            cfg->plugin_id      = NULL;
+            cfg->out_dir        = NULL;
+            cfg->block_size     = OFFLINE_BLOCK_SIZE_DFL;
+            cfg->jobs           = ipc::Thread::system_cores();
+            cfg->list           = false;
+
+            // Parse arguments
+            int i = 1;
+
+            while (i < argc)
+            {
+                const char *arg = argv[i++];
+                if ((!::strcmp(arg, "--help")) || (!::strcmp(arg, "-h")))
+                {
+                    printf("Usage: %s [parameters] plugin-id file...\n\n", argv[0]);
+                    printf("Available parameters:\n");
+                    printf("  -b, --block <size>    Number of samples processed per one call, default %d\n", int(OFFLINE_BLOCK_SIZE_DFL));
+                    printf("  -c, --config <file>   Load settings file before processing\n");
+                    printf("  -h, --help            Output help\n");
+                    printf("  -j, --jobs <number>   Number of files processed in parallel, default is number of CPU cores\n");
+                    printf("  -l, --list            List available plugin identifiers\n");
+                    printf("  -o, --output <dir>    Directory to store processed files\n");
+                    printf("\n");
+
+                    return STATUS_CANCELLED;
+                }
+                else if ((!::strcmp(arg, "--config")) || (!::strcmp(arg, "-c")) ||
+                         (!::strcmp(arg, "--output")) || (!::strcmp(arg, "-o")) ||
+                         (!::strcmp(arg, "--block")) || (!::strcmp(arg, "-b")) ||
+                         (!::strcmp(arg, "--jobs")) || (!::strcmp(arg, "-j")))
+                {
+                    if (i >= argc)
+                    {
+                        fprintf(stderr, "Not specified value for '%s' parameter\n", arg);
+                        return STATUS_BAD_ARGUMENTS;
+                    }
+                    const char *value = argv[i++];
+
+                    if ((!::strcmp(arg, "--config")) || (!::strcmp(arg, "-c")))
+                        cfg->cfg_file       = value;
+                    else if ((!::strcmp(arg, "--output")) || (!::strcmp(arg, "-o")))
+                        cfg->out_dir        = value;
+                    else
+                    {
+                        char *end           = NULL;
+                        long v              = ::strtol(value, &end, 10);
+                        if ((end == NULL) || (*end != '\0') || (v <= 0))
+                        {
+                            fprintf(stderr, "Invalid value for '%s' parameter: %s\n", arg, value);
+                            return STATUS_BAD_ARGUMENTS;
+                        }
+
+                        if ((!::strcmp(arg, "--block")) || (!::strcmp(arg, "-b")))
+                            cfg->block_size     = v;
+                        else
+                            cfg->jobs           = v;
+                    }
+                }
+                else if ((!::strcmp(arg, "--list")) || (!::strcmp(arg, "-l")))
+                    cfg->list           = true;
+                else if ((arg[0] == '-') && (arg[1] != '\0'))
+                {
+                    fprintf(stderr, "Unknown parameter: %s\n", arg);
+                    return STATUS_BAD_ARGUMENTS;
+                }
+                else if (cfg->plugin_id == NULL)
+                    cfg->plugin_id      = arg;
+                else if (!cfg->files.add(const_cast<char *>(arg)))
+                    return STATUS_NO_MEM;
+            }
+
+            cfg->jobs           = lsp_max(cfg->jobs, size_t(1));
+
+            return STATUS_OK;
+        }
+
+        static ssize_t metadata_sort_func(const meta::plugin_t *a, const meta::plugin_t *b)
+        {
+            return strcmp(a->uid, b->uid);
+        }
+
+        status_t list_plugins()
+        {
+            lltl::parray<meta::plugin_t> list;
+            size_t maxlen = 0;
+
+            for (plug::Factory *f = plug::Factory::root(); f != NULL; f = f->next())
+            {
+                for (size_t i=0; ; ++i)
+                {
+                    // Enumerate next element
+                    const meta::plugin_t *meta = f->enumerate(i);
+                    if (meta == NULL)
+                        break;
+
+                    // Add metadata to list
+                    if (!list.add(const_cast<meta::plugin_t *>(meta)))
+                    {
+                        fprintf(stderr, "Error obtaining plugin list\n");
+                        return STATUS_NO_MEM;
+                    }
+
+                    // Estimate maximum length of plugin
+                    maxlen  = lsp_max(maxlen, strlen(meta->uid));
+                }
+            }
+
+            // Check that there are plugins in the list
+            if (list.is_empty())
+            {
+                printf("No plugins have been found\n");
+                return STATUS_OK;
+            }
+
+            // Sort plugin list
+            list.qsort(metadata_sort_func);
+
+            // Output sorted plugin list
+            char fmt[0x20];
+            sprintf(fmt, "  %%%ds  %%s\n", -int(maxlen));
+
+            for (size_t i=0, n=list.size(); i<n; ++i)
+            {
+                const meta::plugin_t *meta = list.uget(i);
+                printf(fmt, meta->uid, meta->description);
+            }
+
+            return STATUS_OK;
+        }
+
+        plug::Module *create_plugin(const char *id)
+        {
+            // Lookup plugin identifier among all registered plugin factories
+            for (plug::Factory *f = plug::Factory::root(); f != NULL; f = f->next())
+            {
+                for (size_t i=0; ; ++i)
+                {
+                    // Enumerate next element
+                    const meta::plugin_t *meta = f->enumerate(i);
+                    if (meta == NULL)
+                        break;
+
+                    // Check plugin identifier
+                    if (!::strcmp(meta->uid, id))
+                        return f->create(meta);
+                }
+            }
+
+            return NULL;
+        }
+
+        const meta::plugin_t *find_plugin(const char *id)
+        {
+            for (plug::Factory *f = plug::Factory::root(); f != NULL; f = f->next())
+            {
+                for (size_t i=0; ; ++i)
+                {
+                    const meta::plugin_t *meta = f->enumerate(i);
+                    if (meta == NULL)
+                        break;
+                    if (!::strcmp(meta->uid, id))
+                        return meta;
+                }
+            }
+
+            return NULL;
+        }
+
+        Worker::Worker(context_t *ctx)
+        {
+            pCtx            = ctx;
+            pLoader         = NULL;
+            pPlugin         = NULL;
+            pWrapper        = NULL;
+            vInData         = NULL;
+            vOutData        = NULL;
+            nInChannels     = 0;
+        }
+
+        Worker::~Worker()
+        {
+            destroy();
+        }
+
+        status_t Worker::init()
+        {
+            status_t res;
+            const cmdline_t *cmd = pCtx->cmdline;
+
+            // Create the resource loader
+            if ((pLoader = core::create_resource_loader()) == NULL)
+            {
+                lsp_error("No resource loader available");
+                return STATUS_NO_DATA;
+            }
+
+            // Create plugin module
+            if ((pPlugin = create_plugin(cmd->plugin_id)) == NULL)
+            {
+                fprintf(stderr, "Plugin instantiation error: %s\n", cmd->plugin_id);
+                return STATUS_NO_MEM;
+            }
+
+            // Create and initialize plugin wrapper
+            if ((pWrapper = new offline::Wrapper(pPlugin, pLoader)) == NULL)
+                return STATUS_NO_MEM;
+            if ((res = pWrapper->init(cmd->block_size)) != STATUS_OK)
+                return res;
+
+            // Load configuration (if specified in parameters)
+            if (cmd->cfg_file != NULL)
+            {
+                if ((res = pWrapper->import_settings(cmd->cfg_file)) != STATUS_OK)
+                {
+                    fprintf(stderr, "Error loading configuration file: '%s': %s\n", cmd->cfg_file, get_status(res));
+                    return res;
+                }
+            }
+
+            // Allocate buffer for interleaved output data
+            size_t outs     = pWrapper->audio_outputs();
+            if (outs <= 0)
+            {
+                fprintf(stderr, "Plugin %s has no audio outputs\n", cmd->plugin_id);
+                return STATUS_BAD_STATE;
+            }
+            vOutData        = static_cast<float *>(::malloc(sizeof(float) * outs * pWrapper->block_size()));
+
+            return (vOutData != NULL) ? STATUS_OK : STATUS_NO_MEM;
+        }
+
+        void Worker::destroy()
+        {
+            // Deactivate and destroy plugin
+            if (pPlugin != NULL)
+            {
+                if (pPlugin->active())
+                    pPlugin->deactivate();
+                pPlugin->destroy();
+                delete pPlugin;
+                pPlugin         = NULL;
+            }
+
+            // Destroy wrapper
+            if (pWrapper != NULL)
+            {
+                pWrapper->destroy();
+                delete pWrapper;
+                pWrapper        = NULL;
+            }
+
+            // Destroy resource loader
+            if (pLoader != NULL)
+            {
+                delete pLoader;
+                pLoader         = NULL;
+            }
+
+            // Free buffers
+            if (vInData != NULL)
+            {
+                ::free(vInData);
+                vInData         = NULL;
+            }
+            if (vOutData != NULL)
+            {
+                ::free(vOutData);
+                vOutData        = NULL;
+            }
+            nInChannels     = 0;
+        }
+
+        const char *Worker::next_file()
+        {
+            const char *file = NULL;
+            if (!pCtx->sLock.lock())
+                return NULL;
+
+            if (pCtx->nNext < pCtx->cmdline->files.size())
+                file    = pCtx->cmdline->files.uget(pCtx->nNext++);
+
+            pCtx->sLock.unlock();
+            return file;
+        }
+
+        void Worker::complete(bool success)
+        {
+            if (success)
+                return;
+            if (pCtx->sLock.lock())
+            {
+                ++pCtx->nFailed;
+                pCtx->sLock.unlock();
+            }
+        }
+
+        status_t Worker::render(mm::InAudioFileStream *is, mm::OutAudioFileStream *os, size_t channels)
+        {
+            const size_t block  = pWrapper->block_size();
+            const size_t ins    = pWrapper->audio_inputs();
+            const size_t outs   = pWrapper->audio_outputs();
+            size_t skip         = 0;        // Number of output frames to skip for latency compensation
+            size_t pad          = 0;        // Number of trailing frames to flush after the end of the input
+            bool first          = true;
+            bool eof            = false;
+
+            while (true)
+            {
+                size_t frames       = 0;
+
+                // Read the block of input data
+                if (!eof)
+                {
+                    ssize_t n           = is->read(vInData, block);
+                    if (n < 0)
+                    {
+                        if (n != -STATUS_EOF)
+                            return status_t(-n);
+                        n                   = 0;
+                    }
+                    eof                 = (n == 0);
+                    frames              = n;
+
+                    // De-interleave data, the missing channels are filled with the last one
+                    for (size_t i=0; i<ins; ++i)
+                    {
+                        float *dst          = pWrapper->input_buffer(i);
+                        const float *src    = &vInData[lsp_min(i, channels - 1)];
+                        for (size_t j=0; j<frames; ++j, src += channels)
+                            dst[j]              = *src;
+                    }
+                }
+
+                // Flush the tail of the processed data delayed by the plugin latency
+                if (eof)
+                {
+                    if (pad <= 0)
+                        break;
+
+                    frames              = lsp_min(pad, block);
+                    pad                -= frames;
+                    for (size_t i=0; i<ins; ++i)
+                        dsp::fill_zero(pWrapper->input_buffer(i), frames);
+                }
+
+                // Process the data
+                pWrapper->process(frames);
+                if (first)
+                {
+                    skip                = lsp_max(pPlugin->latency(), ssize_t(0));
+                    pad                 = skip;
+                    first               = false;
+                }
+
+                // Compensate latency
+                size_t off          = lsp_min(skip, frames);
+                skip               -= off;
+                frames             -= off;
+                if (frames <= 0)
+                    continue;
+
+                // Interleave and write data
+                for (size_t i=0; i<outs; ++i)
+                {
+                    const float *src    = &pWrapper->output_buffer(i)[off];
+                    float *dst          = &vOutData[i];
+                    for (size_t j=0; j<frames; ++j, dst += outs)
+                        *dst                = src[j];
+                }
+
+                ssize_t n           = os->write(vOutData, frames);
+                if (n < 0)
+                    return status_t(-n);
+                if (size_t(n) != frames)
+                    return STATUS_IO_ERROR;
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t Worker::process_file(const char *path)
+        {
+            status_t res;
+            const cmdline_t *cmd = pCtx->cmdline;
+
+            // Compute the output file name
+            io::Path src, dst;
+            LSPString name;
+            if ((res = src.set(path)) != STATUS_OK)
+                return res;
+            if ((res = src.get_last_noext(&name)) != STATUS_OK)
+                return res;
+            if (!name.append_ascii(".wav"))
+                return STATUS_NO_MEM;
+            if ((res = dst.set(cmd->out_dir)) != STATUS_OK)
+                return res;
+            if ((res = dst.append_child(&name)) != STATUS_OK)
+                return res;
+            if (dst.equals(&src))
+            {
+                fprintf(stderr, "Output file '%s' matches the input file\n", dst.as_native());
+                return STATUS_ALREADY_EXISTS;
+            }
+
+            // Open the input file
+            mm::InAudioFileStream is;
+            mm::audio_stream_t fmt;
+            if ((res = is.open(&src)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not open file '%s': %s\n", src.as_native(), get_status(res));
+                return res;
+            }
+            if (((res = is.info(&fmt)) != STATUS_OK) || (fmt.channels <= 0))
+            {
+                fprintf(stderr, "Could not read format of file '%s': %s\n", src.as_native(), get_status(res));
+                is.close();
+                return (res != STATUS_OK) ? res : STATUS_BAD_FORMAT;
+            }
+
+            // Re-allocate input buffer if needed
+            if (fmt.channels > nInChannels)
+            {
+                float *buf      = static_cast<float *>(::realloc(vInData, sizeof(float) * fmt.channels * pWrapper->block_size()));
+                if (buf == NULL)
+                {
+                    is.close();
+                    return STATUS_NO_MEM;
+                }
+                vInData         = buf;
+                nInChannels     = fmt.channels;
+            }
+
+            // Open the output file
+            mm::OutAudioFileStream os;
+            mm::audio_stream_t ofmt;
+            ofmt.srate      = fmt.srate;
+            ofmt.channels   = pWrapper->audio_outputs();
+            ofmt.frames     = -1;
+            ofmt.format     = mm::SFMT_F32;
+
+            if ((res = os.open(&dst, &ofmt, mm::AFMT_WAV | mm::CFMT_PCM)) != STATUS_OK)
+            {
+                fprintf(stderr, "Could not create file '%s': %s\n", dst.as_native(), get_status(res));
+                is.close();
+                return res;
+            }
+
+            // Process the data
+            pWrapper->start(fmt.srate);
+            res = render(&is, &os, fmt.channels);
+
+            // Close files
+            status_t res2   = os.close();
+            is.close();
+            if (res == STATUS_OK)
+                res             = res2;
+
+            if (res != STATUS_OK)
+                fprintf(stderr, "Error processing file '%s': %s\n", src.as_native(), get_status(res));
+            else
+                printf("%s -> %s\n", src.as_native(), dst.as_native());
+
+            return res;
+        }
+
+        status_t Worker::run()
+        {
+            dsp::context_t ctx;
+            const char *file;
+
+            // Initialize the plugin instance
+            status_t res = init();
+            if (res != STATUS_OK)
+            {
+                // Mark all remaining files as failed
+                while ((file = next_file()) != NULL)
+                    complete(false);
+                destroy();
+                return res;
+            }
+
+            // Process files
+            dsp::start(&ctx);
+            while ((file = next_file()) != NULL)
+                complete(process_file(file) == STATUS_OK);
+            dsp::finish(&ctx);
+
+            destroy();
+            return STATUS_OK;
+        }
+
+        status_t offline_main(const cmdline_t *cmdline)
+        {
+            status_t res = STATUS_OK;
+
+            // Initialize context
+            context_t ctx;
+            ctx.cmdline     = cmdline;
+            ctx.nNext       = 0;
+            ctx.nFailed     = 0;
+
+            // Launch workers, there is no sense to launch more workers than files
+            lltl::parray<Worker> workers;
+            size_t jobs     = lsp_min(cmdline->jobs, cmdline->files.size());
+
+            for (size_t i=0; i<jobs; ++i)
+            {
+                Worker *w       = new Worker(&ctx);
+                if ((w == NULL) || (!workers.add(w)))
+                {
+                    delete w;
+                    res             = STATUS_NO_MEM;
+                    break;
+                }
+                if ((res = w->start()) != STATUS_OK)
+                    break;
+            }
+
+            // Wait for all workers to complete
+            for (size_t i=0, n=workers.size(); i<n; ++i)
+            {
+                Worker *w       = workers.uget(i);
+                w->join();
+                delete w;
+            }
+            workers.flush();
+
+            if (res != STATUS_OK)
+                return res;
+
+            // Report status
+            if (ctx.nFailed > 0)
+            {
+                fprintf(stderr, "Failed to process %d of %d files\n", int(ctx.nFailed), int(cmdline->files.size()));
+                return STATUS_IO_ERROR;
+            }
+
+            return STATUS_OK;
+        }
+    } /* namespace offline */
+} /* namespace lsp */
+
+int main(int argc, const char **argv)
+{
+    using namespace lsp;
+
+    status_t res            = STATUS_OK;
+
+#ifndef LSP_IDE_DEBUG
+    IF_DEBUG( lsp::debug::redirect("lsp-offline.log"); );
+#endif /* LSP_IDE_DEBUG */
+
+    // Parse command-line arguments
+    offline::cmdline_t cmdline;
+    if ((res = offline::parse_cmdline(&cmdline, argc, argv)) != STATUS_OK)
+        return (res == STATUS_CANCELLED) ? 0 : -res;
+
+    // Need just to list available plugins?
+    if (cmdline.list)
+    {
+        if ((res = offline::list_plugins()) != STATUS_OK)
+            return -res;
+        return 0;
+    }
+
+    // Validate arguments
+    if (cmdline.plugin_id == NULL)
+    {
+        fprintf(stderr, "Not specified plugin identifier, exiting\n");
+        return -STATUS_NOT_FOUND;
+    }
+    if (offline::find_plugin(cmdline.plugin_id) == NULL)
+    {
+        fprintf(stderr, "Unknown plugin identifier: %s\n", cmdline.plugin_id);
+        return -STATUS_NOT_FOUND;
+    }
+    if (cmdline.out_dir == NULL)
+    {
+        fprintf(stderr, "Not specified output directory, exiting\n");
+        return -STATUS_BAD_ARGUMENTS;
+    }
+    if (cmdline.files.is_empty())
+    {
+        fprintf(stderr, "Not specified files to process, exiting\n");
+        return -STATUS_BAD_ARGUMENTS;
+    }
+
+    // Initialize DSP
+    dsp::init();
+
+    // Process files
+    res = offline::offline_main(&cmdline);
+
+    return (res == STATUS_OK) ? 0 : -res;
+}
@@ -0,0 +1,754 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugin-fw
+ * Created on: 26 июн. 2021 г.
+ *
+ * lsp-plugin-fw is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugin-fw is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugin-fw. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/plug-fw/plug.h>
+#include <lsp-plug.in/plug-fw/wrap/raster/canvas.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <limits.h>
+
+#define RASTER_ARC_TOLERANCE        0.1f        /* Maximum deviation of circle approximation from the arc, pixels */
+#define RASTER_ARC_MIN_SEGMENTS     8
+#define RASTER_ARC_MAX_SEGMENTS     1024
+
+namespace lsp
+{
+    namespace wrap
+    {
+        //---------------------------------------------------------------------
+        class RasterCanvasFactory: public plug::ICanvasFactory
+        {
+            private:
+                RasterCanvasFactory(const RasterCanvasFactory &);
+                RasterCanvasFactory & operator = (const RasterCanvasFactory &);
+
+            public:
+                explicit RasterCanvasFactory();
+                virtual ~RasterCanvasFactory();
+
+                /** Create canvas
+                 *
+                 * @param width initial width of canvas
+                 * @param height initial height of canvas
+                 * @return pointer to object or NULL if creation of canvas is not possible
+                 */
+                virtual plug::ICanvas *create_canvas(size_t width, size_t height);
+        };
+
+        //---------------------------------------------------------------------
+        RasterCanvasFactory::RasterCanvasFactory()
+        {
+        }
+
+        RasterCanvasFactory::~RasterCanvasFactory()
+        {
+        }
+
+        plug::ICanvas *RasterCanvasFactory::create_canvas(size_t width, size_t height)
+        {
+            RasterCanvas *cv = new RasterCanvas();
+            if (cv == NULL)
+                return cv;
+
+            if (!cv->init(width, height))
+            {
+                delete cv;
+                cv = NULL;
+            }
+
+            return cv;
+        }
+
+        //---------------------------------------------------------------------
+        static inline float channel(uint32_t v, size_t shift)
+        {
+            return float((v >> shift) & 0xff);
+        }
+
+        static inline uint32_t pack(float a, float r, float g, float b)
+        {
+            return  (uint32_t(a + 0.5f) << 24) |
+                    (uint32_t(r + 0.5f) << 16) |
+                    (uint32_t(g + 0.5f) << 8) |
+                    uint32_t(b + 0.5f);
+        }
+
+        //---------------------------------------------------------------------
+        RasterCanvas::RasterCanvas()
+        {
+            pPixels         = NULL;
+            vAccum          = NULL;
+            vCoverage       = NULL;
+            pData           = NULL;
+            nAccStride      = 0;
+            fLineWidth      = 2.0f;
+            bAntiAliasing   = false;
+            bLocked         = false;
+
+            set_paint(&sPaint, 0.0f, 0.0f, 0.0f, 0.0f);
+            reset_bbox();
+        }
+
+        RasterCanvas::~RasterCanvas()
+        {
+            destroy_data();
+        }
+
+        void RasterCanvas::destroy_data()
+        {
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData       = NULL;
+            }
+
+            pPixels         = NULL;
+            vAccum          = NULL;
+            vCoverage       = NULL;
+            nAccStride      = 0;
+        }
+
+        void RasterCanvas::set_paint(paint_t *p, float r, float g, float b, float a)
+        {
+            // The alpha value of the canvas API is the transparency
+            float k         = 255.0f * lsp_limit(1.0f - a, 0.0f, 1.0f);
+
+            p->vColor[0]    = k;
+            p->vColor[1]    = k * lsp_limit(r, 0.0f, 1.0f);
+            p->vColor[2]    = k * lsp_limit(g, 0.0f, 1.0f);
+            p->vColor[3]    = k * lsp_limit(b, 0.0f, 1.0f);
+            p->vDelta[0]    = 0.0f;
+            p->vDelta[1]    = 0.0f;
+            p->vDelta[2]    = 0.0f;
+            p->vDelta[3]    = 0.0f;
+            p->fX           = 0.0f;
+            p->fY           = 0.0f;
+            p->fKR          = 0.0f;
+            p->bGradient    = false;
+        }
+
+        void RasterCanvas::set_paint(paint_t *p, const Color &c)
+        {
+            set_paint(p, c.red(), c.green(), c.blue(), c.alpha());
+        }
+
+        void RasterCanvas::reset_bbox()
+        {
+            nMinX           = SSIZE_MAX;
+            nMinY           = SSIZE_MAX;
+            nMaxX           = 0;
+            nMaxY           = 0;
+        }
+
+        bool RasterCanvas::init(size_t width, size_t height)
+        {
+            // Check parameters
+            if ((sData.nWidth != width) || (sData.nHeight != height))
+            {
+                if (!bLocked)
+                    destroy_data();
+                else
+                {
+                    width   = sData.nWidth;
+                    height  = sData.nHeight;
+                }
+            }
+            if ((width <= 0) || (height <= 0))
+                return false;
+
+            // Allocate buffers
+            if (pData == NULL)
+            {
+                size_t stride       = width + 2;
+                size_t szof_pixels  = align_size(width * height * sizeof(uint32_t), DEFAULT_ALIGN);
+                size_t szof_accum   = align_size(stride * height * sizeof(float), DEFAULT_ALIGN);
+                size_t szof_cov     = align_size(stride * sizeof(float), DEFAULT_ALIGN);
+
+                uint8_t *ptr        = alloc_aligned<uint8_t>(pData, szof_pixels + szof_accum + szof_cov, DEFAULT_ALIGN);
+                if (ptr == NULL)
+                    return false;
+
+                pPixels             = reinterpret_cast<uint32_t *>(ptr);
+                ptr                += szof_pixels;
+                vAccum              = reinterpret_cast<float *>(ptr);
+                ptr                += szof_accum;
+                vCoverage           = reinterpret_cast<float *>(ptr);
+                nAccStride          = stride;
+
+                dsp::fill_zero(vAccum, stride * height);
+            }
+
+            // All seems to be OK
+            sData.nWidth        = width;
+            sData.nHeight       = height;
+            sData.nStride       = width * sizeof(uint32_t);
+            sData.pData         = NULL;
+            bLocked             = true;     // Lock size update
+
+            // Reset drawing state and clear surface
+            fLineWidth          = 2.0f;
+            bAntiAliasing       = false;
+            set_paint(&sPaint, 0.0f, 0.0f, 0.0f, 0.0f);
+            reset_bbox();
+
+            for (size_t i=0, n=width*height; i<n; ++i)
+                pPixels[i]          = 0xff000000;
+
+            return true;
+        }
+
+        void RasterCanvas::destroy()
+        {
+            destroy_data();
+        }
+
+        void RasterCanvas::accumulate(float x0, float y0, float x1, float y1)
+        {
+            // Edges are walked from top to bottom, the direction defines the sign of the area
+            float dir       = 1.0f;
+            if (y0 > y1)
+            {
+                lsp::swap(x0, x1);
+                lsp::swap(y0, y1);
+                dir             = -1.0f;
+            }
+
+            const float w   = sData.nWidth;
+            const float h   = sData.nHeight;
+            if ((y0 == y1) || (y1 <= 0.0f) || (y0 >= h))
+                return;
+
+            float dxdy      = (x1 - x0) / (y1 - y0);
+            float x         = (y0 < 0.0f) ? x0 - y0 * dxdy : x0;
+            ssize_t ys      = (y0 > 0.0f) ? ssize_t(y0) : 0;
+            ssize_t ye      = lsp_min(ssize_t(ceilf(y1)), ssize_t(sData.nHeight));
+
+            nMinY           = lsp_min(nMinY, ys);
+            nMaxY           = lsp_max(nMaxY, ye);
+
+            for (ssize_t y=ys; y<ye; ++y)
+            {
+                float *acc      = &vAccum[y * nAccStride];
+                float dy        = lsp_min(float(y + 1), y1) - lsp_max(float(y), y0);
+                float xnext     = x + dxdy * dy;
+                float d         = dy * dir;
+                float xa        = lsp_limit(lsp_min(x, xnext), 0.0f, w);
+                float xb        = lsp_limit(lsp_max(x, xnext), 0.0f, w);
+                float xaf       = floorf(xa);
+                float xbc       = ceilf(xb);
+                ssize_t xai     = xaf;
+                ssize_t xbi     = xbc;
+
+                if (xbi <= xai + 1)
+                {
+                    // The edge crosses the only pixel in the row
+                    float xmf       = 0.5f * (xa + xb) - xaf;
+                    acc[xai]       += d - d * xmf;
+                    acc[xai + 1]   += d * xmf;
+                    xbi             = xai + 1;
+                }
+                else
+                {
+                    // The edge crosses multiple pixels in the row
+                    float s         = 1.0f / (xb - xa);
+                    float xf0       = xa - xaf;
+                    float a0        = 0.5f * s * (1.0f - xf0) * (1.0f - xf0);
+                    float xf1       = xb - xbc + 1.0f;
+                    float am        = 0.5f * s * xf1 * xf1;
+
+                    acc[xai]       += d * a0;
+                    if (xbi == xai + 2)
+                        acc[xai + 1]   += d * (1.0f - a0 - am);
+                    else
+                    {
+                        float a1        = s * (1.5f - xf0);
+                        acc[xai + 1]   += d * (a1 - a0);
+                        for (ssize_t xi = xai + 2; xi < xbi - 1; ++xi)
+                            acc[xi]        += d * s;
+                        float a2        = a1 + (xbi - xai - 3) * s;
+                        acc[xbi - 1]   += d * (1.0f - a2 - am);
+                    }
+                    acc[xbi]       += d * am;
+                }
+
+                nMinX           = lsp_min(nMinX, xai);
+                nMaxX           = lsp_max(nMaxX, xbi + 1);
+                x               = xnext;
+            }
+        }
+
+        void RasterCanvas::add_edge(float x0, float y0, float x1, float y1)
+        {
+            // Horizontal and invalid edges do not contribute to the coverage
+            if (!(y0 != y1))
+                return;
+            if ((x0 != x0) || (x1 != x1))
+                return;
+
+            // Split the edge at the left and right borders: parts of the edge that
+            // are outside of the canvas are projected onto the border
+            const float w   = sData.nWidth;
+            const float dx  = x1 - x0;
+            const float dy  = y1 - y0;
+            float t[4];
+            size_t n        = 0;
+
+            t[n++]          = 0.0f;
+            if ((x0 < 0.0f) != (x1 < 0.0f))
+                t[n++]          = -x0 / dx;
+            if ((x0 < w) != (x1 < w))
+                t[n++]          = (w - x0) / dx;
+            if ((n == 3) && (t[1] > t[2]))
+                lsp::swap(t[1], t[2]);
+            t[n++]          = 1.0f;
+
+            float px        = x0, py = y0;
+            for (size_t i=1; i<n; ++i)
+            {
+                float nx        = (i < n-1) ? x0 + dx * t[i] : x1;
+                float ny        = (i < n-1) ? y0 + dy * t[i] : y1;
+                accumulate(lsp_limit(px, 0.0f, w), py, lsp_limit(nx, 0.0f, w), ny);
+                px              = nx;
+                py              = ny;
+            }
+        }
+
+        void RasterCanvas::add_triangle(float x0, float y0, float x1, float y1, float x2, float y2)
+        {
+            // Keep the same orientation as segments of the stroke have to make
+            // the non-zero winding rule join them instead of cutting holes
+            float area      = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+            if (area > 0.0f)
+            {
+                lsp::swap(x1, x2);
+                lsp::swap(y1, y2);
+            }
+
+            add_edge(x0, y0, x1, y1);
+            add_edge(x1, y1, x2, y2);
+            add_edge(x2, y2, x0, y0);
+        }
+
+        void RasterCanvas::add_polygon(const float *x, const float *y, size_t count)
+        {
+            if (count < 2)
+                return;
+
+            for (size_t i=1; i<count; ++i)
+                add_edge(x[i-1], y[i-1], x[i], y[i]);
+            add_edge(x[count-1], y[count-1], x[0], y[0]);
+        }
+
+        void RasterCanvas::add_stroke(const float *x, const float *y, size_t count)
+        {
+            float hw        = fLineWidth * 0.5f;
+            if ((hw <= 0.0f) || (count < 2))
+                return;
+
+            float pnx = 0.0f, pny = 0.0f;
+            bool joint      = false;
+
+            for (size_t i=1; i<count; ++i)
+            {
+                float x0        = x[i-1], y0 = y[i-1];
+                float x1        = x[i], y1 = y[i];
+                float dx        = x1 - x0;
+                float dy        = y1 - y0;
+                float len       = sqrtf(dx*dx + dy*dy);
+                if (!(len > 0.0f))
+                    continue;
+
+                // Segment of the line with butt caps
+                float nx        = -dy * hw / len;
+                float ny        = dx * hw / len;
+
+                add_edge(x0 + nx, y0 + ny, x1 + nx, y1 + ny);
+                add_edge(x1 + nx, y1 + ny, x1 - nx, y1 - ny);
+                add_edge(x1 - nx, y1 - ny, x0 - nx, y0 - ny);
+                add_edge(x0 - nx, y0 - ny, x0 + nx, y0 + ny);
+
+                // Bevel join with the previous segment
+                if (joint)
+                {
+                    add_triangle(x0, y0, x0 + pnx, y0 + pny, x0 + nx, y0 + ny);
+                    add_triangle(x0, y0, x0 - pnx, y0 - pny, x0 - nx, y0 - ny);
+                }
+
+                pnx             = nx;
+                pny             = ny;
+                joint           = true;
+            }
+        }
+
+        void RasterCanvas::add_circle(float x, float y, float r)
+        {
+            if (!(r > 0.0f))
+                return;
+
+            // Estimate number of segments to keep the deviation from the arc within the tolerance
+            size_t n        = RASTER_ARC_MAX_SEGMENTS;
+            if (r > RASTER_ARC_TOLERANCE)
+            {
+                float step      = acosf(1.0f - RASTER_ARC_TOLERANCE / r);
+                if (step > 0.0f)
+                    n               = lsp_limit(size_t(ceilf(M_PI / step)), size_t(RASTER_ARC_MIN_SEGMENTS), size_t(RASTER_ARC_MAX_SEGMENTS));
+            }
+            else
+                n               = RASTER_ARC_MIN_SEGMENTS;
+
+            float delta     = (2.0f * M_PI) / n;
+            float px        = x + r, py = y;
+            for (size_t i=1; i<n; ++i)
+            {
+                float nx        = x + r * cosf(i * delta);
+                float ny        = y + r * sinf(i * delta);
+                add_edge(px, py, nx, ny);
+                px              = nx;
+                py              = ny;
+            }
+            add_edge(px, py, x + r, y);
+        }
+
+        void RasterCanvas::composite(uint32_t *dst, const float *cov, const paint_t *p, ssize_t x, ssize_t y, size_t count)
+        {
+            if (p->bGradient)
+            {
+                const float dy  = y + 0.5f - p->fY;
+                const float dy2 = dy * dy;
+
+                for (size_t i=0; i<count; ++i)
+                {
+                    float dx        = x + ssize_t(i) + 0.5f - p->fX;
+                    float t         = sqrtf(dx*dx + dy2) * p->fKR;
+                    t               = (t < 1.0f) ? t : 1.0f;
+                    float c         = cov[i];
+
+                    float sa        = (p->vColor[0] + p->vDelta[0] * t) * c;
+                    float sr        = (p->vColor[1] + p->vDelta[1] * t) * c;
+                    float sg        = (p->vColor[2] + p->vDelta[2] * t) * c;
+                    float sb        = (p->vColor[3] + p->vDelta[3] * t) * c;
+                    float k         = 1.0f - sa * (1.0f / 255.0f);
+
+                    uint32_t d      = dst[i];
+                    dst[i]          = pack(
+                        sa + channel(d, 24) * k,
+                        sr + channel(d, 16) * k,
+                        sg + channel(d, 8) * k,
+                        sb + channel(d, 0) * k);
+                }
+            }
+            else
+            {
+                const float ca  = p->vColor[0];
+                const float cr  = p->vColor[1];
+                const float cg  = p->vColor[2];
+                const float cb  = p->vColor[3];
+
+                for (size_t i=0; i<count; ++i)
+                {
+                    float c         = cov[i];
+                    float k         = 1.0f - ca * c * (1.0f / 255.0f);
+
+                    uint32_t d      = dst[i];
+                    dst[i]          = pack(
+                        ca * c + channel(d, 24) * k,
+                        cr * c + channel(d, 16) * k,
+                        cg * c + channel(d, 8) * k,
+                        cb * c + channel(d, 0) * k);
+                }
+            }
+        }
+
+        void RasterCanvas::fill(const paint_t *p)
+        {
+            if ((pPixels == NULL) || (nMinY >= nMaxY) || (nMinX >= nMaxX))
+            {
+                reset_bbox();
+                return;
+            }
+
+            const ssize_t w     = sData.nWidth;
+            const ssize_t x0    = nMinX;
+            const ssize_t x1    = nMaxX;
+            const ssize_t count = lsp_min(x1, w) - x0;
+
+            for (ssize_t y=nMinY; y<nMaxY; ++y)
+            {
+                // Integrate the signed area into the coverage and clear the accumulator
+                float *acc      = &vAccum[y * nAccStride];
+                float s         = 0.0f;
+                for (ssize_t x=x0; x<x1; ++x)
+                {
+                    s              += acc[x];
+                    vCoverage[x]    = s;
+                    acc[x]          = 0.0f;
+                }
+                if (count <= 0)
+                    continue;
+
+                // Apply the non-zero winding rule
+                float *cov      = &vCoverage[x0];
+                if (bAntiAliasing)
+                {
+                    for (ssize_t i=0; i<count; ++i)
+                    {
+                        float c         = fabsf(cov[i]);
+                        cov[i]          = (c < 1.0f) ? c : 1.0f;
+                    }
+                }
+                else
+                {
+                    for (ssize_t i=0; i<count; ++i)
+                        cov[i]          = (fabsf(cov[i]) >= 0.5f) ? 1.0f : 0.0f;
+                }
+
+                composite(&pPixels[y * w + x0], cov, p, x0, y, count);
+            }
+
+            reset_bbox();
+        }
+
+        void RasterCanvas::set_color(float r, float g, float b, float a)
+        {
+            set_paint(&sPaint, r, g, b, a);
+        }
+
+        void RasterCanvas::paint()
+        {
+            if (pPixels == NULL)
+                return;
+
+            const size_t w  = sData.nWidth;
+            for (size_t i=0; i<w; ++i)
+                vCoverage[i]    = 1.0f;
+            for (size_t y=0; y<sData.nHeight; ++y)
+                composite(&pPixels[y * w], vCoverage, &sPaint, 0, y, w);
+        }
+
+        void RasterCanvas::set_line_width(float w)
+        {
+            fLineWidth      = w;
+        }
+
+        void RasterCanvas::line(float x1, float y1, float x2, float y2)
+        {
+            if (pPixels == NULL)
+                return;
+
+            float x[2]      = { x1, x2 };
+            float y[2]      = { y1, y2 };
+            add_stroke(x, y, 2);
+            fill(&sPaint);
+        }
+
+        void RasterCanvas::draw_poly(float *x, float *y, size_t count, const Color &stroke, const Color &fill)
+        {
+            if ((count < 2) || (pPixels == NULL))
+                return;
+
+            set_paint(&sPaint, fill);
+            add_polygon(x, y, count);
+            this->fill(&sPaint);
+
+            // The stroke color remains the current color as it does for cairo
+            set_paint(&sPaint, stroke);
+            add_stroke(x, y, count);
+            this->fill(&sPaint);
+        }
+
+        bool RasterCanvas::set_anti_aliasing(bool enable)
+        {
+            if (pPixels == NULL)
+                return false;
+
+            bool old        = bAntiAliasing;
+            bAntiAliasing   = enable;
+            return old;
+        }
+
+        void RasterCanvas::draw_lines(float *x, float *y, size_t count)
+        {
+            if ((count < 2) || (pPixels == NULL))
+                return;
+
+            add_stroke(x, y, count);
+            fill(&sPaint);
+        }
+
+        void RasterCanvas::circle(ssize_t x, ssize_t y, ssize_t r)
+        {
+            if (pPixels == NULL)
+                return;
+
+            add_circle(x, y, r);
+            fill(&sPaint);
+        }
+
+        void RasterCanvas::radial_gradient(ssize_t x, ssize_t y, const Color &c1, const Color &c2, ssize_t r)
+        {
+            if ((pPixels == NULL) || (r <= 0))
+                return;
+
+            // The gradient changes the transparency of the first color, the
+            // gradient remains the current source as it does for cairo
+            paint_t end;
+            set_paint(&sPaint, c1);
+            set_paint(&end, c1.red(), c1.green(), c1.blue(), c2.alpha());
+            for (size_t i=0; i<4; ++i)
+                sPaint.vDelta[i]    = end.vColor[i] - sPaint.vColor[i];
+            sPaint.fX       = x;
+            sPaint.fY       = y;
+            sPaint.fKR      = 1.0f / r;
+            sPaint.bGradient= true;
+
+            add_circle(x, y, r);
+            fill(&sPaint);
+        }
+
+        void RasterCanvas::draw_alpha(ICanvas *s, float x, float y, float sx, float sy, float a)
+        {
+            if (pPixels == NULL)
+                return;
+            RasterCanvas *cs = static_cast<RasterCanvas *>(s);
+            if ((cs->pPixels == NULL) || (sx == 0.0f) || (sy == 0.0f))
+                return;
+
+            const ssize_t sw    = cs->sData.nWidth;
+            const ssize_t sh    = cs->sData.nHeight;
+            const ssize_t w     = sData.nWidth;
+            const ssize_t h     = sData.nHeight;
+
+            if (sx < 0.0f)
+                x       -= sx * sw;
+            if (sy < 0.0f)
+                y       -= sy * sh;
+
+            // Compute the area of the canvas affected by the surface
+            float xe            = x + sx * sw;
+            float ye            = y + sy * sh;
+            ssize_t px0         = lsp_max(ssize_t(floorf(lsp_min(x, xe))), ssize_t(0));
+            ssize_t px1         = lsp_min(ssize_t(ceilf(lsp_max(x, xe))), w);
+            ssize_t py0         = lsp_max(ssize_t(floorf(lsp_min(y, ye))), ssize_t(0));
+            ssize_t py1         = lsp_min(ssize_t(ceilf(lsp_max(y, ye))), h);
+
+            const float op      = lsp_limit(1.0f - a, 0.0f, 1.0f);
+            const float kx      = 1.0f / sx;
+            const float ky      = 1.0f / sy;
+            const uint32_t *src = cs->pPixels;
+
+            // Draw the surface with bilinear filtering
+            for (ssize_t py=py0; py<py1; ++py)
+            {
+                float v             = (py + 0.5f - y) * ky - 0.5f;
+                float vf            = floorf(v);
+                ssize_t v0          = vf;
+                float fv            = v - vf;
+                const uint32_t *r0  = ((v0 >= 0) && (v0 < sh)) ? &src[v0 * sw] : NULL;
+                const uint32_t *r1  = ((v0 + 1 >= 0) && (v0 + 1 < sh)) ? &src[(v0 + 1) * sw] : NULL;
+                uint32_t *dst       = &pPixels[py * w];
+
+                for (ssize_t px=px0; px<px1; ++px)
+                {
+                    float u             = (px + 0.5f - x) * kx - 0.5f;
+                    float uf            = floorf(u);
+                    ssize_t u0          = uf;
+                    float fu            = u - uf;
+                    bool c0             = (u0 >= 0) && (u0 < sw);
+                    bool c1             = (u0 + 1 >= 0) && (u0 + 1 < sw);
+
+                    uint32_t t00        = ((r0 != NULL) && (c0)) ? r0[u0] : 0;
+                    uint32_t t01        = ((r0 != NULL) && (c1)) ? r0[u0 + 1] : 0;
+                    uint32_t t10        = ((r1 != NULL) && (c0)) ? r1[u0] : 0;
+                    uint32_t t11        = ((r1 != NULL) && (c1)) ? r1[u0 + 1] : 0;
+                    if ((t00 | t01 | t10 | t11) == 0)
+                        continue;
+
+                    float k00           = (1.0f - fu) * (1.0f - fv) * op;
+                    float k01           = fu * (1.0f - fv) * op;
+                    float k10           = (1.0f - fu) * fv * op;
+                    float k11           = fu * fv * op;
+
+                    float sc[4];
+                    for (size_t j=0; j<4; ++j)
+                    {
+                        size_t shift        = 24 - j*8;
+                        sc[j]               = channel(t00, shift) * k00 + channel(t01, shift) * k01 +
+                                              channel(t10, shift) * k10 + channel(t11, shift) * k11;
+                    }
+
+                    float k             = 1.0f - sc[0] * (1.0f / 255.0f);
+                    uint32_t d          = dst[px];
+                    dst[px]             = pack(
+                        sc[0] + channel(d, 24) * k,
+                        sc[1] + channel(d, 16) * k,
+                        sc[2] + channel(d, 8) * k,
+                        sc[3] + channel(d, 0) * k);
+                }
+            }
+        }
+
+        plug::canvas_data_t *RasterCanvas::data()
+        {
+            return &sData;
+        }
+
+        void *RasterCanvas::row(size_t row)
+        {
+            return (sData.pData != NULL) ? &sData.pData[row * sData.nStride] : NULL;
+        }
+
+        void *RasterCanvas::start_direct()
+        {
+            if (pPixels == NULL)
+                return NULL;
+
+            sData.nStride   = sData.nWidth * sizeof(uint32_t);
+            return sData.pData = reinterpret_cast<uint8_t *>(pPixels);
+        }
+
+        void RasterCanvas::end_direct()
+        {
+            sData.pData     = NULL;
+        }
+
+        void RasterCanvas::sync()
+        {
+            if (pPixels == NULL)
+                return;
+
+            // Return data
+            sData.nStride   = sData.nWidth * sizeof(uint32_t);
+            sData.pData     = reinterpret_cast<uint8_t *>(pPixels);
+
+            // Unlock size update
+            bLocked         = false;
+        }
+
+        //---------------------------------------------------------------------
+    #ifdef LSP_PLUGIN_FW_RASTER_CANVAS
+        static RasterCanvasFactory raster_canvas_factory;
+    #endif /* LSP_PLUGIN_FW_RASTER_CANVAS */
+    } /* namespace wrap */
+} /* namespace lsp */
+